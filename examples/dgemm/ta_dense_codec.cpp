@@ -0,0 +1,160 @@
+/*
+ * This file is a part of TiledArray.
+ * Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <iostream>
+#include <tiledarray.h>
+#include <TiledArray/version.h>
+
+// Compare the time and accuracy of a dense matrix multiply when the SUMMA
+// broadcasts use each of the tile transport codecs.
+int main(int argc, char** argv) {
+  int rc = 0;
+
+  try {
+
+    // Initialize runtime
+    TiledArray::World& world = TiledArray::initialize(argc, argv);
+
+    // Get command line arguments
+    if(argc < 3) {
+      std::cout << "Usage: " << argv[0] << " matrix_size block_size [repetitions]\n";
+      return 0;
+    }
+    const long matrix_size = atol(argv[1]);
+    const long block_size = atol(argv[2]);
+    if (matrix_size <= 0) {
+      std::cerr << "Error: matrix size must be greater than zero.\n";
+      return 1;
+    }
+    if (block_size <= 0) {
+      std::cerr << "Error: block size must be greater than zero.\n";
+      return 1;
+    }
+    if((matrix_size % block_size) != 0ul) {
+      std::cerr << "Error: matrix size must be evenly divisible by block size.\n";
+      return 1;
+    }
+    const long repeat = (argc >= 4 ? atol(argv[3]) : 5);
+    if (repeat <= 0) {
+      std::cerr << "Error: number of repetitions must be greater than zero.\n";
+      return 1;
+    }
+
+    const std::size_t num_blocks = matrix_size / block_size;
+    const std::size_t block_count = num_blocks * num_blocks;
+
+    if(world.rank() == 0)
+      std::cout << "TiledArray: dense matrix multiply tile codec test..."
+                << "\nGit HASH: " << TILEDARRAY_REVISION
+                << "\nNumber of nodes     = " << world.size()
+                << "\nMatrix size         = " << matrix_size << "x" << matrix_size
+                << "\nBlock size          = " << block_size << "x" << block_size
+                << "\nNumber of blocks    = " << block_count
+                << "\nAverage blocks/node = " << double(block_count) / double(world.size())
+                << "\n";
+
+    // Construct TiledRange
+    std::vector<unsigned int> blocking;
+    blocking.reserve(num_blocks + 1);
+    for(long i = 0l; i <= matrix_size; i += block_size)
+      blocking.push_back(i);
+
+    std::vector<TiledArray::TiledRange1> blocking2(2,
+        TiledArray::TiledRange1(blocking.begin(), blocking.end()));
+
+    TiledArray::TiledRange
+      trange(blocking2.begin(), blocking2.end());
+
+    const double gflop = 2.0 * double(matrix_size * matrix_size * matrix_size) / 1.0e9;
+
+    // Construct and initialize arrays
+    TiledArray::TArrayD a(world, trange);
+    TiledArray::TArrayD b(world, trange);
+    a.fill_random();
+    b.fill_random();
+
+    // Compute the reference result
+    TiledArray::TArrayD c_ref;
+    c_ref("m,n") = a("m,k") * b("k,n");
+
+    const std::vector<std::pair<std::string, TiledArray::TileCodec> > codecs = {
+      { "none", TiledArray::TileCodec() },
+      { "lossless", TiledArray::TileCodec::lossless() },
+      { "downcast", TiledArray::TileCodec::downcast() },
+      { "truncated", TiledArray::TileCodec::truncated(
+          TiledArray::SparseShape<float>::threshold()) }
+    };
+
+    for(const auto& codec : codecs) {
+
+      // Measure the encoded size of the local tiles of a
+      std::size_t encoded_size = 0ul, decoded_size = 0ul;
+      for(auto it = a.begin(); it != a.end(); ++it) {
+        const TiledArray::TensorD tile = *it;
+        TiledArray::detail::PackedTile<TiledArray::TensorD>
+            packed(tile, codec.second);
+        encoded_size += (codec.second.enabled() ? packed.encoded_size() : packed.decoded_size());
+        decoded_size += packed.decoded_size();
+      }
+      world.gop.sum(encoded_size);
+      world.gop.sum(decoded_size);
+
+      TiledArray::TArrayD c;
+      double total_time = 0.0;
+      for(int i = 0; i < repeat; ++i) {
+        world.gop.fence();
+        const double start = madness::wall_time();
+        c("m,n") = (a("m,k") * b("k,n")).set_codec(codec.second);
+        world.gop.fence();
+        total_time += madness::wall_time() - start;
+      }
+
+      TiledArray::TArrayD diff;
+      diff("m,n") = c("m,n") - c_ref("m,n");
+      const double error = diff("m,n").abs_max().get();
+
+      if(world.rank() == 0)
+        std::cout << "Codec " << codec.first
+                  << ":\n  Compression ratio   = " << double(decoded_size) / double(encoded_size)
+                  << "\n  Average wall time   = " << total_time / double(repeat)
+                  << " sec\n  Average GFLOPS      = " << gflop * double(repeat) / total_time
+                  << "\n  Max abs error       = " << error << "\n";
+    }
+
+    TiledArray::finalize();
+
+  } catch(TiledArray::Exception& e) {
+    std::cerr << "!! TiledArray exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(madness::MadnessException& e) {
+    std::cerr << "!! MADNESS exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(SafeMPI::Exception& e) {
+    std::cerr << "!! SafeMPI exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(std::exception& e) {
+    std::cerr << "!! std exception: " << e.what() << "\n";
+    rc = 1;
+  } catch(...) {
+    std::cerr << "!! exception: unknown exception\n";
+    rc = 1;
+  }
+
+  return rc;
+}
@@ -167,8 +167,14 @@ int main(int argc, char** argv) {
   M_oh_inv.fill(1.0);
   world.gop.fence();
   madness::print_meminfo(world.rank(), "made M_oh_inv");
-  array_type Eri(world, aad_trange, aad_shape);
-  Eri.fill(1.0);
+  // The three-center integrals are computed on demand (integral-direct), and
+  // each process caches up to half of its integral tiles between iterations.
+  const std::size_t eri_cache_size =
+      aad_trange.tiles_range().volume() / (2ul * world.size()) + 1ul;
+  auto Eri = TA::make_direct_array<TA::TensorD, TA::SparsePolicy>(world,
+      aad_trange, aad_shape,
+      [] (const TA::Range& range) { return TA::TensorD(range, 1.0); },
+      eri_cache_size, 1.0f);
   world.gop.fence();
   madness::print_meminfo(world.rank(), "made Eri");
   array_type K_temp(world, oad_trange, oad_shape);
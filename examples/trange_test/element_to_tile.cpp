@@ -0,0 +1,92 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <tiledarray.h>
+
+// Time random element-to-tile lookups, and return the time per lookup in ns
+double time_lookups(const TiledArray::TiledRange1& tr,
+    const std::vector<std::size_t>& elements, std::size_t& checksum)
+{
+  const auto start = std::chrono::high_resolution_clock::now();
+  for(const std::size_t e : elements)
+    checksum += tr.element_to_tile(e);
+  const auto stop = std::chrono::high_resolution_clock::now();
+
+  return std::chrono::duration<double, std::nano>(stop - start).count() /
+      double(elements.size());
+}
+
+int main(int argc, char** argv) {
+  // Get command line arguments
+  if(argc < 3) {
+    std::cout << "Usage: " << argv[0] << " elements tile_size [lookups = 10000000]\n";
+    return 0;
+  }
+  const long elements = atol(argv[1]);
+  const long tile_size = atol(argv[2]);
+  const long lookups = (argc >= 4 ? atol(argv[3]) : 10000000);
+  if(elements <= 0 || tile_size <= 0 || lookups <= 0) {
+    std::cerr << "Error: all arguments must be greater than zero.\n";
+    return 1;
+  }
+
+  std::mt19937 gen(42);
+
+  // Construct a uniform tiling and a tiling with random tile sizes in
+  // [tile_size / 2, 3 * tile_size / 2]
+  std::vector<std::size_t> uniform_blocking;
+  for(long i = 0l; i < elements; i += tile_size)
+    uniform_blocking.push_back(i);
+  uniform_blocking.push_back(elements);
+
+  std::uniform_int_distribution<long> size_dist(std::max(tile_size / 2l, 1l),
+      tile_size + tile_size / 2l);
+  std::vector<std::size_t> random_blocking;
+  for(long i = 0l; i < elements; i += size_dist(gen))
+    random_blocking.push_back(i);
+  random_blocking.push_back(elements);
+
+  const TiledArray::TiledRange1 uniform(uniform_blocking.begin(), uniform_blocking.end());
+  const TiledArray::TiledRange1 random(random_blocking.begin(), random_blocking.end());
+
+  // Generate the lookups
+  std::uniform_int_distribution<std::size_t> elem_dist(0ul, elements - 1l);
+  std::vector<std::size_t> lookup_elements(lookups);
+  for(std::size_t& e : lookup_elements)
+    e = elem_dist(gen);
+
+  std::size_t checksum = 0ul;
+  const double uniform_time = time_lookups(uniform, lookup_elements, checksum);
+  const double random_time = time_lookups(random, lookup_elements, checksum);
+
+  std::cout << "Elements:          " << elements
+            << "\nLookups:           " << lookups
+            << "\nUniform tiles:     " << uniform.tile_extent()
+            << " (tile size = " << uniform.tile_size() << ")"
+            << "\nNon-uniform tiles: " << random.tile_extent()
+            << " (tile size = " << random.tile_size() << ")"
+            << "\nUniform lookup:     " << uniform_time << " ns"
+            << "\nNon-uniform lookup: " << random_time << " ns"
+            << "\nChecksum:          " << checksum << "\n";
+
+  return 0;
+}
@@ -28,6 +28,7 @@
 
 #include <TiledArray/tensor_impl.h>
 #include <TiledArray/distributed_storage.h>
+#include <TiledArray/symm/tile_symmetry.h>
 #include <TiledArray/transform_iterator.h>
 #include <TiledArray/type_traits.h>
 
@@ -444,6 +445,7 @@ namespace TiledArray {
     private:
 
       storage_type data_; ///< Tile container
+      TiledArray::symmetry::TileSymmetry symmetry_; ///< The symmetry of the stored tiles
 
     public:
 
@@ -456,10 +458,13 @@ namespace TiledArray {
       /// \param pmap The tile-process map
       /// \throw TiledArray::Exception When the size of shape is not equal to
       /// zero
+      /// \note All local tiles of a dense tensor are stored, so they are held
+      /// in flat storage that is accessed without locking.
       ArrayImpl(World& world, const trange_type& trange, const shape_type& shape,
           const std::shared_ptr<pmap_interface>& pmap) :
         TensorImpl_(world, trange, shape, pmap),
-        data_(world, trange.tiles_range().volume(), pmap)
+        data_(world, trange.tiles_range().volume(), pmap, shape.is_dense()),
+        symmetry_()
       { }
 
       /// Virtual destructor
@@ -488,6 +493,122 @@ namespace TiledArray {
         return get<std::initializer_list<Integer>>(i);
       }
 
+      /// Tile future accessor with an encoded transfer
+
+      /// \tparam Index The index type
+      /// \param i The tile index
+      /// \param codec The codec used to encode the tile if it is remote
+      /// \return A \c future to tile \c i
+      /// \throw TiledArray::Exception When tile \c i is zero
+      template <typename Index>
+      future get(const Index& i, const TileCodec& codec) const {
+        TA_ASSERT(! TensorImpl_::is_zero(i));
+        return data_.get(TensorImpl_::trange().tiles_range().ordinal(i), codec);
+      }
+
+      /// Tile future accessor for a consumer
+
+      /// The read is counted, and the tile is released by its owner after
+      /// the last consumer (see \c set_consumers() ).
+      /// \tparam Index The index type
+      /// \param i The tile index
+      /// \return A \c future to tile \c i
+      /// \throw TiledArray::Exception When tile \c i is zero
+      template <typename Index>
+      future consume(const Index& i) const {
+        TA_ASSERT(! TensorImpl_::is_zero(i));
+        return data_.consume(TensorImpl_::trange().tiles_range().ordinal(i));
+      }
+
+      /// Count a consumer read of a tile without getting it
+
+      /// The owner of the tile counts the read and releases the tile after
+      /// the last consumer, but the tile is not sent.
+      /// \tparam Index The index type
+      /// \param i The tile index
+      /// \throw TiledArray::Exception When tile \c i is zero
+      template <typename Index>
+      void discard(const Index& i) const {
+        TA_ASSERT(! TensorImpl_::is_zero(i));
+        data_.discard(TensorImpl_::trange().tiles_range().ordinal(i));
+      }
+
+      /// Number of local tiles held by this process
+
+      /// Unlike \c local_size() , only the local tiles that are currently
+      /// stored are counted, i.e. tiles released by their last consumer are
+      /// not. No communication.
+      /// \return The number of local tiles stored on this process
+      size_type stored_size() const { return data_.size(); }
+
+      /// Consumer count accessor
+
+      /// \return The number of consumers of each tile, or zero if tiles are
+      /// not released by consumers
+      unsigned int consumers() const { return data_.consumers(); }
+
+      /// Set the number of consumers of each tile
+
+      /// \param n The number of consumers of each tile
+      void set_consumers(const unsigned int n) { data_.set_consumers(n); }
+
+      /// Tile symmetry accessor
+
+      /// \return The symmetry of the stored tiles; it is trivial unless only
+      /// the symmetry-unique tiles are stored
+      const TiledArray::symmetry::TileSymmetry& symmetry() const { return symmetry_; }
+
+      /// Set the tile symmetry
+
+      /// \param symm The symmetry of the stored tiles
+      void set_symmetry(const TiledArray::symmetry::TileSymmetry& symm) { symmetry_ = symm; }
+
+      /// Tile future accessor for a list of tiles
+
+      /// Remote tiles are requested with one message per owner.
+      /// \tparam Index The index type
+      /// \param indices The tile indices
+      /// \return Futures to the tiles of \c indices , in the same order
+      /// \throw TiledArray::Exception When a tile of \c indices is zero
+      template <typename Index>
+      std::vector<future> get_tiles(const std::vector<Index>& indices) const {
+        typename storage_type::key_vector keys;
+        keys.reserve(indices.size());
+        for(const Index& i : indices) {
+          TA_ASSERT(! TensorImpl_::is_zero(i));
+          keys.push_back(TensorImpl_::trange().tiles_range().ordinal(i));
+        }
+        return data_.get(keys);
+      }
+
+      /// Set a list of tiles
+
+      /// Remote tiles are sent with one message per owner.
+      /// \tparam Index The index type
+      /// \param indices The indices of the tiles to be set
+      /// \param tiles The tiles of \c indices
+      template <typename Index>
+      void set_tiles(const std::vector<Index>& indices,
+          const std::vector<value_type>& tiles)
+      {
+        typename storage_type::key_vector keys;
+        keys.reserve(indices.size());
+        for(const Index& i : indices) {
+          TA_ASSERT(! TensorImpl_::is_zero(i));
+          keys.push_back(TensorImpl_::trange().tiles_range().ordinal(i));
+        }
+        data_.set(keys, tiles);
+      }
+
+      /// Aggregate remote tile sets
+
+      /// \param n The number of remote tiles that are sent to each process
+      /// in one message (0 or 1 = not aggregated)
+      void set_batch_size(const size_type n) { data_.set_batch_size(n); }
+
+      /// Send all aggregated remote tiles
+      void flush() { data_.flush(); }
+
       /// Set tile
 
       /// Set the tile at \c i with \c value . \c Value type may be \c value_type ,
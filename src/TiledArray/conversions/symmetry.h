@@ -0,0 +1,161 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  symmetry.h
+ *
+ */
+
+#ifndef TILEDARRAY_CONVERSIONS_SYMMETRY_H__INCLUDED
+#define TILEDARRAY_CONVERSIONS_SYMMETRY_H__INCLUDED
+
+#include <TiledArray/symm/tile_symmetry.h>
+#include <TiledArray/tile_interface/permute.h>
+#include <TiledArray/tile_interface/scale.h>
+
+namespace TiledArray {
+
+  /// Forward declarations
+  template <typename, typename> class DistArray;
+  class DensePolicy;
+  class SparsePolicy;
+
+  /// Find a tile of an array that stores only symmetry-unique tiles
+
+  /// If \c index is not a unique tile index, the result is the stored
+  /// canonical tile permuted and scaled by the phase of the group element
+  /// that maps it to \c index .
+  /// \tparam Tile The tile type of the array
+  /// \tparam Policy The policy of the array
+  /// \tparam Index The tile index type
+  /// \param array The array that holds the unique tiles
+  /// \param symm The symmetry of \c array
+  /// \param index The coordinate index of the requested tile
+  /// \return A future to the tile at \c index
+  template <typename Tile, typename Policy, typename Index,
+      typename std::enable_if<! std::is_integral<Index>::value>::type* = nullptr>
+  inline Future<typename DistArray<Tile, Policy>::value_type>
+  find_symmetric(const DistArray<Tile, Policy>& array,
+      const symmetry::TileSymmetry& symm, const Index& index)
+  {
+    typedef typename DistArray<Tile, Policy>::value_type value_type;
+
+    const unsigned int rank = array.trange().tiles_range().rank();
+    TA_ASSERT(index.size() == rank);
+
+    symmetry::TileSymmetry::element_type g;
+    const auto canonical_index =
+        symm.canonical(std::vector<std::size_t>(index.begin(), index.end()), g);
+
+    TA_USER_ASSERT(! array.is_zero(canonical_index),
+        "find_symmetric(): the canonical tile is zero.");
+
+    Future<value_type> tile = array.find(canonical_index);
+    if(g == symmetry::PermutationGroup::identity())
+      return tile;
+
+    // Spawn a task to map the canonical tile to the requested tile
+    const Permutation perm = symmetry::TileSymmetry::to_permutation(g, rank);
+    const int phase = symm.phase(g);
+    return array.world().taskq.add(
+        [perm, phase] (const value_type& tile) -> value_type {
+          using TiledArray::permute;
+          using TiledArray::scale;
+          if(phase == 1)
+            return permute(tile, perm);
+          return scale(tile, phase, perm);
+        }, tile);
+  }
+
+  /// Find a tile of an array that stores only symmetry-unique tiles
+
+  /// \tparam Tile The tile type of the array
+  /// \tparam Policy The policy of the array
+  /// \tparam Integer An integral type
+  /// \param array The array that holds the unique tiles
+  /// \param symm The symmetry of \c array
+  /// \param i The ordinal index of the requested tile
+  /// \return A future to the tile at \c i
+  template <typename Tile, typename Policy, typename Integer,
+      typename std::enable_if<std::is_integral<Integer>::value>::type* = nullptr>
+  inline Future<typename DistArray<Tile, Policy>::value_type>
+  find_symmetric(const DistArray<Tile, Policy>& array,
+      const symmetry::TileSymmetry& symm, const Integer i)
+  {
+    return find_symmetric(array, symm, array.trange().tiles_range().idx(i));
+  }
+
+  /// Store only the symmetry-unique tiles of a sparse array
+
+  /// The non-unique tiles of the result are zero. The unique tiles of the
+  /// result are shallow copies of the tiles of \c array . The result is
+  /// marked with \c symm (see \c DistArray::set_symmetry() ), so
+  /// expressions that read it map its non-unique tiles to the unique tiles.
+  /// Use \c find_symmetric() to access any tile of the result, and
+  /// \c expand_symmetric() to restore all tiles.
+  /// \tparam Tile The tile type of the array
+  /// \param array The array to be compressed
+  /// \param symm The symmetry of \c array
+  /// \return An array that holds the unique tiles of \c array
+  template <typename Tile>
+  inline DistArray<Tile, SparsePolicy>
+  compress_symmetric(const DistArray<Tile, SparsePolicy>& array,
+      const symmetry::TileSymmetry& symm)
+  {
+    typedef typename DistArray<Tile, SparsePolicy>::shape_type shape_type;
+
+    const shape_type shape = array.shape().mask(
+        symmetry::unique_tile_mask(array.shape(), array.trange(), symm));
+    DistArray<Tile, SparsePolicy> result(array.world(), array.trange(), shape,
+        array.pmap());
+
+    for(auto index : * array.pmap()) {
+      if(result.is_zero(index))
+        continue;
+      result.set(index, array.find(index));
+    }
+    result.set_symmetry(symm);
+
+    return result;
+  }
+
+  /// Restore all tiles of a sparse array that stores only unique tiles
+
+  /// \tparam Tile The tile type of the array
+  /// \param array The array that holds the unique tiles
+  /// \param symm The symmetry of \c array
+  /// \return An array that holds all tiles
+  template <typename Tile>
+  inline DistArray<Tile, SparsePolicy>
+  expand_symmetric(const DistArray<Tile, SparsePolicy>& array,
+      const symmetry::TileSymmetry& symm)
+  {
+    DistArray<Tile, SparsePolicy> result(array.world(), array.trange(),
+        symmetry::expand_shape(array.shape(), array.trange(), symm),
+        array.pmap());
+
+    for(auto index : * result.pmap()) {
+      if(result.is_zero(index))
+        continue;
+      result.set(index, find_symmetric(array, symm, index));
+    }
+
+    return result;
+  }
+
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_CONVERSIONS_SYMMETRY_H__INCLUDED
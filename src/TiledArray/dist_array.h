@@ -23,6 +23,7 @@
 #include <cstdlib>
 
 #include <TiledArray/replicator.h>
+#include <TiledArray/node_replicator.h>
 #include <TiledArray/pmap/replicated_pmap.h>
 //#include <TiledArray/tensor.h>
 #include <TiledArray/policies/dense_policy.h>
@@ -30,6 +31,7 @@
 #include <TiledArray/conversions/truncate.h>
 #include <TiledArray/conversions/clone.h>
 #include <TiledArray/tile_interface/cast.h>
+#include <TiledArray/math/random.h>
 
 namespace TiledArray {
 
@@ -337,6 +339,149 @@ namespace TiledArray {
       return find<std::initializer_list<Integer>>(i);
     }
 
+    /// Find local or remote tile with an encoded transfer
+
+    /// Remote tiles are encoded by their owner with \c codec before they are
+    /// sent to this process (see \c TileCodec ).
+    /// \tparam Index The index type
+    /// \param i The tile index
+    /// \param codec The codec used to encode remote tiles
+    /// \return A \c future to tile \c i
+    /// \throw TiledArray::Exception When tile \c i is zero
+    template <typename Index>
+    Future<value_type> find(const Index& i, const TileCodec& codec) const {
+      check_index(i);
+      return pimpl_->get(i, codec);
+    }
+
+    /// Find a list of local or remote tiles
+
+    /// The requests for remote tiles are sent with one message per owner,
+    /// and the tiles that are already set are returned with one message per
+    /// owner, which is much faster than calling \c find() for each of many
+    /// small tiles.
+    /// \tparam Index The index type
+    /// \param indices The tile indices
+    /// \return Futures to the tiles of \c indices , in the same order
+    /// \throw TiledArray::Exception When a tile of \c indices is zero
+    template <typename Index>
+    std::vector<Future<value_type> >
+    find_tiles(const std::vector<Index>& indices) const {
+      check_pimpl();
+      for(const Index& i : indices)
+        check_index(i);
+      return pimpl_->get_tiles(indices);
+    }
+
+    /// Find local or remote tile as a consumer
+
+    /// This is equivalent to \c find() , except the owner of the tile counts
+    /// the read and releases the tile after its last consumer (see
+    /// \c set_consumers() ).
+    /// \tparam Index The index type
+    /// \param i The tile index
+    /// \return A \c future to tile \c i
+    /// \throw TiledArray::Exception When tile \c i is zero
+    template <typename Index>
+    Future<value_type> consume(const Index& i) const {
+      check_index(i);
+      return pimpl_->consume(i);
+    }
+
+    /// Skip a tile as a consumer
+
+    /// The owner of the tile counts the read as for \c consume() , and
+    /// releases the tile after its last consumer, but the tile is not
+    /// fetched. Consumers that do not need a tile must call this instead of
+    /// \c consume() .
+    /// \tparam Index The index type
+    /// \param i The tile index
+    /// \throw TiledArray::Exception When tile \c i is zero
+    template <typename Index>
+    void discard(const Index& i) const {
+      check_index(i);
+      pimpl_->discard(i);
+    }
+
+    /// Number of local tiles stored on this process
+
+    /// Tiles that are zero, not yet assigned, or released by their last
+    /// consumer (see \c set_consumers() ) are not counted. No communication.
+    /// \return The number of local tiles stored on this process
+    size_type stored_size() const {
+      check_pimpl();
+      return pimpl_->stored_size();
+    }
+
+    /// Consumer count accessor
+
+    /// \return The number of consumers of each tile, or zero if the tiles of
+    /// this array are not released by their consumers
+    unsigned int consumers() const {
+      check_pimpl();
+      return pimpl_->consumers();
+    }
+
+    /// Use this array as an intermediate with \c n consumers
+
+    /// Each local tile is released after it has been read by \c n
+    /// consumers, i.e. expressions that read this array, or calls to
+    /// \c consume() or \c discard() . An expression is one consumer of each
+    /// non-zero tile of its arguments: it reads the tiles it needs once, and
+    /// discards the others without fetching them, e.g. the tiles outside the
+    /// block of a block expression, <tt>t("i,j").block(lo, up)</tt> . So an
+    /// intermediate that is the argument of the next expression, e.g. \c t
+    /// in
+    /// \code
+    /// t("i,j").assign_async(a("i,k") * b("k,j"));
+    /// t.set_consumers(1);
+    /// c("i,j") = t("i,k") * d("k,j");
+    /// \endcode
+    /// streams its tiles to the consumer as they are computed, and each tile
+    /// is freed as soon as the consumer is done with it. The tiles must not
+    /// be accessed after the last consumer. This must be called after all
+    /// tiles have been set (or assigned futures), and before the consumers
+    /// are evaluated. No communication.
+    /// \param n The number of consumers of each tile (0 = tiles are never
+    /// released)
+    void set_consumers(const unsigned int n) {
+      check_pimpl();
+      pimpl_->set_consumers(n);
+    }
+
+    /// Tile symmetry accessor
+
+    /// \return The symmetry of the tiles of this array. It is trivial unless
+    /// this array stores only the symmetry-unique tiles (see
+    /// \c set_symmetry() ).
+    const TiledArray::symmetry::TileSymmetry& symmetry() const {
+      check_pimpl();
+      return pimpl_->symmetry();
+    }
+
+    /// Mark this array as storing only the symmetry-unique tiles
+
+    /// The non-unique tiles of this array must be zero in its shape, as in
+    /// the result of \c compress_symmetric() ; only sparse arrays of
+    /// non-lazy tiles are supported. When this array is the
+    /// argument of an expression, the non-unique tiles are mapped to the
+    /// stored canonical tiles, which are permuted and scaled by the phase of
+    /// the symmetry (see \c find_symmetric() ), so the expression sees all
+    /// tiles. Other accessors, e.g. \c find() , see only the stored tiles,
+    /// and the tiles are not released by consumers (see
+    /// \c set_consumers() ). No communication.
+    /// \param symm The symmetry of the tiles of this array
+    /// \throw TiledArray::Exception When \c symm is not compatible with the
+    /// tiled range of this array
+    void set_symmetry(const TiledArray::symmetry::TileSymmetry& symm) {
+      static_assert((! shape_type::is_dense()) && (! is_lazy_tile<value_type>::value),
+          "DistArray::set_symmetry() is only supported for sparse arrays of non-lazy tiles.");
+      check_pimpl();
+      TA_USER_ASSERT(symm.is_compatible(pimpl_->trange()),
+          "DistArray::set_symmetry(): the symmetry is not compatible with the tiled range.");
+      pimpl_->set_symmetry(symm);
+    }
+
     /// Set a tile and fill it using a sequence
 
     /// \tparam Index An index or integral type
@@ -429,6 +574,36 @@ namespace TiledArray {
       set<std::initializer_list<Integer>>(i, v);
     }
 
+    /// Set a list of tiles
+
+    /// The remote tiles are sent with one message per owner.
+    /// \tparam Index An index or integral type
+    /// \param indices The indices or the ordinals of the tiles to be set
+    /// \param tiles The tiles of \c indices
+    template <typename Index>
+    void set_tiles(const std::vector<Index>& indices,
+        const std::vector<value_type>& tiles)
+    {
+      check_pimpl();
+      TA_USER_ASSERT(indices.size() == tiles.size(),
+          "The number of tiles does not match the number of tile indices.");
+      for(const Index& i : indices)
+        check_index(i);
+      pimpl_->set_tiles(indices, tiles);
+    }
+
+    /// Aggregate the remote tiles that are set
+
+    /// When \c n is greater than one, tiles that are set by \c set() with a
+    /// remote owner are sent to their owner in batches of \c n tiles. The
+    /// remaining tiles are sent by a task, which completes before the next
+    /// fence. This must not be called while tiles are being set.
+    /// \param n The number of tiles in each batch (0 or 1 = not aggregated)
+    void set_batch_size(const size_type n) {
+      check_pimpl();
+      pimpl_->set_batch_size(n);
+    }
+
     /// Fill all local tiles
 
     /// \param value The fill value
@@ -446,12 +621,54 @@ namespace TiledArray {
       fill_local(value, skip_set);
     }
 
-    /// Fill all local tiles with random values obtained as \code (element_type)std::rand()/RAND_MAX \endcode
+    /// Fill all local tiles with uniform random values in [0,1)
+
+    /// The seed is taken from \c math::default_random_seed() , so arrays
+    /// are reproducible when all processes call this function in the same
+    /// order (see the overload below).
     /// \param skip_set If false, will throw if any tiles are already set
     void fill_random(bool skip_set = false) {
-      init_elements([](const auto &) {
-        return (element_type)std::rand() / RAND_MAX;
-      });
+      fill_random(math::RandomDistribution::uniform,
+          math::default_random_seed(), skip_set);
+    }
+
+    /// Fill all local tiles with random values
+
+    /// Each element is generated by a counter-based random number generator
+    /// (see \c math::Philox4x32 ) from \c seed and the ordinal of the
+    /// element in the element range of the array. The tiles are generated in
+    /// parallel, and the array elements do not depend on the tiling, process
+    /// map, or number of processes. The tiles are constructed with
+    /// <tt>value_type(range)</tt> and filled in row-major order through
+    /// their element iterators.
+    /// \param dist The random number distribution
+    /// \param seed The random number seed
+    /// \param skip_set If false, will throw if any tiles are already set
+    void fill_random(const math::RandomDistribution dist,
+        const std::uint64_t seed, bool skip_set = false)
+    {
+      check_pimpl();
+      const typename trange_type::range_type& elements =
+          pimpl_->trange().elements_range();
+      init_tiles([dist, seed, elements] (const TiledArray::Range& range) -> value_type
+      {
+        value_type tile(range);
+
+        // Fill each row of the tile; the elements of a row have consecutive
+        // ordinals in the element range. Rows are generated into a buffer
+        // and copied through the tile iterators, so any tile type with
+        // row-major element iterators can be filled.
+        const std::size_t row_size = range.extent_data()[range.rank() - 1u];
+        std::vector<element_type> row(row_size);
+        auto it = std::begin(tile);
+        for(std::size_t i = 0ul; i < range.volume(); i += row_size) {
+          math::random_fill(row_size, row.data(), seed,
+              elements.ordinal(range.idx(i)), dist);
+          it = std::copy(row.begin(), row.end(), it);
+        }
+
+        return tile;
+      }, skip_set);
     }
 
     /// Initialize (local) tiles with a user provided functor
@@ -761,6 +978,26 @@ namespace TiledArray {
       }
     }
 
+    /// Convert a distributed array into a node-replicated array
+
+    /// The processes of a node share one read-only copy of the array in
+    /// POSIX shared memory, and each tile is transferred to a node once
+    /// (see \c detail::node_replicate() ). This is only supported for arrays
+    /// of \c Tensor tiles; when MPI-3 shared communicators are not available,
+    /// this is equivalent to \c make_replicated() .
+    /// \note This is a collective, blocking operation that includes a fence.
+    /// The tiles of the array must not be modified in place.
+    void make_node_replicated() {
+      check_pimpl();
+      if((! pimpl_->pmap()->is_replicated()) && (world().size() > 1)) {
+#ifdef TILEDARRAY_HAS_NODE_REPLICATION
+        DistArray_::operator=(detail::node_replicate(*this));
+#else
+        make_replicated();
+#endif // TILEDARRAY_HAS_NODE_REPLICATION
+      }
+    }
+
     /// Update shape data and remove tiles that are below the zero threshold
 
     /// \note This function is a no-op for dense arrays.
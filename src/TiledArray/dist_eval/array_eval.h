@@ -28,10 +28,25 @@
 
 #include <TiledArray/dist_eval/dist_eval.h>
 #include <TiledArray/block_range.h>
+#include <TiledArray/conversions/symmetry.h>
 
 namespace TiledArray {
   namespace detail {
 
+    /// Relative cost of evaluating a tile that provides a \c cost() member
+
+    /// \param tile The tile
+    /// \return The cost of evaluating \c tile relative to contracting it
+    template <typename Tile>
+    inline auto tile_cost(const Tile& tile, int) -> decltype(float(tile.cost()))
+    { return tile.cost(); }
+
+    /// Relative cost of evaluating a stored tile
+
+    /// \return Zero
+    template <typename Tile>
+    inline float tile_cost(const Tile&, long) { return 0.0f; }
+
     /// Lazy tile for on-the-fly evaluation of array tiles.
 
     /// This tile object is used to hold input array tiles and do on-the-fly
@@ -203,18 +218,14 @@ namespace TiledArray {
       virtual ~ArrayEvalImpl() { }
 
       virtual Future<value_type> get_tile(size_type i) const {
+        const size_type array_index = to_array_index(i);
 
-        // Get the array index that corresponds to the target index
-        size_type array_index = DistEvalImpl_::perm_index_to_source(i);
-
-        // If this object only uses a sub-block of the array, shift the tile
-        // index to the correct location.
-        if(block_range_.rank())
-          array_index = block_range_.ordinal(array_index);
-
-        // Get the tile from array_, which may be located on a remote node.
+        // Get the tile from array_, which may be located on a remote node. The
+        // owner releases the tile after its last consumer when array_ is an
+        // intermediate. When array_ stores only its symmetry-unique tiles,
+        // the tile is mapped from its canonical tile.
         Future<typename array_type::value_type> tile =
-            array_.find(array_index);
+            find_tile(array_index, symmetric_tiles());
 
         const bool consumable_tile = ! array_.is_local(array_index);
         // Insert the tile into this evaluator for subsequent processing
@@ -240,12 +251,75 @@ namespace TiledArray {
 
       /// This function handles the cleanup for tiles that are not needed in
       /// subsequent computation.
-      virtual void discard_tile(size_type) const {
+      virtual void discard_tile(size_type i) const {
+        // Count the discarded tile as consumed, so an intermediate array
+        // releases it; the tile itself is not fetched.
+        if(array_.consumers() && array_.symmetry().trivial())
+          array_.discard(to_array_index(i));
         const_cast<ArrayEvalImpl_*>(this)->notify();
       }
 
+      /// Relative cost of evaluating the array tiles
+
+      /// The cost is taken from the first local, non-zero tile of the array,
+      /// which is non-zero for tiles that are computed on demand (e.g.
+      /// \c DirectTile ).
+      /// \return The cost of evaluating a tile relative to contracting it
+      virtual float tile_cost() const {
+        for(auto index : *array_.pmap()) {
+          if(array_.is_zero(index))
+            continue;
+          const Future<typename array_type::value_type> tile = array_.find(index);
+          return (tile.probe() ? detail::tile_cost(tile.get(), 0) : 0.0f);
+        }
+        return 0.0f;
+      }
+
     private:
 
+      /// \c std::true_type when \c array_ may store only its symmetry-unique
+      /// tiles (see \c DistArray::set_symmetry() ), i.e. for sparse arrays of
+      /// non-lazy tiles
+      typedef std::integral_constant<bool,
+          (! array_type::shape_type::is_dense()) &&
+          (! is_lazy_tile<typename array_type::value_type>::value)> symmetric_tiles;
+
+      /// Get a tile of an array that may store only symmetry-unique tiles
+
+      /// \param array_index The ordinal index of the tile of \c array_
+      /// \return A future to the tile
+      Future<typename array_type::value_type>
+      find_tile(const size_type array_index, std::true_type) const {
+        if(array_.symmetry().trivial())
+          return array_.consume(array_index);
+        return find_symmetric(array_, array_.symmetry(), array_index);
+      }
+
+      /// Get a tile of an array that stores all tiles
+
+      /// \param array_index The ordinal index of the tile of \c array_
+      /// \return A future to the tile
+      Future<typename array_type::value_type>
+      find_tile(const size_type array_index, std::false_type) const {
+        return array_.consume(array_index);
+      }
+
+      /// Map a tile index of this evaluator to the tile index of the array
+
+      /// \param i The tile index of this evaluator
+      /// \return The ordinal index of the corresponding tile of \c array_
+      size_type to_array_index(const size_type i) const {
+        // Get the array index that corresponds to the target index
+        size_type array_index = DistEvalImpl_::perm_index_to_source(i);
+
+        // If this object only uses a sub-block of the array, shift the tile
+        // index to the correct location.
+        if(block_range_.rank())
+          array_index = block_range_.ordinal(array_index);
+
+        return array_index;
+      }
+
       value_type make_tile(const typename array_type::value_type& tile, const bool consume) const {
         return value_type(tile, op_, consume);
       }
@@ -258,6 +332,21 @@ namespace TiledArray {
         DistEvalImpl_::set_tile(i, value_type(tile, op_, consume));
       }
 
+      /// Count the local, non-zero array tiles outside the block as consumed
+
+      /// Each local tile of \c array_ that is not in \c block_range_ is
+      /// discarded (see \c DistArray::discard() ), so an expression that
+      /// reads a block of an intermediate array is one consumer of all of
+      /// its tiles.
+      void discard_outside_block() const {
+        const auto& tiles_range = array_.trange().tiles_range();
+        for(const auto index : *array_.pmap()) {
+          if(array_.is_zero(index) || block_range_.includes(tiles_range.idx(index)))
+            continue;
+          array_.discard(index);
+        }
+      }
+
       /// Evaluate the tiles of this tensor
 
       /// This function will evaluate the children of this distributed evaluator
@@ -267,6 +356,11 @@ namespace TiledArray {
         // Counter for the number of tasks submitted by this object
         int task_count = 0;
 
+        // A block of an intermediate array reads only the tiles in the
+        // block, so the other local tiles are counted as consumed here.
+        if(block_range_.rank() && array_.consumers() && array_.symmetry().trivial())
+          discard_outside_block();
+
         // Get a count of the number of local tiles.
         if(TensorImpl_::shape().is_dense()) {
           task_count = TensorImpl_::pmap()->local_size();
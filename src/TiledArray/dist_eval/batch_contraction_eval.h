@@ -0,0 +1,295 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  batch_contraction_eval.h
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_BATCH_CONTRACTION_EVAL_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_BATCH_CONTRACTION_EVAL_H__INCLUDED
+
+#include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/pmap/batch_pmap.h>
+#include <TiledArray/reduce_task.h>
+#include <TiledArray/tile_interface/cast.h>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Distributed batched contraction evaluator implementation
+
+    /// This evaluates contractions with batch (shared external) dimensions,
+    /// e.g. \code c("l,i,j") = a("l,i,k") * b("l,k,j") \endcode . The
+    /// arguments have the batch dimensions first, followed by the outer and
+    /// inner dimensions of the left-hand argument, and the inner and outer
+    /// dimensions of the right-hand argument. All tiles of a batch are owned
+    /// by one process (see \c BatchPmap ), which contracts each result tile of
+    /// the batch with a reduction over the inner tile index, so argument tiles
+    /// are not communicated. Result tiles are sent to the owners given by the
+    /// result process map.
+    /// \tparam Left The left-hand argument evaluator type
+    /// \tparam Right The right-hand argument evaluator type
+    /// \tparam Op The batched contract/reduce tile operation type
+    /// \tparam Policy The tensor policy class
+    template <typename Left, typename Right, typename Op, typename Policy>
+    class BatchContractionEvalImpl :
+      public DistEvalImpl<typename Op::result_type, Policy>,
+      public std::enable_shared_from_this<BatchContractionEvalImpl<Left, Right, Op, Policy> >
+    {
+    public:
+      typedef BatchContractionEvalImpl<Left, Right, Op, Policy>
+          BatchContractionEvalImpl_; ///< This object type
+      typedef DistEvalImpl<typename Op::result_type, Policy> DistEvalImpl_; ///< The base class type
+      typedef typename DistEvalImpl_::TensorImpl_ TensorImpl_; ///< The base, base class type
+      typedef Left left_type; ///< The left-hand argument type
+      typedef Right right_type; ///< The right-hand argument type
+      typedef typename DistEvalImpl_::size_type size_type; ///< Size type
+      typedef typename DistEvalImpl_::range_type range_type; ///< Range type
+      typedef typename DistEvalImpl_::shape_type shape_type; ///< Shape type
+      typedef typename DistEvalImpl_::pmap_interface pmap_interface; ///< Process map interface type
+      typedef typename DistEvalImpl_::trange_type trange_type; ///< Tiled range type
+      typedef typename DistEvalImpl_::value_type value_type; ///< Tile type
+      typedef typename DistEvalImpl_::eval_type eval_type; ///< Tile evaluation type
+      typedef Op op_type; ///< Tile evaluation operator type
+
+      using std::enable_shared_from_this<BatchContractionEvalImpl_>::shared_from_this;
+
+    private:
+
+      left_type left_; ///< Left argument
+      right_type right_; ///< Right argument
+      op_type op_; ///< Batched contract/reduce operation
+      std::shared_ptr<BatchPmap> batch_pmap_; ///< Batch map of the result tiles
+      size_type batches_; ///< The number of batch tile indices
+      size_type m_; ///< The number of left-hand outer tile indices
+      size_type n_; ///< The number of right-hand outer tile indices
+      size_type k_; ///< The number of inner tile indices
+
+    public:
+
+      /// Construct a batched contraction evaluator
+
+      /// \param left The left-hand argument
+      /// \param right The right-hand argument
+      /// \param world The world where the tensor lives
+      /// \param trange The tiled range object
+      /// \param shape The tensor shape object
+      /// \param pmap The tile-process map
+      /// \param perm The permutation that is applied to tile indices
+      /// \param op The batched contract/reduce tile operation
+      BatchContractionEvalImpl(const left_type& left, const right_type& right,
+          World& world, const trange_type& trange, const shape_type& shape,
+          const std::shared_ptr<pmap_interface>& pmap, const Permutation& perm,
+          const op_type& op) :
+        DistEvalImpl_(world, trange, shape, pmap, perm),
+        left_(left), right_(right), op_(op), batch_pmap_(),
+        batches_(1ul), m_(1ul), n_(1ul), k_(1ul)
+      {
+        const unsigned int batch_rank = op.batch_rank();
+        const math::GemmHelper& gemm_helper = op.gemm_helper();
+        const size_type* MADNESS_RESTRICT const left_extent =
+            left.trange().tiles_range().extent_data();
+        const size_type* MADNESS_RESTRICT const right_extent =
+            right.trange().tiles_range().extent_data();
+
+        // Compute the fused tile counts of the batched contraction
+        unsigned int i = 0u;
+        for(; i < batch_rank; ++i)
+          batches_ *= left_extent[i];
+        for(; i < batch_rank + gemm_helper.left_outer_end(); ++i)
+          m_ *= left_extent[i];
+        for(; i < batch_rank + gemm_helper.left_rank(); ++i)
+          k_ *= left_extent[i];
+        for(i = batch_rank + gemm_helper.right_outer_begin();
+            i < batch_rank + gemm_helper.right_rank(); ++i)
+          n_ *= right_extent[i];
+
+        // Map the result tiles to the processes that evaluate them
+        std::vector<unsigned int> batch_dims;
+        batch_dims.reserve(batch_rank);
+        for(i = 0u; i < batch_rank; ++i)
+          batch_dims.push_back(perm ? perm[i] : i);
+        batch_pmap_ = std::make_shared<BatchPmap>(world, trange.tiles_range(),
+            batch_dims);
+      }
+
+      virtual ~BatchContractionEvalImpl() { }
+
+      /// Get tile at index \c i
+
+      /// \param i The index of the tile
+      /// \return A \c Future to the tile at index i
+      /// \throw TiledArray::Exception When tile \c i is owned by a remote node.
+      /// \throw TiledArray::Exception When tile \c i a zero tile.
+      virtual Future<value_type> get_tile(size_type i) const {
+        TA_ASSERT(TensorImpl_::is_local(i));
+        TA_ASSERT(! TensorImpl_::is_zero(i));
+
+        // Tiles are sent by the process that owns the batch of the tile.
+        const ProcessID source = batch_pmap_->owner(i);
+
+        const madness::DistributedID key(DistEvalImpl_::id(), i);
+        return TensorImpl_::world().gop.template recv<value_type>(source, key);
+      }
+
+      /// Discard a tile that is not needed
+
+      /// This function handles the cleanup for tiles that are not needed in
+      /// subsequent computation.
+      /// \param i The index of the tile
+      virtual void discard_tile(size_type i) const { get_tile(i); }
+
+    private:
+
+      /// Conversion function
+
+      /// \tparam Tile The lazy tile type
+      /// \param tile The input tile
+      /// \return The evaluated version of the lazy tile
+      template <typename Tile>
+      static auto convert_tile(const Tile& tile) {
+        TiledArray::Cast<typename eval_trait<Tile>::type, Tile> cast;
+        return cast(tile);
+      }
+
+      /// Get an argument tile that is not a lazy tile
+
+      /// \tparam Arg The type of the argument that holds the input tiles
+      /// \param arg The argument that holds the tiles
+      /// \param index The tile index of arg
+      /// \return A future to the tile
+      template <typename Arg>
+      static typename std::enable_if<
+          ! is_lazy_tile<typename Arg::value_type>::value,
+          Future<typename Arg::eval_type> >::type
+      get_arg_tile(const Arg& arg, const size_type index) { return arg.get(index); }
+
+      /// Get and evaluate a lazy argument tile
+
+      /// \tparam Arg The type of the argument that holds the input tiles
+      /// \param arg The argument that holds the tiles
+      /// \param index The tile index of arg
+      /// \return A future to the evaluated tile
+      template <typename Arg>
+      static typename std::enable_if<
+          is_lazy_tile<typename Arg::value_type>::value,
+          Future<typename Arg::eval_type> >::type
+      get_arg_tile(const Arg& arg, const size_type index) {
+        auto convert_tile_fn =
+            &BatchContractionEvalImpl_::template convert_tile<typename Arg::value_type>;
+        return arg.world().taskq.add(convert_tile_fn, arg.get(index),
+                                     madness::TaskAttributes::hipri());
+      }
+
+      /// Get the non-zero argument tiles of a batch
+
+      /// \tparam Arg The argument type
+      /// \param arg The argument
+      /// \param first The index of the first tile of the batch
+      /// \param size The number of tiles in the batch
+      /// \param[out] tiles The tiles of the batch; zero tiles are not probed
+      /// \param[out] non_zero Flags for the non-zero tiles of the batch
+      template <typename Arg>
+      static void get_batch(const Arg& arg, const size_type first,
+          const size_type size, std::vector<Future<typename Arg::eval_type> >& tiles,
+          std::vector<char>& non_zero)
+      {
+        tiles.assign(size, Future<typename Arg::eval_type>());
+        non_zero.assign(size, 0);
+        for(size_type i = 0ul; i < size; ++i) {
+          if(arg.is_zero(first + i))
+            continue;
+          TA_ASSERT(arg.is_local(first + i));
+          tiles[i] = get_arg_tile(arg, first + i);
+          non_zero[i] = 1;
+        }
+      }
+
+      /// Evaluate the tiles of this tensor
+
+      /// This function will evaluate the children of this distributed evaluator
+      /// and evaluate the tiles for this distributed evaluator. It will block
+      /// until the tasks for the children are evaluated (not for the tasks of
+      /// this object).
+      /// \return The number of tiles that will be set by this process
+      virtual int internal_eval() {
+        // Evaluate child tensors
+        left_.eval();
+        right_.eval();
+
+        int task_count = 0;
+
+        std::vector<Future<typename left_type::eval_type> > left_tiles;
+        std::vector<Future<typename right_type::eval_type> > right_tiles;
+        std::vector<char> left_non_zero, right_non_zero;
+
+        // Iterate over the batches that are owned by this process
+        const size_type rank = TensorImpl_::world().rank();
+        const size_type procs = TensorImpl_::world().size();
+        for(size_type b = rank; b < batches_; b += procs) {
+          TA_ASSERT(batch_pmap_->batch_owner(b) == rank);
+          get_batch(left_, b * m_ * k_, m_ * k_, left_tiles, left_non_zero);
+          get_batch(right_, b * k_ * n_, k_ * n_, right_tiles, right_non_zero);
+
+          for(size_type i = 0ul; i < m_; ++i) {
+            for(size_type j = 0ul; j < n_; ++j) {
+              const size_type source_index = (b * m_ + i) * n_ + j;
+              const size_type target_index =
+                  DistEvalImpl_::perm_index_to_target(source_index);
+              if(TensorImpl_::is_zero(target_index))
+                continue;
+
+              // Reduce the products over the inner tile index
+              ReducePairTask<op_type> reduce_task;
+              for(size_type k = 0ul; k < k_; ++k) {
+                const size_type left_index = i * k_ + k;
+                const size_type right_index = k * n_ + j;
+                if(! (left_non_zero[left_index] && right_non_zero[right_index]))
+                  continue;
+                if(! reduce_task)
+                  reduce_task = ReducePairTask<op_type>(TensorImpl_::world(), op_);
+                reduce_task.add(left_tiles[left_index], right_tiles[right_index]);
+              }
+
+              if(reduce_task) {
+                DistEvalImpl_::set_tile(target_index, reduce_task.submit());
+              } else {
+                // The shape may be non-zero when all products are zero, e.g.
+                // for dense results of sparse arguments.
+                DistEvalImpl_::set_tile(target_index, value_type(
+                    TensorImpl_::trange().make_tile_range(target_index),
+                    typename value_type::numeric_type(0)));
+              }
+
+              ++task_count;
+            }
+          }
+        }
+
+        // Wait for child tensors to be evaluated, and process tasks while waiting.
+        left_.wait();
+        right_.wait();
+
+        return task_count;
+      }
+
+    }; // class BatchContractionEvalImpl
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_BATCH_CONTRACTION_EVAL_H__INCLUDED
@@ -20,14 +20,21 @@
 #ifndef TILEDARRAY_DIST_EVAL_CONTRACTION_EVAL_H__INCLUDED
 #define TILEDARRAY_DIST_EVAL_CONTRACTION_EVAL_H__INCLUDED
 
+#include <map>
 #include <vector>
 
 #include <TiledArray/config.h>
+#include <TiledArray/sparse_contraction_plan.h>
 #include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/dist_eval/work_stealer.h>
 #include <TiledArray/proc_grid.h>
 #include <TiledArray/reduce_task.h>
 #include <TiledArray/type_traits.h>
 #include <TiledArray/shape.h>
+#include <TiledArray/tile_codec.h>
+#include <TiledArray/symm/tile_symmetry.h>
+#include <TiledArray/tile_interface/permute.h>
+#include <TiledArray/tile_interface/scale.h>
 
 //#define TILEDARRAY_ENABLE_SUMMA_TRACE_EVAL 1
 //#define TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE 1
@@ -38,6 +45,51 @@
 namespace TiledArray {
   namespace detail {
 
+    /// Key of the group that broadcasts a SUMMA tile across nodes
+
+    /// SUMMA row and column groups have keys less than <tt>2 * k</tt>. Leader
+    /// groups of the same group with different roots have different members,
+    /// so their keys follow the group keys, one per group and root.
+    /// \param k The number of tiles in the contracted dimension
+    /// \param world_size The number of processes in the world
+    /// \param group_key The key of the row or column group
+    /// \param root The world rank of the broadcast root
+    /// \return The key of the leader group
+    inline std::size_t summa_leader_group_key(const std::size_t k,
+        const std::size_t world_size, const std::size_t group_key,
+        const ProcessID root)
+    {
+      return 2ul * k + group_key * world_size + root;
+    }
+
+    /// Key of the group that broadcasts a SUMMA tile within a node
+
+    /// The keys follow the leader group keys (see
+    /// \c summa_leader_group_key() ), one per group.
+    /// \param k The number of tiles in the contracted dimension
+    /// \param world_size The number of processes in the world
+    /// \param group_key The key of the row or column group
+    /// \return The key of the node group
+    inline std::size_t summa_node_group_key(const std::size_t k,
+        const std::size_t world_size, const std::size_t group_key)
+    {
+      return 2ul * k * (world_size + 1ul) + group_key;
+    }
+
+    /// Key of the broadcast of a SUMMA tile within a node
+
+    /// Argument tile keys are less than <tt>left_size + right_size</tt> , so
+    /// the intra-node keys follow them.
+    /// \param tile_key The key of the argument tile broadcast
+    /// \param left_size The number of tiles of the left-hand argument
+    /// \param right_size The number of tiles of the right-hand argument
+    /// \return The key of the intra-node broadcast of the tile
+    inline std::size_t summa_node_tile_key(const std::size_t tile_key,
+        const std::size_t left_size, const std::size_t right_size)
+    {
+      return tile_key + left_size + right_size;
+    }
+
     /// \brief Distributed contraction evaluator implementation
 
     /// \tparam Left The left-hand argument evaluator type
@@ -68,6 +120,8 @@ namespace TiledArray {
       typedef typename DistEvalImpl_::value_type value_type; ///< Tile type
       typedef typename DistEvalImpl_::eval_type eval_type; ///< Tile evaluation type
       typedef Op op_type; ///< Tile evaluation operator type
+      typedef SparseContractionPlan<shape_type> plan_type; ///< Contraction plan type
+      typedef typename plan_type::Schedule schedule_type; ///< SUMMA schedule type
 
     private:
       static size_type max_memory_; ///< Maximum memory used per node
@@ -86,6 +140,12 @@ namespace TiledArray {
       const size_type k_; ///< Number of tiles in the inner dimension
       const ProcGrid proc_grid_; ///< Process grid for this contraction
 
+      // Transport encoding
+      const TileCodec codec_; ///< The codec used to encode broadcast tiles
+
+      // Result symmetry
+      const symmetry::TileSymmetry symmetry_; ///< The symmetry of the result tiles
+
       // Contraction results
       ReducePairTask<op_type>* reduce_tasks_; ///< A pointer to the reduction tasks
 
@@ -97,6 +157,29 @@ namespace TiledArray {
       const size_type right_stride_; ///< Stride for right row iterators
       const size_type right_stride_local_; ///< stride for local right row iterators
 
+      // Inspector-executor plan (null when not used)
+      const std::shared_ptr<plan_type> plan_; ///< The plan that holds the SUMMA schedule
+      std::shared_ptr<const schedule_type> schedule_; ///< The SUMMA schedule of this process
+
+      // Inter-process work stealing (null when disabled)
+      const std::shared_ptr<WorkStealer<op_type> > stealer_; ///< Balances tile products between processes
+
+      // Non-zero tile indices of sparse arguments (null for other shapes)
+      const std::shared_ptr<const detail::NonzeroIndex> left_nonzeros_; ///< Non-zero tiles of left_, with k_ columns
+      const std::shared_ptr<const detail::NonzeroIndex> right_nonzeros_; ///< Non-zero tiles of right_, with proc_grid_.cols() columns
+
+      /// The two levels of a node-aware broadcast
+      struct NodeBcast {
+        madness::Group leaders; ///< The root and one process of each other node; empty when this process is not a member
+        ProcessID leaders_root; ///< The root of \c leaders
+        madness::Group node; ///< The group processes on this node; empty when there is only this process
+        ProcessID node_root; ///< The root of \c node
+      }; // struct NodeBcast
+
+      // Node-aware broadcasts (null topology when processes do not share nodes)
+      const std::shared_ptr<const NodeTopology> topology_; ///< The node topology of the world
+      mutable std::map<std::pair<size_type, ProcessID>, std::shared_ptr<const NodeBcast> > node_bcasts_; ///< Node-level broadcast groups, by group key and root
+      mutable madness::Spinlock node_bcasts_lock_; ///< Guards node_bcasts_
 
       typedef Future<typename right_type::eval_type> right_future; ///< Future to a right-hand argument tile
       typedef Future<typename left_type::eval_type> left_future; ///< Future to a left-hand argument tile
@@ -164,12 +247,32 @@ namespace TiledArray {
         return 0ul;
       }
 
+      /// Work stealer factory function
+
+      /// \param world The world where the result lives
+      /// \param shape The shape of the result
+      /// \param op The tile contraction operation
+      /// \return A work stealer for sparse results when work stealing is
+      /// enabled (see \c set_work_stealing_granularity() ), otherwise null
+      static std::shared_ptr<WorkStealer<op_type> >
+      make_work_stealer(World& world, const shape_type& shape, const op_type& op) {
+        std::shared_ptr<WorkStealer<op_type> > stealer;
+        if(work_stealing_granularity() && (world.size() > 1) && ! shape.is_dense()) {
+          stealer = std::make_shared<WorkStealer<op_type> >(world, op);
+
+          // Keep the work stealer until the next fence, so that steal
+          // requests from other processes are always received.
+          madness::detail::deferred_cleanup(world, stealer);
+        }
+        return stealer;
+      }
+
 
       // Process groups --------------------------------------------------------
 
-      /// Process group factory function
+      /// Process group list factory function
 
-      /// This function generates a sparse process group.
+      /// This function generates the process list of a sparse process group.
       /// \tparam Shape The shape type
       /// \tparam ProcMap The process map operation type
       /// \param shape The shape that will be used to select processes that are
@@ -185,15 +288,17 @@ namespace TiledArray {
       /// \param max_group_size The maximum number of processes in the result
       /// group, which is equal to the number of process in this process row or
       /// column as defined by \c proc_grid_.
-      /// \param key_offset The key that will be used to identify the process group
       /// \param proc_map The operator that will convert a process row/column
       /// index into the absolute process index (ProcessID)
-      /// \return A sparse process group that includes process in the row or
-      /// column of this process as defined by \c proc_grid_.
+      /// \return The processes of a sparse process group that includes
+      /// process in the row or column of this process as defined by
+      /// \c proc_grid_.
       template <typename Shape, typename ProcMap>
-      madness::Group make_group(const Shape& shape, const std::vector<bool>& process_mask, size_type index,
-          const size_type end, const size_type stride, const size_type max_group_size,
-          const size_type k, const size_type key_offset, const ProcMap& proc_map) const
+      std::vector<ProcessID> make_group_list(const Shape& shape,
+          const std::vector<bool>& process_mask, size_type index,
+          const size_type end, const size_type stride,
+          const size_type max_group_size, const size_type k,
+          const ProcMap& proc_map) const
       {
         // Generate the list of processes in rank_row
         std::vector<ProcessID> proc_list(max_group_size, -1);
@@ -223,8 +328,22 @@ namespace TiledArray {
         // Truncate invalid process id's
         proc_list.resize(count);
 
+        return proc_list;
+      }
+
+      /// Process group factory function
+
+      /// \param proc_list The processes in the group
+      /// \param key The key that will be used to identify the process group
+      /// \return A process group with the processes of \c proc_list , or an
+      /// empty group when \c proc_list is empty
+      madness::Group make_group(const std::vector<ProcessID>& proc_list,
+          const size_type key) const
+      {
+        if(proc_list.empty())
+          return madness::Group();
         return madness::Group(TensorImpl_::world(), proc_list,
-            madness::DistributedID(DistEvalImpl_::id(), k + key_offset));
+            madness::DistributedID(DistEvalImpl_::id(), key));
       }
 
       /// Row process group factory function
@@ -232,6 +351,33 @@ namespace TiledArray {
       /// \param k The broadcast group index
       /// \return A row process group
       madness::Group make_row_group(const size_type k) const {
+        if(schedule_) {
+          const size_type step = schedule_->find(k);
+          if(step < schedule_->steps.size())
+            return make_group(schedule_->row_groups[step], k + k_);
+        }
+        return make_group(make_row_group_list(k), k + k_);
+      }
+
+      /// Column process group factory function
+
+      /// \param k The broadcast group index
+      /// \return A column process group
+      madness::Group make_col_group(const size_type k) const {
+        if(schedule_) {
+          const size_type step = schedule_->find(k);
+          if(step < schedule_->steps.size())
+            return make_group(schedule_->col_groups[step], k);
+        }
+        return make_group(make_col_group_list(k), k);
+      }
+
+      /// Row process group list factory function
+
+      /// \param k The broadcast group index
+      /// \return The processes of the row process group, or an empty list
+      /// when this process is not in the group
+      std::vector<ProcessID> make_row_group_list(const size_type k) const {
         // Construct the sparse broadcast group
         const size_type right_begin_k = k * proc_grid_.cols();
         const size_type right_end_k = right_begin_k + proc_grid_.cols();
@@ -241,19 +387,20 @@ namespace TiledArray {
 
         // return empty group if I am not in this group, otherwise make a group
         if (result_row_mask_k[proc_grid_.rank_col()])
-          return make_group(right_.shape(), result_row_mask_k, right_begin_k, right_end_k,
-                            right_stride_, proc_grid_.proc_cols(), k, k_,
+          return make_group_list(right_.shape(), result_row_mask_k, right_begin_k, right_end_k,
+                            right_stride_, proc_grid_.proc_cols(), k,
                             [&](const ProcGrid::size_type col) { return proc_grid_.map_col(col); });
         else
-          return madness::Group();
+          return std::vector<ProcessID>();
       }
 
 
-      /// Column process group factory function
+      /// Column process group list factory function
 
       /// \param k The broadcast group index
-      /// \return A column process group
-      madness::Group make_col_group(const size_type k) const {
+      /// \return The processes of the column process group, or an empty list
+      /// when this process is not in the group
+      std::vector<ProcessID> make_col_group_list(const size_type k) const {
 
         // make the column mask; using the same mask for all tiles avoids having to compute mask
         // for every tile and use of masked broadcasts
@@ -261,11 +408,11 @@ namespace TiledArray {
 
         // return empty group if I am not in this group, otherwise make a group
         if (result_col_mask_k[proc_grid_.rank_row()])
-          return make_group(left_.shape(), result_col_mask_k, k, left_end_, left_stride_,
-                            proc_grid_.proc_rows(), k, 0ul,
+          return make_group_list(left_.shape(), result_col_mask_k, k, left_end_, left_stride_,
+                            proc_grid_.proc_rows(), k,
                             [&](const ProcGrid::size_type row) { return proc_grid_.map_row(row); });
         else
-          return madness::Group();
+          return std::vector<ProcessID>();
       }
 
       /// Makes the row result mask
@@ -532,6 +679,147 @@ namespace TiledArray {
         get_vector(right_, begin, end, right_stride_local_, row);
       }
 
+      /// Node topology factory function
+
+      /// \param world The world of the contraction
+      /// \return The node topology of \c world , or null when it is not
+      /// known or every process is on a separate node
+      static std::shared_ptr<const NodeTopology> make_topology(const World& world) {
+        std::shared_ptr<const NodeTopology> topology = node_topology(world);
+        if(topology && ((topology->size() != std::size_t(world.size())) ||
+            (topology->nodes() == world.size())))
+          topology.reset();
+        return topology;
+      }
+
+      /// Node-level broadcast groups of a broadcast group
+
+      /// The processes of \c group are split into a group with the root and
+      /// one process of each other node, which broadcasts across nodes, and
+      /// a group for each node, which fans the tile out within the node.
+      /// The groups are constructed once per group and root.
+      /// \param group The process group of the broadcast
+      /// \param group_root The root process of the broadcast
+      /// \return The node-level groups, or null when \c group is on a single
+      /// node or on separate nodes, where a flat broadcast is used
+      std::shared_ptr<const NodeBcast>
+      get_node_bcast(const madness::Group& group, const ProcessID group_root) const {
+        if(! topology_)
+          return std::shared_ptr<const NodeBcast>();
+
+        const size_type group_key = group.id().second;
+        const ProcessID root = group.world_rank(group_root);
+        const std::pair<size_type, ProcessID> cache_key(group_key, root);
+
+        // Hold the lock while the groups are constructed, so each group is
+        // constructed once.
+        madness::ScopedMutex<madness::Spinlock> locker(&node_bcasts_lock_);
+        const auto it = node_bcasts_.find(cache_key);
+        if(it != node_bcasts_.end())
+          return it->second;
+
+        // Split the group by node
+        const ProcessID rank = TensorImpl_::world().rank();
+        std::vector<ProcessID> members(group.size());
+        for(ProcessID p = 0; p < group.size(); ++p)
+          members[p] = group.world_rank(p);
+        std::vector<ProcessID> leader_list, node_list;
+        const ProcessID leader =
+            topology_->split_bcast(members, root, rank, leader_list, node_list);
+
+        std::shared_ptr<NodeBcast> node_bcast;
+        if(leader >= 0) {
+          node_bcast = std::make_shared<NodeBcast>();
+
+          const size_type world_size = TensorImpl_::world().size();
+          if(rank == leader) {
+            node_bcast->leaders = madness::Group(TensorImpl_::world(), leader_list,
+                madness::DistributedID(DistEvalImpl_::id(),
+                    summa_leader_group_key(k_, world_size, group_key, root)));
+            node_bcast->leaders_root = node_bcast->leaders.rank(root);
+          }
+          if(node_list.size() > 1ul) {
+            node_bcast->node = madness::Group(TensorImpl_::world(), node_list,
+                madness::DistributedID(DistEvalImpl_::id(),
+                    summa_node_group_key(k_, world_size, group_key)));
+            node_bcast->node_root = node_bcast->node.rank(leader);
+          }
+        }
+
+        return node_bcasts_.insert(std::make_pair(cache_key,
+            std::shared_ptr<const NodeBcast>(node_bcast))).first->second;
+      }
+
+      /// Broadcast a tile
+
+      /// When the processes of \c group share nodes, the tile is broadcast in
+      /// two levels: once to one process of each node, and from there to the
+      /// other processes of the node (see \c get_node_bcast() ), so it
+      /// crosses the network once per node.
+      /// \tparam Tile The tile type
+      /// \param[in] key The broadcast key
+      /// \param[in,out] tile The tile to be broadcast; on non-root processes
+      /// this future is set to the broadcast tile.
+      /// \param[in] group The process group where the tile will be broadcast
+      /// \param[in] group_root The root process of the broadcast
+      template <typename Tile>
+      void bcast_tile(const madness::DistributedID& key, Future<Tile>& tile,
+          const madness::Group& group, const ProcessID group_root) const
+      {
+        const std::shared_ptr<const NodeBcast> node_bcast =
+            get_node_bcast(group, group_root);
+        if(! node_bcast) {
+          bcast_group(key, tile, group, group_root, codec_.enabled());
+          return;
+        }
+
+        // Broadcast between nodes
+        if(! node_bcast->leaders.empty())
+          bcast_group(key, tile, node_bcast->leaders, node_bcast->leaders_root,
+              codec_.enabled());
+
+        // Broadcast within the node, with keys that follow the argument tile
+        // keys
+        if(! node_bcast->node.empty())
+          bcast_group(madness::DistributedID(key.first, summa_node_tile_key(
+              key.second, left_.size(), right_.size())), tile, node_bcast->node,
+              node_bcast->node_root, false);
+      }
+
+      /// Broadcast a tile within a group
+
+      /// When \c encode is \c true , the root process encodes the tile with
+      /// \c codec_ before it is broadcast, and the other processes decode it
+      /// on arrival.
+      /// \tparam Tile The tile type
+      /// \param[in] key The broadcast key
+      /// \param[in,out] tile The tile to be broadcast; on non-root processes
+      /// this future is set to the broadcast tile.
+      /// \param[in] group The process group where the tile will be broadcast
+      /// \param[in] group_root The root process of the broadcast
+      /// \param[in] encode Encode the tile with \c codec_
+      template <typename Tile>
+      void bcast_group(const madness::DistributedID& key, Future<Tile>& tile,
+          const madness::Group& group, const ProcessID group_root,
+          const bool encode) const
+      {
+        if(encode) {
+          World& world = TensorImpl_::world();
+          Future<PackedTile<Tile> > packed;
+          if(group.rank() == group_root)
+            packed = world.taskq.add(& detail::pack_tile<Tile>, tile, codec_,
+                madness::TaskAttributes::hipri());
+
+          world.gop.bcast(key, packed, group_root, group);
+
+          if(group.rank() != group_root)
+            tile.set(world.taskq.add(& detail::unpack_tile<Tile>, packed,
+                madness::TaskAttributes::hipri()));
+        } else {
+          TensorImpl_::world().gop.bcast(key, tile, group_root, group);
+        }
+      }
+
       /// Broadcast tiles from \c arg
 
       /// \param[in] start The index of the first tile to be broadcast
@@ -566,7 +854,7 @@ namespace TiledArray {
 
           // Broadcast the tile
           const madness::DistributedID key(DistEvalImpl_::id(), index + key_offset);
-          TensorImpl_::world().gop.bcast(key, it->second, group_root, group);
+          bcast_tile(key, it->second, group, group_root);
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_BCAST
           ss  << index << " ";
@@ -665,7 +953,7 @@ namespace TiledArray {
               // Broadcast the tile
               const madness::DistributedID key(DistEvalImpl_::id(), index);
               auto tile = get_tile(left_, index);
-              TensorImpl_::world().gop.bcast(key, tile, group_root, row_group);
+              bcast_tile(key, tile, row_group, group_root);
             } else {
               // Discard the tile
               left_.discard(index);
@@ -710,7 +998,7 @@ namespace TiledArray {
               // Broadcast the tile
               const madness::DistributedID key(DistEvalImpl_::id(), index + left_.size());
               auto tile = get_tile(right_, index);
-              TensorImpl_::world().gop.bcast(key, tile, group_root, col_group);
+              bcast_tile(key, tile, col_group, group_root);
             } else {
               // Discard the tile
               right_.discard(index);
@@ -722,6 +1010,29 @@ namespace TiledArray {
 
       // Row and column iteration functions ------------------------------------
 
+      /// Construct the non-zero tile index of a sparse shape
+
+      /// \tparam T The shape norm type
+      /// \param shape The shape of an argument
+      /// \param cols The number of columns of the argument matrix
+      /// \return The non-zero tile index of \c shape
+      template <typename T>
+      static std::shared_ptr<const detail::NonzeroIndex>
+      make_nonzero_index(const SparseShape<T>& shape, const size_type cols) {
+        return shape.nonzero_index(cols);
+      }
+
+      /// Construct the non-zero tile index of an arbitrary shape
+
+      /// \tparam Shape The shape type
+      /// \return A null pointer; the tiles of \c Shape are iterated directly
+      template <typename Shape>
+      static std::shared_ptr<const detail::NonzeroIndex>
+      make_nonzero_index(const Shape&, const size_type) {
+        return std::shared_ptr<const detail::NonzeroIndex>();
+      }
+
+
       /// Find next non-zero row of \c right_ for a sparse shape
 
       /// Starting at the k-th row of the right-hand argument, find the next row
@@ -731,6 +1042,22 @@ namespace TiledArray {
       /// \return The first row, greater than or equal to \c k with non-zero
       /// tiles, or \c k_ if none is found.
       size_type iterate_row(size_type k) const {
+        if(right_nonzeros_) {
+          // Search the non-zero tiles of each row for a tile in this
+          // process's column; empty rows are skipped without a search.
+          const size_type cols = proc_grid_.cols();
+          const size_type proc_cols = proc_grid_.proc_cols();
+          const size_type rank_col = proc_grid_.rank_col();
+          for(; k < k_; ++k) {
+            const detail::NonzeroIndex::const_iterator end = right_nonzeros_->row_end(k);
+            for(detail::NonzeroIndex::const_iterator it = right_nonzeros_->row_begin(k); it != end; ++it)
+              if(((*it % cols) % proc_cols) == rank_col)
+                return k;
+          }
+
+          return k;
+        }
+
         // Iterate over k's until a non-zero tile is found or the end of the
         // matrix is reached.
         size_type end = k * proc_grid_.cols();
@@ -755,6 +1082,21 @@ namespace TiledArray {
       /// \return The first column, greater than or equal to \c k, that contains
       /// a non-zero tile. If no non-zero tile is not found, return \c k_.
       size_type iterate_col(size_type k) const {
+        if(left_nonzeros_) {
+          // Search the non-zero tiles of each column for a tile in this
+          // process's row; empty columns are skipped without a search.
+          const size_type proc_rows = proc_grid_.proc_rows();
+          const size_type rank_row = proc_grid_.rank_row();
+          for(; k < k_; ++k) {
+            const detail::NonzeroIndex::const_iterator end = left_nonzeros_->col_end(k);
+            for(detail::NonzeroIndex::const_iterator it = left_nonzeros_->col_begin(k); it != end; ++it)
+              if(((*it / k_) % proc_rows) == rank_row)
+                return k;
+          }
+
+          return k;
+        }
+
         // Iterate over k's until a non-zero tile is found or the end of the
         // matrix is reached.
         for(; k < k_; ++k)
@@ -767,17 +1109,13 @@ namespace TiledArray {
       }
 
 
-      /// Find the next k where the left- and right-hand argument have non-zero tiles
+      /// Search for the next k where the left- and right-hand argument have non-zero tiles
 
-      /// Search for the next k-th column and row of the left- and right-hand
-      /// arguments, respectively, that both contain non-zero tiles. This search
-      /// only checks for non-zero tiles in this process's row or column. If a
-      /// non-zero, local tile is found that does not contribute to local
-      /// contractions, the tiles will be immediately broadcast.
       /// \param k The first row/column to check
       /// \return The next k-th column and row of the left- and right-hand
-      /// arguments, respectively, that both have non-zero tiles
-      size_type iterate_sparse(const size_type k) const {
+      /// arguments, respectively, that both have non-zero tiles in this
+      /// process's row or column
+      size_type search_sparse(const size_type k) const {
         // Initial step for k_col and k_row.
         size_type k_col = iterate_col(k);
         size_type k_row = iterate_row(k_col);
@@ -791,19 +1129,57 @@ namespace TiledArray {
           }
         }
 
-        if(k < k_row) {
+        return k_col;
+      }
+
+      /// Find the next k where the left- and right-hand argument have non-zero tiles
+
+      /// Search for the next k-th column and row of the left- and right-hand
+      /// arguments, respectively, that both contain non-zero tiles. This search
+      /// only checks for non-zero tiles in this process's row or column, and
+      /// uses the SUMMA schedule of the contraction plan when there is one. If
+      /// a non-zero, local tile is found that does not contribute to local
+      /// contractions, the tiles will be immediately broadcast.
+      /// \param k The first row/column to check
+      /// \return The next k-th column and row of the left- and right-hand
+      /// arguments, respectively, that both have non-zero tiles
+      size_type iterate_sparse(const size_type k) const {
+        const size_type k_next = (schedule_ ? schedule_->next(k) :
+            search_sparse(k));
+
+        if(k < k_next) {
           // Spawn a task to broadcast any local columns of left that were skipped
           TensorImpl_::world().taskq.add(shared_from_this(),
-              & Summa_::bcast_col_range_task, k, k_row,
+              & Summa_::bcast_col_range_task, k, k_next,
               madness::TaskAttributes::hipri());
 
           // Spawn a task to broadcast any local rows of right that were skipped
           TensorImpl_::world().taskq.add(shared_from_this(),
-              & Summa_::bcast_row_range_task, k, k_col,
+              & Summa_::bcast_row_range_task, k, k_next,
               madness::TaskAttributes::hipri());
         }
 
-        return k_col;
+        return k_next;
+      }
+
+      /// Construct the SUMMA schedule of this process
+
+      /// \return The non-zero SUMMA iterations of this process, with the
+      /// row and column broadcast groups of each iteration
+      std::shared_ptr<const schedule_type> make_schedule() const {
+        std::shared_ptr<schedule_type> schedule = std::make_shared<schedule_type>();
+        schedule->rows = proc_grid_.rows();
+        schedule->cols = proc_grid_.cols();
+        schedule->k = k_;
+        schedule->proc_rows = proc_grid_.proc_rows();
+        schedule->proc_cols = proc_grid_.proc_cols();
+        schedule->result = TensorImpl_::shape();
+        for(size_type k = search_sparse(0ul); k < k_; k = search_sparse(k + 1ul)) {
+          schedule->steps.push_back(k);
+          schedule->row_groups.push_back(make_row_group_list(k));
+          schedule->col_groups.push_back(make_col_group_list(k));
+        }
+        return schedule;
       }
 
 
@@ -823,10 +1199,111 @@ namespace TiledArray {
       }
 
 
+      // Result symmetry functions ---------------------------------------------
+
+      /// Check that a result tile is evaluated
+
+      /// When the result has a symmetry, only the non-zero, symmetry-unique
+      /// tiles, and the non-zero tiles whose unique tile is zero, are
+      /// evaluated. The other non-zero tiles are copies of evaluated tiles.
+      /// The unique tile of an orbit is its lexicographically smallest index
+      /// (see \c symmetry::TileSymmetry::canonical() ), so for a symmetric
+      /// matrix the tiles \c (i,j) with <tt>i <= j</tt>, i.e. the upper
+      /// triangle, are contracted.
+      /// \tparam Shape The shape type
+      /// \param shape The result shape
+      /// \param index The ordinal index of a result tile in the target layout
+      /// \return \c true if the tile at \c index is evaluated
+      template <typename Shape>
+      bool is_evaluated(const Shape& shape, const size_type index) const {
+        if(shape.is_zero(index))
+          return false;
+        if(symmetry_.trivial())
+          return true;
+        const size_type unique_index = evaluated_index(index);
+        return (unique_index == index) || shape.is_zero(unique_index);
+      }
+
+      /// Ordinal index of the unique tile of a result tile
+
+      /// \param index The ordinal index of a result tile in the target layout
+      /// \return The ordinal index of the symmetry-unique tile in the orbit of
+      /// \c index
+      size_type evaluated_index(const size_type index) const {
+        if(symmetry_.trivial())
+          return index;
+        const auto& tiles_range = TensorImpl_::tiles_range();
+        return tiles_range.ordinal(symmetry_.canonical(tiles_range.idx(index)));
+      }
+
+      /// Find the result tiles that are copies of an evaluated tile
+
+      /// \tparam Shape The shape type
+      /// \param shape The result shape
+      /// \param index The ordinal index of an evaluated result tile in the
+      /// target layout
+      /// \return A list of the ordinal indices of the non-zero tiles that are
+      /// copies of the tile at \c index , and the symmetry group elements that
+      /// map \c index to them
+      template <typename Shape>
+      std::vector<std::pair<size_type, symmetry::TileSymmetry::element_type> >
+      symmetric_copies(const Shape& shape, const size_type index) const {
+        std::vector<std::pair<size_type, symmetry::TileSymmetry::element_type> > result;
+        if(symmetry_.trivial())
+          return result;
+
+        const auto& tiles_range = TensorImpl_::tiles_range();
+        const auto tile_index = tiles_range.idx(index);
+        if(! symmetry_.is_unique(tile_index))
+          return result;
+
+        auto copy_index = tile_index;
+        for(const auto& e : symmetry_.elements()) {
+          symmetry::detail::permute_array(e.first, tile_index, copy_index);
+          const size_type copy = tiles_range.ordinal(copy_index);
+          if((copy == index) || shape.is_zero(copy) ||
+              std::any_of(result.begin(), result.end(),
+                  [copy] (const std::pair<size_type, symmetry::TileSymmetry::element_type>& c)
+                  { return c.first == copy; }))
+            continue;
+          result.emplace_back(copy, e.first);
+        }
+
+        return result;
+      }
+
+      /// Set the result tiles that are copies of an evaluated tile
+
+      /// \tparam Shape The shape type
+      /// \param shape The result shape
+      /// \param index The ordinal index of an evaluated result tile in the
+      /// target layout
+      /// \param tile The evaluated result tile
+      template <typename Shape>
+      void set_symmetric_copies(const Shape& shape, const size_type index,
+          const Future<value_type>& tile)
+      {
+        const unsigned int rank = TensorImpl_::tiles_range().rank();
+        for(const auto& copy : symmetric_copies(shape, index)) {
+          const Permutation perm =
+              symmetry::TileSymmetry::to_permutation(copy.second, rank);
+          const int phase = symmetry_.phase(copy.second);
+          DistEvalImpl_::set_tile(copy.first, TensorImpl_::world().taskq.add(
+              [perm, phase] (const value_type& tile) -> value_type {
+                using TiledArray::permute;
+                using TiledArray::scale;
+                if(phase == 1)
+                  return permute(tile, perm);
+                return scale(tile, phase, perm);
+              }, tile));
+        }
+      }
+
+
       // Initialization functions ----------------------------------------------
 
       /// Initialize reduce tasks and construct broadcast groups
-      size_type initialize(const DenseShape&) {
+      size_type initialize(const DenseShape& shape) {
         // Construct static broadcast groups for dense arguments
         const madness::DistributedID col_did(DistEvalImpl_::id(), 0ul);
         col_group_ = proc_grid_.make_col_group(col_did);
@@ -846,6 +1323,10 @@ namespace TiledArray {
         printf(ss.str().c_str());
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
 
+        // Only the unique tiles of a symmetric result are evaluated
+        if(! symmetry_.trivial())
+          return initialize_tasks(shape);
+
         // Allocate memory for the reduce pair tasks.
         std::allocator<ReducePairTask<op_type> > alloc;
         reduce_tasks_ = alloc.allocate(proc_grid_.local_size());
@@ -863,7 +1344,11 @@ namespace TiledArray {
 
       /// Initialize reduce tasks
       template <typename Shape>
-      size_type initialize(const Shape& shape) {
+      size_type initialize(const Shape& shape) { return initialize_tasks(shape); }
+
+      /// Initialize reduce tasks for the evaluated tiles of the result
+      template <typename Shape>
+      size_type initialize_tasks(const Shape& shape) {
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
         std::stringstream ss;
@@ -894,15 +1379,16 @@ namespace TiledArray {
 
             // Initialize the reduction task
 
-            // Skip zero tiles
-            if(! shape.is_zero(DistEvalImpl_::perm_index_to_target(index))) {
+            // Skip zero tiles and the tiles that are copies of symmetric tiles
+            const size_type perm_index = DistEvalImpl_::perm_index_to_target(index);
+            if(is_evaluated(shape, perm_index)) {
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
               ss << index << " ";
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_INITIALIZE
 
               new(reduce_task) ReducePairTask<op_type>(TensorImpl_::world(), op_);
-              ++tile_count;
+              tile_count += 1ul + symmetric_copies(shape, perm_index).size();
             } else {
               // Construct an empty task to represent zero tiles.
               new(reduce_task) ReducePairTask<op_type>();
@@ -936,7 +1422,13 @@ namespace TiledArray {
       // Finalize functions ----------------------------------------------------
 
       /// Set the result tiles, destroy reduce tasks, and destroy broadcast groups
-      void finalize(const DenseShape&) {
+      void finalize(const DenseShape& shape) {
+        // Only the unique tiles of a symmetric result were evaluated
+        if(! symmetry_.trivial()) {
+          finalize_tasks(shape);
+          return;
+        }
+
         // Initialize iteration variables
         size_type row_start = proc_grid_.rank_row() * proc_grid_.cols();
         size_type row_end = row_start + proc_grid_.cols();
@@ -969,7 +1461,12 @@ namespace TiledArray {
 
       /// Set the result tiles and destroy reduce tasks
       template <typename Shape>
-      void finalize(const Shape& shape) {
+      void finalize(const Shape& shape) { finalize_tasks(shape); }
+
+      /// Set the evaluated result tiles, and their symmetric copies, and
+      /// destroy reduce tasks
+      template <typename Shape>
+      void finalize_tasks(const Shape& shape) {
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
         std::stringstream ss;
@@ -993,15 +1490,17 @@ namespace TiledArray {
             // Compute the permuted index
             const size_type perm_index = DistEvalImpl_::perm_index_to_target(index);
 
-            // Skip zero tiles
-            if(! shape.is_zero(perm_index)) {
+            // Skip zero tiles and the tiles that are copies of symmetric tiles
+            if(is_evaluated(shape, perm_index)) {
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
               ss << index << " ";
 #endif // TILEDARRAY_ENABLE_SUMMA_TRACE_FINALIZE
 
               // Set the result tile
-              DistEvalImpl_::set_tile(perm_index, reduce_task->submit());
+              const Future<value_type> tile = reduce_task->submit();
+              DistEvalImpl_::set_tile(perm_index, tile);
+              set_symmetric_copies(shape, perm_index, tile);
             }
 
             // Destroy the reduce task
@@ -1074,6 +1573,10 @@ namespace TiledArray {
           for(size_type j = 0ul; j < row.size(); ++j) {
             const size_type reduce_task_index = reduce_task_offset + row[j].first;
 
+            // Skip tiles that are not evaluated for symmetric results
+            if(! reduce_tasks_[reduce_task_index])
+              continue;
+
             // Schedule task for contraction pairs
             if(task)
               task->inc();
@@ -1119,7 +1622,10 @@ namespace TiledArray {
             }
             const left_future left = col[i].second;
             const right_future right = row[j].second;
-            reduce_tasks_[reduce_task_index].add(left, right, task);
+            if(stealer_)
+              stealer_->add(reduce_task_index, left, right, task);
+            else
+              reduce_tasks_[reduce_task_index].add(left, right, task);
           }
         }
       }
@@ -1323,6 +1829,11 @@ namespace TiledArray {
             finalize_task_->notify();
 
           } else if(finalize_task_) {
+            // All local tile products have been scheduled, so this process
+            // may steal products from other processes.
+            if(owner_->stealer_)
+              owner_->stealer_->finish();
+
             // Signal the finalize task so it can run after all non-zero step
             // tasks have completed.
             finalize_task_->notify();
@@ -1426,6 +1937,9 @@ namespace TiledArray {
         SparseStepTask(const std::shared_ptr<Summa_>& owner, size_type depth) :
           StepTask(owner, 1ul)
         {
+          if(owner_->stealer_)
+            owner_->stealer_->start(owner_->reduce_tasks_, finalize_task_);
+
           StepTask::make_next_step_tasks(this, depth);
 
           // Spawn a task to find the next non-zero iteration
@@ -1477,24 +1991,37 @@ namespace TiledArray {
       /// \param k The number of tiles in the inner dimension
       /// \param proc_grid The process grid that defines the layout of the tiles
       ///                  during the contraction evaluation
+      /// \param codec The codec used to encode broadcast tiles
+      /// \param result_symmetry The symmetry of the result; only the unique
+      ///                  result tiles are contracted
+      /// \param plan The contraction plan that holds the SUMMA schedule of
+      ///                  this process, or null
       /// \note The trange, shape, and pmap refer to the final,
       ///       permuted, state for the result, NOT to the result during
       ///       the SUMMA evaluation.
       Summa(const left_type& left, const right_type& right,
           World& world, const trange_type trange, const shape_type& shape,
           const std::shared_ptr<pmap_interface>& pmap, const Permutation& perm,
-          const op_type& op, const size_type k, const ProcGrid& proc_grid) :
+          const op_type& op, const size_type k, const ProcGrid& proc_grid,
+          const TileCodec& codec = TileCodec(),
+          const symmetry::TileSymmetry& result_symmetry = symmetry::TileSymmetry(),
+          const std::shared_ptr<plan_type>& plan = std::shared_ptr<plan_type>()) :
         DistEvalImpl_(world, trange, shape, pmap, perm),
         left_(left), right_(right), op_(op),
         row_group_(), col_group_(),
-        k_(k), proc_grid_(proc_grid),
+        k_(k), proc_grid_(proc_grid), codec_(codec), symmetry_(result_symmetry),
         reduce_tasks_(NULL),
         left_start_local_(proc_grid_.rank_row() * k),
         left_end_(left.size()),
         left_stride_(k),
         left_stride_local_(proc_grid.proc_rows() * k),
         right_stride_(1ul),
-        right_stride_local_(proc_grid.proc_cols())
+        right_stride_local_(proc_grid.proc_cols()),
+        plan_(plan), schedule_(),
+        stealer_(make_work_stealer(world, shape, op)),
+        left_nonzeros_(make_nonzero_index(left.shape(), k)),
+        right_nonzeros_(make_nonzero_index(right.shape(), proc_grid.cols())),
+        topology_(make_topology(world)), node_bcasts_(), node_bcasts_lock_()
       { }
 
       virtual ~Summa() { }
@@ -1509,7 +2036,10 @@ namespace TiledArray {
         TA_ASSERT(TensorImpl_::is_local(i));
         TA_ASSERT(! TensorImpl_::is_zero(i));
 
-        const size_type source_index = DistEvalImpl_::perm_index_to_source(i);
+        // Copies of symmetric tiles are sent by the process that evaluates
+        // the unique tile.
+        const size_type source_index = DistEvalImpl_::perm_index_to_source(
+            is_evaluated(TensorImpl_::shape(), i) ? i : evaluated_index(i));
 
         // Compute tile coordinate in tile grid
         const size_type tile_row = source_index / proc_grid_.cols();
@@ -1617,6 +2147,13 @@ namespace TiledArray {
           size_type depth =
               std::max(ProcGrid::size_type(2), std::min(proc_grid_.proc_rows(), proc_grid_.proc_cols()));
 
+          // Increase the depth when argument tiles are computed on demand, so
+          // that tile generation overlaps with the contraction of earlier
+          // iterations.
+          const float tile_cost = std::max(left_.tile_cost(), right_.tile_cost());
+          if(tile_cost > 0.0f)
+            depth = float(depth) * (1.0f + tile_cost) + 0.5f;
+
           // Construct the first SUMMA iteration task
           if(TensorImpl_::shape().is_dense()) {
             // We cannot have more iterations than there are blocks in the k
@@ -1628,7 +2165,7 @@ namespace TiledArray {
             depth = mem_bound_depth(depth, 0.0f, 0.0f);
 
             // Enforce user defined depth bound
-            if(max_depth_) std::min(depth, max_depth_);
+            if(max_depth_) depth = std::min(depth, max_depth_);
 
             TensorImpl_::world().taskq.add(new DenseStepTask(shared_from_this(),
                                                              depth));
@@ -1655,11 +2192,25 @@ namespace TiledArray {
             depth = mem_bound_depth(depth, left_sparsity, right_sparsity);
 
             // Enforce user defined depth bound
-            if(max_depth_) std::min(depth, max_depth_);
+            if(max_depth_) depth = std::min(depth, max_depth_);
+
+            // Reuse the SUMMA schedule of the contraction plan, or record it
+            if(plan_) {
+              schedule_ = plan_->schedule(proc_grid_.rows(), proc_grid_.cols(),
+                  k_, proc_grid_.proc_rows(), proc_grid_.proc_cols(),
+                  TensorImpl_::shape());
+              if(! schedule_) {
+                schedule_ = make_schedule();
+                plan_->set_schedule(schedule_);
+              }
+            }
 
             TensorImpl_::world().taskq.add(new SparseStepTask(shared_from_this(),
                                                               depth));
           }
+        } else if(stealer_) {
+          // This process has no tiles to contract, so it only steals work
+          stealer_->finish();
         }
 
 #ifdef TILEDARRAY_ENABLE_SUMMA_TRACE_EVAL
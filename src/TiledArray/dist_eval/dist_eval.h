@@ -24,6 +24,7 @@
 #include <TiledArray/permutation.h>
 #include <TiledArray/perm_index.h>
 #include <TiledArray/type_traits.h>
+#include <atomic>
 
 namespace TiledArray {
   namespace detail {
@@ -64,6 +65,8 @@ namespace TiledArray {
 
       volatile int task_count_; ///< Total number of local tasks
       madness::AtomicInt set_counter_; ///< The number of tiles set by this node
+      std::atomic<madness::CallbackInterface*>
+          completion_callback_; ///< Notified when all local tiles are set
 
     protected:
 
@@ -104,7 +107,8 @@ namespace TiledArray {
         source_to_target_(),
         target_to_source_(),
         task_count_(-1),
-        set_counter_()
+        set_counter_(),
+        completion_callback_(nullptr)
       {
         set_counter_ = 0;
 
@@ -137,6 +141,15 @@ namespace TiledArray {
       /// \param i The index of the tile
       virtual void discard_tile(size_type i) const = 0;
 
+      /// Relative cost of evaluating a tile
+
+      /// This is a hint for the scheduling of the consumers of this tensor,
+      /// e.g. tiles that are computed on demand are more expensive than
+      /// stored tiles.
+      /// \return The cost of evaluating a tile relative to contracting it;
+      /// the default is zero
+      virtual float tile_cost() const { return 0.0f; }
+
       /// Set tensor value
 
       /// This will store \c value at ordinal index \c i . Typically, this
@@ -167,8 +180,36 @@ namespace TiledArray {
         f.register_callback(this);
       }
 
+      /// Notify the completion callback, if it has not been notified
+      void notify_completion() {
+        madness::CallbackInterface* const callback =
+            completion_callback_.exchange(nullptr);
+        if(callback)
+          callback->notify();
+      }
+
       /// Tile set notification
-      virtual void notify() { set_counter_++; }
+      virtual void notify() {
+        const int count = ++set_counter_;
+        if(count == task_count_)
+          notify_completion();
+      }
+
+      /// Register a completion callback
+
+      /// \c callback is notified once, when all tiles that are evaluated by
+      /// this process have been set. This is the non-blocking alternative to
+      /// \c wait() , and it must be called after \c eval() .
+      /// \param callback The callback object
+      void register_completion_callback(madness::CallbackInterface* callback) {
+        TA_ASSERT(task_count_ >= 0);
+        TA_ASSERT(callback);
+        completion_callback_ = callback;
+
+        // The tiles may have been set before the callback was registered
+        if(set_counter_ == task_count_)
+          notify_completion();
+      }
 
       /// Wait for all tiles to be assigned
       void wait() const {
@@ -352,6 +393,11 @@ namespace TiledArray {
       /// \param i The index of the tile
       virtual void discard(size_type i) const { pimpl_->discard_tile(i); }
 
+      /// Relative cost of evaluating a tile
+
+      /// \return The cost of evaluating a tile relative to contracting it
+      float tile_cost() const { return pimpl_->tile_cost(); }
+
       /// World object accessor
 
       /// \return A reference to the world object
@@ -365,6 +411,14 @@ namespace TiledArray {
       /// Wait for all local tiles to be evaluated
       void wait() const { pimpl_->wait(); }
 
+      /// Register a callback for the evaluation of all local tiles
+
+      /// \param callback The callback object, which is notified once when all
+      /// tiles that are evaluated by this process have been set
+      void register_completion_callback(madness::CallbackInterface* callback) const {
+        pimpl_->register_completion_callback(callback);
+      }
+
     }; // class DistEval
 
   }  // namespace detail
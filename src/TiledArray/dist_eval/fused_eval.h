@@ -0,0 +1,276 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  fused_eval.h
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_FUSED_EVAL_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_FUSED_EVAL_H__INCLUDED
+
+#include <TiledArray/dist_eval/dist_eval.h>
+#include <TiledArray/tile_op/fused.h>
+#include <TiledArray/tile_interface/cast.h>
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Fused element-wise, distributed tensor evaluator
+
+    /// This object is used to evaluate the tiles of a tree of element-wise
+    /// expressions in a single pass. The leaves of the tree are the
+    /// arguments of this evaluator, and each result tile is computed from
+    /// the leaf tiles by one task, without intermediate tiles.
+    /// \tparam Op The fused tile operator type
+    /// \tparam Policy The tensor policy class
+    /// \tparam Args The leaf argument types
+    template <typename Op, typename Policy, typename... Args>
+    class FusedEvalImpl :
+      public DistEvalImpl<typename Op::result_type, Policy>,
+      public std::enable_shared_from_this<FusedEvalImpl<Op, Policy, Args...> >
+    {
+    public:
+      typedef FusedEvalImpl<Op, Policy, Args...> FusedEvalImpl_; ///< This object type
+      typedef DistEvalImpl<typename Op::result_type, Policy> DistEvalImpl_; ///< The base class type
+      typedef typename DistEvalImpl_::TensorImpl_ TensorImpl_; ///< The base, base class type
+      typedef std::tuple<Args...> args_type; ///< The leaf argument types
+      typedef typename DistEvalImpl_::size_type size_type; ///< Size type
+      typedef typename DistEvalImpl_::range_type range_type; ///< Range type
+      typedef typename DistEvalImpl_::shape_type shape_type; ///< Shape type
+      typedef typename DistEvalImpl_::pmap_interface pmap_interface; ///< Process map interface type
+      typedef typename DistEvalImpl_::trange_type trange_type; ///< Tiled range type
+      typedef typename DistEvalImpl_::value_type value_type; ///< Tile type
+      typedef typename DistEvalImpl_::eval_type eval_type; ///< Tile evaluation type
+      typedef Op op_type; ///< Tile evaluation operator type
+
+      using std::enable_shared_from_this<FusedEvalImpl_>::shared_from_this;
+
+      static_assert(sizeof...(Args) > 1ul, "A fused evaluator needs at least two leaves.");
+      static_assert(sizeof...(Args) <= max_fused_leaves, "Too many leaves for a fused evaluator.");
+
+    private:
+
+      args_type args_; ///< Leaf arguments
+      op_type op_; ///< Fused tile operator
+
+      typedef std::make_index_sequence<sizeof...(Args)> arg_indices;
+
+    public:
+
+      /// Construct a fused evaluator
+
+      /// \param args The leaf arguments
+      /// \param world The world where the tensor lives
+      /// \param trange The tiled range object
+      /// \param shape The tensor shape object
+      /// \param pmap The tile-process map
+      /// \param perm The permutation that is applied to tile indices
+      /// \param op The fused tile operation
+      FusedEvalImpl(const args_type& args, World& world,
+          const trange_type& trange, const shape_type& shape,
+          const std::shared_ptr<pmap_interface>& pmap, const Permutation& perm,
+          const op_type& op) :
+        DistEvalImpl_(world, trange, shape, pmap, perm), args_(args), op_(op)
+      { }
+
+      virtual ~FusedEvalImpl() { }
+
+      /// Get tile at index \c i
+
+      /// \param i The index of the tile
+      /// \return A \c Future to the tile at index i
+      /// \throw TiledArray::Exception When tile \c i is owned by a remote node.
+      /// \throw TiledArray::Exception When tile \c i a zero tile.
+      virtual Future<value_type> get_tile(size_type i) const {
+        TA_ASSERT(TensorImpl_::is_local(i));
+        TA_ASSERT(! TensorImpl_::is_zero(i));
+
+        const size_type source_index = DistEvalImpl_::perm_index_to_source(i);
+        const ProcessID source = std::get<0>(args_).owner(source_index); // All
+                                                  // leaves have the same owner
+
+        const madness::DistributedID key(DistEvalImpl_::id(), i);
+        return TensorImpl_::world().gop.template recv<value_type>(source, key);
+      }
+
+      /// Discard a tile that is not needed
+
+      /// This function handles the cleanup for tiles that are not needed in
+      /// subsequent computation.
+      /// \param i The index of the tile
+      virtual void discard_tile(size_type i) const { get_tile(i); }
+
+    private:
+
+      /// Convert a leaf tile to the evaluation type
+
+      /// \tparam T The leaf tile type
+      /// \param range The range of the leaf tile
+      /// \param zero If \c true , the leaf tile is zero
+      /// \param tile The leaf tile
+      /// \return The evaluated leaf tile; a tile of zeros when \c zero is
+      /// \c true
+      template <typename T>
+      static eval_type eval_arg(const range_type& range, const bool zero,
+          const T& tile)
+      {
+        if(zero)
+          return eval_type(range, typename eval_type::numeric_type(0));
+
+        TiledArray::Cast<eval_type, T> cast;
+        return cast(tile);
+      }
+
+      template <std::size_t... Is>
+      void eval_tile_helper(const size_type i, const unsigned int zeros,
+          std::index_sequence<Is...>,
+          const typename Args::value_type&... tiles)
+      {
+        const range_type range = std::get<0>(args_).trange().make_tile_range(
+            DistEvalImpl_::perm_index_to_source(i));
+        DistEvalImpl_::set_tile(i,
+            op_(eval_arg(range, (zeros >> Is) & 1u, tiles)...));
+      }
+
+      /// Task function for evaluating tiles
+
+      /// \param i The tile index
+      /// \param zeros Bit mask of the zero leaf tiles
+      /// \param tiles The leaf tiles
+      void eval_tile(const size_type i, const unsigned int zeros,
+          const typename Args::value_type&... tiles)
+      {
+        eval_tile_helper(i, zeros, arg_indices(), tiles...);
+      }
+
+      /// Schedule the evaluation of a tile
+
+      /// \param index The source index of the tile
+      /// \param zeros Bit mask of the zero leaf tiles
+      template <std::size_t... Is>
+      void add_task(const size_type index, const unsigned int zeros,
+          std::index_sequence<Is...>)
+      {
+        TensorImpl_::world().taskq.add(shared_from_this(),
+            & FusedEvalImpl_::eval_tile, DistEvalImpl_::perm_index_to_target(index),
+            zeros, (((zeros >> Is) & 1u) ?
+                Future<typename Args::value_type>(typename Args::value_type()) :
+                std::get<Is>(args_).get(index))...);
+      }
+
+      /// Get the zero leaf tiles
+
+      /// \param index The source index of the tile
+      /// \return Bit mask of the zero leaf tiles
+      template <std::size_t... Is>
+      unsigned int zero_args(const size_type index,
+          std::index_sequence<Is...>) const
+      {
+        unsigned int zeros = 0u;
+        const unsigned int bits[] = { (std::get<Is>(args_).is_zero(index) ?
+            (1u << Is) : 0u)... };
+        for(const unsigned int bit : bits)
+          zeros |= bit;
+        return zeros;
+      }
+
+      /// Discard the nonzero leaf tiles
+
+      /// \param index The source index of the tile
+      template <std::size_t... Is>
+      void discard_args(const size_type index,
+          std::index_sequence<Is...>) const
+      {
+        const int dummy[] = { (std::get<Is>(args_).is_zero(index) ? 0 :
+            (std::get<Is>(args_).discard(index), 0))... };
+        (void)dummy;
+      }
+
+      template <std::size_t... Is>
+      bool is_dense_args(std::index_sequence<Is...>) const {
+        const bool dense[] = { std::get<Is>(args_).is_dense()... };
+        return std::all_of(std::begin(dense), std::end(dense),
+            [] (const bool x) { return x; });
+      }
+
+      template <std::size_t... Is>
+      void eval_args(std::index_sequence<Is...>) {
+        const int dummy[] = { (std::get<Is>(args_).eval(), 0)... };
+        (void)dummy;
+      }
+
+      template <std::size_t... Is>
+      void wait_args(std::index_sequence<Is...>) const {
+        const int dummy[] = { (std::get<Is>(args_).wait(), 0)... };
+        (void)dummy;
+      }
+
+      /// Evaluate the tiles of this tensor
+
+      /// This function will evaluate the leaves of this distributed evaluator
+      /// and evaluate the tiles for this distributed evaluator. It will block
+      /// until the tasks for the leaves are evaluated (not for the tasks of
+      /// this object).
+      /// \return The number of tiles that will be set by this process
+      virtual int internal_eval() {
+
+        // Evaluate leaf tensors
+        eval_args(arg_indices());
+
+        size_type task_count = 0ul;
+
+        // Construct local iterator
+        typename pmap_interface::const_iterator it = std::get<0>(args_).pmap()->begin();
+        const typename pmap_interface::const_iterator end = std::get<0>(args_).pmap()->end();
+
+        if(is_dense_args(arg_indices()) && TensorImpl_::is_dense()) {
+          // Evaluate tiles where all leaves and the result are dense
+          for(; it != end; ++it) {
+            add_task(*it, 0u, arg_indices());
+            ++task_count;
+          }
+        } else {
+          // Evaluate tiles where the result or one of the leaves is sparse
+          for(; it != end; ++it) {
+            const size_type index = *it;
+
+            if(! TensorImpl_::is_zero(DistEvalImpl_::perm_index_to_target(index))) {
+              add_task(index, zero_args(index, arg_indices()), arg_indices());
+              ++task_count;
+            } else {
+              // Cleanup unused tiles
+              discard_args(index, arg_indices());
+            }
+          }
+        }
+
+        // Wait for leaf tensors to be evaluated, and process tasks while waiting.
+        wait_args(arg_indices());
+
+        return task_count;
+      }
+
+    }; // class FusedEvalImpl
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_FUSED_EVAL_H__INCLUDED
@@ -0,0 +1,526 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  work_stealer.h
+ *
+ */
+
+#ifndef TILEDARRAY_DIST_EVAL_WORK_STEALER_H__INCLUDED
+#define TILEDARRAY_DIST_EVAL_WORK_STEALER_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/reduce_task.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Work stealing statistics of this process
+  struct WorkStealingStatistics {
+    std::size_t requests = 0ul; ///< The number of steal requests sent
+    std::size_t failed = 0ul; ///< The number of steal requests that returned no work
+    std::size_t stolen = 0ul; ///< The number of tile products stolen from other processes
+    std::size_t given = 0ul; ///< The number of tile products given to other processes
+  }; // struct WorkStealingStatistics
+
+  namespace detail {
+
+    /// Work stealing parameters and statistics of this process
+    struct WorkStealingState {
+      std::atomic<std::size_t> granularity; ///< Tile products per steal
+      std::atomic<std::size_t> threshold; ///< Local backlog limit
+      std::atomic<std::size_t> requests; ///< Steal requests sent
+      std::atomic<std::size_t> failed; ///< Failed steal requests
+      std::atomic<std::size_t> stolen; ///< Tile products stolen
+      std::atomic<std::size_t> given; ///< Tile products given
+
+      WorkStealingState() :
+        granularity(init_granularity()),
+        threshold(init_threshold()),
+        requests(0ul), failed(0ul), stolen(0ul), given(0ul)
+      { }
+
+    private:
+      /// Parse a non-negative integer
+
+      /// \param[in] str The string to be parsed
+      /// \param[out] value The parsed value
+      /// \return \c true when all of \c str is a decimal integer that fits in
+      /// \c value
+      static bool parse(const char* const str, std::size_t& value) {
+        if(std::strchr(str, '-'))
+          return false;
+        char* end = nullptr;
+        errno = 0;
+        const unsigned long result = std::strtoul(str, &end, 10);
+        if((end == str) || (*end != '\0') || (errno == ERANGE))
+          return false;
+        value = result;
+        return true;
+      }
+
+      /// Initialize the granularity from \c TA_SUMMA_STEAL_GRANULARITY
+
+      /// \return The value of the environment variable, or zero (disabled)
+      /// when it is not set or invalid
+      static std::size_t init_granularity() {
+        std::size_t granularity = 0ul;
+        const char* const env = getenv("TA_SUMMA_STEAL_GRANULARITY");
+        if(env) {
+          const bool valid = parse(env, granularity);
+          TA_USER_ASSERT(valid,
+              "TA_SUMMA_STEAL_GRANULARITY must be a non-negative integer.");
+          if(! valid)
+            granularity = 0ul;
+        }
+        return granularity;
+      }
+
+      /// Initialize the threshold from \c TA_SUMMA_STEAL_THRESHOLD
+
+      /// \return The value of the environment variable, or 32 when it is not
+      /// set or invalid
+      static std::size_t init_threshold() {
+        std::size_t threshold = 32ul;
+        const char* const env = getenv("TA_SUMMA_STEAL_THRESHOLD");
+        if(env) {
+          const bool valid = parse(env, threshold) && (threshold > 0ul);
+          TA_USER_ASSERT(valid,
+              "TA_SUMMA_STEAL_THRESHOLD must be an integer greater than zero.");
+          if(! valid)
+            threshold = 32ul;
+        }
+        return threshold;
+      }
+    }; // struct WorkStealingState
+
+    /// Work stealing state accessor
+
+    /// \return A reference to the work stealing state of this process
+    inline WorkStealingState& work_stealing_state() {
+      static WorkStealingState state;
+      return state;
+    }
+
+  }  // namespace detail
+
+  /// Work stealing granularity accessor
+
+  /// \return The maximum number of tile products that are moved by one
+  /// steal; zero when work stealing is disabled
+  inline std::size_t work_stealing_granularity() {
+    return detail::work_stealing_state().granularity;
+  }
+
+  /// Set the work stealing granularity of sparse contractions
+
+  /// Idle processes steal up to \c granularity pending tile products at a
+  /// time from the other processes of a sparse contraction. The initial
+  /// value is taken from the \c TA_SUMMA_STEAL_GRANULARITY environment
+  /// variable, and work stealing is disabled by default.
+  /// \param granularity The maximum number of tile products per steal, or
+  /// zero to disable work stealing
+  /// \note This value must be the same on all processes when a contraction
+  /// is constructed.
+  inline void set_work_stealing_granularity(const std::size_t granularity) {
+    detail::work_stealing_state().granularity = granularity;
+  }
+
+  /// Work stealing threshold accessor
+
+  /// \return The number of tile products that a process contracts locally
+  /// before pending products may be stolen
+  inline std::size_t work_stealing_threshold() {
+    return detail::work_stealing_state().threshold;
+  }
+
+  /// Set the work stealing threshold of sparse contractions
+
+  /// Tile products that are scheduled while a process has \c threshold or
+  /// more products in progress are held in a queue, from which they are
+  /// either contracted locally or stolen. The initial value is taken from
+  /// the \c TA_SUMMA_STEAL_THRESHOLD environment variable (default = 32).
+  /// \param threshold The local backlog limit
+  inline void set_work_stealing_threshold(const std::size_t threshold) {
+    TA_USER_ASSERT(threshold > 0ul,
+        "The work stealing threshold must be greater than zero.");
+    detail::work_stealing_state().threshold = threshold;
+  }
+
+  /// Work stealing statistics accessor
+
+  /// \return The work stealing statistics of this process
+  inline WorkStealingStatistics work_stealing_statistics() {
+    const detail::WorkStealingState& state = detail::work_stealing_state();
+    WorkStealingStatistics stats;
+    stats.requests = state.requests;
+    stats.failed = state.failed;
+    stats.stolen = state.stolen;
+    stats.given = state.given;
+    return stats;
+  }
+
+  /// Reset the work stealing statistics of this process
+  inline void reset_work_stealing_statistics() {
+    detail::WorkStealingState& state = detail::work_stealing_state();
+    state.requests = 0ul;
+    state.failed = 0ul;
+    state.stolen = 0ul;
+    state.given = 0ul;
+  }
+
+  namespace detail {
+
+    /// Inter-process work stealing for tile contractions
+
+    /// This object balances the tile products of a contraction between
+    /// processes. Products are added to the local reduce tasks until the
+    /// number of local products in progress reaches the work stealing
+    /// threshold; further products are held in a pending queue, and are
+    /// added to the reduce tasks as local products complete. A process that
+    /// has scheduled all of its products and is (nearly) idle sends steal
+    /// requests to the other processes, in round-robin order. The victim
+    /// replies with up to granularity pending products whose argument tiles
+    /// are ready; the thief contracts them and returns one partial result
+    /// per result tile, which the victim reduces into its reduce task.
+    /// Stealing stops after a full round of requests returns no work.
+    ///
+    /// The finalize task of the owner holds a dependency for each pending
+    /// product until it has been added to a reduce task, or until the
+    /// partial result of a stolen product has been returned.
+    /// \tparam Op The contraction/reduction operation type
+    /// \note This object is derived from \c WorldObject , so it must be
+    /// constructed in the same order on all processes. It is held by the
+    /// deferred cleanup of the world until the next fence, so messages
+    /// never arrive after it is destroyed.
+    template <typename Op>
+    class WorkStealer :
+      public madness::WorldObject<WorkStealer<Op> >,
+      private madness::Spinlock
+    {
+    public:
+      typedef WorkStealer<Op> WorkStealer_; ///< This object type
+      typedef madness::WorldObject<WorkStealer_> WorldObject_; ///< Base object type
+      typedef std::size_t size_type; ///< Size type
+      typedef Op op_type; ///< The contraction/reduction operation type
+      typedef typename op_type::result_type result_type; ///< Result tile type
+      typedef typename std::remove_cv<typename std::remove_reference<
+          typename op_type::first_argument_type>::type>::type left_type; ///< Left-hand tile type
+      typedef typename std::remove_cv<typename std::remove_reference<
+          typename op_type::second_argument_type>::type>::type right_type; ///< Right-hand tile type
+      typedef ReducePairTask<op_type> reduce_task_type; ///< Reduce task type
+
+    private:
+
+      /// A pending tile product
+      struct Product {
+        size_type index; ///< The local reduce task index
+        Future<left_type> left; ///< The left-hand tile
+        Future<right_type> right; ///< The right-hand tile
+        madness::CallbackInterface* callback; ///< The product callback
+      }; // struct Product
+
+      /// Callback for a tile product that is contracted locally
+      class LocalCallback : public madness::CallbackInterface {
+      private:
+        WorkStealer_* owner_; ///< The work stealer
+        madness::CallbackInterface* callback_; ///< The product callback
+
+      public:
+        LocalCallback(WorkStealer_* owner, madness::CallbackInterface* callback) :
+          owner_(owner), callback_(callback)
+        { }
+
+        virtual ~LocalCallback() { }
+
+        virtual void notify() {
+          if(callback_)
+            callback_->notify();
+          owner_->local_done();
+          delete this;
+        }
+      }; // class LocalCallback
+
+      op_type op_; ///< The contraction/reduction operation
+      const size_type granularity_; ///< Maximum number of products per steal
+      const size_type threshold_; ///< Local backlog limit
+      reduce_task_type* reduce_tasks_; ///< The local reduce tasks
+      madness::TaskInterface* finalize_; ///< The finalize task of the owner
+      std::list<Product> pending_; ///< Products that may be stolen
+      size_type local_; ///< Number of local products in progress
+      size_type stolen_; ///< Number of stolen products in progress
+      bool scheduled_; ///< All local products have been scheduled
+      bool stealing_; ///< A steal request is in flight
+      ProcessID victim_; ///< The next process to steal from
+      ProcessID failed_; ///< The number of consecutive failed steals
+
+      /// Add a tile product to its reduce task
+      void submit(const Product& product) {
+        reduce_tasks_[product.index].add(product.left, product.right,
+            new LocalCallback(this, product.callback));
+      }
+
+      /// Local product completion
+
+      /// Add a pending product to the reduce tasks, if any, and steal work
+      /// when this process is idle.
+      void local_done() {
+        bool submit_pending = false;
+        Product product;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          --local_;
+          if((! pending_.empty()) && (local_ < threshold_)) {
+            product = pending_.front();
+            pending_.pop_front();
+            ++local_;
+            submit_pending = true;
+          }
+        }
+
+        if(submit_pending) {
+          submit(product);
+          finalize_->notify();
+        } else {
+          steal();
+        }
+      }
+
+      /// Send a steal request when this process is idle
+      void steal() {
+        World& world = WorldObject_::get_world();
+        ProcessID victim = 0;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          if((! scheduled_) || stealing_ || ((local_ + stolen_) >= granularity_) ||
+              ((failed_ + 1) >= world.size()))
+            return;
+
+          stealing_ = true;
+          victim = victim_;
+          victim_ = (victim_ + 1) % world.size();
+          if(victim_ == world.rank())
+            victim_ = (victim_ + 1) % world.size();
+        }
+
+        ++work_stealing_state().requests;
+        WorldObject_::task(victim, & WorkStealer_::steal_handler, world.rank(),
+            madness::TaskAttributes::hipri());
+      }
+
+      /// Give pending products with ready arguments to a thief
+
+      /// \param thief The process that requested work
+      void steal_handler(const ProcessID thief) {
+        std::vector<size_type> indices;
+        std::vector<left_type> left;
+        std::vector<right_type> right;
+        std::vector<madness::CallbackInterface*> callbacks;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          auto it = pending_.begin();
+          while((it != pending_.end()) && (indices.size() < granularity_)) {
+            if(it->left.probe() && it->right.probe()) {
+              indices.push_back(it->index);
+              left.push_back(it->left.get());
+              right.push_back(it->right.get());
+              callbacks.push_back(it->callback);
+              it = pending_.erase(it);
+            } else {
+              ++it;
+            }
+          }
+        }
+
+        // The argument tiles of stolen products are no longer held here
+        for(madness::CallbackInterface* callback : callbacks)
+          if(callback)
+            callback->notify();
+        work_stealing_state().given += indices.size();
+
+        WorldObject_::task(thief, & WorkStealer_::steal_reply_handler,
+            WorldObject_::get_world().rank(), indices, left, right,
+            madness::TaskAttributes::hipri());
+      }
+
+      /// Receive stolen products
+
+      /// \param victim The process that sent the products
+      /// \param indices The reduce task indices of the products
+      /// \param left The left-hand tiles of the products
+      /// \param right The right-hand tiles of the products
+      void steal_reply_handler(const ProcessID victim,
+          const std::vector<size_type>& indices,
+          const std::vector<left_type>& left,
+          const std::vector<right_type>& right)
+      {
+        if(indices.empty()) {
+          {
+            madness::ScopedMutex<madness::Spinlock> locker(this);
+            stealing_ = false;
+            ++failed_;
+          }
+          ++work_stealing_state().failed;
+          steal();
+          return;
+        }
+
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          stealing_ = false;
+          failed_ = 0;
+          stolen_ += indices.size();
+        }
+        work_stealing_state().stolen += indices.size();
+
+        WorldObject_::get_world().taskq.add(this, & WorkStealer_::contract,
+            victim, indices, left, right);
+      }
+
+      /// Contract stolen products and return the partial results
+
+      /// \param victim The process that owns the products
+      /// \param indices The reduce task indices of the products
+      /// \param left The left-hand tiles of the products
+      /// \param right The right-hand tiles of the products
+      void contract(const ProcessID victim, const std::vector<size_type>& indices,
+          const std::vector<left_type>& left, const std::vector<right_type>& right)
+      {
+        // Reduce the products of each result tile into one partial result
+        std::vector<size_type> result_indices;
+        std::vector<size_type> counts;
+        std::vector<result_type> results;
+        for(size_type i = 0ul; i < indices.size(); ++i) {
+          size_type r = 0ul;
+          while((r < result_indices.size()) && (result_indices[r] != indices[i]))
+            ++r;
+          if(r == result_indices.size()) {
+            result_indices.push_back(indices[i]);
+            counts.push_back(0ul);
+            results.push_back(op_());
+          }
+          op_(results[r], left[i], right[i]);
+          ++counts[r];
+        }
+
+        WorldObject_::task(victim, & WorkStealer_::result_handler,
+            result_indices, counts, results, madness::TaskAttributes::hipri());
+
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          stolen_ -= indices.size();
+        }
+        steal();
+      }
+
+      /// Reduce the partial results of stolen products
+
+      /// \param indices The reduce task indices of the partial results
+      /// \param counts The number of products in each partial result
+      /// \param results The partial results
+      void result_handler(const std::vector<size_type>& indices,
+          const std::vector<size_type>& counts,
+          const std::vector<result_type>& results)
+      {
+        for(size_type r = 0ul; r < indices.size(); ++r) {
+          reduce_tasks_[indices[r]].add_result(results[r]);
+          for(size_type c = 0ul; c < counts[r]; ++c)
+            finalize_->notify();
+        }
+      }
+
+    public:
+
+      /// Constructor
+
+      /// \param world The world where the contraction is evaluated
+      /// \param op The contraction/reduction operation
+      WorkStealer(World& world, const op_type& op) :
+        WorldObject_(world), madness::Spinlock(), op_(op),
+        granularity_(work_stealing_granularity()),
+        threshold_(work_stealing_threshold()),
+        reduce_tasks_(nullptr), finalize_(nullptr), pending_(),
+        local_(0ul), stolen_(0ul), scheduled_(false), stealing_(false),
+        victim_((world.rank() + 1) % world.size()), failed_(0)
+      {
+        TA_ASSERT(granularity_ > 0ul);
+        WorldObject_::process_pending();
+      }
+
+      virtual ~WorkStealer() { }
+
+      /// Start scheduling local products
+
+      /// \param reduce_tasks The local reduce tasks
+      /// \param finalize The task that submits the reduce tasks
+      void start(reduce_task_type* reduce_tasks,
+          madness::TaskInterface* finalize)
+      {
+        reduce_tasks_ = reduce_tasks;
+        finalize_ = finalize;
+      }
+
+      /// Schedule a tile product
+
+      /// \param index The local reduce task index of the product
+      /// \param left The left-hand tile
+      /// \param right The right-hand tile
+      /// \param callback The callback that is invoked when the tiles are no
+      /// longer held by this process
+      void add(const size_type index, const Future<left_type>& left,
+          const Future<right_type>& right, madness::CallbackInterface* callback)
+      {
+        TA_ASSERT(reduce_tasks_);
+        TA_ASSERT(finalize_);
+        const Product product = { index, left, right, callback };
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          if(local_ >= threshold_) {
+            pending_.push_back(product);
+            finalize_->inc();
+            return;
+          }
+          ++local_;
+        }
+
+        submit(product);
+      }
+
+      /// Mark the end of local product scheduling
+
+      /// After this call, this process steals work when it is idle.
+      void finish() {
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(this);
+          scheduled_ = true;
+          failed_ = 0;
+        }
+        steal();
+      }
+
+    }; // class WorkStealer
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_DIST_EVAL_WORK_STEALER_H__INCLUDED
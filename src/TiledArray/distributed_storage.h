@@ -21,6 +21,10 @@
 #define TILEDARRAY_DISTRIBUTED_STORAGE_H__INCLUDED
 
 #include <TiledArray/pmap/pmap.h>
+#include <TiledArray/tile_codec.h>
+#include <algorithm>
+#include <new>
+#include <vector>
 
 namespace TiledArray {
   namespace detail {
@@ -35,6 +39,19 @@ namespace TiledArray {
     /// is first accessed, though you may manually initialize an element with
     /// the \c insert() function. All elements are stored in \c Future ,
     /// which may be set only once.
+    ///
+    /// Local elements are stored either in a concurrent hash map, where they
+    /// are inserted on first access, or in a flat array of futures that is
+    /// allocated when the container is constructed and is indexed by the
+    /// local ordinal of the element in the process map. Access to the flat
+    /// storage does not lock, so it should be preferred when all local
+    /// elements will be stored (e.g. for dense tensors).
+    ///
+    /// Remote elements may be set or requested in bulk, with one message per
+    /// destination process. Single remote sets may also be aggregated (see
+    /// \c set_batch_size() ); aggregated elements are sent when the batch
+    /// for a process is full, by a task that is scheduled when the first
+    /// element is buffered, or by \c flush() .
     /// \note This object is derived from \c WorldObject , which means
     /// the order of construction of object must be the same on all nodes. This
     /// can easily be achieved by only constructing world objects in the main
@@ -54,12 +71,30 @@ namespace TiledArray {
       typedef madness::ConcurrentHashMap<key_type, future> container_type; ///< Local container type
       typedef typename container_type::accessor accessor; ///< Local element accessor type
       typedef typename container_type::const_accessor const_accessor; ///< Local element const accessor type
+      typedef std::vector<key_type> key_vector; ///< Bulk element key type
+      typedef std::vector<value_type> value_vector; ///< Bulk element type
+      typedef std::vector<future> future_vector; ///< Bulk element future type
 
     private:
 
       const size_type max_size_; ///< The maximum number of elements that can be stored by this container
       std::shared_ptr<pmap_interface> pmap_; ///< The process map that defines the element distribution
       mutable container_type data_; ///< The local data container
+      std::vector<future> flat_data_; ///< The flat local data container,
+          ///< indexed by local ordinal (empty when the hash map is used)
+      const bool flat_; ///< \c true when local elements are stored in \c flat_data_
+      unsigned int consumers_; ///< The number of reads after which a local
+          ///< element is released (0 = never released)
+      mutable madness::ConcurrentHashMap<key_type, unsigned int> reads_; ///< The
+          ///< number of reads of the local elements
+      size_type batch_size_; ///< The number of remote sets that are
+          ///< aggregated for each process (0 or 1 = not aggregated)
+      std::vector<key_vector> batch_keys_; ///< Buffered remote set keys, per process
+      std::vector<value_vector> batch_values_; ///< Buffered remote set values, per process
+      bool flush_scheduled_; ///< \c true when a flush task has been scheduled
+      madness::Spinlock batch_lock_; ///< Lock for the remote set buffers
+
+      typedef std::vector<typename future::remote_refT> ref_vector;
 
       // not allowed
       DistributedStorage(const DistributedStorage_&);
@@ -68,12 +103,54 @@ namespace TiledArray {
       future get_local(const size_type i) const {
         TA_ASSERT(pmap_->is_local(i));
 
+        // Return the local element from the flat storage, without locking.
+        if(flat_)
+          return flat_data_[pmap_->local_ordinal(i)];
+
         // Return the local element.
         const_accessor acc;
         data_.insert(acc, i);
         return acc->second;
       }
 
+      future consume_local(const size_type i) const {
+        future f = get_local(i);
+        count_read(i);
+        return f;
+      }
+
+      /// Count a read of a local element
+
+      /// The element is released after the last consumer.
+      /// \param i The element that was read
+      void count_read(const size_type i) const {
+        if(consumers_) {
+          typename madness::ConcurrentHashMap<key_type, unsigned int>::accessor acc;
+          reads_.insert(acc, std::make_pair(i, 0u));
+          if(++(acc->second) == consumers_) {
+            reads_.erase(acc);
+            if(flat_)
+              release_flat(i);
+            else
+              data_.erase(i);
+          }
+        }
+      }
+
+      /// Release a local element held by the flat storage
+
+      /// The future of element \c i is replaced with a new, unset future.
+      /// Futures cannot be reassigned after they have been set, so the old
+      /// future is destroyed in place. This is only called by the last
+      /// consumer of the element, after which the element is not accessed.
+      /// \param i The element to be released
+      void release_flat(const size_type i) const {
+        future* const f =
+            const_cast<future*>(flat_data_.data() + pmap_->local_ordinal(i));
+        f->~future();
+        new(f) future();
+      }
+
       void set_handler(const size_type i, const value_type& value) {
         future f = get_local(i);
 
@@ -92,9 +169,101 @@ namespace TiledArray {
         remote_f.set(f);
       }
 
+      void consume_handler(const size_type i, const typename future::remote_refT& ref) {
+        future f = consume_local(i);
+        future remote_f(ref);
+        remote_f.set(f);
+      }
+
+      void discard_handler(const size_type i) { count_read(i); }
+
+      void set_bulk_handler(const key_vector& keys, const value_vector& values) {
+        TA_ASSERT(keys.size() == values.size());
+        for(size_type k = 0ul; k < keys.size(); ++k)
+          set_handler(keys[k], values[k]);
+      }
+
+      void set_refs_handler(const ref_vector& refs, const value_vector& values) {
+        TA_ASSERT(refs.size() == values.size());
+        for(size_type k = 0ul; k < refs.size(); ++k) {
+          future f(refs[k]);
+          f.set(values[k]);
+        }
+      }
+
+      void get_bulk_handler(const key_vector& keys, const ref_vector& refs,
+          const ProcessID requester)
+      {
+        TA_ASSERT(keys.size() == refs.size());
+
+        // Elements that are already set are returned with a single message,
+        // the others are sent individually when they are set.
+        ref_vector ready_refs;
+        value_vector ready_values;
+        for(size_type k = 0ul; k < keys.size(); ++k) {
+          future f = get_local(keys[k]);
+          if(f.probe()) {
+            ready_refs.push_back(refs[k]);
+            ready_values.push_back(f.get());
+          } else {
+            future remote_f(refs[k]);
+            remote_f.set(f);
+          }
+        }
+
+        if(! ready_refs.empty())
+          WorldObject_::task(requester, & DistributedStorage_::set_refs_handler,
+              ready_refs, ready_values, madness::TaskAttributes::hipri());
+      }
+
+      void get_packed_handler(const size_type i, const TileCodec& codec,
+          const typename Future<PackedTile<value_type> >::remote_refT& ref)
+      {
+        future f = get_local(i);
+        Future<PackedTile<value_type> > remote_f(ref);
+        remote_f.set(get_world().taskq.add(& detail::pack_tile<value_type>, f,
+            codec, madness::TaskAttributes::hipri()));
+      }
+
+      void set_bulk_remote(const ProcessID p, const key_vector& keys,
+          const value_vector& values)
+      {
+        WorldObject_::task(p, & DistributedStorage_::set_bulk_handler,
+            keys, values, madness::TaskAttributes::hipri());
+      }
+
       void set_remote(const size_type i, const value_type& value) {
-        WorldObject_::task(owner(i), & DistributedStorage_::set_handler,
-            i, value, madness::TaskAttributes::hipri());
+        if(batch_size_ < 2ul) {
+          WorldObject_::task(owner(i), & DistributedStorage_::set_handler,
+              i, value, madness::TaskAttributes::hipri());
+          return;
+        }
+
+        // Buffer the element, and send the batch for the owner if it is full
+        const ProcessID p = owner(i);
+        key_vector keys;
+        value_vector values;
+        bool schedule = false;
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(& batch_lock_);
+          batch_keys_[p].push_back(i);
+          batch_values_[p].push_back(value);
+          if(batch_keys_[p].size() >= batch_size_) {
+            keys.swap(batch_keys_[p]);
+            values.swap(batch_values_[p]);
+          } else if(! flush_scheduled_) {
+            flush_scheduled_ = true;
+            schedule = true;
+          }
+        }
+
+        if(! keys.empty())
+          set_bulk_remote(p, keys, values);
+
+        // Partial batches are sent by a task, after the tasks that are
+        // already queued have had a chance to add to them.
+        if(schedule)
+          get_world().taskq.add(*this, & DistributedStorage_::flush);
       }
 
       struct DelayedSet : public madness::CallbackInterface {
@@ -128,17 +297,27 @@ namespace TiledArray {
       /// \param world The world where the distributed container lives
       /// \param max_size The maximum capacity of this container
       /// \param pmap The process map for the container (default = null pointer)
+      /// \param flat If \c true , a future is allocated for every local
+      /// element of \c pmap and local elements are accessed without locking;
+      /// otherwise local elements are stored in a hash map (default = false)
       DistributedStorage(World& world, size_type max_size,
-          const std::shared_ptr<pmap_interface>& pmap) :
+          const std::shared_ptr<pmap_interface>& pmap, const bool flat = false) :
         WorldObject_(world), max_size_(max_size),
         pmap_(pmap),
-        data_((max_size / world.size()) + 11)
+        data_(flat ? 1ul : (max_size / world.size()) + 11),
+        flat_data_(), flat_(flat), consumers_(0u), reads_(), batch_size_(0ul),
+        batch_keys_(world.size()), batch_values_(world.size()),
+        flush_scheduled_(false), batch_lock_()
       {
         // Check that the process map is appropriate for this storage object
         TA_ASSERT(pmap_);
         TA_ASSERT(pmap_->size() == max_size);
         TA_ASSERT(pmap_->rank() == pmap_interface::size_type(world.rank()));
         TA_ASSERT(pmap_->procs() == pmap_interface::size_type(world.size()));
+
+        // Allocate a future for each local element
+        if(flat_)
+          flat_data_.resize(pmap_->local_size());
         WorldObject_::process_pending();
       }
 
@@ -173,12 +352,25 @@ namespace TiledArray {
         return pmap_->is_local(i);
       }
 
+      /// Flat storage query
+
+      /// \return \c true when local elements are stored in a flat array,
+      /// or \c false when they are stored in a hash map
+      bool is_flat() const { return flat_; }
+
       /// Number of local elements
 
-      /// No communication.
+      /// No communication. With flat storage, only the local elements that
+      /// have been assigned are counted, which is linear in the number of
+      /// local elements.
       /// \return The number of local elements stored by the container.
       /// \throw nothing
-      size_type size() const { return data_.size(); }
+      size_type size() const {
+        if(flat_)
+          return std::count_if(flat_data_.begin(), flat_data_.end(),
+              [] (const future& f) { return f.probe(); });
+        return data_.size();
+      }
 
       /// Max size accessor
 
@@ -207,6 +399,197 @@ namespace TiledArray {
         }
       }
 
+      /// Consumer count accessor
+
+      /// \return The number of reads by \c consume() after which an element
+      /// is released, or zero if elements are not released
+      unsigned int consumers() const { return consumers_; }
+
+      /// Set the number of consumers of the elements
+
+      /// After \c n calls to \c consume() for an element, on any process,
+      /// the element is removed from this container, so its memory is freed
+      /// when the last consumer releases it. This must be called before the
+      /// first call to \c consume(), and after all elements have been set or
+      /// inserted as futures. No communication; each process controls its
+      /// local elements.
+      /// \param n The number of consumers of each element (0 = elements are
+      /// never released)
+      void set_consumers(const unsigned int n) { consumers_ = n; }
+
+      /// Remote set batch size accessor
+
+      /// \return The number of remote sets that are aggregated for each
+      /// process, or zero if remote sets are not aggregated
+      size_type batch_size() const { return batch_size_; }
+
+      /// Aggregate remote sets
+
+      /// When \c n is greater than one, elements that are set with a
+      /// remote owner are buffered and sent to the owner in batches of \c n
+      /// elements. Partial batches are sent by a task that is scheduled when
+      /// the first element of a batch is buffered, so all elements are sent
+      /// before the next fence. Call \c flush() to send them immediately.
+      /// This must not be called while elements are being set. No
+      /// communication.
+      /// \param n The number of elements in each batch (0 or 1 = remote sets
+      /// are not aggregated)
+      void set_batch_size(const size_type n) {
+        flush();
+        batch_size_ = n;
+      }
+
+      /// Send all buffered remote sets
+
+      /// Each process with buffered elements receives one message.
+      void flush() {
+        std::vector<key_vector> keys(batch_keys_.size());
+        std::vector<value_vector> values(batch_values_.size());
+        {
+          madness::ScopedMutex<madness::Spinlock> locker(& batch_lock_);
+          keys.swap(batch_keys_);
+          values.swap(batch_values_);
+          flush_scheduled_ = false;
+        }
+
+        for(ProcessID p = 0; p < ProcessID(keys.size()); ++p)
+          if(! keys[p].empty())
+            set_bulk_remote(p, keys[p], values[p]);
+      }
+
+      /// Get local or remote elements in bulk
+
+      /// The requests for remote elements are sent with one message per
+      /// owner. The elements that have already been set are returned by the
+      /// owner with one message.
+      /// \param keys The elements to get
+      /// \return Futures to the elements of \c keys , in the same order
+      /// \throw TiledArray::Exception If an element of \c keys is greater
+      /// than or equal to \c max_size() .
+      future_vector get(const key_vector& keys) const {
+        future_vector result;
+        result.reserve(keys.size());
+
+        std::vector<key_vector> remote_keys(get_world().size());
+        std::vector<ref_vector> remote_refs(get_world().size());
+        for(const key_type i : keys) {
+          TA_ASSERT(i < max_size_);
+          if(is_local(i)) {
+            result.push_back(get_local(i));
+          } else {
+            const ProcessID p = owner(i);
+            future f;
+            remote_keys[p].push_back(i);
+            remote_refs[p].push_back(f.remote_ref(get_world()));
+            result.push_back(f);
+          }
+        }
+
+        // Send a request to each owner for its elements.
+        for(ProcessID p = 0; p < ProcessID(remote_keys.size()); ++p)
+          if(! remote_keys[p].empty())
+            WorldObject_::task(p, & DistributedStorage_::get_bulk_handler,
+                remote_keys[p], remote_refs[p], get_world().rank(),
+                madness::TaskAttributes::hipri());
+
+        return result;
+      }
+
+      /// Set local or remote elements in bulk
+
+      /// Remote elements are sent with one message per owner.
+      /// \param keys The elements to be set
+      /// \param values The values of the elements of \c keys
+      /// \throw TiledArray::Exception If an element of \c keys is greater
+      /// than or equal to \c max_size() .
+      /// \throw TiledArray::Exception If the sizes of \c keys and \c values
+      /// are not equal.
+      /// \throw madness::MadnessException If an element has already been set.
+      void set(const key_vector& keys, const value_vector& values) {
+        TA_ASSERT(keys.size() == values.size());
+
+        std::vector<key_vector> remote_keys(get_world().size());
+        std::vector<value_vector> remote_values(get_world().size());
+        for(size_type k = 0ul; k < keys.size(); ++k) {
+          const key_type i = keys[k];
+          TA_ASSERT(i < max_size_);
+          if(is_local(i)) {
+            set_handler(i, values[k]);
+          } else {
+            const ProcessID p = owner(i);
+            remote_keys[p].push_back(i);
+            remote_values[p].push_back(values[k]);
+          }
+        }
+
+        for(ProcessID p = 0; p < ProcessID(remote_keys.size()); ++p)
+          if(! remote_keys[p].empty())
+            set_bulk_remote(p, remote_keys[p], remote_values[p]);
+      }
+
+      /// Get a local or remote element as a consumer
+
+      /// This is equivalent to \c get() , except the read is counted by the
+      /// owner of the element, which releases it after the last consumer (see
+      /// \c set_consumers() ). A released element must not be accessed again.
+      /// \param i The element to get
+      /// \return A future to element \c i
+      /// \throw TiledArray::Exception If \c i is greater than or equal to \c max_size() .
+      future consume(size_type i) const {
+        TA_ASSERT(i < max_size_);
+        if(is_local(i)) {
+          return consume_local(i);
+        } else {
+          // Send a request to the owner of i for the element.
+          future result;
+          WorldObject_::task(owner(i), & DistributedStorage_::consume_handler, i,
+              result.remote_ref(get_world()), madness::TaskAttributes::hipri());
+
+          return result;
+        }
+      }
+
+      /// Count a read of an element without getting it
+
+      /// This is equivalent to \c consume() for a consumer that does not need
+      /// the element: only the read is counted by the owner, which releases
+      /// the element after the last consumer, and the element itself is not
+      /// sent.
+      /// \param i The element that is not needed
+      /// \throw TiledArray::Exception If \c i is greater than or equal to \c max_size() .
+      void discard(size_type i) const {
+        TA_ASSERT(i < max_size_);
+        if(is_local(i))
+          count_read(i);
+        else
+          WorldObject_::task(owner(i), & DistributedStorage_::discard_handler, i,
+              madness::TaskAttributes::hipri());
+      }
+
+      /// Get local or remote element with an encoded transfer
+
+      /// Remote elements are encoded by the owner with \c codec before they
+      /// are sent, and decoded by the requesting process.
+      /// \param i The element to get
+      /// \param codec The codec used to encode the element
+      /// \return A future to element \c i
+      /// \throw TiledArray::Exception If \c i is greater than or equal to \c max_size() .
+      future get(size_type i, const TileCodec& codec) const {
+        TA_ASSERT(i < max_size_);
+        if(is_local(i) || (! codec.enabled())) {
+          return get(i);
+        } else {
+          // Send a request to the owner of i for the encoded element.
+          Future<PackedTile<value_type> > packed;
+          WorldObject_::task(owner(i), & DistributedStorage_::get_packed_handler,
+              i, codec, packed.remote_ref(get_world()),
+              madness::TaskAttributes::hipri());
+
+          return get_world().taskq.add(& detail::unpack_tile<value_type>,
+              packed, madness::TaskAttributes::hipri());
+        }
+      }
+
       /// Set element \c i with \c value
 
       /// \param i The element to be set
@@ -233,6 +616,16 @@ namespace TiledArray {
       void set(size_type i, const future& f) {
         TA_ASSERT(i < max_size_);
         if(is_local(i)) {
+          if(flat_) {
+            future existing_f = get_local(i);
+#ifndef NDEBUG
+            if(existing_f.probe())
+              TA_EXCEPTION("Tile has already been assigned.");
+#endif // NDEBUG
+            existing_f.set(f);
+            return;
+          }
+
           const_accessor acc;
           if(! data_.insert(acc, typename container_type::datumT(i, f))) {
             // The element was already in the container, so set it with f.
@@ -194,6 +194,13 @@ namespace TiledArray {
         return op_type(op_base_type(), perm);
       }
 
+      /// Element operation factory function
+
+      /// \return The element operation of this expression
+      static auto make_element_op() {
+        return [] (const auto left, const auto right) { return left + right; };
+      }
+
       /// Expression identification tag
 
       /// \return An expression tag used to identify this expression
@@ -251,6 +258,11 @@ namespace TiledArray {
       typedef typename EngineTrait<ScalAddEngine_>::pmap_interface
           pmap_interface; ///< Process map interface type
 
+      static constexpr bool fusable = BinaryEngine_::fusable &&
+          TiledArray::detail::is_fusable_scalar<scalar_type>::value;
+          ///< \c true when this subexpression may be evaluated with a fused
+          ///< element-wise evaluator
+
     private:
 
       scalar_type factor_; ///< Scaling factor
@@ -298,6 +310,16 @@ namespace TiledArray {
         return op_type(op_base_type(factor_), perm);
       }
 
+      /// Element operation factory function
+
+      /// \return The element operation of this expression
+      auto make_element_op() const {
+        const scalar_type factor = factor_;
+        return [=] (const auto left, const auto right) {
+          return (left + right) * factor;
+        };
+      }
+
       /// Scaling factor accessor
 
       /// \return The scaling factor
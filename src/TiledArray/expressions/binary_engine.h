@@ -28,6 +28,7 @@
 
 #include <TiledArray/expressions/expr_engine.h>
 #include <TiledArray/dist_eval/binary_eval.h>
+#include <TiledArray/dist_eval/fused_eval.h>
 
 namespace TiledArray {
   namespace expressions {
@@ -62,6 +63,12 @@ namespace TiledArray {
 
       static constexpr bool consumable = EngineTrait<Derived>::consumable;
       static constexpr unsigned int leaves = EngineTrait<Derived>::leaves;
+      static constexpr bool fusable = left_type::fusable && right_type::fusable
+          && TiledArray::detail::is_fusable_tile<value_type>::value
+          && std::is_same<value_type, typename EngineTrait<left_type>::eval_type>::value
+          && std::is_same<value_type, typename EngineTrait<right_type>::eval_type>::value;
+          ///< \c true when this subexpression may be evaluated with a fused
+          ///< element-wise evaluator
 
     protected:
 
@@ -200,6 +207,72 @@ namespace TiledArray {
 
       /// \return The distributed evaluator that will evaluate this expression
       dist_eval_type make_dist_eval() const {
+        return make_dist_eval(std::integral_constant<bool, Derived::fusable &&
+            (leaves > 2u) && (leaves <= TiledArray::detail::max_fused_leaves)>());
+      }
+
+      /// Query fused element-wise evaluation
+
+      /// \return \c true when this subexpression and its arguments may be
+      /// evaluated as an argument of a fused evaluator, i.e. the result is
+      /// not permuted.
+      bool is_fusable() const {
+        return (! perm_) && left_.is_fusable() && right_.is_fusable();
+      }
+
+      /// Fused element operation factory function
+
+      /// \return The element operation of this subexpression, which takes the
+      /// leaf elements of the left- and right-hand arguments
+      auto make_fused_op() const {
+        return TiledArray::detail::make_fused_binary_op<left_type::leaves>(
+            left_.make_fused_op(), right_.make_fused_op(),
+            ExprEngine_::derived().make_element_op());
+      }
+
+      /// Fused argument factory function
+
+      /// \return A tuple that holds the distributed evaluators of the leaves
+      auto make_fused_args() const {
+        return std::tuple_cat(left_.make_fused_args(), right_.make_fused_args());
+      }
+
+    private:
+
+      /// Construct the fused distributed evaluator for this expression
+
+      /// The element-wise subexpressions of this expression are evaluated in
+      /// a single pass over the leaf tiles, when none of them permutes its
+      /// result.
+      /// \return The distributed evaluator that will evaluate this expression
+      dist_eval_type make_dist_eval(std::true_type) const {
+        if(! (left_.is_fusable() && right_.is_fusable()))
+          return make_dist_eval(std::false_type());
+
+        return make_fused_dist_eval(make_fused_args());
+      }
+
+      template <typename... Args>
+      dist_eval_type make_fused_dist_eval(const std::tuple<Args...>& args) const {
+        const auto element_op = make_fused_op();
+        typedef TiledArray::detail::Fused<value_type,
+            typename std::decay<decltype(element_op)>::type> fused_op_type;
+        typedef TiledArray::detail::FusedEvalImpl<fused_op_type, policy,
+            Args...> impl_type;
+
+        // Construct the distributed evaluator type
+        std::shared_ptr<impl_type> pimpl =
+            std::make_shared<impl_type>(args, *world_, trange_, shape_, pmap_,
+                perm_, fused_op_type(element_op,
+                    (permute_tiles_ ? perm_ : Permutation())));
+
+        return dist_eval_type(pimpl);
+      }
+
+      /// Construct the distributed evaluator for this expression
+
+      /// \return The distributed evaluator that will evaluate this expression
+      dist_eval_type make_dist_eval(std::false_type) const {
         typedef TiledArray::detail::BinaryEvalImpl<typename left_type::dist_eval_type,
             typename right_type::dist_eval_type, op_type, policy> impl_type;
 
@@ -215,6 +288,8 @@ namespace TiledArray {
         return dist_eval_type(pimpl);
       }
 
+    public:
+
       /// Expression print
 
       /// \param os The output stream
@@ -359,7 +359,7 @@ namespace TiledArray {
 
       /// \return The result shape
       shape_type make_shape() {
-        return array_.shape().block(lower_bound_, upper_bound_);
+        return LeafEngine_::array_shape().block(lower_bound_, upper_bound_);
       }
 
       /// Permuting shape factory function
@@ -367,7 +367,7 @@ namespace TiledArray {
       /// \param perm The permutation to be applied to the array
       /// \return The result shape
       shape_type make_shape(const Permutation& perm) {
-        return array_.shape().block(lower_bound_, upper_bound_, perm);
+        return LeafEngine_::array_shape().block(lower_bound_, upper_bound_, perm);
       }
 
       /// Non-permuting tile operation factory function
@@ -498,7 +498,7 @@ namespace TiledArray {
 
       /// \return The result shape
       shape_type make_shape() {
-        return array_.shape().block(lower_bound_, upper_bound_, factor_);
+        return LeafEngine_::array_shape().block(lower_bound_, upper_bound_, factor_);
       }
 
       /// Permuting shape factory function
@@ -507,7 +507,7 @@ namespace TiledArray {
       /// \return The result shape
       shape_type
       make_shape(const Permutation& perm) {
-        return array_.shape().block(lower_bound_, upper_bound_, factor_, perm);
+        return LeafEngine_::array_shape().block(lower_bound_, upper_bound_, factor_, perm);
       }
 
       /// Non-permuting tile operation factory function
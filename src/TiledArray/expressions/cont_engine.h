@@ -27,8 +27,11 @@
 #define TILEDARRAY_EXPRESSIONS_CONT_ENGINE_H__INCLUDED
 
 #include <TiledArray/expressions/binary_engine.h>
+#include <TiledArray/dist_eval/batch_contraction_eval.h>
 #include <TiledArray/dist_eval/contraction_eval.h>
+#include <TiledArray/tile_op/batch_contract_reduce.h>
 #include <TiledArray/tile_op/contract_reduce.h>
+#include <TiledArray/pmap/batch_pmap.h>
 #include <TiledArray/proc_grid.h>
 
 namespace TiledArray {
@@ -37,6 +40,7 @@ namespace TiledArray {
     // Forward declarations
     template <typename, typename> class MultExpr;
     template <typename, typename, typename> class ScalMultExpr;
+    template <typename, bool> class TsrExpr;
 
     /// Multiplication expression engine
 
@@ -65,6 +69,10 @@ namespace TiledArray {
           typename eval_trait<typename left_type::value_type>::type,
           typename eval_trait<typename right_type::value_type>::type,
           scalar_type> op_type; ///< The tile operation type
+      typedef TiledArray::detail::BatchContractReduce<value_type,
+          typename eval_trait<typename left_type::value_type>::type,
+          typename eval_trait<typename right_type::value_type>::type,
+          scalar_type> batch_op_type; ///< The batched tile operation type
       typedef typename EngineTrait<Derived>::policy
           policy; ///< The result policy type
       typedef typename EngineTrait<Derived>::dist_eval_type
@@ -114,7 +122,18 @@ namespace TiledArray {
       op_type op_; ///< Tile operation
       TiledArray::detail::ProcGrid proc_grid_; ///< Process grid for the contraction
       size_type K_; ///< Inner dimension size
-
+      std::vector<std::pair<std::string, std::string> >
+          symmetric_vars_; ///< Outer variables that are exchanged by the result symmetry
+      symmetry::TileSymmetry result_symmetry_; ///< The symmetry of the result tiles
+      unsigned int batch_rank_; ///< The number of batch variables (0 for a contraction)
+      batch_op_type batch_op_; ///< Batched tile operation
+
+      /// Batched contraction support flag
+      static constexpr bool is_batch_contractable =
+          TiledArray::detail::is_batch_contractable<value_type,
+              typename eval_trait<typename left_type::value_type>::type,
+              typename eval_trait<typename right_type::value_type>::type,
+              scalar_type>::value;
 
       static unsigned int
       find(const VariableList& vars, std::string var, unsigned int i, const unsigned int n) {
@@ -126,6 +145,51 @@ namespace TiledArray {
         return i;
       }
 
+      /// Symmetric outer variables of a contraction of generic arguments
+
+      /// \return An empty list
+      template <typename L, typename R>
+      static std::vector<std::pair<std::string, std::string> >
+      symmetric_vars(const L&, const R&) {
+        return std::vector<std::pair<std::string, std::string> >();
+      }
+
+      /// Symmetric outer variables of a contraction of two arrays
+
+      /// The result of a contraction is symmetric when both arguments are the
+      /// same array, and the contracted variables are in the same positions
+      /// of both arguments, e.g. <tt>a("i,k") * a("j,k")</tt> .
+      /// \param left The left-hand argument
+      /// \param right The right-hand argument
+      /// \return The pairs of left- and right-hand outer variables that may be
+      /// exchanged without changing the result, or an empty list if the
+      /// result is not symmetric
+      template <typename A, bool LeftAlias, bool RightAlias>
+      static std::vector<std::pair<std::string, std::string> >
+      symmetric_vars(const TsrExpr<A, LeftAlias>& left, const TsrExpr<A, RightAlias>& right) {
+        std::vector<std::pair<std::string, std::string> > result;
+        const VariableList left_vars(left.vars());
+        const VariableList right_vars(right.vars());
+        const unsigned int rank = left_vars.dim();
+        if((rank != right_vars.dim()) || (left.array().id() != right.array().id()))
+          return result;
+
+        for(unsigned int i = 0u; i < rank; ++i) {
+          const bool left_inner = (find(right_vars, left_vars[i], 0u, rank) < rank);
+          const bool right_inner = (find(left_vars, right_vars[i], 0u, rank) < rank);
+          if(left_inner != right_inner)
+            return std::vector<std::pair<std::string, std::string> >();
+          if(left_inner) {
+            if(left_vars[i] != right_vars[i])
+              return std::vector<std::pair<std::string, std::string> >();
+          } else {
+            result.emplace_back(left_vars[i], right_vars[i]);
+          }
+        }
+
+        return result;
+      }
+
     public:
 
       /// Constructor
@@ -137,8 +201,11 @@ namespace TiledArray {
       ContEngine(const MultExpr<L, R>& expr) :
         BinaryEngine_(expr), factor_(1), left_vars_(), right_vars_(),
         left_op_(permute_to_no_trans), right_op_(permute_to_no_trans), op_(),
-        proc_grid_(), K_(1u)
-      { }
+        proc_grid_(), K_(1u), symmetric_vars_(), result_symmetry_(),
+        batch_rank_(0u), batch_op_()
+      {
+        symmetric_vars_ = symmetric_vars(expr.left(), expr.right());
+      }
 
       /// Constructor
 
@@ -150,8 +217,11 @@ namespace TiledArray {
       ContEngine(const ScalMultExpr<L, R, S>& expr) :
         BinaryEngine_(expr), factor_(expr.factor()), left_vars_(), right_vars_(),
         left_op_(permute_to_no_trans), right_op_(permute_to_no_trans), op_(),
-        proc_grid_(), K_(1u)
-      { }
+        proc_grid_(), K_(1u), symmetric_vars_(), result_symmetry_(),
+        batch_rank_(0u), batch_op_()
+      {
+        symmetric_vars_ = symmetric_vars(expr.left(), expr.right());
+      }
 
       // Pull base class functions into this class.
       using ExprEngine_::derived;
@@ -165,6 +235,10 @@ namespace TiledArray {
       /// result of this expression will be permuted to match \c target_vars.
       /// \param target_vars The target variable list for this expression
       void perm_vars(const VariableList& target_vars) {
+        // The variable lists of batched contractions are fixed by init_vars()
+        if(batch_rank_)
+          return;
+
         // Only permute if the arguments can be permuted
         if((left_op_ == permute_to_no_trans) || (right_op_ == permute_to_no_trans)) {
 
@@ -222,6 +296,95 @@ namespace TiledArray {
 
       /// Initialize the variable list of this expression
 
+      /// Variables that appear in \c target_vars and in both arguments are
+      /// batch variables, e.g. \c l in
+      /// \code c("i,j,l") = a("i,l,k") * b("j,l,k") \endcode . If there are
+      /// batch variables, the arguments are permuted such that the batch
+      /// variables lead, followed by the outer and inner variables of the left
+      /// argument, and the inner and outer variables of the right argument,
+      /// and each batch element is contracted separately. Otherwise, this is
+      /// equivalent to \c init_vars() followed by \c perm_vars(target_vars) .
+      /// \param target_vars The target variable list for this expression
+      /// \note This function does not initialize the child data as is done in
+      /// \c BinaryEngine. Instead they are initialized in \c MultContEngine and
+      /// \c ScalMultContEngine.
+      void init_vars(const VariableList& target_vars) {
+        const VariableList& left_vars = left_.vars();
+        const VariableList& right_vars = right_.vars();
+        const unsigned int left_rank = left_vars.dim();
+        const unsigned int right_rank = right_vars.dim();
+        const unsigned int target_rank = target_vars.dim();
+
+        // Collect the batch variables in the order of the target
+        std::vector<std::string> batch_vars;
+        for(unsigned int i = 0u; i < target_rank; ++i) {
+          const std::string& var = target_vars[i];
+          if((find(left_vars, var, 0u, left_rank) < left_rank) &&
+              (find(right_vars, var, 0u, right_rank) < right_rank))
+            batch_vars.push_back(var);
+        }
+
+        if(batch_vars.empty()) {
+          init_vars();
+          perm_vars(target_vars);
+          return;
+        }
+
+        TA_USER_ASSERT(is_batch_contractable,
+            "ContEngine: contractions with batch (shared outer) indices are only supported for tensors of numeric types.");
+
+        // Partition the target variables into batch, left outer, and right
+        // outer variables, and the remaining variables of the left-hand
+        // argument into inner variables.
+        std::vector<std::string> left_outer, right_outer, inner;
+        for(unsigned int i = 0u; i < target_rank; ++i) {
+          const std::string& var = target_vars[i];
+          const bool in_left = (find(left_vars, var, 0u, left_rank) < left_rank);
+          const bool in_right = (find(right_vars, var, 0u, right_rank) < right_rank);
+          if(in_left && ! in_right)
+            left_outer.push_back(var);
+          else if(in_right && ! in_left)
+            right_outer.push_back(var);
+        }
+        for(unsigned int i = 0u; i < left_rank; ++i) {
+          const std::string& var = left_vars[i];
+          const bool in_target = (find(target_vars, var, 0u, target_rank) < target_rank);
+          const bool in_right = (find(right_vars, var, 0u, right_rank) < right_rank);
+          TA_USER_ASSERT(in_target || in_right,
+              "ContEngine: a variable of the left-hand argument of a batched contraction is not in the result.");
+          if(in_right && ! in_target)
+            inner.push_back(var);
+        }
+        TA_USER_ASSERT((batch_vars.size() + inner.size() + right_outer.size()) == right_rank,
+            "ContEngine: a variable of the right-hand argument of a batched contraction is not in the result.");
+        TA_USER_ASSERT((batch_vars.size() + left_outer.size() + right_outer.size()) == target_rank,
+            "ContEngine: the result variables of a batched contraction are not in the arguments.");
+
+        // Construct the argument and result variable lists
+        std::vector<std::string> vars(batch_vars);
+        vars.insert(vars.end(), left_outer.begin(), left_outer.end());
+        vars.insert(vars.end(), inner.begin(), inner.end());
+        left_vars_ = VariableList(vars.begin(), vars.end());
+
+        vars.resize(batch_vars.size());
+        vars.insert(vars.end(), inner.begin(), inner.end());
+        vars.insert(vars.end(), right_outer.begin(), right_outer.end());
+        right_vars_ = VariableList(vars.begin(), vars.end());
+
+        vars.resize(batch_vars.size());
+        vars.insert(vars.end(), left_outer.begin(), left_outer.end());
+        vars.insert(vars.end(), right_outer.begin(), right_outer.end());
+        vars_ = VariableList(vars.begin(), vars.end());
+
+        batch_rank_ = batch_vars.size();
+
+        // Permute the arguments to the batched layout
+        left_.perm_vars(left_vars_);
+        right_.perm_vars(right_vars_);
+      }
+
+      /// Initialize the variable list of this expression
+
       /// \note This function does not initialize the child data as is done in
       /// \c BinaryEngine. Instead they are initialized in \c MultContEngine and
       /// \c ScalMultContEngine.
@@ -362,6 +525,11 @@ namespace TiledArray {
         left_.init_struct(left_vars_);
         right_.init_struct(right_vars_);
 
+        if(batch_rank_) {
+          init_batch_struct(target_vars);
+          return;
+        }
+
         // Initialize the tile operation in this function because it is used to
         // evaluate the tiled range and shape.
 
@@ -377,18 +545,93 @@ namespace TiledArray {
           op_ = op_type(left_op, right_op, factor_, vars_.dim(), left_vars_.dim(),
               right_vars_.dim(), (permute_tiles_ ? perm_ : Permutation()));
           trange_ = ContEngine_::make_trange(perm_);
-          shape_ = ContEngine_::make_shape(perm_);
+          init_shape();
         } else {
           // Initialize non-permuted structure
           op_ = op_type(left_op, right_op, factor_, vars_.dim(), left_vars_.dim(),
               right_vars_.dim());
           trange_ = ContEngine_::make_trange();
-          shape_ = ContEngine_::make_shape();
+          init_shape();
         }
 
         if(ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->shape){
             shape_ = shape_.mask(*ExprEngine_::override_ptr_->shape);
         } 
+
+        if(ExprEngine_::override_ptr_ && ! ExprEngine_::override_ptr_->symmetry.trivial())
+          shape_ = shape_.mask(symmetry::unique_tile_mask(shape_, trange_,
+              ExprEngine_::override_ptr_->symmetry));
+
+        if(ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->mixed_precision)
+          op_.set_mixed_precision(ExprEngine_::override_ptr_->mixed_precision);
+
+        // Get the symmetry of the result, which is given by the user or
+        // detected from identical arguments. Result tiles can only be copied
+        // when they are permuted to the target layout.
+        if(permute_tiles_ || ! perm_) {
+          if(ExprEngine_::override_ptr_ &&
+              ! ExprEngine_::override_ptr_->result_symmetry.trivial())
+          {
+            result_symmetry_ = ExprEngine_::override_ptr_->result_symmetry;
+            TA_USER_ASSERT(result_symmetry_.is_compatible(trange_),
+                "ContEngine: the result symmetry is not compatible with the result tiled range.");
+          } else if(! symmetric_vars_.empty()) {
+            symmetry::Permutation::Map exchange;
+            for(const auto& vars : symmetric_vars_) {
+              const unsigned int l = find(target_vars, vars.first, 0u, target_vars.dim());
+              const unsigned int r = find(target_vars, vars.second, 0u, target_vars.dim());
+              exchange[l] = r;
+              exchange[r] = l;
+            }
+            result_symmetry_ = symmetry::TileSymmetry(symmetry::TileSymmetry::map_type{
+                { symmetry::Permutation(std::move(exchange)), 1 } });
+          }
+        }
+      }
+
+      /// Initialize the result shape
+
+      /// The result shape of the contraction plan, if any, is reused when the
+      /// plan matches the argument shapes; when the argument norms changed
+      /// within the tolerance of the plan, the result norms are recomputed
+      /// over the non-zero tiles of the recorded shape. Otherwise the shape
+      /// is computed and recorded by the plan.
+      void init_shape() {
+        const auto plan = (ExprEngine_::override_ptr_ ?
+            ExprEngine_::override_ptr_->plan : nullptr);
+        if(plan && plan->match(left_.shape(), right_.shape(), perm_)) {
+          if(plan->execute(left_.shape(), right_.shape()))
+            shape_ = plan->result();
+          else
+            shape_ = (perm_ ? ContEngine_::make_shape(perm_) :
+                ContEngine_::make_shape()).mask(plan->result());
+          return;
+        }
+
+        shape_ = (perm_ ? ContEngine_::make_shape(perm_) : ContEngine_::make_shape());
+        if(plan)
+          plan->inspect(left_.shape(), right_.shape(), perm_, shape_);
+      }
+
+      /// Initialize the structure of a batched contraction result
+
+      /// \param target_vars The target variable list for the result tensor
+      void init_batch_struct(const VariableList& target_vars) {
+        if(target_vars != vars_)
+          perm_ = ExprEngine_::make_perm(target_vars);
+
+        batch_op_ = batch_op_type(factor_, vars_.dim(), left_vars_.dim(),
+            right_vars_.dim(), batch_rank_,
+            (permute_tiles_ ? perm_ : Permutation()));
+        trange_ = ContEngine_::make_batch_trange(perm_);
+        shape_ = ContEngine_::make_batch_shape(perm_);
+
+        if(ExprEngine_::override_ptr_ && ExprEngine_::override_ptr_->shape)
+          shape_ = shape_.mask(*ExprEngine_::override_ptr_->shape);
+
+        if(ExprEngine_::override_ptr_ && ! ExprEngine_::override_ptr_->symmetry.trivial())
+          shape_ = shape_.mask(symmetry::unique_tile_mask(shape_, trange_,
+              ExprEngine_::override_ptr_->symmetry));
       }
 
       /// Initialize result tensor distribution
@@ -398,6 +641,11 @@ namespace TiledArray {
       /// \param world The world were the result will be distributed
       /// \param pmap The process map for the result tensor tiles
       void init_distribution(World* world, std::shared_ptr<pmap_interface> pmap) {
+        if(batch_rank_) {
+          init_batch_distribution(world, pmap);
+          return;
+        }
+
         const unsigned int inner_rank = op_.gemm_helper().num_contract_ranks();
         const unsigned int left_rank = op_.gemm_helper().left_rank();
         const unsigned int right_rank = op_.gemm_helper().right_rank();
@@ -440,6 +688,33 @@ namespace TiledArray {
         ExprEngine_::init_distribution(world, pmap);
       }
 
+      /// Initialize batched contraction result distribution
+
+      /// The tiles of the arguments and the result are distributed by batch
+      /// index, so all tiles of a batch are evaluated by one process.
+      /// \param world The world were the result will be distributed
+      /// \param pmap The process map for the result tensor tiles
+      void init_batch_distribution(World* world, std::shared_ptr<pmap_interface> pmap) {
+        std::vector<unsigned int> batch_dims(batch_rank_);
+        for(unsigned int i = 0u; i < batch_rank_; ++i)
+          batch_dims[i] = i;
+
+        // Initialize children
+        left_.init_distribution(world, std::make_shared<TiledArray::detail::BatchPmap>(
+            *world, left_.trange().tiles_range(), batch_dims));
+        right_.init_distribution(world, std::make_shared<TiledArray::detail::BatchPmap>(
+            *world, right_.trange().tiles_range(), batch_dims));
+
+        // Initialize the process map in not already defined
+        if(! pmap) {
+          for(unsigned int i = 0u; i < batch_rank_; ++i)
+            batch_dims[i] = (perm_ ? perm_[i] : i);
+          pmap = std::make_shared<TiledArray::detail::BatchPmap>(*world,
+              trange_.tiles_range(), batch_dims);
+        }
+        ExprEngine_::init_distribution(world, pmap);
+      }
+
       /// Tiled range factory function
 
       /// \param perm The permutation to be applied to the array
@@ -500,6 +775,57 @@ namespace TiledArray {
         return trange_type(ranges.begin(), ranges.end());
       }
 
+      /// Batched contraction tiled range factory function
+
+      /// \param perm The permutation to be applied to the array
+      /// \return The result tiled range
+      trange_type make_batch_trange(const Permutation& perm) const {
+        // Compute iteration limits
+        const unsigned int left_rank = left_vars_.dim();
+        const unsigned int right_rank = right_vars_.dim();
+        const unsigned int inner_rank =
+            batch_op_.gemm_helper().num_contract_ranks();
+        const unsigned int left_outer_end = left_rank - inner_rank;
+
+        // Check that the batch and contracted dimensions have congruent tilings
+        for(unsigned int l = 0u; l < batch_rank_; ++l)
+          TA_USER_ASSERT(left_.trange().data()[l] == right_.trange().data()[l],
+              "ContEngine: the batch dimensions of the left- and right-hand arguments are not congruent.");
+        for(unsigned int l = left_outer_end, r = batch_rank_; l < left_rank; ++l, ++r)
+          TA_USER_ASSERT(left_.trange().data()[l] == right_.trange().data()[r],
+              "ContEngine: the contracted dimensions of the left- and right-hand arguments are not congruent.");
+
+        // Construct the trange input
+        typename trange_type::Ranges ranges(vars_.dim());
+        unsigned int i = 0ul;
+        for(unsigned int x = 0ul; x < left_outer_end; ++x, ++i) {
+          const unsigned int pi = (perm ? perm[i] : i);
+          ranges[pi] = left_.trange().data()[x];
+        }
+        for(unsigned int x = batch_rank_ + inner_rank; x < right_rank; ++x, ++i) {
+          const unsigned int pi = (perm ? perm[i] : i);
+          ranges[pi] = right_.trange().data()[x];
+        }
+
+        return trange_type(ranges.begin(), ranges.end());
+      }
+
+      /// Batched contraction shape factory function
+
+      /// \param perm The permutation to be applied to the array
+      /// \return The result shape
+      shape_type make_batch_shape(const Permutation& perm) const {
+        const TiledArray::math::GemmHelper
+        shape_gemm_helper(madness::cblas::NoTrans, madness::cblas::NoTrans,
+            vars_.dim() - batch_rank_, left_vars_.dim() - batch_rank_,
+            right_vars_.dim() - batch_rank_);
+        if(perm)
+          return left_.shape().batch_gemm(right_.shape(), factor_,
+              shape_gemm_helper, batch_rank_, perm);
+        return left_.shape().batch_gemm(right_.shape(), factor_,
+            shape_gemm_helper, batch_rank_);
+      }
+
       /// Non-permuting shape factory function
 
       /// \return The result shape
@@ -524,7 +850,37 @@ namespace TiledArray {
                                   perm);
       }
 
+      /// Construct the distributed evaluator of a batched contraction
+
+      /// \return The distributed evaluator for this expression
+      dist_eval_type make_batch_dist_eval(std::true_type) const {
+        typedef TiledArray::detail::BatchContractionEvalImpl<
+            typename left_type::dist_eval_type,
+            typename right_type::dist_eval_type, batch_op_type,
+            typename Derived::policy> impl_type;
+
+        typename left_type::dist_eval_type left = left_.make_dist_eval();
+        typename right_type::dist_eval_type right = right_.make_dist_eval();
+
+        std::shared_ptr<impl_type> pimpl =
+            std::make_shared<impl_type>(left, right, *world_, trange_, shape_,
+                                        pmap_, perm_, batch_op_);
+
+        return dist_eval_type(pimpl);
+      }
+
+      /// Batched contractions are not supported for these tile types
+
+      /// \throw TiledArray::Exception Always
+      dist_eval_type make_batch_dist_eval(std::false_type) const {
+        TA_EXCEPTION("ContEngine: batched contractions are not supported for this tile type.");
+      }
+
       dist_eval_type make_dist_eval() const {
+        if(batch_rank_)
+          return make_batch_dist_eval(
+              std::integral_constant<bool, is_batch_contractable>());
+
         // Define the impl type
         typedef TiledArray::detail::Summa<typename left_type::dist_eval_type,
             typename right_type::dist_eval_type, op_type, typename Derived::policy> impl_type;
@@ -532,9 +888,18 @@ namespace TiledArray {
         typename left_type::dist_eval_type left = left_.make_dist_eval();
         typename right_type::dist_eval_type right = right_.make_dist_eval();
 
+        // Get the transport codec for the argument tiles
+        const TileCodec codec = (ExprEngine_::override_ptr_ ?
+            ExprEngine_::override_ptr_->codec : TileCodec());
+
+        // Get the contraction plan
+        const auto plan = (ExprEngine_::override_ptr_ ?
+            ExprEngine_::override_ptr_->plan : nullptr);
+
         std::shared_ptr<impl_type> pimpl =
             std::make_shared<impl_type>(left, right, *world_, trange_, shape_,
-                                        pmap_, perm_, op_, K_, proc_grid_);
+                                        pmap_, perm_, op_, K_, proc_grid_, codec,
+                                        result_symmetry_, plan);
 
         return dist_eval_type(pimpl);
       }
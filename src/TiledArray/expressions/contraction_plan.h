@@ -0,0 +1,379 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  contraction_plan.h
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_CONTRACTION_PLAN_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_CONTRACTION_PLAN_H__INCLUDED
+
+#include <TiledArray/expressions/variable_list.h>
+#include <TiledArray/error.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace TiledArray {
+  namespace expressions {
+
+    /// Evaluation order of a product of several tensors
+
+    /// A product of \c n tensors, e.g.
+    /// \code c("i,j") = a("i,k") * b("k,l") * d("l,j") \endcode , may be
+    /// evaluated as any sequence of \c n-1 binary products. This object finds
+    /// the sequence with the smallest estimated cost by dynamic programming
+    /// over the subsets of operands. The cost of a binary product is the
+    /// number of floating point operations of the dense product, weighted by
+    /// the fraction of non-zero tile products that is estimated from the
+    /// sparsity of the argument shapes. The indices of an intermediate are the
+    /// indices of its arguments that appear in the target or in another
+    /// operand, ordered as in the left- and right-hand arguments.
+    ///
+    /// Operands are numbered \c 0 to \c n-1 , and the result of step \c s is
+    /// numbered \c n+s . The last step produces the target.
+    class ContractionPlan {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+      /// Operand of the product
+      struct Operand {
+        VariableList vars; ///< The indices of the operand
+        std::vector<size_type> extents; ///< The element extent of each index
+        std::vector<size_type> tiles; ///< The tile extent of each index
+        float density; ///< The fraction of non-zero tiles
+      }; // struct Operand
+
+      /// Binary product step
+      struct Step {
+        size_type left; ///< The left-hand argument
+        size_type right; ///< The right-hand argument
+        VariableList vars; ///< The indices of the result
+        double flops; ///< The estimated cost of the step
+      }; // struct Step
+
+    private:
+
+      /// Index data
+      struct Index {
+        size_type extent; ///< The element extent
+        size_type tiles; ///< The tile extent
+      }; // struct Index
+
+      size_type operands_; ///< The number of operands
+      std::vector<Step> steps_; ///< The evaluation steps
+      double flops_; ///< The estimated cost of the plan
+      double left_to_right_flops_; ///< The estimated cost of left-to-right
+          ///< evaluation
+
+    public:
+
+      /// Make an operand from an array
+
+      /// \tparam A The array type
+      /// \param array The array
+      /// \param vars The indices of \c array
+      /// \return The operand that describes \c array
+      template <typename A>
+      static Operand operand(const A& array, const std::string& vars) {
+        Operand result;
+        result.vars = VariableList(vars);
+        TA_USER_ASSERT(result.vars.dim() == array.trange().tiles_range().rank(),
+            "ContractionPlan: the number of indices does not match the array rank.");
+        for(const auto& tr1 : array.trange().data()) {
+          result.extents.push_back(tr1.extent());
+          result.tiles.push_back(tr1.tile_extent());
+        }
+        result.density = 1.0f - array.shape().sparsity();
+        return result;
+      }
+
+      ContractionPlan() : operands_(0ul), steps_(), flops_(0.0),
+        left_to_right_flops_(0.0)
+      { }
+
+      /// Find the cheapest evaluation order of a product
+
+      /// \param operands The operands of the product, in the order they
+      /// appear in the expression
+      /// \param target The indices of the result
+      /// \throw TiledArray::Exception When there are less than two or more
+      /// than 16 operands, the extents of an index do not match, or the
+      /// product cannot be evaluated as a sequence of binary contractions.
+      ContractionPlan(const std::vector<Operand>& operands,
+          const VariableList& target) :
+        operands_(operands.size()), steps_(), flops_(0.0),
+        left_to_right_flops_(0.0)
+      {
+        TA_USER_ASSERT(operands_ >= 2ul && operands_ <= 16ul,
+            "ContractionPlan: the number of operands must be in [2, 16].");
+
+        // Collect the extents of the indices
+        std::map<std::string, Index> indices;
+        for(const Operand& op : operands) {
+          for(unsigned int d = 0u; d < op.vars.dim(); ++d) {
+            const Index index = { op.extents[d], op.tiles[d] };
+            auto it = indices.insert(std::make_pair(op.vars[d], index)).first;
+            TA_USER_ASSERT((it->second.extent == index.extent) &&
+                (it->second.tiles == index.tiles),
+                "ContractionPlan: the extents of an index do not match.");
+          }
+        }
+        for(const std::string& var : target)
+          TA_USER_ASSERT(indices.count(var),
+              "ContractionPlan: a target index does not appear in the operands.");
+        for(const auto& index : indices) {
+          size_type count = 0ul;
+          for(const Operand& op : operands)
+            count += contains(op.vars.data(), index.first);
+          TA_USER_ASSERT(count > 1ul || contains(target.data(), index.first),
+              "ContractionPlan: an index appears in only one operand and not in the target.");
+        }
+
+        // The external indices of each subset of operands
+        const unsigned int full = (1u << operands_) - 1u;
+        std::vector<std::vector<std::string> > vars(full + 1u);
+        for(unsigned int set = 1u; set <= full; ++set) {
+          for(size_type i = 0ul; i < operands_; ++i) {
+            if(! (set & (1u << i)))
+              continue;
+            for(const std::string& var : operands[i].vars) {
+              if(contains(vars[set], var))
+                continue;
+              bool external = contains(target.data(), var);
+              for(size_type j = 0ul; (j < operands_) && ! external; ++j)
+                external = (! (set & (1u << j))) &&
+                    contains(operands[j].vars.data(), var);
+              if(external)
+                vars[set].push_back(var);
+            }
+          }
+        }
+
+        // Dynamic programming over the subsets of operands
+        const double inf = std::numeric_limits<double>::max();
+        std::vector<double> cost(full + 1u, inf);
+        std::vector<double> density(full + 1u, 0.0);
+        std::vector<unsigned int> split(full + 1u, 0u);
+        for(size_type i = 0ul; i < operands_; ++i) {
+          cost[1u << i] = 0.0;
+          density[1u << i] = operands[i].density;
+        }
+        for(unsigned int set = 1u; set <= full; ++set) {
+          // Skip single operands, and intermediates without indices
+          if(! (set & (set - 1u)) || (set != full && vars[set].empty()))
+            continue;
+
+          // The left-hand subset contains the first operand of the set
+          const unsigned int first = set & (~set + 1u);
+          for(unsigned int left = (set - 1u) & set; left; left = (left - 1u) & set) {
+            const unsigned int right = set ^ left;
+            if(! (left & first) || cost[left] == inf || cost[right] == inf)
+              continue;
+
+            double d = 0.0;
+            const double flops = product_cost(vars[left], vars[right],
+                vars[set], density[left], density[right], indices, d);
+            if(flops < 0.0)
+              continue;
+            if(cost[left] + cost[right] + flops < cost[set]) {
+              cost[set] = cost[left] + cost[right] + flops;
+              density[set] = d;
+              split[set] = left;
+            }
+          }
+        }
+        TA_USER_ASSERT(cost[full] != inf,
+            "ContractionPlan: the product cannot be evaluated as a sequence of binary contractions.");
+        flops_ = cost[full];
+
+        // Estimate the cost of left-to-right evaluation for reference
+        double d = density[1u];
+        for(size_type i = 1ul; i < operands_; ++i) {
+          const unsigned int left = (1u << i) - 1u;
+          const unsigned int set = (left << 1u) | 1u;
+          double flops = product_cost(vars[left], vars[1u << i], vars[set], d,
+              density[1u << i], indices, d);
+          if(flops < 0.0)
+            flops = inf;
+          left_to_right_flops_ = (flops == inf ? inf : left_to_right_flops_ + flops);
+          if(left_to_right_flops_ == inf)
+            break;
+        }
+
+        // Build the steps of the plan
+        make_steps(full, vars, split, target, indices, density);
+      }
+
+      /// Operand count accessor
+
+      /// \return The number of operands
+      size_type operands() const { return operands_; }
+
+      /// Step count accessor
+
+      /// \return The number of steps
+      size_type size() const { return steps_.size(); }
+
+      /// Step accessor
+
+      /// \param s The step index
+      /// \return A const reference to step \c s
+      const Step& step(const size_type s) const {
+        TA_ASSERT(s < steps_.size());
+        return steps_[s];
+      }
+
+      /// Step list accessor
+
+      /// \return A const reference to the steps of this plan
+      const std::vector<Step>& steps() const { return steps_; }
+
+      /// Cost accessor
+
+      /// \return The estimated number of floating point operations of the plan
+      double flops() const { return flops_; }
+
+      /// Left-to-right cost accessor
+
+      /// \return The estimated number of floating point operations of the
+      /// left-to-right evaluation of the product, or the maximum value of
+      /// \c double when it cannot be evaluated left-to-right
+      double left_to_right_flops() const { return left_to_right_flops_; }
+
+    private:
+
+      static bool contains(const std::vector<std::string>& vars,
+          const std::string& var)
+      {
+        return std::find(vars.begin(), vars.end(), var) != vars.end();
+      }
+
+      /// Estimate the cost of a binary product
+
+      /// \param left The external indices of the left-hand argument
+      /// \param right The external indices of the right-hand argument
+      /// \param result The indices of the result
+      /// \param left_density The density of the left-hand argument
+      /// \param right_density The density of the right-hand argument
+      /// \param indices The index extents
+      /// \param[out] density The estimated density of the result
+      /// \return The estimated number of floating point operations, or -1 if
+      /// the arguments do not share an index
+      static double product_cost(const std::vector<std::string>& left,
+          const std::vector<std::string>& right,
+          const std::vector<std::string>& result, const double left_density,
+          const double right_density,
+          const std::map<std::string, Index>& indices, double& density)
+      {
+        double flops = 2.0 * left_density * right_density;
+        double inner_tiles = 1.0;
+        bool shared = false;
+        for(const std::string& var : left) {
+          const Index& index = indices.find(var)->second;
+          flops *= double(index.extent);
+          if(contains(right, var)) {
+            shared = true;
+            if(! contains(result, var))
+              inner_tiles *= double(index.tiles);
+          }
+        }
+        for(const std::string& var : right)
+          if(! contains(left, var))
+            flops *= double(indices.find(var)->second.extent);
+
+        // A result tile is non-zero if any of the tile products in its sum
+        // is non-zero.
+        density = 1.0 - std::pow(1.0 - left_density * right_density, inner_tiles);
+
+        return (shared ? flops : -1.0);
+      }
+
+      /// Append the steps that evaluate a subset of operands
+
+      /// \return The node number of the result of \c set
+      size_type make_steps(const unsigned int set,
+          const std::vector<std::vector<std::string> >& vars,
+          const std::vector<unsigned int>& split, const VariableList& target,
+          const std::map<std::string, Index>& indices,
+          const std::vector<double>& density)
+      {
+        if(! (set & (set - 1u))) {
+          size_type i = 0ul;
+          while(! (set & (1u << i))) ++i;
+          return i;
+        }
+
+        const unsigned int left = split[set];
+        const unsigned int right = set ^ left;
+        Step step;
+        step.left = make_steps(left, vars, split, target, indices, density);
+        step.right = make_steps(right, vars, split, target, indices, density);
+
+        // Order the result indices as they appear in the arguments
+        if(set == ((1u << operands_) - 1u)) {
+          step.vars = target;
+        } else {
+          std::vector<std::string> result;
+          for(const std::string& var : vars[left])
+            if(contains(vars[set], var))
+              result.push_back(var);
+          for(const std::string& var : vars[right])
+            if(contains(vars[set], var) && ! contains(result, var))
+              result.push_back(var);
+          step.vars = VariableList(result.begin(), result.end());
+        }
+
+        double d = 0.0;
+        step.flops = product_cost(vars[left], vars[right], vars[set],
+            density[left], density[right], indices, d);
+        steps_.push_back(step);
+        return operands_ + steps_.size() - 1ul;
+      }
+
+    }; // class ContractionPlan
+
+    /// ContractionPlan output operator
+
+    /// Each step is printed on a line, where operands are named \c a0 ,
+    /// \c a1 , ..., and intermediates are named \c t0 , \c t1 , ... .
+    /// \param os The output stream
+    /// \param plan The plan to be printed
+    /// \return A reference to the output stream
+    inline std::ostream& operator<<(std::ostream& os, const ContractionPlan& plan) {
+      auto name = [&] (const std::size_t node) -> std::string {
+        return (node < plan.operands() ? "a" + std::to_string(node) :
+            "t" + std::to_string(node - plan.operands()));
+      };
+      for(std::size_t s = 0ul; s < plan.size(); ++s) {
+        const ContractionPlan::Step& step = plan.step(s);
+        os << (s + 1ul < plan.size() ? name(plan.operands() + s) : "result")
+           << "(" << step.vars.string() << ") = " << name(step.left) << " * "
+           << name(step.right) << "  [" << step.flops << " flops]\n";
+      }
+      os << "total: " << plan.flops() << " flops (left-to-right: "
+         << plan.left_to_right_flops() << " flops)\n";
+      return os;
+    }
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_CONTRACTION_PLAN_H__INCLUDED
@@ -35,6 +35,10 @@
 #include "../tile_op/unary_reduction.h"
 #include "../tile_op/binary_reduction.h"
 #include "../tile_op/reduce_wrapper.h"
+#include "../tile_codec.h"
+#include "../mixed_precision.h"
+#include "../symm/tile_symmetry.h"
+#include "../sparse_contraction_plan.h"
 
 namespace TiledArray {
   namespace expressions {
@@ -48,17 +52,85 @@ namespace TiledArray {
     template <typename Engine>
     struct EngineParamOverride {
 
-      EngineParamOverride() : world(nullptr), pmap(), shape(nullptr) {}
+      EngineParamOverride() :
+        world(nullptr), pmap(), shape(nullptr), codec(), mixed_precision(),
+        symmetry(), result_symmetry(), plan() {}
 
       typedef typename EngineTrait<Engine>::policy policy; ///< The result policy type
       typedef typename EngineTrait<Engine>::shape_type shape_type; ///< Tensor shape type
       typedef typename EngineTrait<Engine>::pmap_interface pmap_interface; ///< Process map interface type
+      typedef SparseContractionPlan<shape_type> plan_type; ///< Contraction plan type
 
        World* world;
        std::shared_ptr<pmap_interface> pmap;
        const shape_type* shape;
+       TileCodec codec; ///< The codec used to transport tiles of the arguments
+       std::shared_ptr<MixedPrecision> mixed_precision; ///< Mixed precision contraction control
+       TiledArray::symmetry::TileSymmetry symmetry; ///< The symmetry of the result tiles
+       TiledArray::symmetry::TileSymmetry result_symmetry; ///< The symmetry used to copy contraction result tiles
+       std::shared_ptr<plan_type> plan; ///< The reusable plan of a contraction
     };
 
+    /// Completion callback of an asynchronous expression evaluation
+
+    /// This object sets the result future of \c Expr::eval_to_async() when
+    /// the local tiles of the result array, and the tiles that are evaluated
+    /// by this process for other processes, have been set. It holds a
+    /// reference to the distributed evaluator until then, and it deletes
+    /// itself after the future is set.
+    /// \tparam A The result array type
+    /// \tparam DistEval The distributed evaluator type
+    template <typename A, typename DistEval>
+    class AsyncEvalCallback : public madness::CallbackInterface {
+      A result_; ///< The result array
+      DistEval dist_eval_; ///< The distributed evaluator of the expression
+      Future<A> future_; ///< The future of the result array
+      madness::AtomicInt count_; ///< The number of unset dependencies
+
+    public:
+
+      /// Constructor
+
+      /// \param result The result array
+      /// \param dist_eval The distributed evaluator of the result
+      /// \param future The future that will be set to \c result
+      AsyncEvalCallback(const A& result, const DistEval& dist_eval,
+          const Future<A>& future) :
+        result_(result), dist_eval_(dist_eval), future_(future), count_()
+      {
+        count_ = 1;
+      }
+
+      virtual ~AsyncEvalCallback() { }
+
+      /// Wait for the local result tiles and the distributed evaluator
+
+      /// The callback is notified when all dependencies are set and
+      /// \c release() has been called.
+      void register_dependencies() {
+        ++count_;
+        dist_eval_.register_completion_callback(this);
+        for(const auto index : *result_.pmap()) {
+          if(! result_.is_zero(index)) {
+            ++count_;
+            result_.find(index).register_callback(this);
+          }
+        }
+      }
+
+      /// Release the registration guard
+      void release() { notify(); }
+
+      /// Dependency notification
+      virtual void notify() {
+        if(count_.dec_and_test()) {
+          future_.set(result_);
+          delete this;
+        }
+      }
+
+    }; // class AsyncEvalCallback
+
     /// \brief type trait checks if T has array() member
     /// Useful to determine if an Expr is a TsrExpr or a related type
     template<class E>
@@ -135,6 +207,76 @@ namespace TiledArray {
         }
         return derived();
       }
+      /// \param codec the codec used to encode argument tiles that are moved
+      /// between processes while evaluating this expression (e.g. by the
+      /// broadcasts of a contraction)
+      Expr<Derived>& set_codec(const TileCodec& codec) {
+        if (override_ptr_) {
+          override_ptr_->codec = codec;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->codec = codec;
+        }
+        return derived();
+      }
+      /// \param mixed_precision the object that selects the precision of the
+      /// tile products of this contraction expression and counts them
+      Expr<Derived>& set_mixed_precision(
+          const std::shared_ptr<MixedPrecision>& mixed_precision) {
+        if (override_ptr_) {
+          override_ptr_->mixed_precision = mixed_precision;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->mixed_precision = mixed_precision;
+        }
+        return derived();
+      }
+      /// \param symm the permutational symmetry of the result; only the
+      /// symmetry-unique tiles of the result are evaluated (sparse arrays
+      /// only, see \c symmetry::unique_tile_mask() ). The result array is
+      /// marked with \c symm (see \c DistArray::set_symmetry() ), so
+      /// expressions that read it map its non-unique tiles to the unique
+      /// tiles.
+      Expr<Derived>& set_symmetry(const symmetry::TileSymmetry& symm) {
+        if (override_ptr_) {
+          override_ptr_->symmetry = symm;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->symmetry = symm;
+        }
+        return derived();
+      }
+      /// \param symm the permutational symmetry of the result of this
+      /// contraction expression; only the symmetry-unique result tiles are
+      /// contracted, and the other tiles are permuted copies of them. The
+      /// symmetry of contractions of an array with itself, e.g.
+      /// <tt>a("i,k") * a("j,k")</tt> , is detected automatically.
+      Expr<Derived>& set_result_symmetry(const symmetry::TileSymmetry& symm) {
+        if (override_ptr_) {
+          override_ptr_->result_symmetry = symm;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->result_symmetry = symm;
+        }
+        return derived();
+      }
+      /// \param plan the inspector-executor plan of this contraction
+      /// expression; the result shape and the SUMMA schedule that are
+      /// recorded by the first evaluation are reused by later evaluations
+      /// while the argument shapes do not change (see \c SparseContractionPlan ).
+      /// When the argument norms change within the tolerance of the plan,
+      /// the result norms are recomputed, but only the recorded non-zero
+      /// result tiles are evaluated.
+      Expr<Derived>& set_plan(
+          const std::shared_ptr<typename override_type::plan_type>& plan) {
+        if (override_ptr_) {
+          override_ptr_->plan = plan;
+        } else {
+          override_ptr_ = std::make_shared<override_type>();
+          override_ptr_->plan = plan;
+        }
+        return derived();
+      }
 
     private:
 
@@ -259,6 +401,24 @@ namespace TiledArray {
         array.set(index, array.world().taskq.add(eval_tile_fn_ptr, tile, op));
       }
 
+      /// Mark a sparse result that stores only its symmetry-unique tiles
+
+      /// \tparam A The array type
+      /// \param result The result array
+      template <typename A,
+          typename std::enable_if<! A::shape_type::is_dense()>::type* = nullptr>
+      void set_result_tile_symmetry(A& result) const {
+        if(override_ptr_ && ! override_ptr_->symmetry.trivial())
+          result.set_symmetry(override_ptr_->symmetry);
+      }
+
+      /// Dense results store all tiles, so they are not marked
+
+      /// \tparam A The array type
+      template <typename A,
+          typename std::enable_if<A::shape_type::is_dense()>::type* = nullptr>
+      void set_result_tile_symmetry(A&) const { }
+
      public:
 
       // Compiler generated functions
@@ -275,16 +435,20 @@ namespace TiledArray {
       /// Cast this object to its derived type
       const derived_type& derived() const { return *static_cast<const derived_type*>(this); }
 
-      /// Evaluate this object and assign it to \c tsr
+    private:
 
-      /// This expression is evaluated in parallel in distributed environments,
-      /// where the content of \c tsr will be replaced by the results of the
-      /// evaluated tensor expression.
+      /// Start the evaluation of this object for assignment to \c tsr
+
+      /// The result array is constructed with the futures of the result tiles,
+      /// but the evaluation is not awaited.
       /// \tparam A The array type
       /// \tparam Alias Tile alias flag
       /// \param tsr The tensor to be assigned
+      /// \param[out] result The result array
+      /// \return The distributed evaluator of this expression
       template <typename A, bool Alias>
-      void eval_to(TsrExpr<A, Alias>& tsr) const {
+      typename engine_type::dist_eval_type
+      start_eval(TsrExpr<A, Alias>& tsr, A& result) const {
         static_assert(! is_lazy_tile<typename A::value_type>::value,
             "Assignment to an array of lazy tiles is not supported.");
 
@@ -316,8 +480,9 @@ namespace TiledArray {
         dist_eval.eval();
 
         // Create the result array
-        A result(dist_eval.world(), dist_eval.trange(),
+        result = A(dist_eval.world(), dist_eval.trange(),
             dist_eval.shape(), dist_eval.pmap());
+        set_result_tile_symmetry(result);
 
         // Move the data from dist_eval into the result array. There is no
         // communication in this step.
@@ -326,6 +491,24 @@ namespace TiledArray {
             set_tile(result, index, dist_eval.get(index));
         }
 
+        return dist_eval;
+      }
+
+    public:
+
+      /// Evaluate this object and assign it to \c tsr
+
+      /// This expression is evaluated in parallel in distributed environments,
+      /// where the content of \c tsr will be replaced by the results of the
+      /// evaluated tensor expression.
+      /// \tparam A The array type
+      /// \tparam Alias Tile alias flag
+      /// \param tsr The tensor to be assigned
+      template <typename A, bool Alias>
+      void eval_to(TsrExpr<A, Alias>& tsr) const {
+        A result;
+        typename engine_type::dist_eval_type dist_eval = start_eval(tsr, result);
+
         // Wait for child expressions of dist_eval
         dist_eval.wait();
 
@@ -333,6 +516,42 @@ namespace TiledArray {
         result.swap(tsr.array());
       }
 
+      /// Evaluate this object and assign it to \c tsr without waiting
+
+      /// The tiles of this expression are evaluated by tasks, and \c tsr is
+      /// replaced immediately by an array that holds the futures of the result
+      /// tiles, so other expressions that read \c tsr may be evaluated while
+      /// this expression is in flight; they depend on the result tiles
+      /// through their futures. Arrays read by this expression may be
+      /// reassigned, since the expression holds references to their data.
+      /// All processes must call this function in the same order as other
+      /// collective expression evaluations.
+      /// \tparam A The array type
+      /// \tparam Alias Tile alias flag
+      /// \param tsr The tensor to be assigned
+      /// \return A future to the result array, which is set when the local
+      /// result tiles, and the tiles computed by this process, have been set.
+      /// The world must not be destroyed before the future is set, e.g. wait
+      /// for the future or call \c fence() .
+      template <typename A, bool Alias>
+      Future<A> eval_to_async(TsrExpr<A, Alias>& tsr) const {
+        typedef typename engine_type::dist_eval_type dist_eval_type;
+
+        A result;
+        dist_eval_type dist_eval = start_eval(tsr, result);
+
+        Future<A> future;
+        AsyncEvalCallback<A, dist_eval_type>* callback =
+            new AsyncEvalCallback<A, dist_eval_type>(result, dist_eval, future);
+        callback->register_dependencies();
+
+        // Swap the new array with the result array object.
+        result.swap(tsr.array());
+
+        callback->release();
+
+        return future;
+      }
 
       /// Evaluate this object and assign it to \c tsr
 
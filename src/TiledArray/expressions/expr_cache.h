@@ -0,0 +1,321 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  expr_cache.h
+ *
+ */
+
+#ifndef TILEDARRAY_EXPRESSIONS_EXPR_CACHE_H__INCLUDED
+#define TILEDARRAY_EXPRESSIONS_EXPR_CACHE_H__INCLUDED
+
+#include <TiledArray/expressions/tsr_expr.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+namespace TiledArray {
+  namespace expressions {
+
+    namespace detail {
+
+      /// Checks if an expression is a binary expression
+      template <typename E>
+      class is_binary_expr {
+        template <typename U>
+        static auto __test(U* p) -> decltype(p->left(), p->right(), std::true_type());
+        template <typename>
+        static std::false_type __test(...);
+      public:
+        static constexpr const bool value = std::is_same<std::true_type, decltype(__test<E>(0))>::value;
+      };
+
+      /// Checks if an expression is a unary expression
+      template <typename E>
+      class is_unary_expr {
+        template <typename U>
+        static auto __test(U* p) -> decltype(p->arg(), std::true_type());
+        template <typename>
+        static std::false_type __test(...);
+      public:
+        static constexpr const bool value = std::is_same<std::true_type, decltype(__test<E>(0))>::value;
+      };
+
+      /// Checks if an expression is a block expression
+      template <typename E>
+      class is_block_expr {
+        template <typename U>
+        static auto __test(U* p) -> decltype(p->lower_bound(), p->upper_bound(), std::true_type());
+        template <typename>
+        static std::false_type __test(...);
+      public:
+        static constexpr const bool value = std::is_same<std::true_type, decltype(__test<E>(0))>::value;
+      };
+
+      /// Checks if an expression has a scaling factor
+      template <typename E>
+      class has_factor {
+        template <typename U>
+        static auto __test(U* p) -> decltype(p->factor(), std::true_type());
+        template <typename>
+        static std::false_type __test(...);
+      public:
+        static constexpr const bool value = std::is_same<std::true_type, decltype(__test<E>(0))>::value;
+      };
+
+      /// Writes the structural key of an expression
+
+      /// Indices are replaced by their order of first appearance, so that
+      /// expressions that differ only by the names of the indices have the
+      /// same key.
+      class ExprKeyWriter {
+        std::ostream& os_; ///< The key output stream
+        std::vector<std::string> labels_; ///< The index names in order of
+            ///< first appearance
+
+      public:
+
+        /// Constructor
+
+        /// \param os The output stream for the key
+        explicit ExprKeyWriter(std::ostream& os) : os_(os), labels_() { }
+
+        /// Index name accessor
+
+        /// \return The index names in order of first appearance
+        const std::vector<std::string>& labels() const { return labels_; }
+
+        /// Get the canonical number of an index
+
+        /// \param var The index name
+        /// \return The order of the first appearance of \c var
+        std::size_t label(const std::string& var) {
+          const auto it = std::find(labels_.begin(), labels_.end(), var);
+          if(it != labels_.end())
+            return it - labels_.begin();
+          labels_.push_back(var);
+          return labels_.size() - 1ul;
+        }
+
+        /// Write the key of an expression
+
+        /// \tparam E The expression type
+        /// \param expr The expression
+        template <typename E>
+        void write(const E& expr) {
+          static_assert(has_array<E>::value || is_binary_expr<E>::value ||
+              is_unary_expr<E>::value, "Unsupported expression type.");
+          write_factor(expr, std::integral_constant<bool,
+              has_factor<E>::value>());
+          write(expr, std::integral_constant<int,
+              (has_array<E>::value ? 0 : (is_binary_expr<E>::value ? 1 : 2))>());
+        }
+
+      private:
+
+        template <typename E>
+        void write_factor(const E& expr, std::true_type) {
+          os_ << "[" << expr.factor() << "]";
+        }
+
+        template <typename E>
+        void write_factor(const E&, std::false_type) { }
+
+        template <typename E>
+        void write_bounds(const E& expr, std::true_type) {
+          for(const auto x : expr.lower_bound())
+            os_ << " " << x;
+          os_ << " :";
+          for(const auto x : expr.upper_bound())
+            os_ << " " << x;
+        }
+
+        template <typename E>
+        void write_bounds(const E&, std::false_type) { }
+
+        /// Write the key of a tensor expression
+        template <typename E>
+        void write(const E& expr, std::integral_constant<int, 0>) {
+          os_ << "{" << expr.array().id() << ":";
+          for(const std::string& var : VariableList(expr.vars()))
+            os_ << " " << label(var);
+          write_bounds(expr, std::integral_constant<bool,
+              is_block_expr<E>::value>());
+          os_ << "}";
+        }
+
+        /// Write the key of a binary expression
+        template <typename E>
+        void write(const E& expr, std::integral_constant<int, 1>) {
+          os_ << "(";
+          write(expr.left());
+          os_ << ",";
+          write(expr.right());
+          os_ << ")";
+        }
+
+        /// Write the key of a unary expression
+        template <typename E>
+        void write(const E& expr, std::integral_constant<int, 2>) {
+          os_ << "(";
+          write(expr.arg());
+          os_ << ")";
+        }
+
+      }; // class ExprKeyWriter
+
+    } // namespace detail
+
+    /// Structural key of an expression
+
+    /// Two expressions have the same key when they have the same structure
+    /// (i.e. type), the same arrays at the leaves, the same scaling factors
+    /// and block bounds, and the same index annotations up to the renaming of
+    /// indices, so they evaluate to the same result up to the renaming.
+    /// \tparam D The expression type
+    /// \param expr The expression
+    /// \param[out] labels The index names of \c expr in order of first
+    /// appearance; index \c x of the key is \c labels[x]
+    /// \return The key of \c expr
+    template <typename D>
+    inline std::string expr_key(const Expr<D>& expr,
+        std::vector<std::string>& labels)
+    {
+      std::stringstream ss;
+      ss.precision(std::numeric_limits<long double>::max_digits10);
+      ss << typeid(D).name() << " ";
+      detail::ExprKeyWriter writer(ss);
+      writer.write(expr.derived());
+      labels = writer.labels();
+      return ss.str();
+    }
+
+    /// Structural key of an expression
+
+    /// \tparam D The expression type
+    /// \param expr The expression
+    /// \return The key of \c expr
+    template <typename D>
+    inline std::string expr_key(const Expr<D>& expr) {
+      std::vector<std::string> labels;
+      return expr_key(expr, labels);
+    }
+
+    /// Cache of evaluated subexpressions
+
+    /// Subexpressions that appear more than once, in one expression or in a
+    /// batch of assignments, are evaluated once when they are wrapped by this
+    /// object. The first occurrence of a subexpression is evaluated
+    /// asynchronously into an intermediate array, with the indices of the
+    /// subexpression (see \c Expr::eval_to_async() ). Subsequent occurrences
+    /// with the same structural key (see \c expr_key() ) reuse the
+    /// intermediate array, where the indices are renamed as in the
+    /// occurrence, e.g. the transpose is reused in
+    /// \code
+    /// ExprCache cache;
+    /// r("i,j") = cache(a("i,k") * b("k,j")) + 2 * cache(a("j,k") * b("k,i"));
+    /// s("i,j") = cache(a("i,k") * b("k,j")) * d("j,l");
+    /// \endcode
+    /// The intermediates are held until the cache is cleared or destroyed, so
+    /// the arrays read by the cached expressions must not be modified while
+    /// the cache is used. All processes must use the cache in the same order,
+    /// since the evaluation is collective.
+    class ExprCache {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+    private:
+
+      /// Cache entry
+      struct Entry {
+        std::shared_ptr<void> array; ///< The intermediate array
+        std::vector<std::size_t> vars; ///< The key indices of the
+            ///< intermediate array
+      }; // struct Entry
+
+      std::unordered_map<std::string, Entry> entries_; ///< Cached intermediates
+      size_type hits_; ///< The number of reused subexpressions
+
+    public:
+
+      ExprCache() : entries_(), hits_(0ul) { }
+
+      /// Evaluate a subexpression, or reuse an identical one
+
+      /// \tparam D The expression type
+      /// \param expr The subexpression
+      /// \return An expression of the intermediate array that holds the
+      /// result of \c expr , annotated with the indices of \c expr
+      template <typename D,
+          typename A = DistArray<typename ExprTrait<D>::engine_type::eval_type,
+              typename EngineTrait<typename ExprTrait<D>::engine_type>::policy> >
+      TsrExpr<const A, true> operator()(const Expr<D>& expr) {
+        std::vector<std::string> labels;
+        const std::string key = expr_key(expr, labels);
+        auto it = entries_.find(key);
+        if(it != entries_.end()) {
+          ++hits_;
+        } else {
+          // Get the indices of the subexpression
+          typename ExprTrait<D>::engine_type engine(expr.derived());
+          engine.init_vars();
+
+          Entry entry;
+          std::shared_ptr<A> array = std::make_shared<A>();
+          (*array)(engine.vars().string()).assign_async(expr);
+          entry.array = array;
+          for(const std::string& var : engine.vars())
+            entry.vars.push_back(std::find(labels.begin(), labels.end(), var)
+                - labels.begin());
+          it = entries_.insert(std::make_pair(key, entry)).first;
+        }
+
+        // Rename the indices of the intermediate to those of expr
+        std::vector<std::string> vars;
+        for(const std::size_t x : it->second.vars)
+          vars.push_back(labels[x]);
+
+        return TsrExpr<const A, true>(
+            *std::static_pointer_cast<const A>(it->second.array),
+            VariableList(vars.begin(), vars.end()).string());
+      }
+
+      /// Intermediate count accessor
+
+      /// \return The number of cached intermediates
+      size_type size() const { return entries_.size(); }
+
+      /// Reuse count accessor
+
+      /// \return The number of subexpressions that reused an intermediate
+      size_type hits() const { return hits_; }
+
+      /// Release the cached intermediates
+      void clear() {
+        entries_.clear();
+        hits_ = 0ul;
+      }
+
+    }; // class ExprCache
+
+  }  // namespace expressions
+} // namespace TiledArray
+
+#endif // TILEDARRAY_EXPRESSIONS_EXPR_CACHE_H__INCLUDED
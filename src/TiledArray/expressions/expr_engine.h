@@ -28,6 +28,7 @@
 
 #include <TiledArray/madness.h>
 #include <TiledArray/expressions/expr_trace.h>
+#include <TiledArray/symm/tile_symmetry.h>
 
 namespace TiledArray {
   namespace expressions {
@@ -139,6 +140,10 @@ namespace TiledArray {
 
         if(override_ptr_ && override_ptr_->shape)
           shape_ = shape_.mask(*override_ptr_->shape);
+
+        if(override_ptr_ && ! override_ptr_->symmetry.trivial())
+          shape_ = shape_.mask(symmetry::unique_tile_mask(shape_, trange_,
+              override_ptr_->symmetry));
       }
 
       /// Initialize result tensor distribution
@@ -28,6 +28,7 @@
 
 #include <TiledArray/expressions/expr_engine.h>
 #include <TiledArray/dist_eval/array_eval.h>
+#include <TiledArray/tile_op/fused.h>
 
 namespace TiledArray {
   namespace expressions {
@@ -59,6 +60,9 @@ namespace TiledArray {
 
       static constexpr bool consumable = EngineTrait<Derived>::consumable;
       static constexpr unsigned int leaves = EngineTrait<Derived>::leaves;
+      static constexpr bool fusable = TiledArray::detail::is_fusable_tile<
+          typename EngineTrait<Derived>::eval_type>::value; ///< \c true when
+          ///< this leaf may be an argument of a fused element-wise evaluator
 
     protected:
 
@@ -73,6 +77,19 @@ namespace TiledArray {
 
       array_type array_; ///< The array object
 
+      /// Shape of all tiles of the array
+
+      /// When the array stores only its symmetry-unique tiles (see
+      /// \c DistArray::set_symmetry() ), the norms of the non-unique tiles
+      /// are the norms of their canonical tiles.
+      /// \return The shape of the array
+      shape_type array_shape() const {
+        if(array_.symmetry().trivial())
+          return array_.shape();
+        return symmetry::expand_shape(array_.shape(), array_.trange(),
+            array_.symmetry());
+      }
+
     public:
 
       /// Engine constructor
@@ -142,14 +159,14 @@ namespace TiledArray {
       /// Non-permuting shape factory function
 
       /// \return The result shape
-      shape_type make_shape() { return array_.shape(); }
+      shape_type make_shape() { return array_shape(); }
 
       /// Permuting shape factory function
 
       /// \param perm The permutation to be applied to the array
       /// \return The result shape
       shape_type
-      make_shape(const Permutation& perm) { return array_.shape().perm(perm); }
+      make_shape(const Permutation& perm) { return array_shape().perm(perm); }
 
 
       /// Construct the distributed evaluator for array
@@ -165,6 +182,27 @@ namespace TiledArray {
         return dist_eval_type(pimpl);
       }
 
+      /// Query fused element-wise evaluation
+
+      /// Leaf tiles are permuted and scaled when they are evaluated, so a
+      /// leaf is always a valid argument of a fused evaluator.
+      /// \return \c true
+      bool is_fusable() const { return true; }
+
+      /// Fused element operation factory function
+
+      /// \return The identity operation for the elements of this leaf
+      static auto make_fused_op() {
+        return [] (const auto arg) { return arg; };
+      }
+
+      /// Fused argument factory function
+
+      /// \return A tuple that holds the distributed evaluator of this leaf
+      std::tuple<dist_eval_type> make_fused_args() const {
+        return std::tuple<dist_eval_type>(derived().make_dist_eval());
+      }
+
     }; // class LeafEngine
 
   }  // namespace expressions
@@ -125,8 +125,9 @@ namespace TiledArray {
     /// This implements any expression encoded with the multiplication operator. This
     /// includes Hadamard product, e.g. \code (c("i,j")=)a("i,j")*b("i,j") \endcode , and
     /// pure contractions, e.g. \code (c("i,j")=)a("i,k")*b("k,j") \endcode .
-    /// \internal mixed Hadamard-contraction case, e.g. \code c("i,j,l")=a("i,l,k")*b("j,l,k") \endcode , is not supported since
-    ///   this requires that the result labels are assigned by user (currently they are computed by this engine)
+    /// The mixed Hadamard-contraction case, e.g. \code c("i,j,l")=a("i,l,k")*b("j,l,k") \endcode ,
+    /// is evaluated as a batched contraction; it requires that the result labels are
+    /// assigned by the user, i.e. the product must be assigned directly to an array.
     /// \tparam Left The left-hand engine type
     /// \tparam Right The right-hand engine type
     /// \tparam Result The result tile type
@@ -214,8 +215,7 @@ namespace TiledArray {
           BinaryEngine_::perm_vars(target_vars);
         } else {
           contract_ = true;
-          ContEngine_::init_vars();
-          ContEngine_::perm_vars(target_vars);
+          ContEngine_::init_vars(target_vars);
         }
       }
 
@@ -317,6 +317,21 @@ namespace TiledArray {
           return BinaryEngine_::make_dist_eval();
       }
 
+      /// Element operation factory function
+
+      /// \return The element operation of this expression
+      static auto make_element_op() {
+        return [] (const auto left, const auto right) { return left * right; };
+      }
+
+      /// Query fused element-wise evaluation
+
+      /// \return \c true when this is a coefficient-wise multiplication that
+      /// may be evaluated as an argument of a fused evaluator
+      bool is_fusable() const {
+        return (! contract_) && BinaryEngine_::is_fusable();
+      }
+
       /// Expression identification tag
 
       /// \return An expression tag used to identify this expression
@@ -388,6 +403,11 @@ namespace TiledArray {
       typedef typename EngineTrait<ScalMultEngine_>::pmap_interface
           pmap_interface; ///< Process map interface type
 
+      static constexpr bool fusable = BinaryEngine_::fusable &&
+          TiledArray::detail::is_fusable_scalar<scalar_type>::value;
+          ///< \c true when this subexpression may be evaluated with a fused
+          ///< element-wise evaluator
+
     private:
 
       bool contract_; ///< Expression type flag (true == contraction, false ==
@@ -430,8 +450,7 @@ namespace TiledArray {
           BinaryEngine_::perm_vars(target_vars);
         } else {
           contract_ = true;
-          ContEngine_::init_vars();
-          ContEngine_::perm_vars(target_vars);
+          ContEngine_::init_vars(target_vars);
         }
       }
 
@@ -537,7 +556,23 @@ namespace TiledArray {
         return op_type(op_base_type(ContEngine_::factor_), perm);
       }
 
+      /// Element operation factory function
 
+      /// \return The element operation of this expression
+      auto make_element_op() const {
+        const scalar_type factor = ContEngine_::factor_;
+        return [=] (const auto left, const auto right) {
+          return (left * right) * factor;
+        };
+      }
+
+      /// Query fused element-wise evaluation
+
+      /// \return \c true when this is a coefficient-wise multiplication that
+      /// may be evaluated as an argument of a fused evaluator
+      bool is_fusable() const {
+        return (! contract_) && BinaryEngine_::is_fusable();
+      }
 
       /// Expression identification tag
 
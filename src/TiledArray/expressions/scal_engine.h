@@ -99,6 +99,11 @@ namespace TiledArray {
       typedef typename EngineTrait<ScalEngine_>::shape_type shape_type; ///< Shape type
       typedef typename EngineTrait<ScalEngine_>::pmap_interface pmap_interface; ///< Process map interface type
 
+      static constexpr bool fusable = UnaryEngine_::fusable &&
+          TiledArray::detail::is_fusable_scalar<scalar_type>::value;
+          ///< \c true when this subexpression may be evaluated with a fused
+          ///< element-wise evaluator
+
     private:
 
       scalar_type factor_; ///< Scaling factor
@@ -139,6 +144,14 @@ namespace TiledArray {
       /// \return The tile operation
       op_type make_tile_op(const Permutation& perm) const { return op_type(perm, factor_); }
 
+      /// Element operation factory function
+
+      /// \return The element operation of this expression
+      auto make_element_op() const {
+        const scalar_type factor = factor_;
+        return [=] (const auto arg) { return arg * factor; };
+      }
+
       /// Expression identification tag
 
       /// \return An expression tag used to identify this expression
@@ -32,6 +32,7 @@
 #include <TiledArray/expressions/tsr_engine.h>
 #include <TiledArray/expressions/blk_tsr_expr.h>
 #include <TiledArray/expressions/scal_tsr_expr.h>
+#include <TiledArray/expressions/contraction_plan.h>
 
 namespace TiledArray {
   namespace expressions {
@@ -120,6 +121,13 @@ namespace TiledArray {
 
       /// Expression assignment operator
 
+      /// Element-wise subexpressions (sums, differences, scaling, and
+      /// Hadamard products) that do not permute their result are evaluated
+      /// in a single pass over their leaf arrays, without intermediate
+      /// arrays, when they have at most seven leaves
+      /// (\c TiledArray::detail::max_fused_leaves ). Larger element-wise
+      /// expressions are evaluated one binary operation at a time at the
+      /// top, with fused subexpressions below.
       /// \tparam D The derived expression type
       /// \param other The expression that will be assigned to this array
       template <typename D>
@@ -131,6 +139,74 @@ namespace TiledArray {
         return array_;
       }
 
+      /// Asynchronous expression assignment
+
+      /// This array is replaced immediately by an array of the (future) result
+      /// tiles, so it may be used in other expressions before the evaluation
+      /// is complete. See \c Expr::eval_to_async() .
+      /// \tparam D The derived expression type
+      /// \param other The expression that will be assigned to this array
+      /// \return A future to the result array, which is set when the
+      /// evaluation of the local tiles is complete
+      template <typename D>
+      Future<array_type> assign_async(const Expr<D>& other) {
+        static_assert(TiledArray::expressions::is_aliased<D>::value,
+            "no_alias() expressions are not allowed on the right-hand side of "
+            "the assignment operator.");
+        return other.derived().eval_to_async(*this);
+      }
+
+      /// Optimized assignment of a product of several tensors
+
+      /// The product is evaluated as the sequence of binary products with the
+      /// smallest estimated cost (see \c ContractionPlan ), instead of
+      /// left-to-right. The intermediates are released after their use.
+      /// \code
+      /// auto plan = c("i,j").assign_optimized(a("i,k") * b("k,l") * d("l,j"));
+      /// std::cout << plan;
+      /// \endcode
+      /// \tparam Left The left-hand expression type
+      /// \tparam Right The right-hand expression type
+      /// \param other The product of tensor expressions of \c array_type that
+      /// will be assigned to this array
+      /// \return The evaluation plan that was used
+      template <typename Left, typename Right>
+      ContractionPlan assign_optimized(const MultExpr<Left, Right>& other) {
+        std::vector<array_type> arrays;
+        std::vector<std::string> vars;
+        collect_operands(other, arrays, vars);
+
+        std::vector<ContractionPlan::Operand> operands;
+        for(std::size_t i = 0ul; i < arrays.size(); ++i)
+          operands.push_back(ContractionPlan::operand(arrays[i], vars[i]));
+        ContractionPlan plan(operands, VariableList(vars_));
+
+        // Evaluate the steps of the plan
+        for(std::size_t s = 0ul; s < plan.size(); ++s) {
+          const ContractionPlan::Step& step = plan.step(s);
+          const array_type& left = arrays[step.left];
+          const array_type& right = arrays[step.right];
+          if(s + 1ul < plan.size()) {
+            array_type result;
+            vars.push_back(step.vars.string());
+            result(vars.back()) = (left(vars[step.left]) *
+                right(vars[step.right])).set_world(left.world());
+            arrays.push_back(result);
+          } else {
+            *this = (left(vars[step.left]) *
+                right(vars[step.right])).set_world(left.world());
+          }
+
+          // Release the intermediate arguments
+          if(step.left >= plan.operands())
+            arrays[step.left] = array_type();
+          if(step.right >= plan.operands())
+            arrays[step.right] = array_type();
+        }
+
+        return plan;
+      }
+
       /// Expression plus-assignment operator
 
       /// \tparam D The derived expression type
@@ -167,6 +243,43 @@ namespace TiledArray {
         return operator=(MultExpr<TsrExpr_, D>(*this, other.derived()));
       }
 
+    private:
+
+      /// Collect the operands of a product of tensor expressions
+
+      /// \tparam A The array type of the expression
+      /// \tparam AAlias The alias flag of the expression
+      /// \param expr The tensor expression
+      /// \param[out] arrays The arrays of the operands
+      /// \param[out] vars The indices of the operands
+      template <typename A, bool AAlias>
+      static void collect_operands(const TsrExpr<A, AAlias>& expr,
+          std::vector<array_type>& arrays, std::vector<std::string>& vars)
+      {
+        static_assert(std::is_same<typename std::remove_const<A>::type,
+            array_type>::value, "assign_optimized() requires operands of "
+            "the same array type as the result.");
+        arrays.push_back(expr.array());
+        vars.push_back(expr.vars());
+      }
+
+      /// Collect the operands of a product of tensor expressions
+
+      /// \tparam L The left-hand expression type
+      /// \tparam R The right-hand expression type
+      /// \param expr The product expression
+      /// \param[out] arrays The arrays of the operands
+      /// \param[out] vars The indices of the operands
+      template <typename L, typename R>
+      static void collect_operands(const MultExpr<L, R>& expr,
+          std::vector<array_type>& arrays, std::vector<std::string>& vars)
+      {
+        collect_operands(expr.left(), arrays, vars);
+        collect_operands(expr.right(), arrays, vars);
+      }
+
+    public:
+
       /// Array accessor
 
       /// \return a const reference to this array
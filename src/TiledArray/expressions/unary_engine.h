@@ -28,6 +28,7 @@
 
 #include <TiledArray/expressions/expr_engine.h>
 #include <TiledArray/dist_eval/unary_eval.h>
+#include <TiledArray/dist_eval/fused_eval.h>
 
 namespace TiledArray {
   namespace expressions {
@@ -62,6 +63,11 @@ namespace TiledArray {
 
       static constexpr bool consumable = true;
       static constexpr unsigned int leaves = argument_type::leaves;
+      static constexpr bool fusable = argument_type::fusable
+          && TiledArray::detail::is_fusable_tile<value_type>::value
+          && std::is_same<value_type, typename EngineTrait<argument_type>::eval_type>::value;
+          ///< \c true when this subexpression may be evaluated with a fused
+          ///< element-wise evaluator
 
     protected:
 
@@ -161,6 +167,68 @@ namespace TiledArray {
 
       /// \return The distributed evaluator that will evaluate this expression
       dist_eval_type make_dist_eval() const {
+        return make_dist_eval(std::integral_constant<bool, Derived::fusable &&
+            (leaves > 1u) && (leaves <= TiledArray::detail::max_fused_leaves)>());
+      }
+
+      /// Query fused element-wise evaluation
+
+      /// \return \c true when this subexpression and its argument may be
+      /// evaluated as an argument of a fused evaluator, i.e. the result is
+      /// not permuted.
+      bool is_fusable() const { return (! perm_) && arg_.is_fusable(); }
+
+      /// Fused element operation factory function
+
+      /// \return The element operation of this subexpression, which takes the
+      /// leaf elements of the argument
+      auto make_fused_op() const {
+        const auto arg_op = arg_.make_fused_op();
+        const auto op = derived().make_element_op();
+        return [=] (const auto&... args) { return op(arg_op(args...)); };
+      }
+
+      /// Fused argument factory function
+
+      /// \return A tuple that holds the distributed evaluators of the leaves
+      auto make_fused_args() const { return arg_.make_fused_args(); }
+
+    private:
+
+      /// Construct the fused distributed evaluator for this expression
+
+      /// The element-wise argument of this expression is evaluated in a
+      /// single pass over the leaf tiles, when none of its subexpressions
+      /// permutes its result.
+      /// \return The distributed evaluator that will evaluate this expression
+      dist_eval_type make_dist_eval(std::true_type) const {
+        if(! arg_.is_fusable())
+          return make_dist_eval(std::false_type());
+
+        return make_fused_dist_eval(make_fused_args());
+      }
+
+      template <typename... Args>
+      dist_eval_type make_fused_dist_eval(const std::tuple<Args...>& args) const {
+        const auto element_op = make_fused_op();
+        typedef TiledArray::detail::Fused<value_type,
+            typename std::decay<decltype(element_op)>::type> fused_op_type;
+        typedef TiledArray::detail::FusedEvalImpl<fused_op_type, policy,
+            Args...> impl_type;
+
+        // Construct the distributed evaluator type
+        std::shared_ptr<impl_type> pimpl =
+            std::make_shared<impl_type>(args, *world_, trange_, shape_, pmap_,
+                perm_, fused_op_type(element_op,
+                    (permute_tiles_ ? perm_ : Permutation())));
+
+        return dist_eval_type(pimpl);
+      }
+
+      /// Construct the distributed evaluator for this expression
+
+      /// \return The distributed evaluator that will evaluate this expression
+      dist_eval_type make_dist_eval(std::false_type) const {
         typedef TiledArray::detail::UnaryEvalImpl<typename argument_type::dist_eval_type,
             typename Derived::op_type, typename dist_eval_type::policy> impl_type;
 
@@ -175,6 +243,8 @@ namespace TiledArray {
         return dist_eval_type(pimpl);
       }
 
+    public:
+
       /// Expression print
 
       /// \param os The output stream
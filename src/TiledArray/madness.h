@@ -125,6 +125,11 @@ namespace TiledArray {
         current_world, world_resetter);
   }
 
+  namespace detail {
+    inline void init_node_topology(World& world);
+    inline void reset_node_topology();
+  }  // namespace detail
+
   /// @name TiledArray initialization.
   ///       These functions initialize TiledArray AND MADWorld runtime components.
   ///       @note the default World object is set to the object returned by these.
@@ -133,6 +138,7 @@ namespace TiledArray {
   inline World& initialize(int& argc, char**& argv, const SafeMPI::Intracomm& comm) {
     auto& default_world = madness::initialize(argc, argv, comm);
     TiledArray::set_default_world(default_world);
+    detail::init_node_topology(default_world);
     return default_world;
   }
 
@@ -147,10 +153,13 @@ namespace TiledArray {
   inline void finalize() {
     madness::finalize();
     TiledArray::reset_default_world();
+    detail::reset_node_topology();
   }
 
   /// @}
 
 }  // namespace TiledArray
 
+#include <TiledArray/node_topology.h>
+
 #endif // TILEDARRAY_MADNESS_H__INCLUDED
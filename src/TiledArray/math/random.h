@@ -0,0 +1,176 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  random.h
+ *
+ */
+
+#ifndef TILEDARRAY_MATH_RANDOM_H__INCLUDED
+#define TILEDARRAY_MATH_RANDOM_H__INCLUDED
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace TiledArray {
+  namespace math {
+
+    /// Random number distributions
+    enum class RandomDistribution {
+      uniform, ///< Uniform distribution in [0,1)
+      normal ///< Standard normal distribution
+    };
+
+    /// Philox4x32-10 counter-based random number generator
+
+    /// The generator is a keyed bijection of a 128-bit counter, so the
+    /// random numbers for a counter do not depend on the numbers that were
+    /// generated before it. This allows random numbers to be generated in
+    /// any order, by any number of threads or processes, with identical
+    /// results (see Salmon et al., "Parallel random numbers: as easy as
+    /// 1, 2, 3", SC11).
+    class Philox4x32 {
+    public:
+      typedef std::array<std::uint32_t, 4> counter_type; ///< Counter type
+      typedef std::array<std::uint32_t, 2> key_type; ///< Key type
+
+    private:
+
+      static constexpr std::uint32_t m0 = 0xD2511F53u; ///< Round multiplier
+      static constexpr std::uint32_t m1 = 0xCD9E8D57u; ///< Round multiplier
+      static constexpr std::uint32_t w0 = 0x9E3779B9u; ///< Key increment
+      static constexpr std::uint32_t w1 = 0xBB67AE85u; ///< Key increment
+
+      static void round(counter_type& ctr, const key_type& key) {
+        const std::uint64_t p0 = std::uint64_t(m0) * ctr[0];
+        const std::uint64_t p1 = std::uint64_t(m1) * ctr[2];
+        ctr = {{ std::uint32_t(p1 >> 32) ^ ctr[1] ^ key[0], std::uint32_t(p1),
+            std::uint32_t(p0 >> 32) ^ ctr[3] ^ key[1], std::uint32_t(p0) }};
+      }
+
+    public:
+
+      /// Generate the random numbers of a counter
+
+      /// \param ctr The counter
+      /// \param key The key
+      /// \return Four random 32-bit words
+      static counter_type generate(counter_type ctr, key_type key) {
+        for(unsigned int r = 0u; r < 9u; ++r) {
+          round(ctr, key);
+          key[0] += w0;
+          key[1] += w1;
+        }
+        round(ctr, key);
+        return ctr;
+      }
+
+    }; // class Philox4x32
+
+    namespace detail {
+
+      /// Generate the random numbers of a pair of elements
+
+      /// Elements <tt>2 * block</tt> and <tt>2 * block + 1</tt> are
+      /// generated from one counter, with 64 random bits each.
+      /// \param seed The random number seed
+      /// \param block The ordinal of the element pair
+      /// \param dist The random number distribution
+      /// \param[out] x The random numbers of the element pair
+      inline void random_pair(const std::uint64_t seed, const std::uint64_t block,
+          const RandomDistribution dist, double (&x)[2])
+      {
+        const Philox4x32::counter_type r = Philox4x32::generate(
+            {{ std::uint32_t(block), std::uint32_t(block >> 32), 0u, 0u }},
+            {{ std::uint32_t(seed), std::uint32_t(seed >> 32) }});
+
+        // Convert 53 random bits of each element to [0,1)
+        constexpr double scale = 1.0 / 9007199254740992.0; // 2^-53
+        x[0] = double(((std::uint64_t(r[0]) << 32) | r[1]) >> 11) * scale;
+        x[1] = double(((std::uint64_t(r[2]) << 32) | r[3]) >> 11) * scale;
+
+        if(dist == RandomDistribution::normal) {
+          // Box-Muller transform, where 1 - x[0] is in (0,1]
+          constexpr double two_pi = 6.283185307179586476925286766559;
+          const double radius = std::sqrt(-2.0 * std::log(1.0 - x[0]));
+          const double theta = two_pi * x[1];
+          x[0] = radius * std::cos(theta);
+          x[1] = radius * std::sin(theta);
+        }
+      }
+
+    } // namespace detail
+
+    /// Fill a vector with random numbers for consecutive element ordinals
+
+    /// The value of each element is a function of \c seed and its ordinal
+    /// only, so a vector that is filled in pieces, by any number of threads
+    /// or processes, is identical to one that is filled in a single call.
+    /// \tparam T The element type, which must be constructible from \c double
+    /// \param n The number of elements to fill
+    /// \param data A pointer to the vector
+    /// \param seed The random number seed
+    /// \param first The ordinal of the first element of \c data
+    /// \param dist The random number distribution
+    template <typename T>
+    void random_fill(const std::size_t n, T* const data, const std::uint64_t seed,
+        const std::uint64_t first,
+        const RandomDistribution dist = RandomDistribution::uniform)
+    {
+      if(n == 0ul)
+        return;
+
+      double x[2];
+      std::size_t i = 0ul;
+      std::uint64_t block = first >> 1;
+
+      // Fill the unpaired first element
+      if(first & 1u) {
+        detail::random_pair(seed, block++, dist, x);
+        data[i++] = T(x[1]);
+      }
+
+      // Fill element pairs
+      for(; (i + 1ul) < n; i += 2ul) {
+        detail::random_pair(seed, block++, dist, x);
+        data[i] = T(x[0]);
+        data[i + 1ul] = T(x[1]);
+      }
+
+      // Fill the unpaired last element
+      if(i < n) {
+        detail::random_pair(seed, block, dist, x);
+        data[i] = T(x[0]);
+      }
+    }
+
+    /// Default random number seed
+
+    /// \return A seed from a counter that is incremented by each call, so
+    /// the seeds are identical on all processes that make the same sequence
+    /// of calls
+    inline std::uint64_t default_random_seed() {
+      static std::atomic<std::uint64_t> counter(0ul);
+      return counter++;
+    }
+
+  }  // namespace math
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_MATH_RANDOM_H__INCLUDED
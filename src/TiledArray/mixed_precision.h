@@ -0,0 +1,171 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_MIXED_PRECISION_H__INCLUDED
+#define TILEDARRAY_MIXED_PRECISION_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/tensor.h>
+#include <atomic>
+
+namespace TiledArray {
+
+  /// Mixed precision contraction control
+
+  /// Tile products of a contraction whose estimated contribution to the
+  /// result is less than \c threshold() are computed in single precision and
+  /// accumulated into the double precision result tile. The estimate uses the
+  /// same normalization as \c SparseShape , i.e. for the product of an
+  /// \f$ m \times k \f$ tile \f$ L \f$ and a \f$ k \times n \f$ tile
+  /// \f$ R \f$ it is \f$ \|L\| \|R\| / (m n k) \f$ , where the norms are
+  /// Frobenius norms. The threshold should therefore be looser (larger) than
+  /// the sparse shape threshold. Only contractions of real, double precision
+  /// \c Tensor tiles use single precision; all other products are counted as
+  /// full precision products.
+  ///
+  /// This object is shared by all tasks of the contractions it is assigned
+  /// to (see \c Expr::set_mixed_precision() ), and counts the number of
+  /// products that were computed at each precision by this process.
+  class MixedPrecision {
+    const double threshold_; ///< The single precision threshold
+    std::atomic<std::size_t> single_count_; ///< Number of single precision products
+    std::atomic<std::size_t> double_count_; ///< Number of full precision products
+
+  public:
+
+    /// Constructor
+
+    /// \param threshold Tile products with an estimated contribution less
+    /// than \c threshold are computed in single precision.
+    explicit MixedPrecision(const double threshold) :
+      threshold_(threshold), single_count_(0ul), double_count_(0ul)
+    {
+      TA_USER_ASSERT(threshold >= 0.0,
+          "MixedPrecision::MixedPrecision(): threshold must be non-negative.");
+    }
+
+    MixedPrecision(const MixedPrecision&) = delete;
+    MixedPrecision& operator=(const MixedPrecision&) = delete;
+
+    /// Threshold accessor
+
+    /// \return The single precision threshold
+    double threshold() const { return threshold_; }
+
+    /// Single precision product count
+
+    /// \return The number of tile products computed in single precision by
+    /// this process
+    std::size_t single_precision_count() const { return single_count_; }
+
+    /// Full precision product count
+
+    /// \return The number of tile products computed in full precision by
+    /// this process
+    std::size_t double_precision_count() const { return double_count_; }
+
+    /// Reset the product counts
+    void reset() {
+      single_count_ = 0ul;
+      double_count_ = 0ul;
+    }
+
+    /// Check whether a product should use single precision
+
+    /// \param left_norm The Frobenius norm of the left-hand tile
+    /// \param right_norm The Frobenius norm of the right-hand tile
+    /// \param volume The product of the \c m , \c n , and \c k dimensions
+    /// \return \c true if the product should be computed in single precision
+    bool use_single_precision(const double left_norm, const double right_norm,
+        const double volume) const
+    {
+      return (left_norm * right_norm) < (threshold_ * volume);
+    }
+
+    /// Record a single precision product
+    void record_single_precision() { ++single_count_; }
+
+    /// Record a full precision product
+    void record_double_precision() { ++double_count_; }
+
+  }; // class MixedPrecision
+
+  namespace detail {
+
+    /// Mixed precision contraction of generic tiles
+
+    /// Generic tiles are always contracted in full precision.
+    /// \return \c false
+    template <typename Result, typename Left, typename Right, typename Scalar>
+    inline bool mixed_precision_gemm(MixedPrecision& mp, Result&, const Left&,
+        const Right&, const Scalar, const math::GemmHelper&)
+    {
+      mp.record_double_precision();
+      return false;
+    }
+
+    /// Mixed precision contraction of double precision tensors
+
+    /// If the estimated contribution of the product of \c left and \c right
+    /// is below the threshold of \c mp , the product is computed in single
+    /// precision and accumulated to \c result .
+    /// \param mp The mixed precision control object
+    /// \param[in,out] result The result tile; may be empty
+    /// \param left The left-hand tile
+    /// \param right The right-hand tile
+    /// \param factor The scaling factor
+    /// \param gemm_helper The gemm meta data
+    /// \return \c true if the product was computed and accumulated to
+    /// \c result , otherwise \c false and the caller should compute the
+    /// product in full precision.
+    template <typename AR, typename AL, typename ARt, typename Scalar>
+    inline typename std::enable_if<std::is_arithmetic<Scalar>::value, bool>::type
+    mixed_precision_gemm(MixedPrecision& mp, Tensor<double, AR>& result,
+        const Tensor<double, AL>& left, const Tensor<double, ARt>& right,
+        const Scalar factor, const math::GemmHelper& gemm_helper)
+    {
+      integer m = 1, n = 1, k = 1;
+      gemm_helper.compute_matrix_sizes(m, n, k, left.range(), right.range());
+
+      if(! mp.use_single_precision(left.norm(), right.norm(),
+          double(m) * double(n) * double(k)))
+      {
+        mp.record_double_precision();
+        return false;
+      }
+
+      const Tensor<float> left_single(left);
+      const Tensor<float> right_single(right);
+      const Tensor<float> product =
+          left_single.gemm(right_single, float(factor), gemm_helper);
+
+      if(result.empty())
+        result = Tensor<double, AR>(product);
+      else
+        result.add_to(product);
+
+      mp.record_single_precision();
+      return true;
+    }
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_MIXED_PRECISION_H__INCLUDED
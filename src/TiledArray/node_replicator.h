@@ -0,0 +1,262 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  node_replicator.h
+ *
+ */
+
+#ifndef TILEDARRAY_NODE_REPLICATOR_H__INCLUDED
+#define TILEDARRAY_NODE_REPLICATOR_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/error.h>
+#include <TiledArray/node_topology.h>
+#include <TiledArray/pmap/replicated_pmap.h>
+#include <TiledArray/tensor/tensor.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// A POSIX shared-memory segment, mapped into this process
+
+    /// A segment is created by one process of a node and opened by the
+    /// others with the same name. The mapping is released when the object is
+    /// destroyed; tiles that view the segment hold a shared pointer to it.
+    class SharedMemorySegment {
+    private:
+      std::string name_; ///< The segment name
+      void* data_; ///< The mapped data
+      std::size_t size_; ///< The size of the segment in bytes
+      bool linked_; ///< \c true when this process created the segment and it has not been unlinked
+
+      SharedMemorySegment(const std::string& name, const std::size_t size,
+          const bool create) :
+        name_(name), data_(MAP_FAILED), size_(size), linked_(false)
+      {
+        const int fd = (create ?
+            shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR) :
+            shm_open(name_.c_str(), O_RDWR, 0));
+        if(fd < 0)
+          TA_EXCEPTION("SharedMemorySegment: shm_open() failed.");
+        linked_ = create;
+
+        if(create && (ftruncate(fd, size_) != 0)) {
+          close(fd);
+          unlink();
+          TA_EXCEPTION("SharedMemorySegment: ftruncate() failed.");
+        }
+
+        data_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if(data_ == MAP_FAILED) {
+          unlink();
+          TA_EXCEPTION("SharedMemorySegment: mmap() failed.");
+        }
+      }
+
+    public:
+
+      SharedMemorySegment(const SharedMemorySegment&) = delete;
+      SharedMemorySegment& operator=(const SharedMemorySegment&) = delete;
+
+      ~SharedMemorySegment() {
+        if(data_ != MAP_FAILED)
+          munmap(data_, size_);
+        unlink();
+      }
+
+      /// Create a segment
+
+      /// \param name The segment name, which starts with '/'
+      /// \param size The size of the segment in bytes
+      /// \return The mapped segment
+      /// \throw TiledArray::Exception When the segment cannot be created
+      static std::shared_ptr<SharedMemorySegment>
+      create(const std::string& name, const std::size_t size) {
+        return std::shared_ptr<SharedMemorySegment>(
+            new SharedMemorySegment(name, size, true));
+      }
+
+      /// Open a segment that was created by another process
+
+      /// \param name The segment name
+      /// \param size The size of the segment in bytes
+      /// \return The mapped segment
+      /// \throw TiledArray::Exception When the segment cannot be opened
+      static std::shared_ptr<SharedMemorySegment>
+      open(const std::string& name, const std::size_t size) {
+        return std::shared_ptr<SharedMemorySegment>(
+            new SharedMemorySegment(name, size, false));
+      }
+
+      /// Remove the segment name
+
+      /// The data remains mapped by the processes that opened the segment.
+      /// This is a no-op on processes that did not create the segment.
+      void unlink() {
+        if(linked_) {
+          shm_unlink(name_.c_str());
+          linked_ = false;
+        }
+      }
+
+      /// Make the mapping of this process read-only
+      void protect() {
+        if(mprotect(data_, size_, PROT_READ) != 0)
+          TA_EXCEPTION("SharedMemorySegment: mprotect() failed.");
+      }
+
+      /// Data accessor
+
+      /// \return A pointer to the mapped data
+      void* data() const { return data_; }
+
+      /// Size accessor
+
+      /// \return The size of the segment in bytes
+      std::size_t size() const { return size_; }
+
+    }; // class SharedMemorySegment
+
+#ifdef TILEDARRAY_HAS_NODE_REPLICATION
+
+    /// Replicate an array in node-level shared memory
+
+    /// The non-zero tiles of \c source are stored once per node, in a POSIX
+    /// shared-memory segment, at offsets that are computed identically on
+    /// all processes from the tiled range and shape. Each tile is copied into
+    /// the segment by the process that owns it when the owner is on the node,
+    /// otherwise by one process of the node, so a remote tile is transferred
+    /// once per node. The tiles of the result are read-only views of the
+    /// segment, which is mapped until the last view is destroyed.
+    ///
+    /// This is a collective, blocking operation that includes a fence.
+    /// \tparam A The array type, with \c Tensor tiles of trivially copyable
+    /// elements
+    /// \param source The array to be replicated
+    /// \return An array with a replicated process map whose tiles view the
+    /// node's copy of \c source
+    template <typename A>
+    A node_replicate(const A& source) {
+      typedef typename A::value_type value_type;
+      typedef typename value_type::value_type numeric_type;
+      typedef typename A::size_type size_type;
+      static_assert(std::is_same<value_type, Tensor<numeric_type,
+          typename value_type::allocator_type> >::value,
+          "node_replicate(): the array tile type must be Tensor.");
+      static_assert(std::is_trivially_copyable<numeric_type>::value,
+          "node_replicate(): the tile elements must be trivially copyable.");
+
+      World& world = source.world();
+      const NodeGroup node(world);
+
+      // Lay out the non-zero tiles of the segment, each on a cache line
+      constexpr std::size_t alignment = 64ul;
+      const size_type n = source.size();
+      std::vector<std::size_t> offsets(n + 1ul, 0ul);
+      for(size_type i = 0ul; i < n; ++i) {
+        std::size_t bytes = 0ul;
+        if(! source.is_zero(i))
+          bytes = source.trange().make_tile_range(i).volume() * sizeof(numeric_type);
+        offsets[i + 1ul] = offsets[i] +
+            (bytes + alignment - 1ul) / alignment * alignment;
+      }
+      const std::size_t bytes = std::max(offsets[n], alignment);
+
+      // The first process of the node creates the segment, and the others
+      // open it by name
+      static std::atomic<unsigned long> counter(0ul);
+      char name[64] = { };
+      if(node.rank() == 0)
+        std::snprintf(name, sizeof(name), "/tiledarray.%ld.%lu", long(getpid()),
+            counter++);
+      std::shared_ptr<SharedMemorySegment> segment;
+      int status = 0;
+      if(node.rank() == 0) {
+        try {
+          segment = SharedMemorySegment::create(name, bytes);
+        } catch(...) {
+          status = 1;
+        }
+      }
+      node.broadcast(&status, sizeof(status));
+      node.broadcast(name, sizeof(name));
+      if((node.rank() != 0) && (status == 0)) {
+        try {
+          segment = SharedMemorySegment::open(name, bytes);
+        } catch(...) {
+          status = 1;
+        }
+      }
+
+      // All processes agree on the status before any of them throws, so
+      // that no process is left waiting at the fence below.
+      world.gop.max(status);
+      if(status)
+        TA_EXCEPTION("node_replicate(): unable to create or open a shared-memory segment.");
+      char* const data = static_cast<char*>(segment->data());
+
+      // Copy the tiles that this process is responsible for
+      const auto copy_tile = [] (const value_type& tile, numeric_type* const ptr) {
+        std::copy(tile.data(), tile.data() + tile.size(), ptr);
+      };
+      for(size_type i = 0ul; i < n; ++i) {
+        if(source.is_zero(i))
+          continue;
+        const ProcessID owner = source.owner(i);
+        if(node.includes(owner) ? owner == world.rank() :
+            ProcessID(i % node.size()) == node.rank())
+          world.taskq.add(copy_tile, source.find(i),
+              reinterpret_cast<numeric_type*>(data + offsets[i]));
+      }
+
+      // Wait for all processes to copy their tiles
+      world.gop.fence();
+      segment->unlink();
+      segment->protect();
+
+      // Construct the replicated array of tile views
+      A result(world, source.trange(), source.shape(),
+          std::make_shared<ReplicatedPmap>(world, n));
+      for(size_type i = 0ul; i < n; ++i) {
+        if(source.is_zero(i))
+          continue;
+        result.set(i, value_type(source.trange().make_tile_range(i),
+            std::shared_ptr<numeric_type>(segment,
+                reinterpret_cast<numeric_type*>(data + offsets[i]))));
+      }
+
+      return result;
+    }
+
+#endif // TILEDARRAY_HAS_NODE_REPLICATION
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_NODE_REPLICATOR_H__INCLUDED
@@ -0,0 +1,302 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  node_topology.h
+ *
+ */
+
+#ifndef TILEDARRAY_NODE_TOPOLOGY_H__INCLUDED
+#define TILEDARRAY_NODE_TOPOLOGY_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/// Node-level shared memory requires MPI-3 shared communicators
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+#define TILEDARRAY_HAS_NODE_REPLICATION 1
+#endif
+
+namespace TiledArray {
+  namespace detail {
+
+    /// The assignment of the processes of a world to nodes
+    class NodeTopology {
+    public:
+      typedef std::size_t size_type; ///< Size type
+
+    private:
+      std::vector<int> node_; ///< The node index of each process
+      int nodes_; ///< The number of nodes
+      size_type ranks_per_node_; ///< The number of processes of each node when nodes hold contiguous, equal blocks of ranks, otherwise 1
+
+    public:
+
+      /// Constructor
+
+      /// \param leaders The lowest rank on the node of each process
+      explicit NodeTopology(const std::vector<ProcessID>& leaders) :
+        node_(leaders.size(), 0), nodes_(0), ranks_per_node_(1ul)
+      {
+        // Number the nodes in the order of their lowest rank
+        std::vector<ProcessID> sorted = leaders;
+        std::sort(sorted.begin(), sorted.end());
+        sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+        nodes_ = sorted.size();
+        for(std::size_t p = 0ul; p < leaders.size(); ++p)
+          node_[p] = std::lower_bound(sorted.begin(), sorted.end(), leaders[p])
+              - sorted.begin();
+
+        // Check for a block placement of ranks on nodes
+        if((nodes_ > 0) && ((node_.size() % nodes_) == 0ul)) {
+          const size_type block = node_.size() / nodes_;
+          std::size_t p = 0ul;
+          for(; p < node_.size(); ++p)
+            if(size_type(node_[p]) != (p / block))
+              break;
+          if(p == node_.size())
+            ranks_per_node_ = block;
+        }
+      }
+
+      /// Process count accessor
+
+      /// \return The number of processes
+      size_type size() const { return node_.size(); }
+
+      /// Node count accessor
+
+      /// \return The number of nodes
+      int nodes() const { return nodes_; }
+
+      /// Node index accessor
+
+      /// \param rank A process rank
+      /// \return The index of the node of \c rank
+      int node(const ProcessID rank) const {
+        TA_ASSERT(std::size_t(rank) < node_.size());
+        return node_[rank];
+      }
+
+      /// Block size accessor
+
+      /// \return The number of processes of each node when all nodes hold
+      /// the same number of consecutive ranks, otherwise 1
+      size_type ranks_per_node() const { return ranks_per_node_; }
+
+      /// Split a broadcast by node
+
+      /// The members of a broadcast group are split into the leaders, i.e.
+      /// the root and one member of each other node, which broadcast across
+      /// nodes, and the members of each node, which are reached from their
+      /// leader. The root leads its node, and the first member in \c members
+      /// leads each other node.
+      /// \param[in] members The world ranks of the group members
+      /// \param[in] root The world rank of the broadcast root
+      /// \param[in] rank The world rank of this process, which is a member
+      /// \param[out] leaders The sorted world ranks of the leaders
+      /// \param[out] node The members on the node of \c rank , in the order
+      /// of \c members
+      /// \return The world rank of the leader of the node of \c rank , or -1
+      /// when the members are on a single node or on separate nodes, where a
+      /// flat broadcast is used
+      ProcessID split_bcast(const std::vector<ProcessID>& members,
+          const ProcessID root, const ProcessID rank,
+          std::vector<ProcessID>& leaders, std::vector<ProcessID>& node) const
+      {
+        const int root_node = this->node(root);
+        const int this_node = this->node(rank);
+        std::map<int, ProcessID> node_leaders;
+        leaders.clear();
+        node.clear();
+        for(const ProcessID member : members) {
+          const int member_node = this->node(member);
+          if(member_node == this_node)
+            node.push_back(member);
+          if(member_node != root_node)
+            node_leaders.insert(std::make_pair(member_node, member));
+        }
+
+        if(node_leaders.empty() || (node_leaders.size() + 1ul >= members.size()))
+          return -1;
+
+        leaders.push_back(root);
+        for(const auto& leader : node_leaders)
+          leaders.push_back(leader.second);
+        std::sort(leaders.begin(), leaders.end());
+        return (this_node == root_node ? root : node_leaders[this_node]);
+      }
+
+    }; // class NodeTopology
+
+    /// The node topologies of worlds, by world id
+
+    /// \return The topology map and its mutex
+    inline std::pair<std::map<unsigned long, std::shared_ptr<const NodeTopology> >, std::mutex>&
+    node_topologies() {
+      static std::pair<std::map<unsigned long, std::shared_ptr<const NodeTopology> >, std::mutex> topologies;
+      return topologies;
+    }
+
+    /// Node topology accessor
+
+    /// \param world The world
+    /// \return The node topology of \c world , or null when it has not been
+    /// initialized with \c init_node_topology()
+    inline std::shared_ptr<const NodeTopology> node_topology(const World& world) {
+      auto& topologies = node_topologies();
+      std::lock_guard<std::mutex> lock(topologies.second);
+      const auto it = topologies.first.find(world.id());
+      return (it != topologies.first.end() ? it->second :
+          std::shared_ptr<const NodeTopology>());
+    }
+
+    /// Set the node topology of a world
+
+    /// This replaces the topology found by \c init_node_topology() , e.g. to
+    /// test node-aware algorithms with a fake assignment of processes to
+    /// nodes. It must be called with the same topology on all processes of
+    /// \c world , while no operation that uses the topology is running.
+    /// \param world The world
+    /// \param topology The node topology of \c world , or null to remove it
+    inline void set_node_topology(const World& world,
+        const std::shared_ptr<const NodeTopology>& topology)
+    {
+      TA_USER_ASSERT(! topology || (topology->size() == std::size_t(world.size())),
+          "set_node_topology(): the topology does not match the world size.");
+      auto& topologies = node_topologies();
+      std::lock_guard<std::mutex> lock(topologies.second);
+      if(topology)
+        topologies.first[world.id()] = topology;
+      else
+        topologies.first.erase(world.id());
+    }
+
+    /// Discard the node topologies of all worlds
+    inline void reset_node_topology() {
+      auto& topologies = node_topologies();
+      std::lock_guard<std::mutex> lock(topologies.second);
+      topologies.first.clear();
+    }
+
+#ifdef TILEDARRAY_HAS_NODE_REPLICATION
+
+    /// The processes of a world that share a node
+
+    /// Construction and destruction are collective over \c world .
+    class NodeGroup {
+    private:
+      MPI_Comm comm_; ///< The node communicator
+      int rank_; ///< The rank of this process in the node communicator
+      std::vector<ProcessID> ranks_; ///< The sorted world ranks of the node
+
+    public:
+
+      /// Constructor
+
+      /// \param world The world that is split into nodes
+      explicit NodeGroup(World& world) : comm_(MPI_COMM_NULL), rank_(0), ranks_() {
+        int size = 0;
+        {
+          SAFE_MPI_GLOBAL_MUTEX;
+          MPI_Comm_split_type(world.mpi.comm().Get_mpi_comm(),
+              MPI_COMM_TYPE_SHARED, world.rank(), MPI_INFO_NULL, &comm_);
+          MPI_Comm_rank(comm_, &rank_);
+          MPI_Comm_size(comm_, &size);
+        }
+
+        // Node ranks are ordered by world rank, since the split key is the
+        // world rank.
+        ranks_.resize(size);
+        const ProcessID rank = world.rank();
+        SAFE_MPI_GLOBAL_MUTEX;
+        MPI_Allgather(&rank, 1, MPI_INT, ranks_.data(), 1, MPI_INT, comm_);
+      }
+
+      NodeGroup(const NodeGroup&) = delete;
+      NodeGroup& operator=(const NodeGroup&) = delete;
+
+      ~NodeGroup() {
+        SAFE_MPI_GLOBAL_MUTEX;
+        MPI_Comm_free(&comm_);
+      }
+
+      /// Node rank accessor
+
+      /// \return The rank of this process on its node
+      int rank() const { return rank_; }
+
+      /// Node size accessor
+
+      /// \return The number of processes on this node
+      int size() const { return ranks_.size(); }
+
+      /// Node leader accessor
+
+      /// \return The lowest world rank on this node
+      ProcessID leader() const { return ranks_.front(); }
+
+      /// Check that a process is on this node
+
+      /// \param rank A world rank
+      /// \return \c true when \c rank is on the same node as this process
+      bool includes(const ProcessID rank) const {
+        return std::binary_search(ranks_.begin(), ranks_.end(), rank);
+      }
+
+      /// Broadcast a buffer from the first process of the node
+
+      /// \param buffer The buffer
+      /// \param size The size of \c buffer in bytes
+      void broadcast(void* const buffer, const int size) const {
+        SAFE_MPI_GLOBAL_MUTEX;
+        MPI_Bcast(buffer, size, MPI_BYTE, 0, comm_);
+      }
+
+    }; // class NodeGroup
+
+#endif // TILEDARRAY_HAS_NODE_REPLICATION
+
+    /// Initialize the node topology of a world
+
+    /// This is a collective operation over \c world , which is called by
+    /// \c TiledArray::initialize() for the default world. Without MPI-3
+    /// shared communicators, this is a no-op and every process is treated as
+    /// a separate node.
+    /// \param world The world
+    inline void init_node_topology(World& world) {
+#ifdef TILEDARRAY_HAS_NODE_REPLICATION
+      const NodeGroup node(world);
+      const ProcessID leader = node.leader();
+      std::vector<ProcessID> leaders(world.size());
+      {
+        SAFE_MPI_GLOBAL_MUTEX;
+        MPI_Allgather(&leader, 1, MPI_INT, leaders.data(), 1, MPI_INT,
+            world.mpi.comm().Get_mpi_comm());
+      }
+
+      set_node_topology(world, std::make_shared<NodeTopology>(leaders));
+#endif // TILEDARRAY_HAS_NODE_REPLICATION
+    }
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_NODE_TOPOLOGY_H__INCLUDED
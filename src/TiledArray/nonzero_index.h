@@ -0,0 +1,179 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  nonzero_index.h
+ *
+ */
+
+#ifndef TILEDARRAY_NONZERO_INDEX_H__INCLUDED
+#define TILEDARRAY_NONZERO_INDEX_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <cstddef>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Compressed index of the non-zero tiles of a shape
+
+    /// The tiles of the shape are viewed as a row-major matrix, where the
+    /// columns are the trailing dimensions of the tile range, so that the
+    /// tile ordinal is <tt>row * cols() + col</tt>. The ordinals of the
+    /// non-zero tiles are stored in sorted order, with row pointers (CSR), and
+    /// again ordered by column, with column pointers (CSC). Each row or
+    /// column can then be iterated in time proportional to its number of
+    /// non-zero tiles, and empty rows and columns are skipped in constant
+    /// time.
+    class NonzeroIndex {
+    public:
+      typedef std::size_t size_type; ///< Size type
+      typedef std::vector<size_type>::const_iterator const_iterator; ///< Ordinal iterator type
+
+    private:
+
+      size_type rows_; ///< The number of rows
+      size_type cols_; ///< The number of columns
+      std::vector<size_type> ordinals_; ///< Sorted non-zero tile ordinals
+      std::vector<size_type> row_ptr_; ///< Row offsets in \c ordinals_
+      std::vector<size_type> col_ordinals_; ///< Non-zero tile ordinals, by column
+      std::vector<size_type> col_ptr_; ///< Column offsets in \c col_ordinals_
+
+    public:
+
+      /// Construct the index of a dense array of tile norms
+
+      /// \tparam T The norm type
+      /// \param norms A pointer to the tile norms, in row-major order
+      /// \param size The number of tiles
+      /// \param cols The number of columns of the matrix view of the tiles
+      /// \param threshold Tiles with a norm less than \c threshold are zero
+      template <typename T>
+      NonzeroIndex(const T* const norms, const size_type size,
+          const size_type cols, const T threshold) :
+        rows_(cols ? size / cols : 0ul), cols_(cols), ordinals_(),
+        row_ptr_(rows_ + 1ul, 0ul), col_ordinals_(), col_ptr_(cols_ + 1ul, 0ul)
+      {
+        TA_ASSERT((cols_ == 0ul) || ((size % cols_) == 0ul));
+
+        // Construct the row compressed index
+        for(size_type i = 0ul, ord = 0ul; i < rows_; ++i) {
+          for(size_type j = 0ul; j < cols_; ++j, ++ord) {
+            if(! (norms[ord] < threshold)) {
+              ordinals_.push_back(ord);
+              ++col_ptr_[j + 1ul];
+            }
+          }
+          row_ptr_[i + 1ul] = ordinals_.size();
+        }
+
+        // Construct the column compressed index
+        for(size_type j = 0ul; j < cols_; ++j)
+          col_ptr_[j + 1ul] += col_ptr_[j];
+        col_ordinals_.resize(ordinals_.size());
+        std::vector<size_type> offset(col_ptr_.begin(), col_ptr_.end() - 1);
+        for(const size_type ord : ordinals_)
+          col_ordinals_[offset[ord % cols_]++] = ord;
+      }
+
+      /// Row count accessor
+
+      /// \return The number of rows of the matrix view
+      size_type rows() const { return rows_; }
+
+      /// Column count accessor
+
+      /// \return The number of columns of the matrix view
+      size_type cols() const { return cols_; }
+
+      /// Non-zero tile count
+
+      /// \return The number of non-zero tiles
+      size_type size() const { return ordinals_.size(); }
+
+      /// Begin iterator of the non-zero tile ordinals
+
+      /// \return An iterator to the first non-zero ordinal, in sorted order
+      const_iterator begin() const { return ordinals_.begin(); }
+
+      /// End iterator of the non-zero tile ordinals
+
+      /// \return An iterator to one past the last non-zero ordinal
+      const_iterator end() const { return ordinals_.end(); }
+
+      /// Begin iterator of a row
+
+      /// \param i The row index
+      /// \return An iterator to the first non-zero ordinal of row \c i
+      const_iterator row_begin(const size_type i) const {
+        TA_ASSERT(i < rows_);
+        return ordinals_.begin() + row_ptr_[i];
+      }
+
+      /// End iterator of a row
+
+      /// \param i The row index
+      /// \return An iterator to one past the last non-zero ordinal of row \c i
+      const_iterator row_end(const size_type i) const {
+        TA_ASSERT(i < rows_);
+        return ordinals_.begin() + row_ptr_[i + 1ul];
+      }
+
+      /// Row non-zero count
+
+      /// \param i The row index
+      /// \return The number of non-zero tiles in row \c i
+      size_type row_size(const size_type i) const {
+        TA_ASSERT(i < rows_);
+        return row_ptr_[i + 1ul] - row_ptr_[i];
+      }
+
+      /// Begin iterator of a column
+
+      /// \param j The column index
+      /// \return An iterator to the first non-zero ordinal of column \c j ;
+      /// the ordinals of a column are sorted by row
+      const_iterator col_begin(const size_type j) const {
+        TA_ASSERT(j < cols_);
+        return col_ordinals_.begin() + col_ptr_[j];
+      }
+
+      /// End iterator of a column
+
+      /// \param j The column index
+      /// \return An iterator to one past the last non-zero ordinal of column
+      /// \c j
+      const_iterator col_end(const size_type j) const {
+        TA_ASSERT(j < cols_);
+        return col_ordinals_.begin() + col_ptr_[j + 1ul];
+      }
+
+      /// Column non-zero count
+
+      /// \param j The column index
+      /// \return The number of non-zero tiles in column \c j
+      size_type col_size(const size_type j) const {
+        TA_ASSERT(j < cols_);
+        return col_ptr_[j + 1ul] - col_ptr_[j];
+      }
+
+    }; // class NonzeroIndex
+
+  }  // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_NONZERO_INDEX_H__INCLUDED
@@ -0,0 +1,134 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  batch_pmap.h
+ *
+ */
+
+#ifndef TILEDARRAY_PMAP_BATCH_PMAP_H__INCLUDED
+#define TILEDARRAY_PMAP_BATCH_PMAP_H__INCLUDED
+
+#include <TiledArray/pmap/pmap.h>
+#include <TiledArray/range.h>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Maps tiles to processes by their batch index
+
+    /// The tiles of a tensor with batch dimensions, e.g. the \c l dimension of
+    /// \c a("i,l,k") in \code c("i,j,l") = a("i,l,k") * b("j,l,k") \endcode ,
+    /// are mapped such that all tiles with the same batch tile index are owned
+    /// by the same process. Batch indices are distributed cyclically, i.e.
+    /// batch \f$ b \f$ is owned by process \f$ b \% P \f$ . Tensors with
+    /// batch dimensions in different positions are mapped consistently, as
+    /// long as the batch dimensions are given in the same order.
+    class BatchPmap : public Pmap {
+    protected:
+
+      // Import Pmap protected variables
+      using Pmap::rank_; ///< The rank of this process
+      using Pmap::procs_; ///< The number of processes
+      using Pmap::size_; ///< The number of tiles mapped among all processes
+      using Pmap::local_; ///< A list of local tiles
+
+    private:
+
+      std::vector<size_type> tile_strides_; ///< Tile index stride of each batch dimension
+      std::vector<size_type> extents_; ///< Tile extent of each batch dimension
+      std::vector<size_type> batch_strides_; ///< Batch index stride of each batch dimension
+      size_type batches_; ///< The number of batch indices
+
+    public:
+      typedef Pmap::size_type size_type; ///< Size type
+
+      /// Construct a batch process map
+
+      /// \param world The world where the tiles will be mapped
+      /// \param tiles_range The tile index range of the tensor
+      /// \param batch_dims The batch dimensions of \c tiles_range
+      BatchPmap(World& world, const Range& tiles_range,
+          const std::vector<unsigned int>& batch_dims) :
+        Pmap(world, tiles_range.volume()), tile_strides_(batch_dims.size()),
+        extents_(batch_dims.size()), batch_strides_(batch_dims.size()),
+        batches_(1ul)
+      {
+        for(int x = int(batch_dims.size()) - 1; x >= 0; --x) {
+          const unsigned int d = batch_dims[x];
+          TA_ASSERT(d < tiles_range.rank());
+          tile_strides_[x] = tiles_range.stride_data()[d];
+          extents_[x] = tiles_range.extent_data()[d];
+          batch_strides_[x] = batches_;
+          batches_ *= extents_[x];
+        }
+
+        // Construct the local tile list
+        for(size_type tile = 0ul; tile < size_; ++tile)
+          if(BatchPmap::owner(tile) == rank_)
+            local_.push_back(tile);
+      }
+
+      virtual ~BatchPmap() { }
+
+      /// Batch count accessor
+
+      /// \return The number of batch indices
+      size_type batches() const { return batches_; }
+
+      /// Compute the batch index of a tile
+
+      /// \param tile The tile ordinal index
+      /// \return The batch ordinal index of \c tile
+      size_type batch(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        size_type result = 0ul;
+        for(std::size_t x = 0ul; x < extents_.size(); ++x)
+          result += ((tile / tile_strides_[x]) % extents_[x]) * batch_strides_[x];
+        return result;
+      }
+
+      /// Maps a batch index to the processor that owns it
+
+      /// \param batch The batch ordinal index
+      /// \return Processor that owns the tiles of \c batch
+      size_type batch_owner(const size_type batch) const {
+        TA_ASSERT(batch < batches_);
+        return batch % procs_;
+      }
+
+      /// Maps \c tile to the processor that owns it
+
+      /// \param tile The tile to be queried
+      /// \return Processor that logically owns \c tile
+      virtual size_type owner(const size_type tile) const {
+        return batch_owner(batch(tile));
+      }
+
+      /// Check that the tile is owned by this process
+
+      /// \param tile The tile to be checked
+      /// \return \c true if \c tile is owned by this process, otherwise \c false .
+      virtual bool is_local(const size_type tile) const {
+        return BatchPmap::owner(tile) == rank_;
+      }
+
+    }; // class BatchPmap
+
+  } // namespace detail
+}  // namespace TiledArray
+
+#endif // TILEDARRAY_PMAP_BATCH_PMAP_H__INCLUDED
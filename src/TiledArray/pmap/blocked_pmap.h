@@ -100,6 +100,16 @@ namespace TiledArray {
       virtual bool is_local(const size_type tile) const {
         return ((tile >= local_first_) && (tile < local_last_));
       }
+
+      /// Local ordinal of a tile
+
+      /// \param tile The tile to be queried
+      /// \return The local ordinal of \c tile
+      /// \throw TiledArray::Exception When \c tile is not local.
+      virtual size_type local_ordinal(const size_type tile) const {
+        TA_ASSERT(BlockedPmap::is_local(tile));
+        return tile - local_first_;
+      }
     }; // class BlockedPmap
 
   }  // namespace detail
@@ -58,6 +58,7 @@ namespace TiledArray {
       const size_type cols_; ///< Number of tile columns to be mapped
       const size_type proc_cols_; ///< Number of process columns
       const size_type proc_rows_; ///< Number of process rows
+      size_type local_cols_; ///< Number of tile columns owned by this process
 
     public:
       typedef Pmap::size_type size_type; ///< Size type
@@ -75,7 +76,7 @@ namespace TiledArray {
       CyclicPmap(World& world, size_type rows, size_type cols,
           size_type proc_rows, size_type proc_cols) :
         Pmap(world, rows * cols), rows_(rows), cols_(cols),
-        proc_cols_(proc_cols), proc_rows_(proc_rows)
+        proc_cols_(proc_cols), proc_rows_(proc_rows), local_cols_(0ul)
       {
         // Check that the size is non-zero
         TA_ASSERT(rows_ >= 1ul);
@@ -97,6 +98,9 @@ namespace TiledArray {
           const size_type local_cols =
               (cols_ / proc_cols_) + ((cols_ % proc_cols_) < rank_col ? 1ul : 0ul);
 
+          if(rank_col < cols_)
+            local_cols_ = (cols_ - rank_col + proc_cols_ - 1ul) / proc_cols_;
+
           // Allocate memory for the local tile list
           local_.reserve(local_rows * local_cols);
 
@@ -151,6 +155,17 @@ namespace TiledArray {
         return (CyclicPmap::owner(tile) == rank_);
       }
 
+      /// Local ordinal of a tile
+
+      /// \param tile The tile to be queried
+      /// \return The local ordinal of \c tile
+      /// \throw TiledArray::Exception When \c tile is not local.
+      virtual size_type local_ordinal(const size_type tile) const {
+        TA_ASSERT(CyclicPmap::is_local(tile));
+        return ((tile / cols_) / proc_rows_) * local_cols_ +
+            ((tile % cols_) / proc_cols_);
+      }
+
     }; // class CyclicPmap
 
   }  // namespace detail
@@ -28,6 +28,7 @@
 
 #include <TiledArray/madness.h>
 #include <TiledArray/error.h>
+#include <algorithm>
 
 namespace TiledArray {
 
@@ -82,6 +83,24 @@ namespace TiledArray {
     /// \return \c true if \c tile is owned by this process, otherwise \c false .
     virtual bool is_local(const size_type tile) const = 0;
 
+    /// Local ordinal of a tile
+
+    /// The local ordinal is the position of \c tile in the list of local
+    /// tiles, i.e. <tt>*(begin() + local_ordinal(tile)) == tile</tt>, so it
+    /// may be used to index dense, per-process storage. The default
+    /// implementation is a binary search of the local tile list, which is
+    /// sorted; derived classes should override it with an O(1) algorithm
+    /// when one is available.
+    /// \param tile The tile to be queried
+    /// \return The local ordinal of \c tile
+    /// \throw TiledArray::Exception When \c tile is not local.
+    virtual size_type local_ordinal(const size_type tile) const {
+      TA_ASSERT(is_local(tile));
+      const const_iterator it = std::lower_bound(local_.begin(), local_.end(), tile);
+      TA_ASSERT((it != local_.end()) && (*it == tile));
+      return it - local_.begin();
+    }
+
     /// Size accessor
 
     /// \return The number of elements
@@ -84,6 +84,15 @@ namespace TiledArray {
         return true;
       }
 
+      /// Local ordinal of a tile
+
+      /// \param tile The tile to be queried
+      /// \return The local ordinal of \c tile
+      virtual size_type local_ordinal(const size_type tile) const {
+        TA_ASSERT(tile < size_);
+        return tile;
+      }
+
       /// Replicated array status
 
       /// \return \c true if the array is replicated, and false otherwise
@@ -168,12 +168,61 @@ namespace TiledArray {
         }
       }
 
+      /// Align the process rows with node boundaries
+
+      /// Search for values of x and y near the current values, with no more
+      /// unused processes, such that \c y divides \c ranks_per_node or is a
+      /// multiple of it. With a block placement of ranks on nodes, each node
+      /// then holds whole process rows, or each process row whole nodes, so
+      /// no process row or column is split unevenly across nodes and the
+      /// inter-node part of the SUMMA broadcasts is minimal.
+      /// \param[in,out] x The number of rows
+      /// \param[in,out] y The number of columns
+      /// \param[in] nprocs The number of available processes
+      /// \param[in] min_x The minimum valid value for x
+      /// \param[in] max_x The maximum valid value for x
+      /// \param[in] ranks_per_node The number of processes of each node
+      static void align_to_nodes(size_type& x, size_type& y,
+          const size_type nprocs, const size_type min_x, const size_type max_x,
+          const size_type ranks_per_node)
+      {
+        const auto aligned = [=] (const size_type test_y) {
+          return ((ranks_per_node % test_y) == 0u) ||
+              ((test_y % ranks_per_node) == 0u);
+        };
+        if(aligned(y))
+          return;
+
+        const size_type unused = nprocs - x * y;
+        const size_type delta = std::max<size_type>(1ul, std::log2(nprocs));
+        const size_type min_test_x = std::max<int_fast32_t>(min_x, int_fast32_t(x) - delta);
+        const size_type max_test_x = std::min(x + delta, max_x);
+
+        size_type best_x = 0u, diff = 0u;
+        for(size_type test_x = min_test_x; test_x <= max_test_x; ++test_x) {
+          const size_type test_y = nprocs / test_x;
+          const size_type test_diff = std::abs(long(x) - long(test_x));
+          if(aligned(test_y) && ((nprocs - test_x * test_y) <= unused) &&
+              ((best_x == 0u) || (test_diff < diff)))
+          {
+            best_x = test_x;
+            diff = test_diff;
+          }
+        }
+
+        if(best_x != 0u) {
+          x = best_x;
+          y = nprocs / best_x;
+        }
+      }
+
       /// Member variable initialization
 
       /// This function initializes the member variables with with the optimal
       /// sizes.
       void init(const size_type rank, const size_type nprocs,
-          const std::size_t row_size, const std::size_t col_size)
+          const std::size_t row_size, const std::size_t col_size,
+          const size_type ranks_per_node)
       {
         // Check for the simple cases first ...
         if(nprocs == 1u) { // Only one process
@@ -231,6 +280,11 @@ namespace TiledArray {
                 min_proc_rows, max_proc_rows);
           }
 
+          // Keep process rows within, or aligned with, node boundaries
+          if(ranks_per_node > 1u)
+            align_to_nodes(proc_rows_, proc_cols_, nprocs, min_proc_rows,
+                max_proc_rows, ranks_per_node);
+
           proc_size_ = proc_rows_ * proc_cols_;
 
           if(rank < proc_size_) {
@@ -279,7 +333,13 @@ namespace TiledArray {
         TA_ASSERT(row_size >= 1ul);
         TA_ASSERT(col_size >= 1ul);
 
-        init(world_->rank(), world_->size(), row_size, col_size);
+        // Align the grid with the nodes of the world
+        const std::shared_ptr<const NodeTopology> topology = node_topology(world);
+        const size_type ranks_per_node = (topology &&
+            (topology->size() == std::size_t(world_->size())) ?
+            topology->ranks_per_node() : 1u);
+
+        init(world_->rank(), world_->size(), row_size, col_size, ranks_per_node);
       }
 
 #ifdef TILEDARRAY_ENABLE_TEST_PROC_GRID
@@ -300,9 +360,11 @@ namespace TiledArray {
       /// \param cols The number of tile columns
       /// \param row_size The number of element rows
       /// \param col_size The number of element columns
+      /// \param test_ranks_per_node Test number of procs per node
       ProcGrid(World& world, const size_type test_rank, size_type test_nprocs,
           const size_type rows, const size_type cols,
-          const std::size_t row_size, const std::size_t col_size) :
+          const std::size_t row_size, const std::size_t col_size,
+          const size_type test_ranks_per_node = 1u) :
         world_(&world), rows_(rows), cols_(cols), size_(rows_ * cols_),
         proc_rows_(0u), proc_cols_(0u), proc_size_(0u), rank_row_(-1),
         rank_col_(-1), local_rows_(0u), local_cols_(0u), local_size_(0u)
@@ -314,7 +376,7 @@ namespace TiledArray {
         TA_ASSERT(col_size >= 1u);
         TA_ASSERT(test_rank < test_nprocs);
 
-        init(test_rank, test_nprocs, row_size, col_size);
+        init(test_rank, test_nprocs, row_size, col_size, test_ranks_per_node);
       }
 #endif // TILEDARRAY_ENABLE_TEST_PROC_GRID
 
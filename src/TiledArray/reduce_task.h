@@ -23,6 +23,7 @@
 #include <TiledArray/config.h>
 #include <TiledArray/error.h>
 #include <TiledArray/madness.h>
+#include <TiledArray/tile_op/tile_interface.h>
 
 namespace TiledArray {
   namespace detail {
@@ -386,6 +387,28 @@ namespace TiledArray {
           this->dec();
         }
 
+        /// Reduce a partial result
+
+        /// The initial result object, if it has not been used, is replaced
+        /// by the partial result.
+        /// \param partial The partial result to be reduced
+        void reduce_partial(const result_type& partial) {
+          using TiledArray::empty;
+          auto result = std::make_shared<result_type>(partial);
+
+          lock_.lock(); // <<< Begin critical section
+          if(ready_result_ && empty(*ready_result_))
+            ready_result_.reset();
+          lock_.unlock(); // <<< End critical section
+
+          // Check for more reductions
+          reduce(result);
+
+          // Decrement the dependency counter for the partial result. This
+          // must be done after the reduce call to avoid a race condition.
+          this->dec();
+        }
+
         World& world_; ///< The world that owns this task
         opT op_; ///< The reduction operation
         std::shared_ptr<result_type> ready_result_; ///< Result object that is ready to be reduced
@@ -528,6 +551,22 @@ namespace TiledArray {
         return ++count_;
       }
 
+      /// Add a partial result to the reduction task
+
+      /// \c result may be of the result type of \c opT or a \c Future to the
+      /// result type, e.g. the reduction of some arguments that was
+      /// evaluated elsewhere. The result type must be a tile type (see
+      /// \c TiledArray::empty() ).
+      /// \tparam Result The partial result type
+      /// \param result The partial result that will be reduced
+      template <typename Result>
+      void add_result(const Result& result) {
+        TA_ASSERT(pimpl_);
+        pimpl_->inc();
+        pimpl_->world().taskq.add(pimpl_, & ReduceTaskImpl::reduce_partial,
+            Future<result_type>(result), TaskAttributes::hipri());
+      }
+
       /// Argument count
 
       /// \return The total number of arguments added to this task
@@ -0,0 +1,302 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sparse_contraction_plan.h
+ *
+ */
+
+#ifndef TILEDARRAY_SPARSE_CONTRACTION_PLAN_H__INCLUDED
+#define TILEDARRAY_SPARSE_CONTRACTION_PLAN_H__INCLUDED
+
+#include <TiledArray/dense_shape.h>
+#include <TiledArray/sparse_shape.h>
+#include <TiledArray/permutation.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace TiledArray {
+  namespace detail {
+
+    /// Compare the zero tiles of two dense shapes
+
+    /// \return \c true
+    inline bool same_zero_tiles(const DenseShape&, const DenseShape&) {
+      return true;
+    }
+
+    /// Compare the zero tiles of two sparse shapes
+
+    /// \tparam T The shape value type
+    /// \param a The first shape
+    /// \param b The second shape
+    /// \return \c true if \c a and \c b have the same tile range and zero tiles
+    template <typename T>
+    bool same_zero_tiles(const SparseShape<T>& a, const SparseShape<T>& b) {
+      if(a.data().data() == b.data().data())
+        return true;
+      if(a.data().range() != b.data().range())
+        return false;
+      const std::size_t n = a.data().size();
+      for(std::size_t i = 0ul; i < n; ++i)
+        if(a.is_zero(i) != b.is_zero(i))
+          return false;
+      return true;
+    }
+
+    /// Relative change between two dense shapes
+
+    /// \return Zero
+    inline float shape_change(const DenseShape&, const DenseShape&) {
+      return 0.0f;
+    }
+
+    /// Relative change between two sparse shapes
+
+    /// \tparam T The shape value type
+    /// \param a The reference shape
+    /// \param b The new shape, which has the same tile range as \c a
+    /// \return The largest change of a tile norm, relative to the largest
+    /// tile norm of \c a
+    template <typename T>
+    T shape_change(const SparseShape<T>& a, const SparseShape<T>& b) {
+      if(a.data().data() == b.data().data())
+        return T(0);
+      const T* MADNESS_RESTRICT const a_data = a.data().data();
+      const T* MADNESS_RESTRICT const b_data = b.data().data();
+      const std::size_t n = a.data().size();
+      T max_norm = T(0), max_change = T(0);
+      for(std::size_t i = 0ul; i < n; ++i) {
+        max_norm = std::max(max_norm, std::abs(a_data[i]));
+        max_change = std::max(max_change, std::abs(a_data[i] - b_data[i]));
+      }
+      return (max_norm > T(0) ? max_change / max_norm : max_change);
+    }
+
+  }  // namespace detail
+
+  /// Inspector-executor plan of a sparse contraction
+
+  /// A contraction that is evaluated repeatedly, e.g. in an iterative
+  /// method, spends a large part of its set up on quantities that depend
+  /// only on the argument shapes: the result shape ( \c SparseShape::gemm() ),
+  /// and, on each process, the non-zero SUMMA iterations and the processes
+  /// that take part in the broadcast of each iteration. The first evaluation
+  /// of a contraction with a plan (see \c Expr::set_plan() ) inspects the
+  /// shapes and records these quantities; later evaluations execute the
+  /// recorded plan, as long as the argument shapes have the same zero tiles
+  /// and their tile norms changed by no more than \c tolerance() relative to
+  /// the largest tile norm of the inspected shapes. Otherwise the contraction
+  /// is inspected again.
+  ///
+  /// With a non-zero tolerance, the tile norms of reused argument shapes may
+  /// differ from the inspected ones. The result norms are then recomputed
+  /// from the current argument shapes and masked with the recorded result
+  /// shape, so they are those of \c SparseShape::gemm() over the recorded
+  /// non-zero tiles; result tiles that would only become non-zero with the
+  /// new norms are not computed. The SUMMA schedule is reused while the
+  /// zero tiles of the result do not change.
+  ///
+  /// A plan belongs to one contraction expression; the decision to reuse it
+  /// depends only on the replicated shapes, so it is the same on all
+  /// processes.
+  /// \tparam Shape The shape type of the contraction
+  template <typename Shape>
+  class SparseContractionPlan {
+  public:
+    typedef Shape shape_type; ///< Shape type
+    typedef std::size_t size_type; ///< Size type
+
+    /// SUMMA schedule of one process
+    struct Schedule {
+      size_type rows; ///< The number of result tile rows
+      size_type cols; ///< The number of result tile columns
+      size_type k; ///< The number of inner tiles
+      size_type proc_rows; ///< The number of process rows
+      size_type proc_cols; ///< The number of process columns
+      shape_type result; ///< The result shape of the schedule
+      std::vector<size_type> steps; ///< The non-zero SUMMA iterations, in order
+      std::vector<std::vector<ProcessID> > row_groups; ///< The row broadcast group of each step; empty when this process is not a member
+      std::vector<std::vector<ProcessID> > col_groups; ///< The column broadcast group of each step; empty when this process is not a member
+
+      /// Find the first step at or after a SUMMA iteration
+
+      /// \param k The SUMMA iteration
+      /// \return The first non-zero iteration that is not less than \c k , or
+      /// the number of inner tiles when there is none
+      size_type next(const size_type k) const {
+        const auto it = std::lower_bound(steps.begin(), steps.end(), k);
+        return (it != steps.end() ? *it : this->k);
+      }
+
+      /// Step index accessor
+
+      /// \param k The SUMMA iteration
+      /// \return The index of \c k in \c steps , or the number of steps
+      /// when \c k is not a step of this process
+      size_type find(const size_type k) const {
+        const auto it = std::lower_bound(steps.begin(), steps.end(), k);
+        return ((it != steps.end()) && (*it == k) ? it - steps.begin() :
+            steps.size());
+      }
+    }; // struct Schedule
+
+  private:
+
+    const float tolerance_; ///< Relative norm change that reuses the plan
+    bool inspected_; ///< \c true when the argument shapes have been inspected
+    shape_type left_; ///< The inspected left-hand shape
+    shape_type right_; ///< The inspected right-hand shape
+    Permutation perm_; ///< The inspected result permutation
+    shape_type result_; ///< The result shape
+    std::shared_ptr<const Schedule> schedule_; ///< The SUMMA schedule of this process
+    size_type inspections_; ///< The number of inspections
+    size_type executions_; ///< The number of reuses
+
+  public:
+
+    /// Constructor
+
+    /// \param tolerance The largest change of the argument tile norms,
+    /// relative to the largest tile norm, for which the plan is reused
+    explicit SparseContractionPlan(const float tolerance = 0.0f) :
+      tolerance_(tolerance), inspected_(false), left_(), right_(), perm_(),
+      result_(), schedule_(), inspections_(0ul), executions_(0ul)
+    {
+      TA_USER_ASSERT(tolerance >= 0.0f,
+          "SparseContractionPlan::SparseContractionPlan(): tolerance must be non-negative.");
+    }
+
+    SparseContractionPlan(const SparseContractionPlan&) = delete;
+    SparseContractionPlan& operator=(const SparseContractionPlan&) = delete;
+
+    /// Tolerance accessor
+
+    /// \return The relative norm change for which the plan is reused
+    float tolerance() const { return tolerance_; }
+
+    /// Inspection count
+
+    /// \return The number of times the argument shapes were inspected
+    size_type inspections() const { return inspections_; }
+
+    /// Execution count
+
+    /// \return The number of times the plan was reused
+    size_type executions() const { return executions_; }
+
+    /// Discard the plan, so that the next evaluation inspects the shapes
+    void reset() {
+      inspected_ = false;
+      schedule_.reset();
+    }
+
+    /// Check that the plan can be reused
+
+    /// \param left The left-hand argument shape
+    /// \param right The right-hand argument shape
+    /// \param perm The result permutation
+    /// \return \c true when the plan was inspected with the same
+    /// permutation, and shapes with the same zero tiles and tile norms
+    /// within \c tolerance()
+    bool match(const shape_type& left, const shape_type& right,
+        const Permutation& perm) const
+    {
+      return inspected_ && (perm == perm_) &&
+          detail::same_zero_tiles(left_, left) &&
+          detail::same_zero_tiles(right_, right) &&
+          (detail::shape_change(left_, left) <= tolerance_) &&
+          (detail::shape_change(right_, right) <= tolerance_);
+    }
+
+    /// Record the inspected shapes
+
+    /// This discards the SUMMA schedule.
+    /// \param left The left-hand argument shape
+    /// \param right The right-hand argument shape
+    /// \param perm The result permutation
+    /// \param result The result shape
+    void inspect(const shape_type& left, const shape_type& right,
+        const Permutation& perm, const shape_type& result)
+    {
+      inspected_ = true;
+      left_ = left;
+      right_ = right;
+      perm_ = perm;
+      result_ = result;
+      schedule_.reset();
+      ++inspections_;
+    }
+
+    /// Reuse the plan
+
+    /// \param left The left-hand argument shape, which matches the plan
+    /// \param right The right-hand argument shape, which matches the plan
+    /// \return \c true when the tile norms of \c left and \c right are those
+    /// of the inspected shapes, so \c result() is the result shape;
+    /// otherwise the result norms must be recomputed from \c left and
+    /// \c right , and masked with \c result()
+    bool execute(const shape_type& left, const shape_type& right) {
+      TA_ASSERT(inspected_);
+      ++executions_;
+      return (detail::shape_change(left_, left) == 0) &&
+          (detail::shape_change(right_, right) == 0);
+    }
+
+    /// Recorded result shape accessor
+
+    /// \return The result shape of the inspected argument shapes
+    const shape_type& result() const {
+      TA_ASSERT(inspected_);
+      return result_;
+    }
+
+    /// SUMMA schedule accessor
+
+    /// \param rows The number of result tile rows
+    /// \param cols The number of result tile columns
+    /// \param k The number of inner tiles
+    /// \param proc_rows The number of process rows
+    /// \param proc_cols The number of process columns
+    /// \param result The result shape
+    /// \return The recorded schedule when it was made for the same
+    /// dimensions, process grid, and result zero tiles, otherwise null
+    std::shared_ptr<const Schedule> schedule(const size_type rows,
+        const size_type cols, const size_type k, const size_type proc_rows,
+        const size_type proc_cols, const shape_type& result) const
+    {
+      if(schedule_ && (schedule_->rows == rows) && (schedule_->cols == cols) &&
+          (schedule_->k == k) && (schedule_->proc_rows == proc_rows) &&
+          (schedule_->proc_cols == proc_cols) &&
+          detail::same_zero_tiles(schedule_->result, result))
+        return schedule_;
+      return std::shared_ptr<const Schedule>();
+    }
+
+    /// Record the SUMMA schedule of this process
+
+    /// \param schedule The schedule
+    void set_schedule(const std::shared_ptr<const Schedule>& schedule) {
+      schedule_ = schedule;
+    }
+
+  }; // class SparseContractionPlan
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SPARSE_CONTRACTION_PLAN_H__INCLUDED
@@ -0,0 +1,347 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sparse_norm_store.h
+ *
+ */
+
+#ifndef TILEDARRAY_SPARSE_NORM_STORE_H__INCLUDED
+#define TILEDARRAY_SPARSE_NORM_STORE_H__INCLUDED
+
+#include <TiledArray/madness.h>
+#include <TiledArray/error.h>
+#include <TiledArray/sparse_shape.h>
+#include <TiledArray/tiled_range.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Distributed store of the non-zero tile norms of a shape
+
+  /// \c SparseShape keeps a dense tensor of norms on every process, which is
+  /// not practical for tile grids with \f$10^7\f$ or more tiles. This store
+  /// keeps only the non-zero, per-element norms, as sorted (ordinal, norm)
+  /// arrays, so its memory is proportional to the number of non-zero tiles.
+  /// By default the ordinals are split across processes in contiguous
+  /// blocks, and each process stores only the non-zero norms of its block;
+  /// the norms of other blocks are looked up with \c find() , which sends
+  /// one request per owner. The store may also be replicated, in which case
+  /// every process stores all non-zero norms and lookups are local.
+  ///
+  /// The store is built from the (index, norm) contributions of each
+  /// process with a sparse reduce-scatter: each contribution is sent only
+  /// to the process that owns its ordinal, where the contributions are
+  /// summed in rank order, normalized by the tile volume, and compared with
+  /// \c SparseShape<T>::threshold() . The communication volume is therefore
+  /// proportional to the number of non-zero contributions, not to the
+  /// number of tiles.
+  /// \tparam T The norm value type
+  /// \note This object is derived from \c WorldObject , which means
+  /// the order of construction of object must be the same on all nodes.
+  template <typename T>
+  class SparseNormStore : public madness::WorldObject<SparseNormStore<T> > {
+  public:
+    typedef SparseNormStore<T> SparseNormStore_; ///< This object type
+    typedef madness::WorldObject<SparseNormStore_> WorldObject_; ///< Base object type
+    typedef T value_type; ///< The norm value type
+    typedef std::size_t size_type; ///< Size type
+    typedef Future<value_type> future; ///< Norm future type
+    typedef std::vector<size_type> key_vector; ///< Bulk ordinal type
+    typedef std::vector<value_type> value_vector; ///< Bulk norm type
+    typedef std::vector<future> future_vector; ///< Bulk norm future type
+
+  private:
+
+    const size_type size_; ///< The number of tiles
+    const size_type block_size_; ///< The number of ordinals owned by each process
+    const bool replicated_; ///< \c true when every process stores all norms
+    key_vector ordinals_; ///< Sorted ordinals of the stored non-zero norms
+    value_vector norms_; ///< Non-zero norms of \c ordinals_
+    size_type nonzeros_; ///< The number of non-zero norms on all processes
+    std::vector<key_vector> recv_ordinals_; ///< Received ordinals, per
+        ///< source process (only used during construction)
+    std::vector<value_vector> recv_norms_; ///< Received norms, per source
+        ///< process (only used during construction)
+
+    typedef std::vector<typename future::remote_refT> ref_vector;
+
+    // not allowed
+    SparseNormStore(const SparseNormStore_&);
+    SparseNormStore_& operator=(const SparseNormStore_&);
+
+    void scatter_handler(const ProcessID source, const key_vector& ordinals,
+        const value_vector& norms)
+    {
+      TA_ASSERT(ordinals.size() == norms.size());
+
+      // Each process sends at most one message to each process, so the
+      // slots of different sources may be written concurrently.
+      recv_ordinals_[source] = ordinals;
+      recv_norms_[source] = norms;
+    }
+
+    void get_handler(const size_type i, const typename future::remote_refT& ref) {
+      future remote_f(ref);
+      remote_f.set(local_norm(i));
+    }
+
+    void set_refs_handler(const ref_vector& refs, const value_vector& norms) {
+      TA_ASSERT(refs.size() == norms.size());
+      for(size_type k = 0ul; k < refs.size(); ++k) {
+        future f(refs[k]);
+        f.set(norms[k]);
+      }
+    }
+
+    void get_bulk_handler(const key_vector& ordinals, const ref_vector& refs,
+        const ProcessID requester)
+    {
+      TA_ASSERT(ordinals.size() == refs.size());
+      value_vector norms;
+      norms.reserve(ordinals.size());
+      for(const size_type i : ordinals)
+        norms.push_back(local_norm(i));
+      WorldObject_::task(requester, & SparseNormStore_::set_refs_handler,
+          refs, norms, madness::TaskAttributes::hipri());
+    }
+
+    /// Sum, normalize, and store the received contributions
+
+    /// The contributions are concatenated in rank order and stably sorted by
+    /// ordinal, so the norms of a tile are summed in the same order on every
+    /// process.
+    /// \param trange The tiled range of the tensor
+    void reduce(const TiledRange& trange) {
+      key_vector ordinals;
+      value_vector norms;
+      for(size_type p = 0ul; p < recv_ordinals_.size(); ++p) {
+        ordinals.insert(ordinals.end(), recv_ordinals_[p].begin(), recv_ordinals_[p].end());
+        norms.insert(norms.end(), recv_norms_[p].begin(), recv_norms_[p].end());
+        key_vector().swap(recv_ordinals_[p]);
+        value_vector().swap(recv_norms_[p]);
+      }
+
+      key_vector order(ordinals.size());
+      std::iota(order.begin(), order.end(), 0ul);
+      std::stable_sort(order.begin(), order.end(),
+          [&ordinals] (const size_type l, const size_type r) {
+            return ordinals[l] < ordinals[r];
+          });
+
+      const value_type threshold = SparseShape<value_type>::threshold();
+      for(size_type k = 0ul; k < order.size(); ) {
+        const size_type i = ordinals[order[k]];
+        value_type norm = value_type(0);
+        for(; (k < order.size()) && (ordinals[order[k]] == i); ++k)
+          norm += norms[order[k]];
+
+        norm /= value_type(trange.make_tile_range(i).volume());
+        if(norm >= threshold) {
+          ordinals_.push_back(i);
+          norms_.push_back(norm);
+        }
+      }
+    }
+
+  public:
+
+    /// Collective constructor
+
+    /// The norms of a tile may be contributed by any number of processes,
+    /// and are summed. Each process sends its contributions to the owners
+    /// of their ordinals (to every process when \c replicated is \c true ),
+    /// and the construction is completed by a global fence. This is a
+    /// collective operation.
+    /// \tparam SparseNormSequence the sequence of \c std::pair<index,value_type> objects,
+    ///         where \c index is a directly-addressable sequence of integers.
+    /// \param world The world where the store will live
+    /// \param tile_norms The Frobenius norm of tiles contributed by this process
+    /// \param trange The tiled range of the tensor
+    /// \param replicated If \c true , every process stores all non-zero
+    /// norms; otherwise each process stores the norms of its block of
+    /// ordinals (default = false)
+    template <typename SparseNormSequence>
+    SparseNormStore(World& world, const SparseNormSequence& tile_norms,
+        const TiledRange& trange, const bool replicated = false) :
+      WorldObject_(world), size_(trange.tiles_range().volume()),
+      block_size_((size_ / world.size()) + ((size_ % world.size()) ? 1ul : 0ul)),
+      replicated_(replicated), ordinals_(), norms_(), nonzeros_(0ul),
+      recv_ordinals_(world.size()), recv_norms_(world.size())
+    {
+      const ProcessID nproc = world.size();
+      const ProcessID rank = world.rank();
+
+      // Sort the contributions of this process by destination; a replicated
+      // store sends the same list to every process.
+      std::vector<key_vector> send_ordinals(replicated_ ? 1 : nproc);
+      std::vector<value_vector> send_norms(replicated_ ? 1 : nproc);
+      for(const auto& pair_idx_norm : tile_norms) {
+        if(pair_idx_norm.second == value_type(0))
+          continue;
+        const size_type i = trange.tiles_range().ordinal(pair_idx_norm.first);
+        TA_ASSERT(i < size_);
+        const ProcessID p = (replicated_ ? 0 : owner(i));
+        send_ordinals[p].push_back(i);
+        send_norms[p].push_back(pair_idx_norm.second);
+      }
+
+      WorldObject_::process_pending();
+
+      // Reduce-scatter the contributions
+      for(ProcessID p = 0; p < nproc; ++p) {
+        const ProcessID s = (replicated_ ? 0 : p);
+        if(p == rank)
+          scatter_handler(rank, send_ordinals[s], send_norms[s]);
+        else if(! send_ordinals[s].empty())
+          WorldObject_::task(p, & SparseNormStore_::scatter_handler, rank,
+              send_ordinals[s], send_norms[s], madness::TaskAttributes::hipri());
+      }
+      world.gop.fence();
+
+      reduce(trange);
+
+      nonzeros_ = ordinals_.size();
+      if(! replicated_)
+        world.gop.sum(& nonzeros_, 1);
+    }
+
+    virtual ~SparseNormStore() { }
+
+    using WorldObject_::get_world;
+
+    /// Tile count accessor
+
+    /// \return The number of tiles, zero or not
+    size_type size() const { return size_; }
+
+    /// Non-zero tile count accessor
+
+    /// \return The number of non-zero norms on all processes
+    size_type nonzeros() const { return nonzeros_; }
+
+    /// Local non-zero tile count accessor
+
+    /// \return The number of non-zero norms stored by this process
+    size_type local_nonzeros() const { return ordinals_.size(); }
+
+    /// Sparsity of the store
+
+    /// \return The fraction of tiles that are zero
+    float sparsity() const {
+      return float(size_ - nonzeros_) / float(size_);
+    }
+
+    /// Replication query
+
+    /// \return \c true when every process stores all non-zero norms
+    bool is_replicated() const { return replicated_; }
+
+    /// Norm owner
+
+    /// \param i The ordinal of a tile
+    /// \return The process that stores the norm of tile \c i
+    ProcessID owner(const size_type i) const {
+      TA_ASSERT(i < size_);
+      return (replicated_ ? get_world().rank() : ProcessID(i / block_size_));
+    }
+
+    /// Local norm query
+
+    /// \param i The ordinal of a tile
+    /// \return \c true when the norm of tile \c i is stored by this process
+    bool is_local(const size_type i) const {
+      return owner(i) == get_world().rank();
+    }
+
+    /// Local norm accessor
+
+    /// \param i The ordinal of a local tile
+    /// \return The per-element norm of tile \c i , or zero if the tile is zero
+    value_type local_norm(const size_type i) const {
+      TA_ASSERT(is_local(i));
+      const auto it = std::lower_bound(ordinals_.begin(), ordinals_.end(), i);
+      if((it != ordinals_.end()) && (*it == i))
+        return norms_[it - ordinals_.begin()];
+      return value_type(0);
+    }
+
+    /// Ordinals of the local non-zero norms
+
+    /// \return The sorted ordinals of the non-zero norms stored by this process
+    const key_vector& local_ordinals() const { return ordinals_; }
+
+    /// Local non-zero norms
+
+    /// \return The non-zero norms of \c local_ordinals()
+    const value_vector& local_norms() const { return norms_; }
+
+    /// Get a local or remote norm
+
+    /// \param i The ordinal of a tile
+    /// \return A future to the per-element norm of tile \c i
+    future find(const size_type i) const {
+      if(is_local(i))
+        return future(local_norm(i));
+
+      future result;
+      WorldObject_::task(owner(i), & SparseNormStore_::get_handler, i,
+          result.remote_ref(get_world()), madness::TaskAttributes::hipri());
+      return result;
+    }
+
+    /// Get local or remote norms in bulk
+
+    /// The requests for remote norms are sent with one message per owner,
+    /// and each owner returns its norms with one message.
+    /// \param ordinals The ordinals of the tiles
+    /// \return Futures to the per-element norms of \c ordinals , in the
+    /// same order
+    future_vector find(const key_vector& ordinals) const {
+      future_vector result;
+      result.reserve(ordinals.size());
+
+      std::vector<key_vector> remote_ordinals(get_world().size());
+      std::vector<ref_vector> remote_refs(get_world().size());
+      for(const size_type i : ordinals) {
+        if(is_local(i)) {
+          result.push_back(future(local_norm(i)));
+        } else {
+          const ProcessID p = owner(i);
+          future f;
+          remote_ordinals[p].push_back(i);
+          remote_refs[p].push_back(f.remote_ref(get_world()));
+          result.push_back(f);
+        }
+      }
+
+      // Send a request to each owner for its norms.
+      for(ProcessID p = 0; p < ProcessID(remote_ordinals.size()); ++p)
+        if(! remote_ordinals[p].empty())
+          WorldObject_::task(p, & SparseNormStore_::get_bulk_handler,
+              remote_ordinals[p], remote_refs[p], get_world().rank(),
+              madness::TaskAttributes::hipri());
+
+      return result;
+    }
+
+  }; // class SparseNormStore
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SPARSE_NORM_STORE_H__INCLUDED
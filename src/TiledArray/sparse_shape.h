@@ -26,12 +26,18 @@
 #ifndef TILEDARRAY_SPARSE_SHAPE_H__INCLUDED
 #define TILEDARRAY_SPARSE_SHAPE_H__INCLUDED
 
+#include <TiledArray/nonzero_index.h>
 #include <TiledArray/tensor.h>
 #include <TiledArray/tiled_range.h>
 #include <TiledArray/val_array.h>
 #include <TiledArray/tensor/shift_wrapper.h>
 #include <TiledArray/tensor/tensor_interface.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <typeinfo>
+#include <utility>
+#include <vector>
 
 namespace TiledArray {
 
@@ -48,6 +54,8 @@ namespace TiledArray {
   /// \f$ij...\f$, and \f$N_i N_j ...\f$ is the product of tile \f$ij...\f$ in
   /// each dimension.
   /// \tparam T The sparse element value type
+  /// \note The norms are stored densely on every process; see
+  ///       \c SparseNormStore for a distributed store of the non-zero norms.
   /// \note Scaling operations, such as SparseShape<T>::scale , SparseShape<T>::gemm , etc.
   ///       accept generic scaling factors; internally (modulus of) the scaling factor is first
   ///       converted to T, then used (see SparseShape<T>::to_abs_factor).
@@ -72,6 +80,8 @@ namespace TiledArray {
     Tensor<value_type> tile_norms_; ///< Tile magnitude data
     std::shared_ptr<vector_type> size_vectors_; ///< Tile size information; size_vectors_[d][i] reports the size of i-th tile in dimension d
     size_type zero_tile_count_; ///< Number of zero tiles
+    mutable std::shared_ptr<const detail::NonzeroIndex> nonzero_index_; ///< Cached
+        ///< index of the non-zero tiles
     static value_type threshold_; ///< The zero threshold
 
     template <typename Op>
@@ -161,6 +171,66 @@ namespace TiledArray {
       zero_tile_count_ = zero_tile_count;
     }
 
+    /// Sum-reduce the tile norms of all processes
+
+    /// When the non-zero norms of all processes, stored as (ordinal, norm)
+    /// pairs, are smaller than the dense norm data, only the non-zero norms
+    /// are exchanged: the per-process counts are all-reduced, each process
+    /// writes its pairs into its own slot of a buffer sized to the total
+    /// count, and a single all-reduce of that buffer gathers every list on
+    /// every process. The lists are then accumulated in rank order, so the
+    /// result is identical on all processes. Otherwise, the dense norm data
+    /// is all-reduced. This is a collective operation.
+    /// \note Only the communication is compressed; every process still
+    /// stores the full, dense \c tile_norms_ tensor. Use \c SparseNormStore
+    /// when the dense norms of the tile grid do not fit on each process.
+    /// \param world The world where the shape lives
+    void reduce_norms(World& world) {
+      const size_type n = tile_norms_.size();
+      value_type* MADNESS_RESTRICT const norms = tile_norms_.data();
+
+      // Gather the number of non-zero norms of each process
+      const ProcessID nproc = world.size();
+      const ProcessID rank = world.rank();
+      std::vector<size_type> counts(nproc, 0ul);
+      counts[rank] = std::count_if(norms, norms + n,
+          [] (const value_type norm) { return norm != value_type(0); });
+      world.gop.sum(counts.data(), nproc);
+
+      // Select the smaller representation; all processes agree on it.
+      std::vector<size_type> offsets(nproc + 1, 0ul);
+      for(ProcessID p = 0; p < nproc; ++p)
+        offsets[p + 1] = offsets[p] + counts[p];
+      const size_type nonzeros = offsets[nproc];
+      if((nonzeros * (sizeof(size_type) + sizeof(value_type))) >=
+          (n * sizeof(value_type)))
+      {
+        world.gop.sum(norms, n);
+        return;
+      }
+
+      // All-gather the non-zero norms; each process fills only its own slot
+      // and leaves the others zero, so the sum reproduces every list exactly.
+      std::vector<size_type> indices(nonzeros, 0ul);
+      std::vector<value_type> values(nonzeros, value_type(0));
+      for(size_type i = 0ul, j = offsets[rank]; i < n; ++i) {
+        if(norms[i] != value_type(0)) {
+          indices[j] = i;
+          values[j] = norms[i];
+          ++j;
+        }
+      }
+      if(nonzeros) {
+        world.gop.sum(indices.data(), nonzeros);
+        world.gop.sum(values.data(), nonzeros);
+      }
+
+      // Accumulate the non-zero norms in rank order
+      std::fill_n(norms, n, value_type(0));
+      for(size_type j = 0ul; j < nonzeros; ++j)
+        norms[indices[j]] += values[j];
+    }
+
     static std::shared_ptr<vector_type>
     initialize_size_vectors(const TiledRange& trange) {
       // Allocate memory for size vectors
@@ -278,8 +348,8 @@ namespace TiledArray {
     /// Collective "dense" constructor
 
     /// This constructor uses tile norms given as a dense tensor.
-    /// The tile norms data are summed across all processes (via
-    /// an all reduce).
+    /// The tile norms data are summed across all processes; only the
+    /// non-zero norms are exchanged when the norm data is sparse.
     /// Next, the norms are converted to per-element norms by dividing each
     /// norm by the number of elements in the corresponding tile.
     /// \param world The world where the shape will live
@@ -294,7 +364,7 @@ namespace TiledArray {
       TA_ASSERT(tile_norms_.range() == trange.tiles_range());
 
       // reduce norm data from all processors
-      world.gop.sum(tile_norms_.data(), tile_norms_.size());
+      reduce_norms(world);
 
       normalize();
     }
@@ -316,7 +386,13 @@ namespace TiledArray {
                 const SparseNormSequence& tile_norms,
                 const TiledRange& trange) : SparseShape(tile_norms, trange)
     {
-      world.gop.sum(tile_norms_.data(), tile_norms_.size());
+      reduce_norms(world);
+
+      // Count the zero tiles of the reduced norms
+      const value_type threshold = threshold_;
+      zero_tile_count_ = std::count_if(tile_norms_.data(),
+          tile_norms_.data() + tile_norms_.size(),
+          [threshold] (const value_type norm) { return norm < threshold; });
     }
 
     /// Copy constructor
@@ -325,7 +401,8 @@ namespace TiledArray {
     /// \param other The other shape object to be copied
     SparseShape(const SparseShape<T>& other) :
       tile_norms_(other.tile_norms_), size_vectors_(other.size_vectors_),
-      zero_tile_count_(other.zero_tile_count_)
+      zero_tile_count_(other.zero_tile_count_),
+      nonzero_index_(std::atomic_load(& other.nonzero_index_))
     { }
 
     /// Copy assignment operator
@@ -337,6 +414,7 @@ namespace TiledArray {
       tile_norms_ = other.tile_norms_;
       size_vectors_ = other.size_vectors_;
       zero_tile_count_ = other.zero_tile_count_;
+      std::atomic_store(& nonzero_index_, std::atomic_load(& other.nonzero_index_));
       return *this;
     }
 
@@ -393,6 +471,33 @@ namespace TiledArray {
       return tile_norms_[index];
     }
 
+    /// Compressed index of the non-zero tiles
+
+    /// The tiles are viewed as a row-major matrix with \c cols columns, and
+    /// the index lists the non-zero tiles of each row and column (see
+    /// \c detail::NonzeroIndex ). The index is built on the first call and
+    /// cached, and it is shared by shallow copies of this shape. It is
+    /// rebuilt if a different number of columns is requested, but it is not
+    /// updated when the threshold is changed.
+    /// \param cols The number of columns of the matrix view; the product of
+    /// the extents of the trailing dimensions of the tile range
+    /// \return A shared pointer to the non-zero tile index
+    std::shared_ptr<const detail::NonzeroIndex>
+    nonzero_index(const size_type cols) const {
+      TA_ASSERT(! tile_norms_.empty());
+      TA_ASSERT((cols > 0ul) && ((tile_norms_.size() % cols) == 0ul));
+
+      std::shared_ptr<const detail::NonzeroIndex> result =
+          std::atomic_load(& nonzero_index_);
+      if(! result || (result->cols() != cols)) {
+        result = std::make_shared<const detail::NonzeroIndex>(tile_norms_.data(),
+            tile_norms_.size(), cols, threshold_);
+        std::atomic_store(& nonzero_index_, result);
+      }
+
+      return result;
+    }
+
     /// Transform the norm tensor with an operation
 
     /// \return A deep copy of the norms of the object having 
@@ -1150,6 +1255,121 @@ namespace TiledArray {
       return gemm(other, factor, gemm_helper).perm(perm);
     }
 
+    /// Batched contraction of shapes
+
+    /// The leading \c batch_rank dimensions of this shape and \c other are
+    /// batch dimensions, which are not contracted. The norms of each batch
+    /// are computed as in <tt>gemm(other, factor, gemm_helper)</tt> .
+    /// \tparam Factor The scaling factor type
+    /// \param other The right-hand shape
+    /// \param factor The scaling factor
+    /// \param gemm_helper The gemm meta data for the non-batch dimensions;
+    /// the arguments may not be transposed
+    /// \param batch_rank The number of batch dimensions
+    /// \return The shape of the batched contraction, which has the batch
+    /// dimensions followed by the outer dimensions of this shape and \c other
+    /// \note expression abs(Factor) must be well defined (by default, std::abs will be used)
+    template <typename Factor>
+    SparseShape_ batch_gemm(const SparseShape_& other, const Factor factor,
+        const math::GemmHelper& gemm_helper, const unsigned int batch_rank) const
+    {
+      TA_ASSERT(! tile_norms_.empty());
+      TA_ASSERT(gemm_helper.left_op() == madness::cblas::NoTrans);
+      TA_ASSERT(gemm_helper.right_op() == madness::cblas::NoTrans);
+      TA_ASSERT(tile_norms_.range().rank() == gemm_helper.left_rank() + batch_rank);
+      TA_ASSERT(other.tile_norms_.range().rank() == gemm_helper.right_rank() + batch_rank);
+
+      const value_type abs_factor = to_abs_factor(factor);
+      const value_type threshold = threshold_;
+      const unsigned int result_rank = gemm_helper.result_rank() + batch_rank;
+      const unsigned int left_outer_end = batch_rank + gemm_helper.left_outer_end();
+      const unsigned int left_rank = batch_rank + gemm_helper.left_rank();
+      const unsigned int right_outer_begin = batch_rank + gemm_helper.right_outer_begin();
+      const unsigned int right_rank = batch_rank + gemm_helper.right_rank();
+
+      // Compute the batch size and the gemm dimensions
+      const auto* MADNESS_RESTRICT const left_extent = tile_norms_.range().extent_data();
+      const auto* MADNESS_RESTRICT const right_extent = other.tile_norms_.range().extent_data();
+      integer B = 1, M = 1, N = 1, K = 1;
+      unsigned int i = 0u;
+      for(; i < batch_rank; ++i)
+        B *= left_extent[i];
+      for(; i < left_outer_end; ++i)
+        M *= left_extent[i];
+      for(; i < left_rank; ++i)
+        K *= left_extent[i];
+      for(i = right_outer_begin; i < right_rank; ++i)
+        N *= right_extent[i];
+
+      // Construct the result size vectors and norm tensor
+      std::shared_ptr<vector_type> result_size_vectors(new vector_type[result_rank],
+          std::default_delete<vector_type[]>());
+      std::vector<size_type> result_extent;
+      result_extent.reserve(result_rank);
+      unsigned int x = 0u;
+      for(i = 0u; i < left_outer_end; ++i, ++x) {
+        result_size_vectors.get()[x] = size_vectors_.get()[i];
+        result_extent.push_back(left_extent[i]);
+      }
+      for(i = right_outer_begin; i < right_rank; ++i, ++x) {
+        result_size_vectors.get()[x] = other.size_vectors_.get()[i];
+        result_extent.push_back(right_extent[i]);
+      }
+      Tensor<value_type> result_norms(Range(result_extent), 0);
+
+      // Scale the left-hand norms by the size of the contracted dimensions,
+      // since the norms are stored per element
+      const vector_type k_sizes = (left_rank > left_outer_end ?
+          recursive_outer_product(size_vectors_.get() + left_outer_end,
+              left_rank - left_outer_end,
+              [] (const vector_type& size_vector) -> const vector_type&
+              { return size_vector; }) :
+          vector_type(1ul, value_type(1)));
+      Tensor<value_type> left(tile_norms_.range());
+      auto left_op = [] (const value_type left, const value_type right)
+          { return left * right; };
+      for(size_type j = 0ul; j < size_type(B * M * K); j += K)
+        math::vector_op(left_op, K, left.data() + j,
+            tile_norms_.data() + j, k_sizes.data());
+
+      // Contract the norms of each batch
+      const integer MK = M * K, KN = K * N, MN = M * N;
+      for(integer b = 0; b < B; ++b)
+        math::gemm(madness::cblas::NoTrans, madness::cblas::NoTrans, M, N, K,
+            abs_factor, left.data() + b * MK, K, other.tile_norms_.data() + b * KN,
+            N, value_type(0), result_norms.data() + b * MN, N);
+
+      // Hard zero tiles that are below the zero threshold.
+      madness::AtomicInt zero_tile_count;
+      zero_tile_count = 0;
+      result_norms.inplace_unary(
+          [threshold, &zero_tile_count] (value_type& value) {
+            if(value < threshold) {
+              value = value_type(0);
+              ++zero_tile_count;
+            }
+          });
+
+      return SparseShape_(result_norms, result_size_vectors, zero_tile_count);
+    }
+
+    /// Batched contraction of shapes with a permutation
+
+    /// \tparam Factor The scaling factor type
+    /// \param other The right-hand shape
+    /// \param factor The scaling factor
+    /// \param gemm_helper The gemm meta data for the non-batch dimensions
+    /// \param batch_rank The number of batch dimensions
+    /// \param perm The permutation to be applied to the result
+    /// \return The permuted shape of the batched contraction
+    template <typename Factor>
+    SparseShape_ batch_gemm(const SparseShape_& other, const Factor factor,
+        const math::GemmHelper& gemm_helper, const unsigned int batch_rank,
+        const Permutation& perm) const
+    {
+      return batch_gemm(other, factor, gemm_helper, batch_rank).perm(perm);
+    }
+
   private:
     template <typename Factor>
     static value_type to_abs_factor(const Factor factor) {
@@ -30,30 +30,13 @@
 #include <TiledArray/range.h>
 #include <TiledArray/tensor.h>
 #include <TiledArray/tiled_range.h>
+#include <TiledArray/special/diagonal_tile.h>
 
 #include <vector>
 
 namespace TiledArray {
 namespace detail {
 
-// Function that returns a range containing the diagonal elements in the tile
-inline Range diagonal_range(Range const &rng) {
-    auto lo = rng.lobound();
-    auto up = rng.upbound();
-
-    // Determine the largest lower index and the smallest upper index
-    auto max_low = *std::max_element(std::begin(lo), std::end(lo));
-    auto min_up = *std::min_element(std::begin(up), std::end(up));
-
-    // If the max small elem is less than the min large elem then a diagonal
-    // elem is in this tile;
-    if (max_low < min_up) {
-        return Range({max_low}, {min_up});
-    } else {
-        return Range();
-    }
-}
-
 template <typename T>
 Tensor<float> diagonal_shape(TiledRange const &trange, T val) {
     Tensor<float> shape(trange.tiles_range(), 0.0);
@@ -186,6 +169,91 @@ diagonal_array(World &world, TiledRange const &trange, T val = 1) {
   return sparse_diagonal_array<T>(world, trange, val);
 }
 
+namespace detail {
+
+// Shape of an array of diagonal tiles, dense arrays have no zero tiles
+template <typename T>
+DenseShape diagonal_tile_shape(DenseShape const &, TiledRange const &,
+                               std::vector<T> const &) {
+    return DenseShape();
+}
+
+// Shape of an array of diagonal tiles from the norms of the diagonal elements
+template <typename T>
+SparseShape<float> diagonal_tile_shape(SparseShape<float> const &,
+                                       TiledRange const &trange,
+                                       std::vector<T> const &values) {
+    Tensor<float> shape(trange.tiles_range(), 0.0);
+    for (auto ord = 0ul; ord < shape.size(); ++ord) {
+        auto d_range = diagonal_range(trange.make_tile_range(ord));
+        if (d_range.volume() == 0ul)
+            continue;
+
+        float t_norm = 0.0;
+        for (auto i = d_range.lobound_data()[0]; i < d_range.upbound_data()[0]; ++i)
+            t_norm += std::norm(values[i]);
+        shape[ord] = std::sqrt(t_norm);
+    }
+
+    return SparseShape<float>(shape, trange);
+}
+
+}  // namespace detail
+
+/// Create a DistArray of DiagonalTile tiles
+
+/// Only the diagonal elements of each tile are stored, and contractions,
+/// Hadamard products, and sums with arrays of Tensor tiles do not construct
+/// dense diagonal tiles. For example, a matrix of orbital energy
+/// denominators can be applied as a row scaling of \c t :
+/// \code
+/// auto d = diagonal_tile_array<double, DensePolicy>(world, trange, values);
+/// r("i,j") = d("i,k") * t("k,j");
+/// \endcode
+/// \param world The world for the array
+/// \param trange The trange for the array, all dimensions must be equal
+/// \param values The diagonal elements, where <tt>values[i]</tt> is the
+/// value of element <tt>(i, i, ..., i)</tt>
+template <typename T, typename Policy = DensePolicy>
+DistArray<DiagonalTile<T>, Policy>
+diagonal_tile_array(World &world, TiledRange const &trange,
+                    std::vector<T> const &values) {
+    auto d_range = detail::diagonal_range(trange.elements_range());
+    TA_USER_ASSERT((d_range.volume() == 0ul) ||
+                   (values.size() >= d_range.upbound_data()[0]),
+        "diagonal_tile_array(): the number of values is less than the length of the diagonal.");
+
+    // Init the array
+    typedef typename DistArray<DiagonalTile<T>, Policy>::shape_type shape_type;
+    DistArray<DiagonalTile<T>, Policy> A(world, trange,
+        detail::diagonal_tile_shape(shape_type(), trange, values));
+
+    A.init_tiles([&values] (Range const &rng) {
+        auto d_range = detail::diagonal_range(rng);
+        Tensor<T> diag(d_range);
+        for (auto i = 0ul; i < diag.size(); ++i)
+            diag[i] = values[d_range.lobound_data()[0] + i];
+        return DiagonalTile<T>(rng, diag);
+    });
+
+    world.gop.fence();
+    return A;
+}
+
+/// Create a DistArray of DiagonalTile tiles with a constant diagonal
+
+/// \param world The world for the array
+/// \param trange The trange for the array
+/// \param val The value to be written along the diagonal elements
+template <typename T, typename Policy = DensePolicy>
+DistArray<DiagonalTile<T>, Policy>
+diagonal_tile_array(World &world, TiledRange const &trange, T val = 1) {
+    auto ext = trange.elements_range().upbound();
+    auto max_up = *std::max_element(std::begin(ext), std::end(ext));
+    return diagonal_tile_array<T, Policy>(world, trange,
+                                          std::vector<T>(max_up, val));
+}
+
 }  // namespace TiledArray
 
 #endif  // TILEDARRAY_SPECIALARRAYS_DIAGONAL_ARRAY_H__INCLUDED
@@ -0,0 +1,857 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  diagonal_tile.h
+ *
+ */
+
+#ifndef TILEDARRAY_SPECIAL_DIAGONAL_TILE_H__INCLUDED
+#define TILEDARRAY_SPECIAL_DIAGONAL_TILE_H__INCLUDED
+
+#include <TiledArray/tensor.h>
+#include <TiledArray/math/gemm_helper.h>
+
+namespace TiledArray {
+
+  // Forward declarations
+  template <typename> class DiagonalTile;
+
+  namespace detail {
+
+    /// Diagonal tile trait
+
+    /// Diagonal tiles are zero except for the hyper-diagonal elements,
+    /// <tt>(i, i, ..., i)</tt> , and provide the element accessor
+    /// <tt>diagonal(i)</tt> . Products and sums of diagonal tiles and tensors
+    /// are evaluated without constructing the dense diagonal tile.
+    /// \tparam Tile The tile type
+    template <typename Tile>
+    struct is_diagonal_tile : public std::false_type { };
+
+    template <typename T>
+    struct is_diagonal_tile<DiagonalTile<T> > : public std::true_type { };
+
+    /// Range of the diagonal elements of a tile
+
+    /// \param rng The range of a tile
+    /// \return A rank-1 range that contains the element indices, \c i , of the
+    /// hyper-diagonal elements, <tt>(i, i, ..., i)</tt> , of \c rng
+    inline Range diagonal_range(Range const &rng) {
+        auto lo = rng.lobound();
+        auto up = rng.upbound();
+
+        // Determine the largest lower index and the smallest upper index
+        auto max_low = *std::max_element(std::begin(lo), std::end(lo));
+        auto min_up = *std::min_element(std::begin(up), std::end(up));
+
+        // If the max small elem is less than the min large elem then a diagonal
+        // elem is in this tile;
+        if (max_low < min_up) {
+            return Range({max_low}, {min_up});
+        } else {
+            return Range();
+        }
+    }
+
+    /// Ordinal offset of a hyper-diagonal element
+
+    /// \param range The range of a tensor
+    /// \param i The element index of the hyper-diagonal element
+    /// \return The ordinal index of element <tt>(i, i, ..., i)</tt> in
+    /// \c range
+    inline std::size_t diagonal_ordinal(const Range& range, const std::size_t i) {
+      const auto* MADNESS_RESTRICT const lower = range.lobound_data();
+      const auto* MADNESS_RESTRICT const stride = range.stride_data();
+      std::size_t result = 0ul;
+      for(unsigned int d = 0u; d < range.rank(); ++d)
+        result += (i - lower[d]) * stride[d];
+      return result;
+    }
+
+    /// Add a diagonal tile to the diagonal of a tensor
+
+    /// <tt>result(i,...,i) += diag(i) * factor</tt>
+    /// \tparam T The tensor element type
+    /// \tparam A The tensor allocator type
+    /// \tparam Diag The diagonal tile type
+    /// \tparam Scalar The scaling factor type
+    /// \param result The tensor that will be modified
+    /// \param diag The diagonal tile
+    /// \param factor The scaling factor
+    template <typename T, typename A, typename Diag, typename Scalar>
+    inline void diagonal_axpy(Tensor<T, A>& result, const Diag& diag,
+        const Scalar factor)
+    {
+      TA_ASSERT(! result.empty());
+      TA_ASSERT(result.range() == diag.range());
+
+      const Range diag_range = diagonal_range(result.range());
+      if(diag_range.volume() == 0ul)
+        return;
+
+      T* MADNESS_RESTRICT const result_data = result.data();
+      for(std::size_t i = diag_range.lobound_data()[0]; i < diag_range.upbound_data()[0]; ++i)
+        result_data[diagonal_ordinal(result.range(), i)] += T(diag.diagonal(i)) * factor;
+    }
+
+    /// Hadamard product of a diagonal tile and a tensor
+
+    /// \tparam T The tensor element type
+    /// \tparam A The tensor allocator type
+    /// \tparam Diag The diagonal tile type
+    /// \tparam Scalar The scaling factor type
+    /// \param diag The diagonal tile
+    /// \param arg The tensor argument
+    /// \param factor The scaling factor
+    /// \return A tensor that is zero except for the diagonal elements,
+    /// <tt>result(i,...,i) = diag(i) * arg(i,...,i) * factor</tt>
+    template <typename T, typename A, typename Diag, typename Scalar>
+    inline Tensor<T, A>
+    diagonal_mult(const Diag& diag, const Tensor<T, A>& arg, const Scalar factor) {
+      TA_ASSERT(! arg.empty());
+      TA_ASSERT(arg.range() == diag.range());
+
+      Tensor<T, A> result(arg.range(), T(0));
+      const Range diag_range = diagonal_range(arg.range());
+      const T* MADNESS_RESTRICT const arg_data = arg.data();
+      T* MADNESS_RESTRICT const result_data = result.data();
+      for(std::size_t i = diag_range.lobound_data()[0]; i < diag_range.upbound_data()[0]; ++i) {
+        const std::size_t ord = diagonal_ordinal(arg.range(), i);
+        result_data[ord] = arg_data[ord] * T(diag.diagonal(i)) * factor;
+      }
+
+      return result;
+    }
+
+    /// Contract a diagonal tile with a tensor
+
+    /// Computes <tt>result += left * right * factor</tt> , where \c left is a
+    /// rank-2 diagonal tile that is contracted over one dimension. The
+    /// contraction is a row scaling of \c right ; rows of \c right that do
+    /// not overlap the diagonal are skipped, and no GEMM is done.
+    /// \tparam T The tensor element type
+    /// \tparam A The tensor allocator type
+    /// \tparam Diag The diagonal tile type
+    /// \tparam Scalar The scaling factor type
+    /// \param result The result tensor
+    /// \param left The left-hand diagonal tile
+    /// \param right The right-hand tensor
+    /// \param factor The scaling factor
+    /// \param gemm_config The contraction meta data
+    template <typename T, typename A, typename Diag, typename Scalar>
+    inline void diagonal_gemm(Tensor<T, A>& result, const Diag& left,
+        const Tensor<T, A>& right, const Scalar factor,
+        const math::GemmHelper& gemm_config)
+    {
+      TA_USER_ASSERT((gemm_config.left_rank() == 2u) &&
+          (gemm_config.num_contract_ranks() == 1u),
+          "diagonal_gemm(): diagonal tiles must be rank 2 and contracted over one dimension.");
+      TA_ASSERT(! result.empty());
+
+      const unsigned int outer = gemm_config.left_outer_begin();
+      const unsigned int inner = gemm_config.left_inner_begin();
+      const auto& diag_range = left.range();
+      const auto* MADNESS_RESTRICT const lower = diag_range.lobound_data();
+      const auto* MADNESS_RESTRICT const upper = diag_range.upbound_data();
+
+      integer m = 1, n = 1, k = 1;
+      gemm_config.compute_matrix_sizes(m, n, k, diag_range, right.range());
+
+      const std::size_t first = std::max(lower[outer], lower[inner]);
+      const std::size_t last = std::min(upper[outer], upper[inner]);
+      const bool trans = (gemm_config.right_op() != madness::cblas::NoTrans);
+      const T* MADNESS_RESTRICT const right_data = right.data();
+      T* MADNESS_RESTRICT const result_data = result.data();
+      for(std::size_t i = first; i < last; ++i) {
+        const T d = T(left.diagonal(i)) * factor;
+        const std::size_t row = i - lower[inner];
+        T* MADNESS_RESTRICT const result_row = result_data + (i - lower[outer]) * n;
+        if(trans) {
+          for(integer j = 0; j < n; ++j)
+            result_row[j] += d * right_data[j * k + row];
+        } else {
+          const T* MADNESS_RESTRICT const right_row = right_data + row * n;
+          for(integer j = 0; j < n; ++j)
+            result_row[j] += d * right_row[j];
+        }
+      }
+    }
+
+    /// Contract a tensor with a diagonal tile
+
+    /// Computes <tt>result += left * right * factor</tt> , where \c right is a
+    /// rank-2 diagonal tile that is contracted over one dimension. The
+    /// contraction is a column scaling of \c left .
+    /// \tparam T The tensor element type
+    /// \tparam A The tensor allocator type
+    /// \tparam Diag The diagonal tile type
+    /// \tparam Scalar The scaling factor type
+    /// \param result The result tensor
+    /// \param left The left-hand tensor
+    /// \param right The right-hand diagonal tile
+    /// \param factor The scaling factor
+    /// \param gemm_config The contraction meta data
+    template <typename T, typename A, typename Diag, typename Scalar>
+    inline void diagonal_gemm(Tensor<T, A>& result, const Tensor<T, A>& left,
+        const Diag& right, const Scalar factor,
+        const math::GemmHelper& gemm_config)
+    {
+      TA_USER_ASSERT((gemm_config.right_rank() == 2u) &&
+          (gemm_config.num_contract_ranks() == 1u),
+          "diagonal_gemm(): diagonal tiles must be rank 2 and contracted over one dimension.");
+      TA_ASSERT(! result.empty());
+
+      const unsigned int outer = gemm_config.right_outer_begin();
+      const unsigned int inner = gemm_config.right_inner_begin();
+      const auto& diag_range = right.range();
+      const auto* MADNESS_RESTRICT const lower = diag_range.lobound_data();
+      const auto* MADNESS_RESTRICT const upper = diag_range.upbound_data();
+
+      integer m = 1, n = 1, k = 1;
+      gemm_config.compute_matrix_sizes(m, n, k, left.range(), diag_range);
+
+      const std::size_t first = std::max(lower[outer], lower[inner]);
+      const std::size_t last = std::min(upper[outer], upper[inner]);
+      const bool trans = (gemm_config.left_op() != madness::cblas::NoTrans);
+      const T* MADNESS_RESTRICT const left_data = left.data();
+      T* MADNESS_RESTRICT const result_data = result.data();
+      for(std::size_t j = first; j < last; ++j) {
+        const T d = T(right.diagonal(j)) * factor;
+        const std::size_t col = j - lower[inner];
+        T* MADNESS_RESTRICT const result_col = result_data + (j - lower[outer]);
+        if(trans) {
+          const T* MADNESS_RESTRICT const left_row = left_data + col * m;
+          for(integer i = 0; i < m; ++i)
+            result_col[i * n] += d * left_row[i];
+        } else {
+          for(integer i = 0; i < m; ++i)
+            result_col[i * n] += d * left_data[i * k + col];
+        }
+      }
+    }
+
+  } // namespace detail
+
+  /// Diagonal tile
+
+  /// A diagonal tile is zero except for the hyper-diagonal elements,
+  /// <tt>(i, i, ..., i)</tt> , which are the only elements that are stored.
+  /// Contractions of rank-2 diagonal tiles with tensors are evaluated as
+  /// row or column scalings, and Hadamard products, additions, and
+  /// subtractions only touch the diagonal elements of the tensor argument.
+  /// \tparam T The element type
+  template <typename T>
+  class DiagonalTile {
+  public:
+    typedef DiagonalTile<T> DiagonalTile_; ///< This class type
+    typedef Range range_type; ///< Tile range type
+    typedef T value_type; ///< Element type
+    typedef typename Tensor<T>::numeric_type numeric_type; ///< Numeric type
+    typedef typename Tensor<T>::scalar_type scalar_type; ///< Scalar type
+    typedef std::size_t size_type; ///< Size type
+
+  private:
+    range_type range_; ///< The tile range
+    Tensor<T> diag_; ///< The diagonal elements
+
+  public:
+
+    /// Construct an empty tile
+    DiagonalTile() : range_(), diag_() { }
+
+    /// Construct a diagonal tile with a constant diagonal
+
+    /// \param range The tile range
+    /// \param value The value of the diagonal elements
+    DiagonalTile(const range_type& range, const value_type value) :
+      range_(range), diag_(detail::diagonal_range(range), value)
+    { }
+
+    /// Construct a diagonal tile
+
+    /// \param range The tile range
+    /// \param diag The diagonal elements, where the range of \c diag is
+    /// <tt>detail::diagonal_range(range)</tt>
+    DiagonalTile(const range_type& range, const Tensor<T>& diag) :
+      range_(range), diag_(diag)
+    {
+      TA_ASSERT(diag_.range() == detail::diagonal_range(range_));
+    }
+
+    DiagonalTile(const DiagonalTile_&) = default;
+    DiagonalTile(DiagonalTile_&&) = default;
+    DiagonalTile_& operator=(const DiagonalTile_&) = default;
+    DiagonalTile_& operator=(DiagonalTile_&&) = default;
+
+    /// Deep copy
+
+    /// \return A deep copy of this tile
+    DiagonalTile_ clone() const { return DiagonalTile_(range_, diag_.clone()); }
+
+    /// Tile range accessor
+
+    /// \return The tile range
+    const range_type& range() const { return range_; }
+
+    /// Check for an empty tile
+
+    /// \return \c true if this tile was default constructed
+    bool empty() const { return range_.volume() == 0ul; }
+
+    /// Diagonal element accessor
+
+    /// \return The diagonal elements of this tile
+    const Tensor<T>& diagonal() const { return diag_; }
+
+    /// Diagonal element accessor
+
+    /// \param i The element index of a diagonal element in this tile
+    /// \return The value of element <tt>(i, i, ..., i)</tt>
+    value_type diagonal(const std::size_t i) const {
+      TA_ASSERT(i >= diag_.range().lobound_data()[0]);
+      TA_ASSERT(i < diag_.range().upbound_data()[0]);
+      return diag_.data()[i - diag_.range().lobound_data()[0]];
+    }
+
+    /// Convert to a dense tensor
+
+    /// \return A tensor that holds all elements of this tile
+    explicit operator Tensor<T>() const {
+      Tensor<T> result(range_, T(0));
+      if(diag_.size())
+        detail::diagonal_axpy(result, *this, T(1));
+      return result;
+    }
+
+    /// Permute this tile
+
+    /// The diagonal is invariant under permutation of the dimensions, so
+    /// only the range is permuted.
+    /// \param perm The permutation to be applied to this tile
+    /// \return A permuted copy of this tile
+    DiagonalTile_ permute(const Permutation& perm) const {
+      return DiagonalTile_(perm * range_, diag_);
+    }
+
+    /// Scale this tile
+
+    /// \param factor The scaling factor
+    /// \return A copy of this tile scaled by \c factor
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    DiagonalTile_ scale(const Scalar factor) const {
+      return DiagonalTile_(range_, diag_.scale(factor));
+    }
+
+    /// Scale and permute this tile
+
+    /// \param factor The scaling factor
+    /// \param perm The permutation to be applied to this tile
+    /// \return A permuted copy of this tile scaled by \c factor
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    DiagonalTile_ scale(const Scalar factor, const Permutation& perm) const {
+      return DiagonalTile_(perm * range_, diag_.scale(factor));
+    }
+
+    /// Scale this tile in place
+
+    /// \param factor The scaling factor
+    /// \return A reference to this tile
+    template <typename Scalar,
+        typename std::enable_if<detail::is_numeric<Scalar>::value>::type* = nullptr>
+    DiagonalTile_& scale_to(const Scalar factor) {
+      diag_.scale_to(factor);
+      return *this;
+    }
+
+    /// Negate this tile
+
+    /// \return A negated copy of this tile
+    DiagonalTile_ neg() const { return DiagonalTile_(range_, diag_.neg()); }
+
+    /// Negate and permute this tile
+
+    /// \param perm The permutation to be applied to this tile
+    /// \return A negated and permuted copy of this tile
+    DiagonalTile_ neg(const Permutation& perm) const {
+      return DiagonalTile_(perm * range_, diag_.neg());
+    }
+
+    /// Negate this tile in place
+
+    /// \return A reference to this tile
+    DiagonalTile_& neg_to() {
+      diag_.neg_to();
+      return *this;
+    }
+
+    /// Vector 2-norm of this tile
+
+    /// \return The 2-norm of the diagonal elements
+    scalar_type norm() const { return diag_.norm(); }
+
+    /// Squared vector 2-norm of this tile
+
+    /// \return The squared 2-norm of the diagonal elements
+    scalar_type squared_norm() const { return diag_.squared_norm(); }
+
+    /// Serialize this tile
+
+    /// \tparam Archive The archive type
+    /// \param ar The archive
+    template <typename Archive>
+    void serialize(Archive& ar) { ar & range_ & diag_; }
+
+  }; // class DiagonalTile
+
+
+  // Contraction operations ----------------------------------------------------
+
+  /// Contract a diagonal tile with a tensor
+
+  /// \tparam Diag The diagonal tile type
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand diagonal tile
+  /// \param right The right-hand tensor
+  /// \param factor The scaling factor
+  /// \param gemm_config The contraction meta data
+  /// \return A tensor that is equal to <tt>(left * right) * factor</tt>
+  template <typename Diag, typename T, typename A, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A> gemm(const Diag& left, const Tensor<T, A>& right,
+      const Scalar factor, const math::GemmHelper& gemm_config)
+  {
+    Tensor<T, A> result(gemm_config.make_result_range<Range>(left.range(),
+        right.range()), T(0));
+    detail::diagonal_gemm(result, left, right, factor, gemm_config);
+    return result;
+  }
+
+  /// Contract a tensor with a diagonal tile
+
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \tparam Diag The diagonal tile type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand tensor
+  /// \param right The right-hand diagonal tile
+  /// \param factor The scaling factor
+  /// \param gemm_config The contraction meta data
+  /// \return A tensor that is equal to <tt>(left * right) * factor</tt>
+  template <typename T, typename A, typename Diag, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A> gemm(const Tensor<T, A>& left, const Diag& right,
+      const Scalar factor, const math::GemmHelper& gemm_config)
+  {
+    Tensor<T, A> result(gemm_config.make_result_range<Range>(left.range(),
+        right.range()), T(0));
+    detail::diagonal_gemm(result, left, right, factor, gemm_config);
+    return result;
+  }
+
+  /// Contract a diagonal tile with a tensor and add to the result tile
+
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \tparam Diag The diagonal tile type
+  /// \tparam Scalar A scalar type
+  /// \param result The result tensor
+  /// \param left The left-hand diagonal tile
+  /// \param right The right-hand tensor
+  /// \param factor The scaling factor
+  /// \param gemm_config The contraction meta data
+  /// \return A reference to \c result
+  template <typename T, typename A, typename Diag, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A>& gemm(Tensor<T, A>& result, const Diag& left,
+      const Tensor<T, A>& right, const Scalar factor,
+      const math::GemmHelper& gemm_config)
+  {
+    detail::diagonal_gemm(result, left, right, factor, gemm_config);
+    return result;
+  }
+
+  /// Contract a tensor with a diagonal tile and add to the result tile
+
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \tparam Diag The diagonal tile type
+  /// \tparam Scalar A scalar type
+  /// \param result The result tensor
+  /// \param left The left-hand tensor
+  /// \param right The right-hand diagonal tile
+  /// \param factor The scaling factor
+  /// \param gemm_config The contraction meta data
+  /// \return A reference to \c result
+  template <typename T, typename A, typename Diag, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A>& gemm(Tensor<T, A>& result, const Tensor<T, A>& left,
+      const Diag& right, const Scalar factor,
+      const math::GemmHelper& gemm_config)
+  {
+    detail::diagonal_gemm(result, left, right, factor, gemm_config);
+    return result;
+  }
+
+  // Multiplication operations -------------------------------------------------
+
+  /// Hadamard product of a diagonal tile and a tensor
+
+  /// \tparam Diag The diagonal tile type
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \param left The left-hand diagonal tile
+  /// \param right The right-hand tensor
+  /// \return A tensor that is equal to <tt>left[i] * right[i]</tt>
+  template <typename Diag, typename T, typename A,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A> mult(const Diag& left, const Tensor<T, A>& right) {
+    return detail::diagonal_mult(left, right, T(1));
+  }
+
+  /// Hadamard product of a tensor and a diagonal tile
+
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \tparam Diag The diagonal tile type
+  /// \param left The left-hand tensor
+  /// \param right The right-hand diagonal tile
+  /// \return A tensor that is equal to <tt>left[i] * right[i]</tt>
+  template <typename T, typename A, typename Diag,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A> mult(const Tensor<T, A>& left, const Diag& right) {
+    return detail::diagonal_mult(right, left, T(1));
+  }
+
+  /// Scaled Hadamard product of a diagonal tile and a tensor
+
+  /// \return A tensor that is equal to <tt>left[i] * right[i] * factor</tt>
+  template <typename Diag, typename T, typename A, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  mult(const Diag& left, const Tensor<T, A>& right, const Scalar factor) {
+    return detail::diagonal_mult(left, right, factor);
+  }
+
+  /// Scaled Hadamard product of a tensor and a diagonal tile
+
+  /// \return A tensor that is equal to <tt>left[i] * right[i] * factor</tt>
+  template <typename T, typename A, typename Diag, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  mult(const Tensor<T, A>& left, const Diag& right, const Scalar factor) {
+    return detail::diagonal_mult(right, left, factor);
+  }
+
+  /// Permuted Hadamard product of a diagonal tile and a tensor
+
+  /// \return A tensor that is equal to <tt>perm ^ (left[i] * right[i])</tt>
+  template <typename Diag, typename T, typename A,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  mult(const Diag& left, const Tensor<T, A>& right, const Permutation& perm) {
+    return detail::diagonal_mult(left, right, T(1)).permute(perm);
+  }
+
+  /// Permuted Hadamard product of a tensor and a diagonal tile
+
+  /// \return A tensor that is equal to <tt>perm ^ (left[i] * right[i])</tt>
+  template <typename T, typename A, typename Diag,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  mult(const Tensor<T, A>& left, const Diag& right, const Permutation& perm) {
+    return detail::diagonal_mult(right, left, T(1)).permute(perm);
+  }
+
+  /// Scaled and permuted Hadamard product of a diagonal tile and a tensor
+
+  /// \return A tensor that is equal to
+  /// <tt>perm ^ (left[i] * right[i] * factor)</tt>
+  template <typename Diag, typename T, typename A, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A> mult(const Diag& left, const Tensor<T, A>& right,
+      const Scalar factor, const Permutation& perm)
+  {
+    return detail::diagonal_mult(left, right, factor).permute(perm);
+  }
+
+  /// Scaled and permuted Hadamard product of a tensor and a diagonal tile
+
+  /// \return A tensor that is equal to
+  /// <tt>perm ^ (left[i] * right[i] * factor)</tt>
+  template <typename T, typename A, typename Diag, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A> mult(const Tensor<T, A>& left, const Diag& right,
+      const Scalar factor, const Permutation& perm)
+  {
+    return detail::diagonal_mult(right, left, factor).permute(perm);
+  }
+
+  /// Multiply a tensor by a diagonal tile
+
+  /// \return A reference to \c result , where <tt>result[i] *= arg[i]</tt>
+  template <typename T, typename A, typename Diag,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A>& mult_to(Tensor<T, A>& result, const Diag& arg) {
+    result = detail::diagonal_mult(arg, result, T(1));
+    return result;
+  }
+
+  // Addition operations -------------------------------------------------------
+
+  /// Add a diagonal tile and a tensor
+
+  /// \tparam Diag The diagonal tile type
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \param left The left-hand diagonal tile
+  /// \param right The right-hand tensor
+  /// \return A tensor that is equal to <tt>left[i] + right[i]</tt>
+  template <typename Diag, typename T, typename A,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A> add(const Diag& left, const Tensor<T, A>& right) {
+    Tensor<T, A> result = right.clone();
+    detail::diagonal_axpy(result, left, T(1));
+    return result;
+  }
+
+  /// Add a tensor and a diagonal tile
+
+  /// \return A tensor that is equal to <tt>left[i] + right[i]</tt>
+  template <typename T, typename A, typename Diag,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A> add(const Tensor<T, A>& left, const Diag& right) {
+    return add(right, left);
+  }
+
+  /// Add and scale a diagonal tile and a tensor
+
+  /// \return A tensor that is equal to <tt>(left[i] + right[i]) * factor</tt>
+  template <typename Diag, typename T, typename A, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  add(const Diag& left, const Tensor<T, A>& right, const Scalar factor) {
+    Tensor<T, A> result = right.scale(factor);
+    detail::diagonal_axpy(result, left, factor);
+    return result;
+  }
+
+  /// Add and scale a tensor and a diagonal tile
+
+  /// \return A tensor that is equal to <tt>(left[i] + right[i]) * factor</tt>
+  template <typename T, typename A, typename Diag, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  add(const Tensor<T, A>& left, const Diag& right, const Scalar factor) {
+    return add(right, left, factor);
+  }
+
+  /// Add and permute a diagonal tile and a tensor
+
+  /// \return A tensor that is equal to <tt>perm ^ (left[i] + right[i])</tt>
+  template <typename Diag, typename T, typename A,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  add(const Diag& left, const Tensor<T, A>& right, const Permutation& perm) {
+    return add(left, right).permute(perm);
+  }
+
+  /// Add and permute a tensor and a diagonal tile
+
+  /// \return A tensor that is equal to <tt>perm ^ (left[i] + right[i])</tt>
+  template <typename T, typename A, typename Diag,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  add(const Tensor<T, A>& left, const Diag& right, const Permutation& perm) {
+    return add(right, left).permute(perm);
+  }
+
+  /// Add, scale, and permute a diagonal tile and a tensor
+
+  /// \return A tensor that is equal to
+  /// <tt>perm ^ ((left[i] + right[i]) * factor)</tt>
+  template <typename Diag, typename T, typename A, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A> add(const Diag& left, const Tensor<T, A>& right,
+      const Scalar factor, const Permutation& perm)
+  {
+    return add(left, right, factor).permute(perm);
+  }
+
+  /// Add, scale, and permute a tensor and a diagonal tile
+
+  /// \return A tensor that is equal to
+  /// <tt>perm ^ ((left[i] + right[i]) * factor)</tt>
+  template <typename T, typename A, typename Diag, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A> add(const Tensor<T, A>& left, const Diag& right,
+      const Scalar factor, const Permutation& perm)
+  {
+    return add(right, left, factor).permute(perm);
+  }
+
+  /// Add a diagonal tile to a tensor
+
+  /// \return A reference to \c result , where <tt>result[i] += arg[i]</tt>
+  template <typename T, typename A, typename Diag,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A>& add_to(Tensor<T, A>& result, const Diag& arg) {
+    detail::diagonal_axpy(result, arg, T(1));
+    return result;
+  }
+
+  // Subtraction operations ----------------------------------------------------
+
+  /// Subtract a tensor from a diagonal tile
+
+  /// \tparam Diag The diagonal tile type
+  /// \tparam T The tensor element type
+  /// \tparam A The tensor allocator type
+  /// \param left The left-hand diagonal tile
+  /// \param right The right-hand tensor
+  /// \return A tensor that is equal to <tt>left[i] - right[i]</tt>
+  template <typename Diag, typename T, typename A,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A> subt(const Diag& left, const Tensor<T, A>& right) {
+    Tensor<T, A> result = right.neg();
+    detail::diagonal_axpy(result, left, T(1));
+    return result;
+  }
+
+  /// Subtract a diagonal tile from a tensor
+
+  /// \return A tensor that is equal to <tt>left[i] - right[i]</tt>
+  template <typename T, typename A, typename Diag,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A> subt(const Tensor<T, A>& left, const Diag& right) {
+    Tensor<T, A> result = left.clone();
+    detail::diagonal_axpy(result, right, T(-1));
+    return result;
+  }
+
+  /// Subtract and scale a tensor from a diagonal tile
+
+  /// \return A tensor that is equal to <tt>(left[i] - right[i]) * factor</tt>
+  template <typename Diag, typename T, typename A, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  subt(const Diag& left, const Tensor<T, A>& right, const Scalar factor) {
+    Tensor<T, A> result = right.scale(-factor);
+    detail::diagonal_axpy(result, left, factor);
+    return result;
+  }
+
+  /// Subtract and scale a diagonal tile from a tensor
+
+  /// \return A tensor that is equal to <tt>(left[i] - right[i]) * factor</tt>
+  template <typename T, typename A, typename Diag, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  subt(const Tensor<T, A>& left, const Diag& right, const Scalar factor) {
+    Tensor<T, A> result = left.scale(factor);
+    detail::diagonal_axpy(result, right, -factor);
+    return result;
+  }
+
+  /// Subtract and permute a tensor from a diagonal tile
+
+  /// \return A tensor that is equal to <tt>perm ^ (left[i] - right[i])</tt>
+  template <typename Diag, typename T, typename A,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  subt(const Diag& left, const Tensor<T, A>& right, const Permutation& perm) {
+    return subt(left, right).permute(perm);
+  }
+
+  /// Subtract and permute a diagonal tile from a tensor
+
+  /// \return A tensor that is equal to <tt>perm ^ (left[i] - right[i])</tt>
+  template <typename T, typename A, typename Diag,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A>
+  subt(const Tensor<T, A>& left, const Diag& right, const Permutation& perm) {
+    return subt(left, right).permute(perm);
+  }
+
+  /// Subtract, scale, and permute a tensor from a diagonal tile
+
+  /// \return A tensor that is equal to
+  /// <tt>perm ^ ((left[i] - right[i]) * factor)</tt>
+  template <typename Diag, typename T, typename A, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A> subt(const Diag& left, const Tensor<T, A>& right,
+      const Scalar factor, const Permutation& perm)
+  {
+    return subt(left, right, factor).permute(perm);
+  }
+
+  /// Subtract, scale, and permute a diagonal tile from a tensor
+
+  /// \return A tensor that is equal to
+  /// <tt>perm ^ ((left[i] - right[i]) * factor)</tt>
+  template <typename T, typename A, typename Diag, typename Scalar,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value &&
+          detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Tensor<T, A> subt(const Tensor<T, A>& left, const Diag& right,
+      const Scalar factor, const Permutation& perm)
+  {
+    return subt(left, right, factor).permute(perm);
+  }
+
+  /// Subtract a diagonal tile from a tensor
+
+  /// \return A reference to \c result , where <tt>result[i] -= arg[i]</tt>
+  template <typename T, typename A, typename Diag,
+      typename std::enable_if<detail::is_diagonal_tile<Diag>::value>::type* = nullptr>
+  inline Tensor<T, A>& subt_to(Tensor<T, A>& result, const Diag& arg) {
+    detail::diagonal_axpy(result, arg, T(-1));
+    return result;
+  }
+
+  /// DiagonalTile output operator
+
+  /// \tparam T The element type
+  /// \param os The output stream
+  /// \param tile The tile to be printed
+  /// \return A reference to the output stream
+  template <typename T>
+  inline std::ostream& operator<<(std::ostream& os, const DiagonalTile<T>& tile) {
+    os << tile.range() << " diagonal: " << tile.diagonal();
+    return os;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SPECIAL_DIAGONAL_TILE_H__INCLUDED
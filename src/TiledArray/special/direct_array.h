@@ -0,0 +1,316 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  direct_array.h
+ *
+ */
+
+#ifndef TILEDARRAY_SPECIAL_DIRECT_ARRAY_H__INCLUDED
+#define TILEDARRAY_SPECIAL_DIRECT_ARRAY_H__INCLUDED
+
+#include <TiledArray/dist_array.h>
+#include <TiledArray/tile_interface/clone.h>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+namespace TiledArray {
+
+  /// Generator of the tiles of a direct array
+
+  /// The generator holds the user function that computes the tiles of a
+  /// direct array, and a bounded, least-recently-used cache of generated
+  /// tiles. The cache is local to each process, and tiles are only generated
+  /// by the process that owns them. Cached tiles are reused when the same
+  /// tile is needed more than once, e.g. by consecutive contractions in an
+  /// iterative procedure.
+  /// \tparam Tile The type of the generated tiles
+  template <typename Tile>
+  class DirectTileGenerator : private madness::Spinlock {
+  public:
+    typedef DirectTileGenerator<Tile> DirectTileGenerator_; ///< This class type
+    typedef Tile tile_type; ///< The generated tile type
+    typedef std::size_t size_type; ///< Size type
+    typedef std::function<tile_type(const Range&)> op_type; ///< The tile generator function type
+
+  private:
+    typedef std::list<size_type> lru_type; ///< Tile indices, most recently used first
+    typedef std::unordered_map<size_type, std::pair<tile_type,
+        typename lru_type::iterator> > cache_type; ///< Cached tiles
+
+    op_type op_; ///< The tile generator function
+    float cost_; ///< The relative cost of generating a tile
+    size_type capacity_; ///< The maximum number of cached tiles
+    lru_type lru_; ///< Cache usage order
+    cache_type cache_; ///< Cached tiles
+    size_type hits_; ///< The number of tiles found in the cache
+    size_type misses_; ///< The number of generated tiles
+
+  public:
+
+    /// Constructor
+
+    /// \param op The tile generator function, with the signature
+    /// <tt>tile_type op(const Range&)</tt>
+    /// \param capacity The maximum number of tiles cached by each process
+    /// \param cost The cost of generating a tile relative to contracting it
+    DirectTileGenerator(const op_type& op, const size_type capacity,
+        const float cost) :
+      madness::Spinlock(), op_(op), cost_(cost), capacity_(capacity),
+      lru_(), cache_(), hits_(0ul), misses_(0ul)
+    {
+      TA_USER_ASSERT(cost_ >= 0.0f,
+          "DirectTileGenerator::DirectTileGenerator(): the generator cost must be non-negative.");
+    }
+
+    DirectTileGenerator(const DirectTileGenerator_&) = delete;
+    DirectTileGenerator_& operator=(const DirectTileGenerator_&) = delete;
+
+    /// Get a tile
+
+    /// The tile is taken from the cache, if present, otherwise it is
+    /// generated and inserted into the cache. The generator function is
+    /// called outside the cache lock, so the same tile may be generated
+    /// concurrently by different threads.
+    /// \param index The ordinal index of the tile
+    /// \param range The range of the tile
+    /// \return A tile that does not share data with the cache
+    tile_type operator()(const size_type index, const Range& range) {
+      using TiledArray::clone;
+      {
+        madness::ScopedMutex<madness::Spinlock> locker(this);
+        typename cache_type::iterator it = cache_.find(index);
+        if(it != cache_.end()) {
+          ++hits_;
+          lru_.splice(lru_.begin(), lru_, it->second.second);
+          return clone(it->second.first);
+        }
+        ++misses_;
+      }
+
+      tile_type tile = op_(range);
+      if(capacity_ == 0ul)
+        return tile;
+
+      // Insert a copy of the tile, since the result may be consumed
+      tile_type cached = clone(tile);
+      madness::ScopedMutex<madness::Spinlock> locker(this);
+      if(cache_.find(index) == cache_.end()) {
+        lru_.push_front(index);
+        cache_.emplace(index, std::make_pair(std::move(cached), lru_.begin()));
+        while(cache_.size() > capacity_) {
+          cache_.erase(lru_.back());
+          lru_.pop_back();
+        }
+      }
+
+      return tile;
+    }
+
+    /// Generator cost accessor
+
+    /// \return The cost of generating a tile relative to contracting it
+    float cost() const { return cost_; }
+
+    /// Cache capacity accessor
+
+    /// \return The maximum number of tiles cached by this process
+    size_type capacity() const { return capacity_; }
+
+    /// Cache hit count accessor
+
+    /// \return The number of tiles that were taken from the cache
+    size_type hits() const {
+      madness::ScopedMutex<madness::Spinlock> locker(this);
+      return hits_;
+    }
+
+    /// Cache miss count accessor
+
+    /// \return The number of tiles that were generated
+    size_type misses() const {
+      madness::ScopedMutex<madness::Spinlock> locker(this);
+      return misses_;
+    }
+
+    /// Remove all tiles from the cache
+    void clear() {
+      madness::ScopedMutex<madness::Spinlock> locker(this);
+      cache_.clear();
+      lru_.clear();
+    }
+
+  }; // class DirectTileGenerator
+
+  /// Lazy tile of a direct array
+
+  /// A direct tile holds the tile index and a pointer to the generator of
+  /// the array, and is converted to its evaluated tile type on demand (see
+  /// \c make_direct_array() ). When a direct tile is sent to another process
+  /// it is generated by the sender, so the generator never leaves the
+  /// process that owns the tile.
+  /// \tparam Tile The evaluated tile type
+  template <typename Tile>
+  class DirectTile {
+  public:
+    typedef DirectTile<Tile> DirectTile_; ///< This class type
+    typedef Tile eval_type; ///< The evaluated tile type
+    typedef Range range_type; ///< The tile range type
+    typedef DirectTileGenerator<Tile> generator_type; ///< The generator type
+    typedef std::size_t size_type; ///< Size type
+
+  private:
+    range_type range_; ///< The tile range
+    size_type index_; ///< The ordinal index of the tile
+    std::shared_ptr<generator_type> generator_; ///< The tile generator
+    std::shared_ptr<eval_type> tile_; ///< The tile data, for tiles received from other processes
+
+  public:
+
+    /// Default constructor
+    DirectTile() : range_(), index_(0ul), generator_(), tile_() { }
+
+    /// Constructor
+
+    /// \param range The tile range
+    /// \param index The ordinal index of the tile
+    /// \param generator The tile generator
+    DirectTile(const range_type& range, const size_type index,
+        const std::shared_ptr<generator_type>& generator) :
+      range_(range), index_(index), generator_(generator), tile_()
+    { }
+
+    DirectTile(const DirectTile_&) = default;
+    DirectTile(DirectTile_&&) = default;
+    DirectTile_& operator=(const DirectTile_&) = default;
+    DirectTile_& operator=(DirectTile_&&) = default;
+
+    /// Tile range accessor
+
+    /// \return The tile range
+    const range_type& range() const { return range_; }
+
+    /// Generator cost accessor
+
+    /// \return The cost of generating this tile relative to contracting it
+    float cost() const { return (generator_ ? generator_->cost() : 0.0f); }
+
+    /// Evaluate this tile
+
+    /// \return The generated tile
+    explicit operator eval_type() const {
+      if(tile_) {
+        using TiledArray::clone;
+        return clone(*tile_);
+      }
+      TA_ASSERT(generator_);
+      return (*generator_)(index_, range_);
+    }
+
+    /// Output serialization function
+
+    /// The tile is generated and its data is serialized.
+    template <typename Archive,
+        typename std::enable_if<
+          madness::archive::is_output_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      eval_type tile = static_cast<eval_type>(*this);
+      ar & range_ & index_ & tile;
+    }
+
+    /// Input serialization function
+    template <typename Archive,
+        typename std::enable_if<
+          madness::archive::is_input_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      eval_type tile;
+      ar & range_ & index_ & tile;
+      generator_.reset();
+      tile_ = std::make_shared<eval_type>(std::move(tile));
+    }
+
+  }; // class DirectTile
+
+  /// Construct a direct array
+
+  /// The tiles of a direct array are computed by \c op when they are needed
+  /// by an expression, instead of being stored, as in integral-direct
+  /// methods. Each process caches at most \c cache_size tiles for reuse.
+  /// Direct arrays may be used as arguments of expressions, but not assigned
+  /// to.
+  /// \code
+  /// auto eri = make_direct_array<TensorD>(world, trange, shape,
+  ///     [] (const Range& range) { return compute_integrals(range); }, 64ul, 10.0f);
+  /// K("i,j,P") = C("m,i") * eri("m,j,P");
+  /// \endcode
+  /// \tparam Tile The generated tile type
+  /// \tparam Policy The array policy type
+  /// \tparam Op The tile generator type
+  /// \param world The world where the array will live
+  /// \param trange The tiled range of the array
+  /// \param shape The shape of the array; only non-zero tiles are generated
+  /// \param op The tile generator, with the signature
+  /// <tt>Tile op(const Range&)</tt> ; it must be thread safe
+  /// \param cache_size The maximum number of tiles cached by each process
+  /// \param cost The cost of generating a tile relative to contracting it,
+  /// which is used to increase the number of concurrent SUMMA iterations
+  /// \return A direct array
+  template <typename Tile, typename Policy, typename Op>
+  inline DistArray<DirectTile<Tile>, Policy>
+  make_direct_array(World& world, const TiledRange& trange,
+      const typename Policy::shape_type& shape, Op&& op,
+      const std::size_t cache_size = 0ul, const float cost = 1.0f)
+  {
+    typedef DistArray<DirectTile<Tile>, Policy> array_type;
+
+    auto generator = std::make_shared<DirectTileGenerator<Tile> >(
+        std::forward<Op>(op), cache_size, cost);
+
+    array_type result(world, trange, shape);
+    for(auto index : *result.pmap()) {
+      if(result.is_zero(index))
+        continue;
+      result.set(index, DirectTile<Tile>(trange.make_tile_range(index), index,
+          generator));
+    }
+
+    return result;
+  }
+
+  /// Construct a dense direct array
+
+  /// \tparam Tile The generated tile type
+  /// \tparam Op The tile generator type
+  /// \param world The world where the array will live
+  /// \param trange The tiled range of the array
+  /// \param op The tile generator, with the signature
+  /// <tt>Tile op(const Range&)</tt> ; it must be thread safe
+  /// \param cache_size The maximum number of tiles cached by each process
+  /// \param cost The cost of generating a tile relative to contracting it
+  /// \return A dense direct array
+  template <typename Tile, typename Op>
+  inline DistArray<DirectTile<Tile>, DensePolicy>
+  make_direct_array(World& world, const TiledRange& trange, Op&& op,
+      const std::size_t cache_size = 0ul, const float cost = 1.0f)
+  {
+    return make_direct_array<Tile, DensePolicy>(world, trange, DenseShape(),
+        std::forward<Op>(op), cache_size, cost);
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SPECIAL_DIRECT_ARRAY_H__INCLUDED
@@ -31,6 +31,7 @@
 #include <TiledArray/tensor.h>
 #include <TiledArray/tile.h>
 #include <TiledArray/tile_op/tile_interface.h>
+#include <TiledArray/special/diagonal_tile.h>
 
 // Array policy classes
 #include <TiledArray/policies/dense_policy.h>
@@ -92,6 +93,12 @@ template<unsigned _N = 1>
 
       bool empty() const { return empty_; }
 
+      /// Diagonal element accessor
+
+      /// \return The value of diagonal element <tt>(i, i, ..., i)</tt> , which
+      /// is always 1
+      value_type diagonal(const std::size_t) const { return 1; }
+
       /// MADNESS compliant serialization
       template<typename Archive>
       void
@@ -114,6 +121,17 @@ template<unsigned _N = 1>
 
   }; // class KroneckerDeltaTile
 
+namespace TiledArray {
+  namespace detail {
+
+    /// An ordinary Kronecker delta is a diagonal tile, so its products and
+    /// sums with tensors do not construct a dense identity tile
+    template <>
+    struct is_diagonal_tile<KroneckerDeltaTile<1> > : public std::true_type { };
+
+  } // namespace detail
+} // namespace TiledArray
+
 // these are to satisfy interfaces, but not needed, actually
 
 // Sum of hyper diagonal elements
@@ -152,18 +170,25 @@ abs_max(const KroneckerDeltaTile<_N>& arg);
 // Permutation operation
 
 // returns a tile for which result[perm ^ i] = tile[i]
+// a product of deltas is invariant under permutations that map each pair of
+// delta indices to a pair, e.g. the transpose of an ordinary delta
 template <unsigned N>
 KroneckerDeltaTile<N> permute(const KroneckerDeltaTile<N>& tile,
                               const TiledArray::Permutation& perm) {
-  abort();
+  for (unsigned i = 0; i != 2*N; i += 2)
+    TA_USER_ASSERT(perm[i] / 2 == perm[i+1] / 2,
+        "permute(KroneckerDeltaTile): the permutation does not preserve the delta index pairs.");
+  return KroneckerDeltaTile<N>(perm * tile.range());
 }
 
 // dense_result[i] = dense_arg1[i] * sparse_arg2[i]
+// only the diagonal elements of arg2 are read
 template<typename T, unsigned _N>
   TiledArray::Tensor<T>
   mult (const KroneckerDeltaTile<_N>& arg1,
         const TiledArray::Tensor<T>& arg2) {
-  abort();
+  TA_USER_ASSERT(_N == 1, "mult(KroneckerDeltaTile): only implemented for N == 1.");
+  return TiledArray::detail::diagonal_mult(arg1, arg2, T(1));
 }
 // dense_result[perm ^ i] = dense_arg1[i] * sparse_arg2[i]
 template<typename T, unsigned _N>
@@ -171,7 +196,7 @@ template<typename T, unsigned _N>
   mult (const KroneckerDeltaTile<_N>& arg1,
         const TiledArray::Tensor<T>& arg2,
         const Permutation& perm) {
-  abort();
+  return mult(arg1, arg2).permute(perm);
 }
 
 // dense_result[i] *= sparse_arg1[i]
@@ -179,7 +204,7 @@ template<typename T, unsigned N>
   TiledArray::Tensor<T>&
   mult_to (TiledArray::Tensor<T>& result,
            const KroneckerDeltaTile<N>& arg1) {
-    abort();
+    result = mult(arg1, result);
     return result;
   }
 
@@ -187,6 +212,7 @@ template<typename T, unsigned N>
 
 // GEMM operation with fused indices as defined by gemm_config:
 // dense_result[i,j] = dense_arg1[i,k] * sparse_arg2[k,j]
+// contractions of an ordinary delta relabel the rows of arg2, and no GEMM is done
 template<typename T, unsigned N>
   TiledArray::Tensor<T>
   gemm (
@@ -196,8 +222,15 @@ template<typename T, unsigned N>
       const TiledArray::math::GemmHelper& gemm_config) {
 
   // preconditions:
-  // 1. implemented only outer product
-  assert(gemm_config.result_rank() == gemm_config.left_rank() + gemm_config.right_rank());
+  // 1. implemented outer products, and contractions over one index of an
+  //    ordinary delta
+  if (gemm_config.num_contract_ranks() != 0u) {
+    TA_USER_ASSERT(N == 1, "gemm(KroneckerDeltaTile): contractions are only implemented for N == 1.");
+    TiledArray::Tensor<T> result(gemm_config.make_result_range<TiledArray::Range>(
+        arg1.range(), arg2.range()), T(0));
+    TiledArray::detail::diagonal_gemm(result, arg1, arg2, factor, gemm_config);
+    return result;
+  }
 
   auto arg1_range = arg1.range();
   auto arg2_range = arg2.range();
@@ -217,7 +250,8 @@ template<typename T, unsigned N>
         for (decltype(i0_range) i0 = 0; i0 != i0_range; ++i0) {
           auto result_i0i0_ptr = result_data
               + (i0 * arg1_extents[1] + i0) * arg2_volume;
-          std::copy (arg2_data, arg2_data + arg2_volume, result_i0i0_ptr);
+          std::transform (arg2_data, arg2_data + arg2_volume, result_i0i0_ptr,
+                          [factor] (const T arg) { return arg * factor; });
         }
       }
         break;
@@ -231,7 +265,8 @@ template<typename T, unsigned N>
           for (decltype(i1_range) i1 = 0; i1 != i1_range; ++i1) {
             auto result_i0i0i1i1_ptr = result_i0i0i1i1_ptr_offset
                 + (i1 * arg1_extents[3] + i1) * arg2_volume;
-            std::copy (arg2_data, arg2_data + arg2_volume, result_i0i0i1i1_ptr);
+            std::transform (arg2_data, arg2_data + arg2_volume, result_i0i0i1i1_ptr,
+                            [factor] (const T arg) { return arg * factor; });
           }
         }
       }
@@ -254,7 +289,12 @@ template<typename T, unsigned N>
       const TiledArray::Tensor<T>& arg2,
       const typename TiledArray::Tensor<T>::numeric_type factor,
       const TiledArray::math::GemmHelper& gemm_config) {
-  abort();
+  if (gemm_config.num_contract_ranks() != 0u) {
+    TA_USER_ASSERT(N == 1, "gemm(KroneckerDeltaTile): contractions are only implemented for N == 1.");
+    TiledArray::detail::diagonal_gemm(result, arg1, arg2, factor, gemm_config);
+  } else {
+    result.add_to(gemm(arg1, arg2, factor, gemm_config));
+  }
   }
 
 #endif // TILEDARRAY_TEST_SPARSE_TILE_H__INCLUDED
@@ -0,0 +1,375 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tile_symmetry.h
+ *
+ */
+
+#ifndef TILEDARRAY_SYMM_TILE_SYMMETRY_H__INCLUDED
+#define TILEDARRAY_SYMM_TILE_SYMMETRY_H__INCLUDED
+
+#include <TiledArray/symm/permutation_group.h>
+#include <TiledArray/symm/representation.h>
+#include <TiledArray/permutation.h>
+#include <TiledArray/tiled_range.h>
+#include <TiledArray/dense_shape.h>
+#include <TiledArray/sparse_shape.h>
+#include <limits>
+
+namespace TiledArray {
+  namespace symmetry {
+
+    /// The identity of the phase (sign) representation
+    template <>
+    inline int identity<int>() { return 1; }
+
+    /// Permutational symmetry of the tiles of an array
+
+    /// A tile symmetry is a permutation group, \f$ G \f$ , that acts on the
+    /// dimensions of an array, and a phase, \f$ \chi(g) = \pm 1 \f$ , for each
+    /// element of the group, such that the elements of the array satisfy
+    /// \f$ t_{g \cdot i} = \chi(g) t_i \f$ . For example, the two-electron
+    /// amplitudes \c t2("i,j,a,b") are antisymmetric with respect to the
+    /// exchange of dimensions 0 and 1, and 2 and 3:
+    /// \code
+    /// auto t2_symm = TileSymmetry::antisymmetric({0, 1}) * TileSymmetry::antisymmetric({2, 3});
+    /// \endcode
+    /// If the tiled range of the array is invariant under the action of
+    /// \f$ G \f$ (see \c is_compatible() ), the tiles of the array are related
+    /// in the same way, i.e. the tile at \f$ g \cdot I \f$ is equal to the
+    /// tile at \f$ I \f$ permuted by \f$ g \f$ and scaled by \f$ \chi(g) \f$ .
+    /// Only the \em unique tiles, whose index is the lexicographically
+    /// smallest index in its orbit, need to be stored or computed.
+    class TileSymmetry {
+    public:
+      typedef symmetry::Permutation element_type; ///< Group element type
+      typedef element_type::index_type index_type; ///< Dimension index type
+      typedef std::map<element_type, int> map_type; ///< Element to phase map
+
+    private:
+      map_type generators_; ///< Group generators and their phases
+      map_type elements_; ///< Group elements and their phases
+
+      /// Construct the phases of all group elements
+      void init() {
+        if(generators_.empty()) {
+          elements_ = map_type{ { PermutationGroup::identity(), 1 } };
+          return;
+        }
+
+        elements_ = Representation<PermutationGroup, int>(generators_).representatives();
+
+        // Check that the phases are a representation of the group, otherwise
+        // the only tensor with this symmetry is zero.
+        for(const auto& e : elements_)
+          for(const auto& g : generators_)
+            TA_USER_ASSERT(elements_.at(e.first * g.first) == e.second * g.second,
+                "TileSymmetry::TileSymmetry(): the generator phases are not consistent.");
+      }
+
+      /// Construct the generators of the symmetric group on \c domain
+      static map_type transpositions(std::initializer_list<index_type> domain,
+          const int phase)
+      {
+        map_type result;
+        for(auto it = domain.begin(); (it != domain.end()) && ((it + 1) != domain.end()); ++it)
+          result.emplace(element_type(element_type::Map{ {*it, *(it + 1)}, {*(it + 1), *it} }), phase);
+        return result;
+      }
+
+    public:
+
+      /// Construct a trivial symmetry
+      TileSymmetry() : generators_(), elements_() { init(); }
+
+      TileSymmetry(const TileSymmetry&) = default;
+      TileSymmetry(TileSymmetry&&) = default;
+      TileSymmetry& operator=(const TileSymmetry&) = default;
+      TileSymmetry& operator=(TileSymmetry&&) = default;
+
+      /// Construct a symmetry from generators
+
+      /// \param generators A map of group generators to their phases, which
+      /// must be \c 1 or \c -1
+      /// \throw TiledArray::Exception When the phases are not consistent with
+      /// the group generated by \c generators
+      explicit TileSymmetry(map_type generators) :
+        generators_(), elements_()
+      {
+        for(auto& g : generators) {
+          TA_USER_ASSERT((g.second == 1) || (g.second == -1),
+              "TileSymmetry::TileSymmetry(): generator phases must be 1 or -1.");
+          if(g.first != PermutationGroup::identity())
+            generators_.insert(std::move(g));
+        }
+        init();
+      }
+
+      /// Symmetric group factory function
+
+      /// \param domain The dimensions that may be exchanged without a change
+      /// of sign
+      /// \return A symmetry that is invariant to any permutation of \c domain
+      static TileSymmetry symmetric(std::initializer_list<index_type> domain) {
+        return TileSymmetry(transpositions(domain, 1));
+      }
+
+      /// Antisymmetric group factory function
+
+      /// \param domain The dimensions that change the sign of the array when
+      /// two of them are exchanged
+      /// \return A symmetry where odd permutations of \c domain change sign
+      static TileSymmetry antisymmetric(std::initializer_list<index_type> domain) {
+        return TileSymmetry(transpositions(domain, -1));
+      }
+
+      /// Direct product of symmetries
+
+      /// \param other The other symmetry
+      /// \return The symmetry generated by the generators of this and \c other
+      TileSymmetry operator*(const TileSymmetry& other) const {
+        map_type generators = generators_;
+        generators.insert(other.generators_.begin(), other.generators_.end());
+        return TileSymmetry(std::move(generators));
+      }
+
+      /// Group order accessor
+
+      /// \return The number of elements in the group
+      std::size_t order() const { return elements_.size(); }
+
+      /// Check for a trivial symmetry
+
+      /// \return \c true if the group only contains the identity
+      bool trivial() const { return elements_.size() == 1ul; }
+
+      /// Group element accessor
+
+      /// \return A map of all group elements to their phases
+      const map_type& elements() const { return elements_; }
+
+      /// Phase accessor
+
+      /// \param g A group element
+      /// \return The phase of \c g
+      int phase(const element_type& g) const {
+        TA_ASSERT(elements_.find(g) != elements_.end());
+        return elements_.at(g);
+      }
+
+      /// Convert a group element to a \c TiledArray::Permutation
+
+      /// \param g A group element
+      /// \param rank The rank of the array
+      /// \return The permutation of \c rank dimensions equal to \c g
+      static TiledArray::Permutation
+      to_permutation(const element_type& g, const unsigned int rank) {
+        std::vector<index_type> p(rank);
+        for(unsigned int i = 0u; i < rank; ++i) {
+          p[i] = g[i];
+          TA_ASSERT(p[i] < rank);
+        }
+        return TiledArray::Permutation(std::move(p));
+      }
+
+      /// Check that a tiled range is compatible with this symmetry
+
+      /// \param trange The tiled range of an array
+      /// \return \c true if every group element maps each dimension of
+      /// \c trange to a dimension with the same tiling
+      bool is_compatible(const TiledRange& trange) const {
+        const unsigned int rank = trange.tiles_range().rank();
+        for(const auto& e : elements_) {
+          for(const auto& p : e.first) {
+            if((p.first >= rank) || (p.second >= rank) ||
+                (trange.data()[p.first] != trange.data()[p.second]))
+              return false;
+          }
+        }
+        return true;
+      }
+
+      /// Canonical tile index
+
+      /// \tparam Index The tile index type
+      /// \param index A tile index
+      /// \param[out] g The group element that maps the canonical index to
+      /// \c index , i.e. <tt>index == g * result</tt>
+      /// \return The lexicographically smallest index in the orbit of
+      /// \c index
+      template <typename Index>
+      Index canonical(const Index& index, element_type& g) const {
+        Index result = index;
+        g = PermutationGroup::identity();
+        for(const auto& e : elements_) {
+          Index candidate = index;
+          detail::permute_array(e.first, index, candidate);
+          if(std::lexicographical_compare(candidate.begin(), candidate.end(),
+              result.begin(), result.end()))
+          {
+            result = std::move(candidate);
+            g = e.first.inv();
+          }
+        }
+        return result;
+      }
+
+      /// Canonical tile index
+
+      /// \tparam Index The tile index type
+      /// \param index A tile index
+      /// \return The lexicographically smallest index in the orbit of
+      /// \c index
+      template <typename Index>
+      Index canonical(const Index& index) const {
+        element_type g;
+        return canonical(index, g);
+      }
+
+      /// Check for a unique tile
+
+      /// \tparam Index The tile index type
+      /// \param index A tile index
+      /// \return \c true if \c index is the canonical index of its orbit
+      template <typename Index>
+      bool is_unique(const Index& index) const {
+        Index candidate = index;
+        for(const auto& e : elements_) {
+          detail::permute_array(e.first, index, candidate);
+          if(std::lexicographical_compare(candidate.begin(), candidate.end(),
+              index.begin(), index.end()))
+            return false;
+        }
+        return true;
+      }
+
+      /// Serialization function
+
+      /// Only the generators are serialized; the group is regenerated when
+      /// the symmetry is deserialized.
+      template <typename Archive,
+          typename std::enable_if<
+            madness::archive::is_output_archive<Archive>::value>::type* = nullptr>
+      void serialize(Archive& ar) {
+        std::vector<std::pair<std::vector<index_type>, int> > generators;
+        for(const auto& g : generators_) {
+          std::vector<index_type> map;
+          for(const auto& p : g.first) {
+            map.push_back(p.first);
+            map.push_back(p.second);
+          }
+          generators.emplace_back(std::move(map), g.second);
+        }
+        ar & generators;
+      }
+
+      /// Serialization function
+      template <typename Archive,
+          typename std::enable_if<
+            madness::archive::is_input_archive<Archive>::value>::type* = nullptr>
+      void serialize(Archive& ar) {
+        std::vector<std::pair<std::vector<index_type>, int> > generators;
+        ar & generators;
+        map_type generator_map;
+        for(const auto& g : generators) {
+          element_type::Map map;
+          for(std::size_t i = 0ul; i < g.first.size(); i += 2ul)
+            map.emplace(g.first[i], g.first[i + 1ul]);
+          generator_map.emplace(element_type(std::move(map)), g.second);
+        }
+        *this = TileSymmetry(std::move(generator_map));
+      }
+
+    }; // class TileSymmetry
+
+    /// Mask of the unique tiles of a dense shape
+
+    /// Dense arrays store all tiles, so the mask does not remove any tiles.
+    /// \return A dense shape
+    inline DenseShape
+    unique_tile_mask(const DenseShape&, const TiledRange&, const TileSymmetry&) {
+      return DenseShape();
+    }
+
+    /// Mask of the unique tiles of a sparse shape
+
+    /// \tparam T The shape value type
+    /// \param shape The shape to be masked
+    /// \param trange The tiled range of the shape
+    /// \param symm The tile symmetry
+    /// \return A shape where the non-unique tiles are zero, for use with
+    /// \c SparseShape::mask()
+    template <typename T>
+    inline SparseShape<T>
+    unique_tile_mask(const SparseShape<T>& shape, const TiledRange& trange,
+        const TileSymmetry& symm)
+    {
+      TA_USER_ASSERT(symm.is_compatible(trange),
+          "unique_tile_mask(): the tiled range is not compatible with the symmetry.");
+      TA_ASSERT(shape.data().range() == trange.tiles_range());
+
+      const auto& tiles_range = trange.tiles_range();
+      Tensor<T> norms(tiles_range, T(0));
+      for(std::size_t ord = 0ul; ord < tiles_range.volume(); ++ord)
+        if(symm.is_unique(tiles_range.idx(ord)))
+          norms[ord] = std::numeric_limits<T>::max();
+
+      return SparseShape<T>(norms, trange);
+    }
+
+    /// Shape of all tiles of a dense array that stores only unique tiles
+
+    /// Dense arrays store all tiles, so the shape is not changed.
+    /// \param shape The shape of the unique tiles
+    /// \return \c shape
+    inline DenseShape
+    expand_shape(const DenseShape& shape, const TiledRange&, const TileSymmetry&) {
+      return shape;
+    }
+
+    /// Shape of all tiles of a sparse array that stores only unique tiles
+
+    /// The norm of each tile is the norm of its canonical tile. Shape data is
+    /// normalized by the tile volume, which is the same for all tiles in an
+    /// orbit.
+    /// \tparam T The shape value type
+    /// \param shape The shape of the unique tiles
+    /// \param trange The tiled range of the shape
+    /// \param symm The tile symmetry
+    /// \return The shape of all tiles
+    template <typename T>
+    inline SparseShape<T>
+    expand_shape(const SparseShape<T>& shape, const TiledRange& trange,
+        const TileSymmetry& symm)
+    {
+      TA_ASSERT(shape.data().range() == trange.tiles_range());
+
+      const auto& tiles_range = trange.tiles_range();
+      Tensor<T> norms(tiles_range, T(0));
+      for(std::size_t ord = 0ul; ord < tiles_range.volume(); ++ord) {
+        const auto canonical_index = symm.canonical(tiles_range.idx(ord));
+        norms[ord] = shape.data()[tiles_range.ordinal(canonical_index)] *
+            T(trange.make_tile_range(ord).volume());
+      }
+
+      return SparseShape<T>(norms, trange);
+    }
+
+  } // namespace symmetry
+} // namespace TiledArray
+
+#endif // TILEDARRAY_SYMM_TILE_SYMMETRY_H__INCLUDED
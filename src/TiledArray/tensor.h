@@ -31,6 +31,7 @@
 #include <TiledArray/tensor/tensor_interface.h>
 #include <TiledArray/tensor/shift_wrapper.h>
 #include <TiledArray/tensor/operators.h>
+#include <TiledArray/tensor/lazy_tensor.h>
 #include <TiledArray/block_range.h>
 
 namespace TiledArray {
@@ -0,0 +1,759 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  arena_tensor.h
+ *
+ */
+
+#ifndef TILEDARRAY_TENSOR_ARENA_TENSOR_H__INCLUDED
+#define TILEDARRAY_TENSOR_ARENA_TENSOR_H__INCLUDED
+
+#include <TiledArray/tensor.h>
+#include <TiledArray/tensor/tensor_map.h>
+#include <iosfwd>
+
+namespace TiledArray {
+
+  /// Tensor of tensors with contiguous storage
+
+  /// An arena tensor stores the same data as <tt>Tensor<Tensor<T> ></tt> ,
+  /// but all inner tensors of the tile are stored in one contiguous block of
+  /// memory (the arena), and the ranges of the inner tensors are stored in a
+  /// table of bounds and offsets. A tile is constructed with two allocations,
+  /// instead of one allocation per inner tensor, and the table is shared by
+  /// all tiles that are computed from it, e.g. by element-wise operations.
+  /// Element-wise operations and reductions are computed over the arena, i.e.
+  /// across inner tensors, and serialization is a bulk copy of the arena and
+  /// the table. Inner tensors are accessed as \c TensorMap views.
+  ///
+  /// All non-empty inner tensors must have the same rank. Element-wise
+  /// operations require that the arguments are congruent, i.e. they have the
+  /// same outer range and the same inner ranges (see \c is_congruent() ).
+  /// Permutations are applied to the outer dimensions only.
+  ///
+  /// This is a shallow copy object that implements the intrusive tile
+  /// interface, so it can be used as the tile type of \c DistArray .
+  /// \tparam T The element type of the inner tensors
+  /// \tparam A The allocator type for the arena
+  template <typename T, typename A = Eigen::aligned_allocator<T> >
+  class ArenaTensor {
+  public:
+    typedef ArenaTensor<T, A> ArenaTensor_; ///< This class type
+    typedef Range range_type; ///< Tensor range type
+    typedef typename range_type::size_type size_type; ///< Size type
+    typedef Tensor<T, A> arena_type; ///< The arena storage type
+    typedef Tensor<T, A> value_type; ///< The inner tensor type
+    typedef TensorMap<T> reference; ///< Inner tensor view type
+    typedef TensorConstMap<T> const_reference; ///< Const inner tensor view type
+    typedef typename arena_type::numeric_type numeric_type; ///< The numeric type that supports T
+    typedef typename arena_type::scalar_type scalar_type; ///< The scalar type that supports T
+
+  private:
+
+    /// The layout of the inner tensors in the arena
+    struct Layout {
+      Layout() : rank_(0u), bounds_(), offsets_(1ul, 0ul) { }
+
+      unsigned int rank_; ///< The rank of the inner tensors
+      std::vector<size_type> bounds_; ///< The lower and upper bounds of each inner tensor
+      std::vector<size_type> offsets_; ///< The arena offset of each inner tensor
+
+      /// Append an inner tensor range to the layout
+
+      /// \param range The range of the inner tensor; a range with zero
+      /// volume denotes an empty inner tensor
+      void push_back(const range_type& range) {
+        if(range.volume() == 0ul) {
+          bounds_.insert(bounds_.end(), rank_ + rank_, 0ul);
+        } else {
+          if(rank_ == 0u) {
+            // Add the bounds of the preceding empty inner tensors
+            rank_ = range.rank();
+            bounds_.assign((offsets_.size() - 1ul) * (rank_ + rank_), 0ul);
+          }
+          TA_USER_ASSERT(range.rank() == rank_,
+              "ArenaTensor: all inner tensors must have the same rank.");
+          bounds_.insert(bounds_.end(), range.lobound_data(),
+              range.lobound_data() + rank_);
+          bounds_.insert(bounds_.end(), range.upbound_data(),
+              range.upbound_data() + rank_);
+        }
+        offsets_.push_back(offsets_.back() + range.volume());
+      }
+
+      bool operator==(const Layout& other) const {
+        return (rank_ == other.rank_) && (bounds_ == other.bounds_)
+            && (offsets_ == other.offsets_);
+      }
+
+      template <typename Archive>
+      void serialize(Archive& ar) { ar & rank_ & bounds_ & offsets_; }
+    }; // struct Layout
+
+    range_type range_; ///< The outer range
+    std::shared_ptr<const Layout> layout_; ///< The inner tensor layout
+    arena_type arena_; ///< The inner tensor data
+
+    /// Construct from the components of an arena tensor
+
+    /// \param range The outer range
+    /// \param layout The inner tensor layout
+    /// \param arena The inner tensor data
+    ArenaTensor(const range_type& range,
+        const std::shared_ptr<const Layout>& layout, arena_type&& arena) :
+      range_(range), layout_(layout), arena_(std::move(arena))
+    { }
+
+    /// Construct a one-dimensional arena range
+
+    /// \param size The number of elements in the arena
+    /// \return The range of the arena
+    static range_type arena_range(const size_type size) {
+      const std::array<size_type, 1> lower = {{ 0ul }}, upper = {{ size }};
+      return range_type(lower, upper);
+    }
+
+    /// Apply an element-wise operation to the arenas of two tensors
+
+    /// \tparam Op The arena operation type
+    /// \param other The right-hand argument
+    /// \param op The operation, with the signature
+    /// <tt>arena_type op(const arena_type&, const arena_type&)</tt>
+    /// \return A tensor with the layout of this tensor
+    template <typename Op>
+    ArenaTensor_ binary(const ArenaTensor_& other, Op&& op) const {
+      TA_ASSERT(is_congruent(other));
+      return ArenaTensor_(range_, layout_, op(arena_, other.arena_));
+    }
+
+    /// Apply an in-place element-wise operation to the arenas of two tensors
+
+    /// \tparam Op The arena operation type
+    /// \param other The right-hand argument
+    /// \param op The operation, with the signature
+    /// <tt>void op(arena_type&, const arena_type&)</tt>
+    /// \return A reference to this tensor
+    template <typename Op>
+    ArenaTensor_& inplace_binary(const ArenaTensor_& other, Op&& op) {
+      TA_ASSERT(is_congruent(other));
+      op(arena_, other.arena_);
+      return *this;
+    }
+
+  public:
+
+    // Compiler generated functions
+    ArenaTensor() : range_(), layout_(), arena_() { }
+    ArenaTensor(const ArenaTensor_&) = default;
+    ArenaTensor(ArenaTensor_&&) = default;
+    ~ArenaTensor() = default;
+    ArenaTensor_& operator=(const ArenaTensor_&) = default;
+    ArenaTensor_& operator=(ArenaTensor_&&) = default;
+
+    /// Construct an arena tensor with uninitialized inner tensors
+
+    /// \tparam Op The inner range generator type
+    /// \param range The outer range
+    /// \param op The inner range generator, with the signature
+    /// <tt>range_type op(size_type)</tt> , which returns the range of the
+    /// inner tensor at the given outer ordinal index; an empty range denotes
+    /// an empty inner tensor
+    template <typename Op,
+        typename std::enable_if<! std::is_convertible<Op, numeric_type>::value>::type* = nullptr>
+    ArenaTensor(const range_type& range, Op&& op) :
+      range_(range), layout_(), arena_()
+    {
+      auto layout = std::make_shared<Layout>();
+      layout->offsets_.reserve(range.volume() + 1ul);
+      for(size_type i = 0ul; i < range.volume(); ++i)
+        layout->push_back(op(i));
+      arena_ = arena_type(arena_range(layout->offsets_.back()));
+      layout_ = layout;
+    }
+
+    /// Construct an arena tensor with the layout of another arena tensor
+
+    /// \param other The arena tensor that provides the layout
+    /// \param value The value of all inner tensor elements
+    ArenaTensor(const ArenaTensor_& other, const numeric_type value) :
+      range_(other.range_), layout_(other.layout_),
+      arena_(other.arena_.range(), value)
+    { }
+
+    /// Construct an arena tensor from a tensor of tensors
+
+    /// \tparam AT The outer allocator type of \c other
+    /// \param other The tensor of tensors to be copied
+    template <typename AT>
+    explicit ArenaTensor(const Tensor<Tensor<T, A>, AT>& other) :
+      range_(other.range()), layout_(), arena_()
+    {
+      auto layout = std::make_shared<Layout>();
+      layout->offsets_.reserve(other.size() + 1ul);
+      for(size_type i = 0ul; i < other.size(); ++i)
+        layout->push_back(other[i].empty() ? range_type() : other[i].range());
+      arena_ = arena_type(arena_range(layout->offsets_.back()));
+      for(size_type i = 0ul; i < other.size(); ++i)
+        if(! other[i].empty())
+          std::copy(other[i].data(), other[i].data() + other[i].size(),
+              arena_.data() + layout->offsets_[i]);
+      layout_ = layout;
+    }
+
+    /// Convert to a tensor of tensors
+
+    /// \return A tensor of tensors with a copy of the data of this tensor
+    explicit operator Tensor<Tensor<T, A> >() const {
+      TA_ASSERT(! empty());
+      Tensor<Tensor<T, A> > result(range_);
+      for(size_type i = 0ul; i < range_.volume(); ++i) {
+        if(inner_size(i) == 0ul)
+          continue;
+        value_type inner(inner_range(i));
+        std::copy(arena_.data() + layout_->offsets_[i],
+            arena_.data() + layout_->offsets_[i + 1ul], inner.data());
+        result[i] = inner;
+      }
+      return result;
+    }
+
+    /// Deep copy
+
+    /// \return A deep copy of this tensor; the layout is shared
+    ArenaTensor_ clone() const {
+      ArenaTensor_ result;
+      if(! empty())
+        result = ArenaTensor_(range_, layout_, arena_.clone());
+      return result;
+    }
+
+    /// Tensor range accessor
+
+    /// \return The outer range
+    const range_type& range() const { return range_; }
+
+    /// Tensor size accessor
+
+    /// \return The number of inner tensors
+    size_type size() const { return range_.volume(); }
+
+    /// Check for an empty tensor
+
+    /// \return \c true if this tensor is not initialized
+    bool empty() const { return ! layout_; }
+
+    /// Arena accessor
+
+    /// \return A const reference to the one-dimensional tensor that holds
+    /// the data of all inner tensors
+    const arena_type& arena() const { return arena_; }
+
+    /// Arena accessor
+
+    /// \return A reference to the one-dimensional tensor that holds the data
+    /// of all inner tensors
+    arena_type& arena() { return arena_; }
+
+    /// Inner tensor size accessor
+
+    /// \param i The outer ordinal index
+    /// \return The number of elements of inner tensor \c i
+    size_type inner_size(const size_type i) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(i < range_.volume());
+      return layout_->offsets_[i + 1ul] - layout_->offsets_[i];
+    }
+
+    /// Inner tensor range accessor
+
+    /// \param i The outer ordinal index
+    /// \return The range of inner tensor \c i
+    range_type inner_range(const size_type i) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(i < range_.volume());
+      const unsigned int rank = layout_->rank_;
+      const size_type* const bounds = layout_->bounds_.data() + i * (rank + rank);
+      return range_type(std::vector<size_type>(bounds, bounds + rank),
+          std::vector<size_type>(bounds + rank, bounds + rank + rank));
+    }
+
+    /// Inner tensor accessor
+
+    /// \param i The outer ordinal index
+    /// \return A view of inner tensor \c i
+    reference operator[](const size_type i) {
+      return reference(inner_range(i), arena_.data() + layout_->offsets_[i]);
+    }
+
+    /// Inner tensor accessor
+
+    /// \param i The outer ordinal index
+    /// \return A const view of inner tensor \c i
+    const_reference operator[](const size_type i) const {
+      return const_reference(inner_range(i),
+          static_cast<const T*>(arena_.data() + layout_->offsets_[i]));
+    }
+
+    /// Check that two tensors have the same layout
+
+    /// \param other The other tensor
+    /// \return \c true if this and \c other have the same outer range and
+    /// inner ranges
+    bool is_congruent(const ArenaTensor_& other) const {
+      if(empty() || other.empty())
+        return false;
+      return (range_ == other.range_) && ((layout_ == other.layout_) ||
+          (*layout_ == *other.layout_));
+    }
+
+    // Permutation operations ------------------------------------------------
+
+    /// Permute the outer dimensions of this tensor
+
+    /// \param perm The permutation to be applied to the outer dimensions
+    /// \return A permuted copy of this tensor
+    ArenaTensor_ permute(const Permutation& perm) const {
+      TA_ASSERT(! empty());
+      TA_ASSERT(perm.dim() == range_.rank());
+      const range_type result_range(perm, range_);
+
+      // Map the inner tensors to their permuted positions
+      std::vector<size_type> target(range_.volume());
+      size_type i = 0ul;
+      for(const auto& index : range_)
+        target[i++] = result_range.ordinal(perm * index);
+      std::vector<size_type> source(range_.volume());
+      for(i = 0ul; i < range_.volume(); ++i)
+        source[target[i]] = i;
+
+      // Construct the permuted layout and copy the inner tensors
+      const unsigned int rank2 = layout_->rank_ + layout_->rank_;
+      auto layout = std::make_shared<Layout>();
+      layout->rank_ = layout_->rank_;
+      layout->bounds_.reserve(layout_->bounds_.size());
+      layout->offsets_.reserve(layout_->offsets_.size());
+      arena_type arena(arena_.range());
+      for(i = 0ul; i < range_.volume(); ++i) {
+        const size_type s = source[i];
+        layout->bounds_.insert(layout->bounds_.end(),
+            layout_->bounds_.begin() + s * rank2,
+            layout_->bounds_.begin() + (s + 1ul) * rank2);
+        std::copy(arena_.data() + layout_->offsets_[s],
+            arena_.data() + layout_->offsets_[s + 1ul],
+            arena.data() + layout->offsets_.back());
+        layout->offsets_.push_back(layout->offsets_.back() + inner_size(s));
+      }
+
+      return ArenaTensor_(result_range, layout, std::move(arena));
+    }
+
+    // Scaling operations ----------------------------------------------------
+
+    /// Construct a scaled copy of this tensor
+
+    /// \param factor The scaling factor
+    /// \return A new tensor where the elements are scaled by \c factor
+    ArenaTensor_ scale(const numeric_type factor) const {
+      return ArenaTensor_(range_, layout_, arena_.scale(factor));
+    }
+
+    /// Construct a scaled and permuted copy of this tensor
+
+    /// \param factor The scaling factor
+    /// \param perm The permutation to be applied to the outer dimensions
+    /// \return A new tensor where the elements are scaled by \c factor
+    ArenaTensor_ scale(const numeric_type factor, const Permutation& perm) const {
+      return scale(factor).permute(perm);
+    }
+
+    /// Scale this tensor
+
+    /// \param factor The scaling factor
+    /// \return A reference to this tensor
+    ArenaTensor_& scale_to(const numeric_type factor) {
+      arena_.scale_to(factor);
+      return *this;
+    }
+
+    // Addition operations ---------------------------------------------------
+
+    /// Add this and \c other to construct a new tensor
+
+    /// \param other The tensor that will be added to this tensor
+    /// \return A new tensor where the elements are the sum of the elements of
+    /// \c this and \c other
+    ArenaTensor_ add(const ArenaTensor_& other) const {
+      return binary(other, [] (const arena_type& l, const arena_type& r)
+          { return l.add(r); });
+    }
+
+    /// Add this and \c other to construct a new, scaled tensor
+
+    /// \param other The tensor that will be added to this tensor
+    /// \param factor The scaling factor
+    /// \return A new tensor where the elements are the scaled sum of the
+    /// elements of \c this and \c other
+    ArenaTensor_ add(const ArenaTensor_& other, const numeric_type factor) const {
+      return binary(other, [=] (const arena_type& l, const arena_type& r)
+          { return l.add(r, factor); });
+    }
+
+    /// Add this and \c other to construct a new, permuted tensor
+
+    /// \param other The tensor that will be added to this tensor
+    /// \param perm The permutation to be applied to the outer dimensions
+    /// \return A new tensor where the elements are the sum of the elements of
+    /// \c this and \c other
+    ArenaTensor_ add(const ArenaTensor_& other, const Permutation& perm) const {
+      return add(other).permute(perm);
+    }
+
+    /// Add this and \c other to construct a new, scaled, and permuted tensor
+
+    /// \param other The tensor that will be added to this tensor
+    /// \param factor The scaling factor
+    /// \param perm The permutation to be applied to the outer dimensions
+    /// \return A new tensor where the elements are the scaled sum of the
+    /// elements of \c this and \c other
+    ArenaTensor_ add(const ArenaTensor_& other, const numeric_type factor,
+        const Permutation& perm) const
+    {
+      return add(other, factor).permute(perm);
+    }
+
+    /// Add a constant to a copy of this tensor
+
+    /// \param value The constant to be added to this tensor
+    /// \return A new tensor where the elements are the sum of the elements of
+    /// \c this and \c value
+    ArenaTensor_ add(const numeric_type value) const {
+      return ArenaTensor_(range_, layout_, arena_.add(value));
+    }
+
+    /// Add \c other to this tensor
+
+    /// \param other The tensor that will be added to this tensor
+    /// \return A reference to this tensor
+    ArenaTensor_& add_to(const ArenaTensor_& other) {
+      return inplace_binary(other, [] (arena_type& l, const arena_type& r)
+          { l.add_to(r); });
+    }
+
+    /// Add \c other to this tensor, and scale the result
+
+    /// \param other The tensor that will be added to this tensor
+    /// \param factor The scaling factor
+    /// \return A reference to this tensor
+    ArenaTensor_& add_to(const ArenaTensor_& other, const numeric_type factor) {
+      return inplace_binary(other, [=] (arena_type& l, const arena_type& r)
+          { l.add_to(r, factor); });
+    }
+
+    /// Add a constant to this tensor
+
+    /// \param value The constant to be added
+    /// \return A reference to this tensor
+    ArenaTensor_& add_to(const numeric_type value) {
+      arena_.add_to(value);
+      return *this;
+    }
+
+    // Subtraction operations ------------------------------------------------
+
+    /// Subtract \c other from this to construct a new tensor
+
+    /// \param other The tensor that will be subtracted from this tensor
+    /// \return A new tensor where the elements are the difference of the
+    /// elements of \c this and \c other
+    ArenaTensor_ subt(const ArenaTensor_& other) const {
+      return binary(other, [] (const arena_type& l, const arena_type& r)
+          { return l.subt(r); });
+    }
+
+    /// Subtract \c other from this to construct a new, scaled tensor
+
+    /// \param other The tensor that will be subtracted from this tensor
+    /// \param factor The scaling factor
+    /// \return A new tensor where the elements are the scaled difference of
+    /// the elements of \c this and \c other
+    ArenaTensor_ subt(const ArenaTensor_& other, const numeric_type factor) const {
+      return binary(other, [=] (const arena_type& l, const arena_type& r)
+          { return l.subt(r, factor); });
+    }
+
+    /// Subtract \c other from this to construct a new, permuted tensor
+
+    /// \param other The tensor that will be subtracted from this tensor
+    /// \param perm The permutation to be applied to the outer dimensions
+    /// \return A new tensor where the elements are the difference of the
+    /// elements of \c this and \c other
+    ArenaTensor_ subt(const ArenaTensor_& other, const Permutation& perm) const {
+      return subt(other).permute(perm);
+    }
+
+    /// Subtract \c other from this to construct a new, scaled, and permuted
+    /// tensor
+
+    /// \param other The tensor that will be subtracted from this tensor
+    /// \param factor The scaling factor
+    /// \param perm The permutation to be applied to the outer dimensions
+    /// \return A new tensor where the elements are the scaled difference of
+    /// the elements of \c this and \c other
+    ArenaTensor_ subt(const ArenaTensor_& other, const numeric_type factor,
+        const Permutation& perm) const
+    {
+      return subt(other, factor).permute(perm);
+    }
+
+    /// Subtract a constant from a copy of this tensor
+
+    /// \param value The constant to be subtracted from this tensor
+    /// \return A new tensor where the elements are the difference of the
+    /// elements of \c this and \c value
+    ArenaTensor_ subt(const numeric_type value) const {
+      return ArenaTensor_(range_, layout_, arena_.subt(value));
+    }
+
+    /// Subtract \c other from this tensor
+
+    /// \param other The tensor that will be subtracted from this tensor
+    /// \return A reference to this tensor
+    ArenaTensor_& subt_to(const ArenaTensor_& other) {
+      return inplace_binary(other, [] (arena_type& l, const arena_type& r)
+          { l.subt_to(r); });
+    }
+
+    /// Subtract \c other from this tensor, and scale the result
+
+    /// \param other The tensor that will be subtracted from this tensor
+    /// \param factor The scaling factor
+    /// \return A reference to this tensor
+    ArenaTensor_& subt_to(const ArenaTensor_& other, const numeric_type factor) {
+      return inplace_binary(other, [=] (arena_type& l, const arena_type& r)
+          { l.subt_to(r, factor); });
+    }
+
+    /// Subtract a constant from this tensor
+
+    /// \param value The constant to be subtracted
+    /// \return A reference to this tensor
+    ArenaTensor_& subt_to(const numeric_type value) {
+      arena_.subt_to(value);
+      return *this;
+    }
+
+    // Multiplication operations ---------------------------------------------
+
+    /// Multiply this by \c other to create a new tensor
+
+    /// \param other The tensor that will be multiplied by this tensor
+    /// \return A new tensor where the elements are the product of the
+    /// elements of \c this and \c other
+    ArenaTensor_ mult(const ArenaTensor_& other) const {
+      return binary(other, [] (const arena_type& l, const arena_type& r)
+          { return l.mult(r); });
+    }
+
+    /// Multiply this by \c other to create a new, scaled tensor
+
+    /// \param other The tensor that will be multiplied by this tensor
+    /// \param factor The scaling factor
+    /// \return A new tensor where the elements are the scaled product of the
+    /// elements of \c this and \c other
+    ArenaTensor_ mult(const ArenaTensor_& other, const numeric_type factor) const {
+      return binary(other, [=] (const arena_type& l, const arena_type& r)
+          { return l.mult(r, factor); });
+    }
+
+    /// Multiply this by \c other to create a new, permuted tensor
+
+    /// \param other The tensor that will be multiplied by this tensor
+    /// \param perm The permutation to be applied to the outer dimensions
+    /// \return A new tensor where the elements are the product of the
+    /// elements of \c this and \c other
+    ArenaTensor_ mult(const ArenaTensor_& other, const Permutation& perm) const {
+      return mult(other).permute(perm);
+    }
+
+    /// Multiply this by \c other to create a new, scaled, and permuted tensor
+
+    /// \param other The tensor that will be multiplied by this tensor
+    /// \param factor The scaling factor
+    /// \param perm The permutation to be applied to the outer dimensions
+    /// \return A new tensor where the elements are the scaled product of the
+    /// elements of \c this and \c other
+    ArenaTensor_ mult(const ArenaTensor_& other, const numeric_type factor,
+        const Permutation& perm) const
+    {
+      return mult(other, factor).permute(perm);
+    }
+
+    /// Multiply this tensor by \c other
+
+    /// \param other The tensor that will be multiplied by this tensor
+    /// \return A reference to this tensor
+    ArenaTensor_& mult_to(const ArenaTensor_& other) {
+      return inplace_binary(other, [] (arena_type& l, const arena_type& r)
+          { l.mult_to(r); });
+    }
+
+    /// Multiply this tensor by \c other, and scale the result
+
+    /// \param other The tensor that will be multiplied by this tensor
+    /// \param factor The scaling factor
+    /// \return A reference to this tensor
+    ArenaTensor_& mult_to(const ArenaTensor_& other, const numeric_type factor) {
+      return inplace_binary(other, [=] (arena_type& l, const arena_type& r)
+          { l.mult_to(r, factor); });
+    }
+
+    // Negation operations ---------------------------------------------------
+
+    /// Create a negated copy of this tensor
+
+    /// \return A new tensor that contains the negative values of this tensor
+    ArenaTensor_ neg() const {
+      return ArenaTensor_(range_, layout_, arena_.neg());
+    }
+
+    /// Create a negated and permuted copy of this tensor
+
+    /// \param perm The permutation to be applied to the outer dimensions
+    /// \return A new tensor that contains the negative values of this tensor
+    ArenaTensor_ neg(const Permutation& perm) const {
+      return neg().permute(perm);
+    }
+
+    /// Negate elements of this tensor
+
+    /// \return A reference to this tensor
+    ArenaTensor_& neg_to() {
+      arena_.neg_to();
+      return *this;
+    }
+
+    // Reduction operations --------------------------------------------------
+
+    /// Sum of all elements of the inner tensors
+
+    /// \return The sum of all elements of all inner tensors
+    numeric_type sum() const { return arena_.sum(); }
+
+    /// Product of all elements of the inner tensors
+
+    /// \return The product of all elements of all inner tensors
+    numeric_type product() const { return arena_.product(); }
+
+    /// Square of the vector 2-norm
+
+    /// \return The sum of the squared elements of all inner tensors
+    scalar_type squared_norm() const { return arena_.squared_norm(); }
+
+    /// Vector 2-norm
+
+    /// This is the tile norm used by \c SparseShape .
+    /// \return The 2-norm of all elements of all inner tensors
+    scalar_type norm() const { return arena_.norm(); }
+
+    /// Minimum element
+
+    /// \return The minimum element of all inner tensors
+    numeric_type min() const { return arena_.min(); }
+
+    /// Maximum element
+
+    /// \return The maximum element of all inner tensors
+    numeric_type max() const { return arena_.max(); }
+
+    /// Absolute minimum element
+
+    /// \return The minimum absolute element of all inner tensors
+    scalar_type abs_min() const { return arena_.abs_min(); }
+
+    /// Absolute maximum element
+
+    /// \return The maximum absolute element of all inner tensors
+    scalar_type abs_max() const { return arena_.abs_max(); }
+
+    /// Vector dot product
+
+    /// \param other The other tensor to be reduced
+    /// \return The inner product of the elements of \c this and \c other
+    numeric_type dot(const ArenaTensor_& other) const {
+      TA_ASSERT(is_congruent(other));
+      return arena_.dot(other.arena_);
+    }
+
+    // Serialization ---------------------------------------------------------
+
+    /// Output serialization function
+
+    /// The layout and the arena are each written as a single block.
+    /// \tparam Archive The output archive type
+    /// \param[out] ar The output archive
+    template <typename Archive,
+        typename std::enable_if<
+          madness::archive::is_output_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      const bool have_layout = bool(layout_);
+      ar & have_layout;
+      if(have_layout)
+        ar & range_ & *layout_ & arena_;
+    }
+
+    /// Input serialization function
+
+    /// \tparam Archive The input archive type
+    /// \param[out] ar The input archive
+    template <typename Archive,
+        typename std::enable_if<
+          madness::archive::is_input_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      bool have_layout = false;
+      ar & have_layout;
+      if(have_layout) {
+        auto layout = std::make_shared<Layout>();
+        ar & range_ & *layout & arena_;
+        layout_ = layout;
+      } else {
+        range_ = range_type();
+        layout_.reset();
+        arena_ = arena_type();
+      }
+    }
+
+  }; // class ArenaTensor
+
+  /// Arena tensor output operator
+
+  /// \tparam T The element type
+  /// \tparam A The allocator type
+  /// \param os The output stream
+  /// \param tile The tile to be printed
+  /// \return A reference to the output stream
+  template <typename T, typename A>
+  inline std::ostream& operator<<(std::ostream& os, const ArenaTensor<T, A>& tile) {
+    if(tile.empty())
+      os << "{ }";
+    else
+      os << static_cast<Tensor<Tensor<T, A> > >(tile);
+    return os;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TENSOR_ARENA_TENSOR_H__INCLUDED
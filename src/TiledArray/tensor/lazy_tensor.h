@@ -0,0 +1,482 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  lazy_tensor.h
+ *
+ */
+
+#ifndef TILEDARRAY_TENSOR_LAZY_TENSOR_H__INCLUDED
+#define TILEDARRAY_TENSOR_LAZY_TENSOR_H__INCLUDED
+
+#include <TiledArray/tensor/tensor.h>
+#include <TiledArray/tile_op/fused.h>
+#include <tuple>
+#include <utility>
+
+namespace TiledArray {
+
+  namespace detail {
+
+    template <typename> class LazyTensorExpr;
+
+    /// Lazy tensor expression trait
+
+    /// \c value is \c true when \c T is a lazy tensor expression
+    /// \tparam T The type to be tested
+    template <typename T>
+    struct is_lazy_tensor_expr :
+        public std::is_base_of<LazyTensorExpr<T>, T>
+    { };
+
+    /// Lazy tensor operand trait
+
+    /// \c value is \c true when \c T1 and \c T2 are lazy tensor expressions or
+    /// tensors of numeric elements, and at least one of them is a lazy
+    /// tensor expression.
+    /// \tparam T1 The left-hand operand type
+    /// \tparam T2 The right-hand operand type
+    template <typename T1, typename T2>
+    struct is_lazy_tensor_operands :
+        public std::integral_constant<bool,
+            (is_lazy_tensor_expr<T1>::value || is_lazy_tensor_expr<T2>::value)
+            && (is_lazy_tensor_expr<T1>::value || is_tensor<T1>::value)
+            && (is_lazy_tensor_expr<T2>::value || is_tensor<T2>::value)>
+    { };
+
+    /// The result range of a lazy tensor expression
+
+    /// The range of the first contiguous argument is used, so that the
+    /// result has the same lower bound as the tensors in the expression. If
+    /// all arguments are strided views, a contiguous copy of the range of
+    /// the first argument is used.
+    /// \param first The first argument
+    /// \return The range of \c tensor
+    template <typename T1, typename T, typename... Ts,
+        typename std::enable_if<is_contiguous_tensor<T>::value>::type* = nullptr>
+    inline Range lazy_result_range(const T1&, const T& tensor, const Ts&...) {
+      return tensor.range();
+    }
+
+    template <typename T1, typename T,
+        typename std::enable_if<! is_contiguous_tensor<T>::value>::type* = nullptr>
+    inline Range lazy_result_range(const T1& first, const T&) {
+      return clone_range(first);
+    }
+
+    template <typename T1, typename T, typename T2, typename... Ts,
+        typename std::enable_if<! is_contiguous_tensor<T>::value>::type* = nullptr>
+    inline Range lazy_result_range(const T1& first, const T&,
+        const T2& tensor2, const Ts&... tensors)
+    {
+      return lazy_result_range(first, tensor2, tensors...);
+    }
+
+    /// Get a contiguous tensor
+
+    /// \param range The range of the result
+    /// \param tensor The argument tensor
+    /// \return \c tensor , or a contiguous copy of \c tensor with \c range
+    /// when it is a strided view
+    template <typename T,
+        typename std::enable_if<is_contiguous_tensor<T>::value>::type* = nullptr>
+    inline const T& lazy_contiguous(const Range&, const T& tensor) {
+      return tensor;
+    }
+
+    template <typename T,
+        typename std::enable_if<! is_contiguous_tensor<T>::value>::type* = nullptr>
+    inline Tensor<typename T::numeric_type>
+    lazy_contiguous(const Range& range, const T& tensor) {
+      typedef typename T::numeric_type numeric_type;
+      Tensor<numeric_type> result(range);
+      tensor_init([] (const numeric_type arg) { return arg; }, result, tensor);
+      return result;
+    }
+
+    /// Lazy tensor expression base class
+
+    /// Lazy tensor expressions record element-wise tensor arithmetic, and
+    /// evaluate it with a single pass over the argument tensors when the
+    /// expression is converted to a tensor, e.g.
+    /// \code
+    /// Tensor<double> x = lazy(a) + 2.0 * lazy(b) - c;
+    /// Tensor<double> y = (lazy(a) - b.block(lower, upper)).eval(perm);
+    /// \endcode
+    /// The arguments may be tensors or tensor views (e.g. blocks of tensors),
+    /// which are held by shallow copy.
+    /// \tparam Derived The derived expression type
+    template <typename Derived>
+    class LazyTensorExpr {
+    public:
+
+      /// Cast this object to its derived type
+      const Derived& derived() const {
+        return *static_cast<const Derived*>(this);
+      }
+
+      /// Evaluate this expression
+
+      /// \tparam Result The result tensor type
+      /// \return A tensor that holds the result of this expression
+      template <typename Result = Tensor<typename Derived::numeric_type> >
+      Result eval() const {
+        return eval<Result>(derived().args(),
+            std::make_index_sequence<Derived::leaves>());
+      }
+
+      /// Evaluate and permute this expression
+
+      /// \tparam Result The result tensor type
+      /// \param perm The permutation that is applied to the result
+      /// \return A tensor that holds the permuted result of this expression
+      template <typename Result = Tensor<typename Derived::numeric_type> >
+      Result eval(const Permutation& perm) const {
+        if(! perm)
+          return eval<Result>();
+        return eval<Result>(perm, derived().args(),
+            std::make_index_sequence<Derived::leaves>());
+      }
+
+      /// Evaluate this expression
+
+      /// \tparam T The result element type
+      /// \tparam A The result allocator type
+      /// \return A tensor that holds the result of this expression
+      template <typename T, typename A>
+      operator Tensor<T, A>() const { return eval<Tensor<T, A> >(); }
+
+    private:
+
+      template <typename Result, typename Args, std::size_t... Is>
+      Result eval(const Args& args, std::index_sequence<Is...>) const {
+        Result result(lazy_result_range(std::get<0>(args),
+            std::get<Is>(args)...));
+        tensor_init(derived().element_op(), result, std::get<Is>(args)...);
+        return result;
+      }
+
+      template <typename Result, typename Args, std::size_t... Is>
+      Result eval(const Permutation& perm, const Args& args,
+          std::index_sequence<Is...>) const
+      {
+        const Range range = lazy_result_range(std::get<0>(args),
+            std::get<Is>(args)...);
+        Result result(perm * range);
+        tensor_init(derived().element_op(), perm, result,
+            lazy_contiguous(range, std::get<Is>(args))...);
+        return result;
+      }
+
+    }; // class LazyTensorExpr
+
+    /// Lazy tensor expression leaf
+
+    /// \tparam T The tensor type
+    template <typename T>
+    class LazyTensorLeaf : public LazyTensorExpr<LazyTensorLeaf<T> > {
+    public:
+      typedef T tensor_type; ///< The tensor type
+      typedef typename T::numeric_type numeric_type; ///< The element type
+
+      static constexpr unsigned int leaves = 1u;
+
+    private:
+
+      tensor_type tensor_; ///< The tensor
+
+    public:
+
+      /// Constructor
+
+      /// \param tensor The tensor of this leaf
+      explicit LazyTensorLeaf(const tensor_type& tensor) : tensor_(tensor) { }
+
+      /// Tensor accessor
+
+      /// \return A const reference to the tensor of this leaf
+      const tensor_type& tensor() const { return tensor_; }
+
+      /// Argument accessor
+
+      /// \return A tuple that holds the tensor of this leaf
+      std::tuple<tensor_type> args() const {
+        return std::tuple<tensor_type>(tensor_);
+      }
+
+      /// Element operation factory function
+
+      /// \return The identity operation
+      static auto element_op() { return [] (const auto arg) { return arg; }; }
+
+    }; // class LazyTensorLeaf
+
+    /// Lazy unary tensor expression
+
+    /// \tparam Arg The argument expression type
+    /// \tparam Op The element operation type
+    template <typename Arg, typename Op>
+    class LazyTensorUnary : public LazyTensorExpr<LazyTensorUnary<Arg, Op> > {
+    public:
+      typedef typename std::decay<decltype(std::declval<const Op&>()(
+          std::declval<typename Arg::numeric_type>()))>::type
+          numeric_type; ///< The element type
+
+      static constexpr unsigned int leaves = Arg::leaves;
+
+    private:
+
+      Arg arg_; ///< The argument expression
+      Op op_; ///< The element operation
+
+    public:
+
+      /// Constructor
+
+      /// \param arg The argument expression
+      /// \param op The element operation
+      LazyTensorUnary(const Arg& arg, const Op& op) : arg_(arg), op_(op) { }
+
+      /// Argument accessor
+
+      /// \return A tuple that holds the leaf tensors of this expression
+      auto args() const { return arg_.args(); }
+
+      /// Element operation factory function
+
+      /// \return The element operation of this expression, which takes the
+      /// leaf elements of the argument
+      auto element_op() const {
+        const auto arg_op = arg_.element_op();
+        const Op op = op_;
+        return [=] (const auto&... args) { return op(arg_op(args...)); };
+      }
+
+    }; // class LazyTensorUnary
+
+    /// Lazy binary tensor expression
+
+    /// \tparam Left The left-hand expression type
+    /// \tparam Right The right-hand expression type
+    /// \tparam Op The element operation type
+    template <typename Left, typename Right, typename Op>
+    class LazyTensorBinary :
+        public LazyTensorExpr<LazyTensorBinary<Left, Right, Op> >
+    {
+    public:
+      typedef typename std::decay<decltype(std::declval<const Op&>()(
+          std::declval<typename Left::numeric_type>(),
+          std::declval<typename Right::numeric_type>()))>::type
+          numeric_type; ///< The element type
+
+      static constexpr unsigned int leaves = Left::leaves + Right::leaves;
+
+    private:
+
+      Left left_; ///< The left-hand expression
+      Right right_; ///< The right-hand expression
+      Op op_; ///< The element operation
+
+    public:
+
+      /// Constructor
+
+      /// \param left The left-hand expression
+      /// \param right The right-hand expression
+      /// \param op The element operation
+      LazyTensorBinary(const Left& left, const Right& right, const Op& op) :
+        left_(left), right_(right), op_(op)
+      { }
+
+      /// Argument accessor
+
+      /// \return A tuple that holds the leaf tensors of this expression
+      auto args() const { return std::tuple_cat(left_.args(), right_.args()); }
+
+      /// Element operation factory function
+
+      /// \return The element operation of this expression, which takes the
+      /// leaf elements of the left- and right-hand expressions
+      auto element_op() const {
+        return make_fused_binary_op<Left::leaves>(left_.element_op(),
+            right_.element_op(), op_);
+      }
+
+    }; // class LazyTensorBinary
+
+    /// Convert an operand to a lazy tensor expression
+
+    /// \return \c arg
+    template <typename T,
+        typename std::enable_if<is_lazy_tensor_expr<T>::value>::type* = nullptr>
+    inline const T& lazy_arg(const T& arg) { return arg; }
+
+    /// Convert an operand to a lazy tensor expression
+
+    /// \return A leaf expression that holds \c arg
+    template <typename T,
+        typename std::enable_if<is_tensor<T>::value>::type* = nullptr>
+    inline LazyTensorLeaf<T> lazy_arg(const T& arg) {
+      return LazyTensorLeaf<T>(arg);
+    }
+
+    /// Lazy binary tensor expression factory function
+
+    /// \param left The left-hand operand
+    /// \param right The right-hand operand
+    /// \param op The element operation
+    /// \return A lazy expression that applies \c op to \c left and \c right
+    template <typename T1, typename T2, typename Op>
+    inline auto make_lazy_binary(const T1& left, const T2& right, const Op& op) {
+      typedef typename std::decay<decltype(lazy_arg(left))>::type left_type;
+      typedef typename std::decay<decltype(lazy_arg(right))>::type right_type;
+      return LazyTensorBinary<left_type, right_type, Op>(lazy_arg(left),
+          lazy_arg(right), op);
+    }
+
+    /// Lazy unary tensor expression factory function
+
+    /// \param arg The argument expression
+    /// \param op The element operation
+    /// \return A lazy expression that applies \c op to \c arg
+    template <typename Arg, typename Op>
+    inline LazyTensorUnary<Arg, Op> make_lazy_unary(const Arg& arg, const Op& op) {
+      return LazyTensorUnary<Arg, Op>(arg, op);
+    }
+
+  } // namespace detail
+
+  /// Create a lazy tensor expression
+
+  /// Arithmetic on the result is recorded and evaluated in a single pass
+  /// when it is converted to a tensor (see \c detail::LazyTensorExpr ).
+  /// \tparam T The tensor type
+  /// \param tensor A tensor or tensor view
+  /// \return A lazy expression that holds \c tensor
+  template <typename T,
+      typename std::enable_if<detail::is_tensor<T>::value>::type* = nullptr>
+  inline detail::LazyTensorLeaf<T> lazy(const T& tensor) {
+    return detail::LazyTensorLeaf<T>(tensor);
+  }
+
+  /// Lazy tensor plus operator
+
+  /// \tparam T1 The left-hand operand type
+  /// \tparam T2 The right-hand operand type
+  /// \param left The left-hand operand
+  /// \param right The right-hand operand
+  /// \return A lazy expression where element \c i is equal to
+  /// <tt>left[i] + right[i]</tt>
+  template <typename T1, typename T2,
+      typename std::enable_if<
+          detail::is_lazy_tensor_operands<T1, T2>::value>::type* = nullptr>
+  inline auto operator+(const T1& left, const T2& right) {
+    return detail::make_lazy_binary(left, right,
+        [] (const auto l, const auto r) { return l + r; });
+  }
+
+  /// Lazy tensor minus operator
+
+  /// \tparam T1 The left-hand operand type
+  /// \tparam T2 The right-hand operand type
+  /// \param left The left-hand operand
+  /// \param right The right-hand operand
+  /// \return A lazy expression where element \c i is equal to
+  /// <tt>left[i] - right[i]</tt>
+  template <typename T1, typename T2,
+      typename std::enable_if<
+          detail::is_lazy_tensor_operands<T1, T2>::value>::type* = nullptr>
+  inline auto operator-(const T1& left, const T2& right) {
+    return detail::make_lazy_binary(left, right,
+        [] (const auto l, const auto r) { return l - r; });
+  }
+
+  /// Lazy tensor multiplication operator
+
+  /// \tparam T1 The left-hand operand type
+  /// \tparam T2 The right-hand operand type
+  /// \param left The left-hand operand
+  /// \param right The right-hand operand
+  /// \return A lazy expression where element \c i is equal to
+  /// <tt>left[i] * right[i]</tt>
+  template <typename T1, typename T2,
+      typename std::enable_if<
+          detail::is_lazy_tensor_operands<T1, T2>::value>::type* = nullptr>
+  inline auto operator*(const T1& left, const T2& right) {
+    return detail::make_lazy_binary(left, right,
+        [] (const auto l, const auto r) { return l * r; });
+  }
+
+  /// Lazy tensor division operator
+
+  /// \tparam T1 The left-hand operand type
+  /// \tparam T2 The right-hand operand type
+  /// \param left The left-hand operand
+  /// \param right The right-hand operand
+  /// \return A lazy expression where element \c i is equal to
+  /// <tt>left[i] / right[i]</tt>
+  template <typename T1, typename T2,
+      typename std::enable_if<
+          detail::is_lazy_tensor_operands<T1, T2>::value>::type* = nullptr>
+  inline auto operator/(const T1& left, const T2& right) {
+    return detail::make_lazy_binary(left, right,
+        [] (const auto l, const auto r) { return l / r; });
+  }
+
+  /// Lazy tensor scale operator
+
+  /// \tparam D The expression type
+  /// \tparam N Numeric type
+  /// \param left The left-hand expression
+  /// \param right The right-hand scalar argument
+  /// \return A lazy expression where element \c i is equal to
+  /// <tt>left[i] * right</tt>
+  template <typename D, typename N,
+      typename std::enable_if<detail::is_numeric<N>::value>::type* = nullptr>
+  inline auto operator*(const detail::LazyTensorExpr<D>& left, N right) {
+    return detail::make_lazy_unary(left.derived(),
+        [right] (const auto arg) { return arg * right; });
+  }
+
+  /// Lazy tensor scale operator
+
+  /// \tparam N Numeric type
+  /// \tparam D The expression type
+  /// \param left The left-hand scalar argument
+  /// \param right The right-hand expression
+  /// \return A lazy expression where element \c i is equal to
+  /// <tt>left * right[i]</tt>
+  template <typename N, typename D,
+      typename std::enable_if<detail::is_numeric<N>::value>::type* = nullptr>
+  inline auto operator*(N left, const detail::LazyTensorExpr<D>& right) {
+    return detail::make_lazy_unary(right.derived(),
+        [left] (const auto arg) { return left * arg; });
+  }
+
+  /// Lazy tensor negation operator
+
+  /// \tparam D The expression type
+  /// \param arg The argument expression
+  /// \return A lazy expression where element \c i is equal to \c -arg[i]
+  template <typename D>
+  inline auto operator-(const detail::LazyTensorExpr<D>& arg) {
+    return detail::make_lazy_unary(arg.derived(),
+        [] (const auto x) { return -x; });
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TENSOR_LAZY_TENSOR_H__INCLUDED
@@ -0,0 +1,880 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  low_rank_tensor.h
+ *
+ */
+
+#ifndef TILEDARRAY_TENSOR_LOW_RANK_TENSOR_H__INCLUDED
+#define TILEDARRAY_TENSOR_LOW_RANK_TENSOR_H__INCLUDED
+
+#include <TiledArray/tensor.h>
+#include <TiledArray/math/eigen.h>
+#include <Eigen/SVD>
+#include <cmath>
+#include <iosfwd>
+#include <limits>
+
+namespace TiledArray {
+
+  /// Block low-rank tensor tile
+
+  /// A low-rank tensor stores the matrix formed by the first \c row_dims()
+  /// dimensions (rows) and the remaining dimensions (columns) of the tile as
+  /// the product of two factors, \f$ U V^T \f$ , where \f$ U \f$ is
+  /// \f$ m \times r \f$ and \f$ V \f$ is \f$ n \times r \f$ . Contractions,
+  /// additions, scaling, and permutations are computed directly on the
+  /// factors. Sums are recompressed, and factors are truncated such that the
+  /// discarded singular values are less than \c threshold() relative to the
+  /// norm of the tile. When the rank of a tile exceeds
+  /// <tt>max_rank_ratio() * min(m, n)</tt> the tile is stored as a dense
+  /// matrix instead, which is indicated by \c is_dense() .
+  ///
+  /// This is a shallow copy object that implements the intrusive tile
+  /// interface, so it can be used as the tile type of \c DistArray .
+  /// \tparam T The element type, which must be a real floating point type
+  template <typename T>
+  class LowRankTensor {
+    static_assert(std::is_floating_point<T>::value,
+        "LowRankTensor<T>: T must be a real floating point type");
+  public:
+    typedef LowRankTensor<T> LowRankTensor_; ///< This class type
+    typedef Range range_type; ///< Tensor range type
+    typedef typename range_type::size_type size_type; ///< Size type
+    typedef T value_type; ///< Element type
+    typedef T numeric_type; ///< The numeric type that supports T
+    typedef T scalar_type; ///< The scalar type that supports T
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>
+        matrix_type; ///< Factor and dense matrix type
+
+  private:
+    typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>
+        col_matrix_type; ///< Column major matrix used for factorizations
+    typedef Eigen::Matrix<T, Eigen::Dynamic, 1> vector_type; ///< Vector type
+
+    struct Impl {
+      Impl() : range_(), row_dims_(0u), dense_(false), u_(), v_() { }
+
+      Impl(const range_type& range, const unsigned int row_dims) :
+        range_(range), row_dims_(row_dims), dense_(false), u_(), v_()
+      { }
+
+      range_type range_; ///< The tile range
+      unsigned int row_dims_; ///< The number of leading dimensions that form rows
+      bool dense_; ///< If true, \c u_ holds the dense matrix and \c v_ is empty
+      matrix_type u_; ///< The left-hand factor or the dense matrix
+      matrix_type v_; ///< The right-hand factor
+    }; // struct Impl
+
+    std::shared_ptr<Impl> pimpl_; ///< Tile data
+
+    static T threshold_; ///< The relative truncation threshold
+    static T max_rank_ratio_; ///< The maximum rank ratio of low-rank tiles
+
+    /// Matrix representation of an argument of a contraction
+
+    /// Holds either the dense matrix or the factors of \c op(arg) .
+    struct MatrixOp {
+      MatrixOp(const Impl& impl, const bool trans) :
+        dense(nullptr), u(nullptr), v(nullptr), temp()
+      {
+        if(impl.dense_) {
+          if(trans) {
+            temp = impl.u_.transpose();
+            dense = &temp;
+          } else {
+            dense = &impl.u_;
+          }
+        } else {
+          u = (trans ? &impl.v_ : &impl.u_);
+          v = (trans ? &impl.u_ : &impl.v_);
+        }
+      }
+
+      const matrix_type* dense; ///< Dense matrix
+      const matrix_type* u; ///< Left-hand factor
+      const matrix_type* v; ///< Right-hand factor
+      matrix_type temp; ///< Transposed dense matrix
+    }; // struct MatrixOp
+
+    static size_type extent_product(const range_type& range,
+        const unsigned int first, const unsigned int last)
+    {
+      const auto* MADNESS_RESTRICT const extent = range.extent_data();
+      size_type result = 1ul;
+      for(unsigned int i = first; i < last; ++i)
+        result *= extent[i];
+      return result;
+    }
+
+    static size_type num_rows(const range_type& range, const unsigned int row_dims) {
+      return extent_product(range, 0u, row_dims);
+    }
+
+    static size_type num_cols(const range_type& range, const unsigned int row_dims) {
+      return extent_product(range, row_dims, range.rank());
+    }
+
+    /// Check whether a tile of the given rank should be stored densely
+    static bool use_dense(const size_type rank, const size_type rows,
+        const size_type cols)
+    {
+      return T(rank) > max_rank_ratio_ * T(std::min(rows, cols));
+    }
+
+    /// Compute the truncated rank for a set of singular values
+
+    /// \param s The singular values, in decreasing order
+    /// \return The smallest rank such that the norm of the discarded singular
+    /// values is less than or equal to <tt>threshold() * s.norm()</tt>
+    static size_type truncated_rank(const vector_type& s) {
+      const T tolerance = threshold_ * threshold_ * s.squaredNorm();
+      size_type rank = s.size();
+      T discarded = T(0);
+      while(rank > 0ul) {
+        discarded += s[rank - 1ul] * s[rank - 1ul];
+        if(discarded > tolerance)
+          break;
+        --rank;
+      }
+      return rank;
+    }
+
+    /// Store a dense matrix
+    void set_dense(matrix_type&& a) {
+      pimpl_->dense_ = true;
+      pimpl_->u_ = std::move(a);
+      pimpl_->v_.resize(0, 0);
+    }
+
+    /// Store factors, or their product when the rank is too large
+    void set_factors(matrix_type&& u, matrix_type&& v) {
+      TA_ASSERT(u.cols() == v.cols());
+      if(use_dense(u.cols(), u.rows(), v.rows())) {
+        set_dense(u * v.transpose());
+      } else {
+        pimpl_->dense_ = false;
+        pimpl_->u_ = std::move(u);
+        pimpl_->v_ = std::move(v);
+      }
+    }
+
+    /// Compress a dense matrix with a truncated SVD
+    void compress(const matrix_type& a) {
+      const col_matrix_type ca = a;
+      Eigen::BDCSVD<col_matrix_type> svd(ca, Eigen::ComputeThinU | Eigen::ComputeThinV);
+      const vector_type s = svd.singularValues();
+      const size_type rank = truncated_rank(s);
+
+      if(use_dense(rank, a.rows(), a.cols())) {
+        set_dense(matrix_type(a));
+      } else {
+        pimpl_->dense_ = false;
+        pimpl_->u_ = svd.matrixU().leftCols(rank) * s.head(rank).asDiagonal();
+        pimpl_->v_ = svd.matrixV().leftCols(rank);
+      }
+    }
+
+    /// Recompress a pair of factors
+
+    /// The factors are orthogonalized with QR decompositions and the product
+    /// of the triangular factors is truncated with an SVD.
+    void recompress(const matrix_type& u, const matrix_type& v) {
+      TA_ASSERT(u.cols() == v.cols());
+      const size_type rows = u.rows(), cols = v.rows(), rank = u.cols();
+
+      if(rank == 0ul) {
+        pimpl_->dense_ = false;
+        pimpl_->u_.resize(rows, 0);
+        pimpl_->v_.resize(cols, 0);
+        return;
+      }
+
+      if(rank >= std::min(rows, cols)) {
+        // The factors are not smaller than the dense matrix
+        compress(u * v.transpose());
+        return;
+      }
+
+      Eigen::HouseholderQR<col_matrix_type> qr_u(u), qr_v(v);
+      const col_matrix_type r_u =
+          qr_u.matrixQR().topRows(rank).template triangularView<Eigen::Upper>();
+      const col_matrix_type r_v =
+          qr_v.matrixQR().topRows(rank).template triangularView<Eigen::Upper>();
+
+      const col_matrix_type core = r_u * r_v.transpose();
+      Eigen::BDCSVD<col_matrix_type> svd(core, Eigen::ComputeThinU | Eigen::ComputeThinV);
+      const vector_type s = svd.singularValues();
+      const size_type new_rank = truncated_rank(s);
+
+      const col_matrix_type q_u = qr_u.householderQ() * col_matrix_type::Identity(rows, rank);
+      const col_matrix_type q_v = qr_v.householderQ() * col_matrix_type::Identity(cols, rank);
+      set_factors(q_u * (svd.matrixU().leftCols(new_rank) * s.head(new_rank).asDiagonal()),
+          q_v * svd.matrixV().leftCols(new_rank));
+    }
+
+    /// Permute the rows of a factor
+
+    /// \param factor The factor, where the rows are the fused tile dimensions
+    /// given by \c extent
+    /// \param extent The extents of the tile dimensions of the factor rows
+    /// \param perm The permutation of the tile dimensions of the factor rows
+    /// \return The permuted factor
+    static matrix_type permute_factor(const matrix_type& factor,
+        const std::vector<size_type>& extent, const std::vector<unsigned int>& perm)
+    {
+      bool identity = true;
+      for(unsigned int i = 0u; i < perm.size(); ++i)
+        identity = identity && (perm[i] == i);
+      if(identity || (factor.size() == 0))
+        return factor;
+
+      // Treat the factor as a tensor where the last dimension is the rank
+      std::vector<size_type> factor_extent(extent);
+      factor_extent.push_back(factor.cols());
+      std::vector<unsigned int> factor_perm(perm);
+      factor_perm.push_back(perm.size());
+
+      const Tensor<T> tensor(Range(factor_extent), factor.data());
+      const Tensor<T> result = tensor.permute(Permutation(factor_perm));
+
+      return Eigen::Map<const matrix_type>(result.data(), factor.rows(), factor.cols());
+    }
+
+    /// Compute <tt>alpha * left + beta * right</tt>
+    static LowRankTensor_ add(const LowRankTensor_& left, const LowRankTensor_& right,
+        const numeric_type alpha, const numeric_type beta)
+    {
+      TA_ASSERT(left.pimpl_);
+      TA_ASSERT(right.pimpl_);
+      TA_ASSERT(left.range() == right.range());
+
+      const LowRankTensor_ arg = right.resplit(left.row_dims());
+
+      LowRankTensor_ result;
+      result.pimpl_ = std::make_shared<Impl>(left.range(), left.row_dims());
+      if(left.is_dense() || arg.is_dense()) {
+        result.set_dense(alpha * left.matrix() + beta * arg.matrix());
+      } else {
+        const size_type rank = left.rank() + arg.rank();
+        matrix_type u(left.pimpl_->u_.rows(), rank), v(left.pimpl_->v_.rows(), rank);
+        u << alpha * left.pimpl_->u_, beta * arg.pimpl_->u_;
+        v << left.pimpl_->v_, arg.pimpl_->v_;
+        result.recompress(u, v);
+      }
+
+      return result;
+    }
+
+  public:
+
+    /// Default constructor
+
+    /// Construct an empty tile.
+    LowRankTensor() : pimpl_() { }
+
+    LowRankTensor(const LowRankTensor_&) = default;
+    LowRankTensor(LowRankTensor_&&) = default;
+    LowRankTensor_& operator=(const LowRankTensor_&) = default;
+    LowRankTensor_& operator=(LowRankTensor_&&) = default;
+
+    /// Construct from a dense tensor
+
+    /// \tparam A The tensor allocator type
+    /// \param tensor The tensor to be compressed
+    /// \param row_dims The number of leading dimensions of \c tensor that form
+    /// the rows of the compressed matrix
+    template <typename A>
+    LowRankTensor(const Tensor<T, A>& tensor, const unsigned int row_dims) :
+      pimpl_(std::make_shared<Impl>(tensor.range(), row_dims))
+    {
+      TA_ASSERT(! tensor.empty());
+      TA_ASSERT(row_dims <= tensor.range().rank());
+      compress(Eigen::Map<const matrix_type>(tensor.data(),
+          num_rows(tensor.range(), row_dims), num_cols(tensor.range(), row_dims)));
+    }
+
+    /// Construct from a dense tensor
+
+    /// The first half of the dimensions of \c tensor form the rows of the
+    /// compressed matrix.
+    /// \tparam A The tensor allocator type
+    /// \param tensor The tensor to be compressed
+    template <typename A>
+    explicit LowRankTensor(const Tensor<T, A>& tensor) :
+      LowRankTensor(tensor, tensor.range().rank() / 2u)
+    { }
+
+    /// Construct from factors
+
+    /// \param range The tile range
+    /// \param row_dims The number of leading dimensions that form the rows
+    /// \param u The left-hand factor, with one row for each element of the
+    /// fused row dimensions
+    /// \param v The right-hand factor, with one row for each element of the
+    /// fused column dimensions
+    LowRankTensor(const range_type& range, const unsigned int row_dims,
+        const matrix_type& u, const matrix_type& v) :
+      pimpl_(std::make_shared<Impl>(range, row_dims))
+    {
+      TA_ASSERT(row_dims <= range.rank());
+      TA_ASSERT(size_type(u.rows()) == num_rows(range, row_dims));
+      TA_ASSERT(size_type(v.rows()) == num_cols(range, row_dims));
+      TA_ASSERT(u.cols() == v.cols());
+      set_factors(matrix_type(u), matrix_type(v));
+    }
+
+    /// Truncation threshold accessor
+
+    /// \return The relative truncation threshold
+    static T threshold() { return threshold_; }
+
+    /// Set the truncation threshold
+
+    /// \param thresh The relative truncation threshold
+    static void threshold(const T thresh) { threshold_ = thresh; }
+
+    /// Maximum rank ratio accessor
+
+    /// \return The maximum ratio of the rank to the smallest matrix dimension
+    /// of tiles stored in low-rank form
+    static T max_rank_ratio() { return max_rank_ratio_; }
+
+    /// Set the maximum rank ratio
+
+    /// \param ratio The maximum ratio of the rank to the smallest matrix
+    /// dimension of tiles stored in low-rank form
+    static void max_rank_ratio(const T ratio) { max_rank_ratio_ = ratio; }
+
+    /// Deep copy
+
+    /// \return A deep copy of this tile
+    LowRankTensor_ clone() const {
+      LowRankTensor_ result;
+      if(pimpl_)
+        result.pimpl_ = std::make_shared<Impl>(*pimpl_);
+      return result;
+    }
+
+    /// Convert to a dense tensor
+
+    /// \return A dense tensor with the elements of this tile
+    explicit operator Tensor<T>() const {
+      TA_ASSERT(pimpl_);
+      Tensor<T> result(pimpl_->range_);
+      Eigen::Map<matrix_type>(result.data(), num_rows(pimpl_->range_, pimpl_->row_dims_),
+          num_cols(pimpl_->range_, pimpl_->row_dims_)) = matrix();
+      return result;
+    }
+
+    /// Tile range accessor
+
+    /// \return The tile range
+    const range_type& range() const {
+      TA_ASSERT(pimpl_);
+      return pimpl_->range_;
+    }
+
+    /// Tile size accessor
+
+    /// \return The number of elements in the tile
+    size_type size() const { return (pimpl_ ? pimpl_->range_.volume() : 0ul); }
+
+    /// Check for an empty tile
+
+    /// \return \c true if this tile is not initialized
+    bool empty() const { return ! pimpl_; }
+
+    /// Row dimension accessor
+
+    /// \return The number of leading tile dimensions that form the rows
+    unsigned int row_dims() const {
+      TA_ASSERT(pimpl_);
+      return pimpl_->row_dims_;
+    }
+
+    /// Check for dense storage
+
+    /// \return \c true if this tile is stored as a dense matrix
+    bool is_dense() const {
+      TA_ASSERT(pimpl_);
+      return pimpl_->dense_;
+    }
+
+    /// Rank accessor
+
+    /// \return The rank of the factors, or the smallest matrix dimension for
+    /// dense tiles
+    size_type rank() const {
+      TA_ASSERT(pimpl_);
+      return (pimpl_->dense_ ?
+          std::min(pimpl_->u_.rows(), pimpl_->u_.cols()) : pimpl_->u_.cols());
+    }
+
+    /// Left-hand factor accessor
+
+    /// \return The left-hand factor, or the dense matrix for dense tiles
+    const matrix_type& u() const {
+      TA_ASSERT(pimpl_);
+      return pimpl_->u_;
+    }
+
+    /// Right-hand factor accessor
+
+    /// \return The right-hand factor, which is empty for dense tiles
+    const matrix_type& v() const {
+      TA_ASSERT(pimpl_);
+      return pimpl_->v_;
+    }
+
+    /// Dense matrix
+
+    /// \return The matrix formed by the row and column dimensions of the tile
+    matrix_type matrix() const {
+      TA_ASSERT(pimpl_);
+      if(pimpl_->dense_)
+        return pimpl_->u_;
+      return pimpl_->u_ * pimpl_->v_.transpose();
+    }
+
+    /// Change the row dimensions of this tile
+
+    /// \param row_dims The number of leading dimensions that form the rows
+    /// \return A tile with \c row_dims row dimensions, which is a shallow
+    /// copy of this tile if the row dimensions are unchanged
+    LowRankTensor_ resplit(const unsigned int row_dims) const {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(row_dims <= pimpl_->range_.rank());
+      if(row_dims == pimpl_->row_dims_)
+        return *this;
+
+      LowRankTensor_ result;
+      result.pimpl_ = std::make_shared<Impl>(pimpl_->range_, row_dims);
+      const size_type rows = num_rows(pimpl_->range_, row_dims);
+      const size_type cols = num_cols(pimpl_->range_, row_dims);
+      if(pimpl_->dense_) {
+        // Dense data is stored in row-major order, so it is simply reshaped.
+        result.set_dense(Eigen::Map<const matrix_type>(pimpl_->u_.data(), rows, cols));
+      } else {
+        const matrix_type a = matrix();
+        result.compress(Eigen::Map<const matrix_type>(a.data(), rows, cols));
+      }
+      return result;
+    }
+
+    // Permutation operation ---------------------------------------------------
+
+    /// Create a permuted copy of this tile
+
+    /// If \c perm does not mix the row and column dimensions, the rows of the
+    /// factors are permuted. Otherwise the tile is permuted densely and
+    /// recompressed.
+    /// \param perm The permutation to be applied to this tile
+    /// \return A permuted copy of this tile
+    LowRankTensor_ permute(const Permutation& perm) const {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(perm.dim() == pimpl_->range_.rank());
+
+      const unsigned int n = pimpl_->range_.rank();
+      const unsigned int p = pimpl_->row_dims_;
+      const auto* MADNESS_RESTRICT const extent = pimpl_->range_.extent_data();
+
+      bool rows_fixed = true, rows_swapped = true;
+      for(unsigned int i = 0u; i < p; ++i) {
+        rows_fixed = rows_fixed && (perm[i] < p);
+        rows_swapped = rows_swapped && (perm[i] >= (n - p));
+      }
+
+      LowRankTensor_ result;
+      if(pimpl_->dense_ || ! (rows_fixed || rows_swapped)) {
+        const Tensor<T> tensor = static_cast<Tensor<T> >(*this).permute(perm);
+        result.pimpl_ = std::make_shared<Impl>(tensor.range(), p);
+        const Eigen::Map<const matrix_type> a(tensor.data(),
+            num_rows(tensor.range(), p), num_cols(tensor.range(), p));
+        if(pimpl_->dense_)
+          result.set_dense(a);
+        else
+          result.compress(a);
+        return result;
+      }
+
+      std::vector<size_type> row_extent(extent, extent + p), col_extent(extent + p, extent + n);
+      std::vector<unsigned int> row_perm, col_perm;
+      row_perm.reserve(p);
+      col_perm.reserve(n - p);
+      if(rows_fixed) {
+        for(unsigned int i = 0u; i < p; ++i)
+          row_perm.push_back(perm[i]);
+        for(unsigned int i = p; i < n; ++i)
+          col_perm.push_back(perm[i] - p);
+
+        result.pimpl_ = std::make_shared<Impl>(perm * pimpl_->range_, p);
+        result.pimpl_->u_ = permute_factor(pimpl_->u_, row_extent, row_perm);
+        result.pimpl_->v_ = permute_factor(pimpl_->v_, col_extent, col_perm);
+      } else {
+        // The row and column dimensions are exchanged
+        for(unsigned int i = 0u; i < p; ++i)
+          row_perm.push_back(perm[i] - (n - p));
+        for(unsigned int i = p; i < n; ++i)
+          col_perm.push_back(perm[i]);
+
+        result.pimpl_ = std::make_shared<Impl>(perm * pimpl_->range_, n - p);
+        result.pimpl_->u_ = permute_factor(pimpl_->v_, col_extent, col_perm);
+        result.pimpl_->v_ = permute_factor(pimpl_->u_, row_extent, row_perm);
+      }
+
+      return result;
+    }
+
+    // Scaling operations ------------------------------------------------------
+
+    /// Scale this tile
+
+    /// \param factor The scaling factor
+    /// \return A reference to this tile
+    LowRankTensor_& scale_to(const numeric_type factor) {
+      TA_ASSERT(pimpl_);
+      pimpl_->u_ *= factor;
+      return *this;
+    }
+
+    /// Create a scaled copy of this tile
+
+    /// \param factor The scaling factor
+    /// \return A scaled copy of this tile
+    LowRankTensor_ scale(const numeric_type factor) const {
+      LowRankTensor_ result = clone();
+      result.scale_to(factor);
+      return result;
+    }
+
+    /// Create a scaled and permuted copy of this tile
+
+    /// \param factor The scaling factor
+    /// \param perm The permutation to be applied to this tile
+    /// \return A scaled and permuted copy of this tile
+    LowRankTensor_ scale(const numeric_type factor, const Permutation& perm) const {
+      LowRankTensor_ result = permute(perm);
+      if(result.pimpl_ == pimpl_)
+        result = result.clone();
+      result.scale_to(factor);
+      return result;
+    }
+
+    /// Create a negated copy of this tile
+
+    /// \return A negated copy of this tile
+    LowRankTensor_ neg() const { return scale(numeric_type(-1)); }
+
+    /// Create a negated and permuted copy of this tile
+
+    /// \param perm The permutation to be applied to this tile
+    /// \return A negated and permuted copy of this tile
+    LowRankTensor_ neg(const Permutation& perm) const {
+      return scale(numeric_type(-1), perm);
+    }
+
+    /// Negate this tile
+
+    /// \return A reference to this tile
+    LowRankTensor_& neg_to() { return scale_to(numeric_type(-1)); }
+
+    // Addition operations -----------------------------------------------------
+
+    /// Add this tile and \c right
+
+    /// \param right The tile to be added to this tile
+    /// \return A recompressed tile that is equal to <tt>this + right</tt>
+    LowRankTensor_ add(const LowRankTensor_& right) const {
+      return add(*this, right, numeric_type(1), numeric_type(1));
+    }
+
+    /// Add and scale this tile and \c right
+
+    /// \param right The tile to be added to this tile
+    /// \param factor The scaling factor
+    /// \return A recompressed tile that is equal to <tt>(this + right) * factor</tt>
+    LowRankTensor_ add(const LowRankTensor_& right, const numeric_type factor) const {
+      return add(*this, right, factor, factor);
+    }
+
+    /// Add and permute this tile and \c right
+
+    /// \param right The tile to be added to this tile
+    /// \param perm The permutation to be applied to the result
+    /// \return A recompressed tile that is equal to <tt>perm ^ (this + right)</tt>
+    LowRankTensor_ add(const LowRankTensor_& right, const Permutation& perm) const {
+      return add(right).permute(perm);
+    }
+
+    /// Add, scale, and permute this tile and \c right
+
+    /// \param right The tile to be added to this tile
+    /// \param factor The scaling factor
+    /// \param perm The permutation to be applied to the result
+    /// \return A recompressed tile that is equal to
+    /// <tt>perm ^ (this + right) * factor</tt>
+    LowRankTensor_ add(const LowRankTensor_& right, const numeric_type factor,
+        const Permutation& perm) const
+    {
+      return add(right, factor).permute(perm);
+    }
+
+    /// Add \c right to this tile
+
+    /// \param right The tile to be added to this tile
+    /// \return A reference to this tile
+    LowRankTensor_& add_to(const LowRankTensor_& right) {
+      *pimpl_ = std::move(*add(right).pimpl_);
+      return *this;
+    }
+
+    /// Add \c right to this tile, and scale the result
+
+    /// \param right The tile to be added to this tile
+    /// \param factor The scaling factor
+    /// \return A reference to this tile
+    LowRankTensor_& add_to(const LowRankTensor_& right, const numeric_type factor) {
+      *pimpl_ = std::move(*add(right, factor).pimpl_);
+      return *this;
+    }
+
+    // Subtraction operations --------------------------------------------------
+
+    /// Subtract \c right from this tile
+
+    /// \param right The tile to be subtracted from this tile
+    /// \return A recompressed tile that is equal to <tt>this - right</tt>
+    LowRankTensor_ subt(const LowRankTensor_& right) const {
+      return add(*this, right, numeric_type(1), numeric_type(-1));
+    }
+
+    /// Subtract \c right from this tile, and scale the result
+
+    /// \param right The tile to be subtracted from this tile
+    /// \param factor The scaling factor
+    /// \return A recompressed tile that is equal to <tt>(this - right) * factor</tt>
+    LowRankTensor_ subt(const LowRankTensor_& right, const numeric_type factor) const {
+      return add(*this, right, factor, -factor);
+    }
+
+    /// Subtract \c right from this tile, and permute the result
+
+    /// \param right The tile to be subtracted from this tile
+    /// \param perm The permutation to be applied to the result
+    /// \return A recompressed tile that is equal to <tt>perm ^ (this - right)</tt>
+    LowRankTensor_ subt(const LowRankTensor_& right, const Permutation& perm) const {
+      return subt(right).permute(perm);
+    }
+
+    /// Subtract \c right from this tile, and scale and permute the result
+
+    /// \param right The tile to be subtracted from this tile
+    /// \param factor The scaling factor
+    /// \param perm The permutation to be applied to the result
+    /// \return A recompressed tile that is equal to
+    /// <tt>perm ^ (this - right) * factor</tt>
+    LowRankTensor_ subt(const LowRankTensor_& right, const numeric_type factor,
+        const Permutation& perm) const
+    {
+      return subt(right, factor).permute(perm);
+    }
+
+    /// Subtract \c right from this tile
+
+    /// \param right The tile to be subtracted from this tile
+    /// \return A reference to this tile
+    LowRankTensor_& subt_to(const LowRankTensor_& right) {
+      *pimpl_ = std::move(*subt(right).pimpl_);
+      return *this;
+    }
+
+    /// Subtract \c right from this tile, and scale the result
+
+    /// \param right The tile to be subtracted from this tile
+    /// \param factor The scaling factor
+    /// \return A reference to this tile
+    LowRankTensor_& subt_to(const LowRankTensor_& right, const numeric_type factor) {
+      *pimpl_ = std::move(*subt(right, factor).pimpl_);
+      return *this;
+    }
+
+    // Contraction operations --------------------------------------------------
+
+    /// Contract this tile with \c other
+
+    /// The product is computed from the factors of the arguments, and the
+    /// rank of the result is at most the smallest rank of the arguments.
+    /// \param other The right-hand argument
+    /// \param factor The scaling factor
+    /// \param gemm_helper The *GEMM operation meta data
+    /// \return A tile that is equal to <tt>op(this) * op(other) * factor</tt>
+    LowRankTensor_ gemm(const LowRankTensor_& other, const numeric_type factor,
+        const math::GemmHelper& gemm_helper) const
+    {
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(other.pimpl_);
+      TA_ASSERT(pimpl_->range_.rank() == gemm_helper.left_rank());
+      TA_ASSERT(other.pimpl_->range_.rank() == gemm_helper.right_rank());
+
+      const bool left_trans = (gemm_helper.left_op() != madness::cblas::NoTrans);
+      const bool right_trans = (gemm_helper.right_op() != madness::cblas::NoTrans);
+
+      // Split the arguments such that the rows and columns of the arguments
+      // are the outer and inner dimensions of the contraction.
+      const LowRankTensor_ left = resplit(left_trans ?
+          gemm_helper.left_inner_end() : gemm_helper.left_outer_end());
+      const LowRankTensor_ right = other.resplit(right_trans ?
+          gemm_helper.right_outer_end() : gemm_helper.right_inner_end());
+      const MatrixOp a(*left.pimpl_, left_trans), b(*right.pimpl_, right_trans);
+
+      LowRankTensor_ result;
+      result.pimpl_ = std::make_shared<Impl>(
+          gemm_helper.make_result_range<range_type>(pimpl_->range_, other.pimpl_->range_),
+          gemm_helper.left_outer_end() - gemm_helper.left_outer_begin());
+
+      if(a.dense && b.dense) {
+        result.set_dense(factor * (*a.dense) * (*b.dense));
+      } else if(a.dense) {
+        // (A * Ub) * Vb^T
+        result.set_factors(factor * (*a.dense) * (*b.u), matrix_type(*b.v));
+      } else if(b.dense) {
+        // Ua * (Va^T * B)
+        result.set_factors(factor * (*a.u), b.dense->transpose() * (*a.v));
+      } else {
+        // Ua * (Va^T * Ub) * Vb^T, where the core is merged into the factor
+        // that gives the smallest rank
+        const matrix_type core = a.v->transpose() * (*b.u);
+        if(a.u->cols() <= b.u->cols())
+          result.set_factors(factor * (*a.u), (*b.v) * core.transpose());
+        else
+          result.set_factors(factor * (*a.u) * core, matrix_type(*b.v));
+      }
+
+      return result;
+    }
+
+    /// Contract \c left and \c right and add the result to this tile
+
+    /// \param left The left-hand argument
+    /// \param right The right-hand argument
+    /// \param factor The scaling factor
+    /// \param gemm_helper The *GEMM operation meta data
+    /// \return A reference to this tile
+    LowRankTensor_& gemm(const LowRankTensor_& left, const LowRankTensor_& right,
+        const numeric_type factor, const math::GemmHelper& gemm_helper)
+    {
+      if(pimpl_)
+        add_to(left.gemm(right, factor, gemm_helper));
+      else
+        *this = left.gemm(right, factor, gemm_helper);
+      return *this;
+    }
+
+    // Reduction operations ----------------------------------------------------
+
+    /// Square of the vector 2-norm
+
+    /// \return The sum of the squared elements of this tile
+    scalar_type squared_norm() const {
+      TA_ASSERT(pimpl_);
+      if(pimpl_->dense_)
+        return pimpl_->u_.squaredNorm();
+      // ||U V^T||^2 = sum_ij (U^T U)_ij (V^T V)_ij
+      const matrix_type uu = pimpl_->u_.transpose() * pimpl_->u_;
+      const matrix_type vv = pimpl_->v_.transpose() * pimpl_->v_;
+      return std::max(uu.cwiseProduct(vv).sum(), scalar_type(0));
+    }
+
+    /// Vector 2-norm
+
+    /// This is the tile norm used by \c SparseShape .
+    /// \return The Frobenius norm of this tile
+    scalar_type norm() const { return std::sqrt(squared_norm()); }
+
+    // Serialization -----------------------------------------------------------
+
+    /// Output serialization function
+
+    /// \tparam Archive The output archive type
+    /// \param[out] ar The output archive
+    template <typename Archive,
+        typename std::enable_if<
+          madness::archive::is_output_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      const bool have_impl = bool(pimpl_);
+      ar & have_impl;
+      if(have_impl) {
+        ar & pimpl_->range_ & pimpl_->row_dims_ & pimpl_->dense_;
+        for(matrix_type* m : { &pimpl_->u_, &pimpl_->v_ }) {
+          const std::size_t rows = m->rows(), cols = m->cols();
+          ar & rows & cols & madness::archive::wrap(m->data(), m->size());
+        }
+      }
+    }
+
+    /// Input serialization function
+
+    /// \tparam Archive The input archive type
+    /// \param[out] ar The input archive
+    template <typename Archive,
+        typename std::enable_if<
+          madness::archive::is_input_archive<Archive>::value>::type* = nullptr>
+    void serialize(Archive& ar) {
+      bool have_impl = false;
+      ar & have_impl;
+      if(have_impl) {
+        std::shared_ptr<Impl> temp = std::make_shared<Impl>();
+        ar & temp->range_ & temp->row_dims_ & temp->dense_;
+        for(matrix_type* m : { &temp->u_, &temp->v_ }) {
+          std::size_t rows = 0ul, cols = 0ul;
+          ar & rows & cols;
+          m->resize(rows, cols);
+          ar & madness::archive::wrap(m->data(), m->size());
+        }
+        pimpl_ = temp;
+      } else {
+        pimpl_.reset();
+      }
+    }
+
+  }; // class LowRankTensor
+
+  template <typename T>
+  T LowRankTensor<T>::threshold_ = std::sqrt(std::numeric_limits<T>::epsilon());
+
+  template <typename T>
+  T LowRankTensor<T>::max_rank_ratio_ = T(0.5);
+
+  /// Low-rank tensor output operator
+
+  /// \tparam T The element type
+  /// \param os The output stream
+  /// \param tile The tile to be printed
+  /// \return A reference to the output stream
+  template <typename T>
+  inline std::ostream& operator<<(std::ostream& os, const LowRankTensor<T>& tile) {
+    if(tile.empty())
+      os << "{ }";
+    else
+      os << static_cast<Tensor<T> >(tile);
+    return os;
+  }
+
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TENSOR_LOW_RANK_TENSOR_H__INCLUDED
@@ -65,13 +65,13 @@ namespace TiledArray {
       /// Default constructor
 
       /// Construct an empty tensor that has no data or dimensions
-      Impl() : allocator_type(), range_(), data_(NULL) { }
+      Impl() : allocator_type(), range_(), data_(NULL), external_() { }
 
       /// Construct with range
 
       /// \param range The N-dimensional range for this tensor
       explicit Impl(const range_type& range) :
-        allocator_type(), range_(range), data_(NULL)
+        allocator_type(), range_(range), data_(NULL), external_()
       {
         data_ = allocator_type::allocate(range.volume());
       }
@@ -80,19 +80,31 @@ namespace TiledArray {
 
       /// \param range The N-dimensional range for this tensor
       explicit Impl(range_type&& range) :
-        allocator_type(), range_(range), data_(NULL)
+        allocator_type(), range_(range), data_(NULL), external_()
       {
         data_ = allocator_type::allocate(range.volume());
       }
 
+      /// Construct a view of external data
+
+      /// \param range The N-dimensional range for this tensor
+      /// \param data A shared pointer to the data, which holds the owner of
+      /// the data
+      Impl(const range_type& range, const std::shared_ptr<value_type>& data) :
+        allocator_type(), range_(range), data_(data.get()), external_(data)
+      { }
+
       ~Impl() {
-        math::destroy_vector(range_.volume(), data_);
-        allocator_type::deallocate(data_, range_.volume());
+        if(! external_) {
+          math::destroy_vector(range_.volume(), data_);
+          allocator_type::deallocate(data_, range_.volume());
+        }
         data_ = NULL;
       }
 
       range_type range_; ///< Tensor size info
       pointer data_; ///< Tensor data
+      std::shared_ptr<value_type> external_; ///< The owner of external data (null when the data is allocated)
     }; // class Impl
 
     template <typename... Ts>
@@ -181,6 +193,18 @@ namespace TiledArray {
         data[i] = *it++;
     }
 
+    /// Construct a view of external data
+
+    /// The tensor does not copy or free the data; it holds a reference to
+    /// \c data , so the aliasing constructor of \c std::shared_ptr can be
+    /// used to keep the owner of the data alive.
+    /// \param range The range of the tensor
+    /// \param data A shared pointer to the first of <tt>range.volume()</tt>
+    /// initialized elements
+    Tensor(const range_type& range, const std::shared_ptr<value_type>& data) :
+      pimpl_(std::make_shared<Impl>(range, data))
+    { }
+
     template <typename U>
     Tensor(const Range& range, const U* u) :
       pimpl_(std::make_shared<Impl>(range))
@@ -1262,6 +1286,138 @@ namespace TiledArray {
       return *this;
     }
 
+    /// Batched contraction of this tensor with \c other
+
+    /// The leading \c batch_rank dimensions of this tensor and \c other are
+    /// batch dimensions, which are not contracted. Each batch element is
+    /// contracted with a GEMM, as defined by \c gemm_helper for the remaining
+    /// dimensions, e.g.
+    /// \code
+    /// C[L...,M...,N...] = A[L...,M...,K...] * B[L...,K...,N...]
+    /// \endcode
+    /// \tparam U The other tensor element type
+    /// \tparam AU The other tensor allocator type
+    /// \tparam V The type of \c factor scalar
+    /// \param other The tensor that will be contracted with this tensor
+    /// \param factor Multiply the result by this constant
+    /// \param gemm_helper The *GEMM operation meta data for the non-batch
+    /// dimensions
+    /// \param batch_rank The number of batch dimensions
+    /// \return A new tensor which is the result of contracting this tensor with
+    /// \c other and scaled by \c factor
+    template <typename U, typename AU, typename V,
+              typename std::enable_if<!detail::is_tensor_of_tensor<
+                  Tensor_, Tensor<U, AU>>::value>::type* = nullptr>
+    Tensor_ batch_gemm(const Tensor<U, AU>& other, const V factor,
+        const math::GemmHelper& gemm_helper, const unsigned int batch_rank) const
+    {
+      // Check that the arguments are not empty and have the correct ranks
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(pimpl_->range_.rank() == gemm_helper.left_rank() + batch_rank);
+      TA_ASSERT(!other.empty());
+      TA_ASSERT(other.range().rank() == gemm_helper.right_rank() + batch_rank);
+      TA_ASSERT(std::equal(pimpl_->range_.extent_data(),
+          pimpl_->range_.extent_data() + batch_rank, other.range().extent_data()));
+
+      // Construct the result range, which has the batch dimensions followed by
+      // the outer dimensions of this tensor and other
+      const unsigned int result_rank = gemm_helper.result_rank() + batch_rank;
+      std::vector<size_type> lower, upper;
+      lower.reserve(result_rank);
+      upper.reserve(result_rank);
+      for(unsigned int i = 0u; i < batch_rank; ++i) {
+        lower.push_back(pimpl_->range_.lobound_data()[i]);
+        upper.push_back(pimpl_->range_.upbound_data()[i]);
+      }
+      for(unsigned int i = gemm_helper.left_outer_begin() + batch_rank;
+          i < gemm_helper.left_outer_end() + batch_rank; ++i)
+      {
+        lower.push_back(pimpl_->range_.lobound_data()[i]);
+        upper.push_back(pimpl_->range_.upbound_data()[i]);
+      }
+      for(unsigned int i = gemm_helper.right_outer_begin() + batch_rank;
+          i < gemm_helper.right_outer_end() + batch_rank; ++i)
+      {
+        lower.push_back(other.range().lobound_data()[i]);
+        upper.push_back(other.range().upbound_data()[i]);
+      }
+      Tensor_ result(range_type(lower, upper), numeric_type(0));
+
+      result.batch_gemm(*this, other, factor, gemm_helper, batch_rank);
+
+      return result;
+    }
+
+    /// Batched contraction of two tensors accumulated to this tensor
+
+    /// The leading \c batch_rank dimensions of this tensor and the arguments
+    /// are batch dimensions (see
+    /// <tt>batch_gemm(const Tensor<U, AU>&, const V, const math::GemmHelper&, const unsigned int)</tt> ).
+    /// \tparam U The left-hand tensor element type
+    /// \tparam AU The left-hand tensor allocator type
+    /// \tparam V The right-hand tensor element type
+    /// \tparam AV The right-hand tensor allocator type
+    /// \tparam W The type of the scaling factor
+    /// \param left The left-hand tensor that will be contracted
+    /// \param right The right-hand tensor that will be contracted
+    /// \param factor The contraction result will be scaling by this value, then accumulated into \c this
+    /// \param gemm_helper The *GEMM operation meta data for the non-batch
+    /// dimensions
+    /// \param batch_rank The number of batch dimensions
+    /// \return A reference to \c this
+    template <
+        typename U, typename AU, typename V, typename AV, typename W,
+        typename std::enable_if<!detail::is_tensor_of_tensor<
+            Tensor_, Tensor<U, AU>, Tensor<V, AV>>::value>::type* = nullptr>
+    Tensor_& batch_gemm(const Tensor<U, AU>& left, const Tensor<V, AV>& right,
+        const W factor, const math::GemmHelper& gemm_helper,
+        const unsigned int batch_rank)
+    {
+      // Check that this tensor and the arguments are not empty and have the
+      // correct ranks
+      TA_ASSERT(pimpl_);
+      TA_ASSERT(pimpl_->range_.rank() == gemm_helper.result_rank() + batch_rank);
+      TA_ASSERT(!left.empty());
+      TA_ASSERT(left.range().rank() == gemm_helper.left_rank() + batch_rank);
+      TA_ASSERT(!right.empty());
+      TA_ASSERT(right.range().rank() == gemm_helper.right_rank() + batch_rank);
+      TA_ASSERT(std::equal(left.range().extent_data(),
+          left.range().extent_data() + batch_rank, right.range().extent_data()));
+      TA_ASSERT(std::equal(left.range().extent_data(),
+          left.range().extent_data() + batch_rank, pimpl_->range_.extent_data()));
+
+      // Compute the batch size and the gemm dimensions
+      const auto* MADNESS_RESTRICT const left_extent = left.range().extent_data();
+      const auto* MADNESS_RESTRICT const right_extent = right.range().extent_data();
+      integer batch = 1, m = 1, n = 1, k = 1;
+      for(unsigned int i = 0u; i < batch_rank; ++i)
+        batch *= left_extent[i];
+      for(unsigned int i = gemm_helper.left_outer_begin();
+          i < gemm_helper.left_outer_end(); ++i)
+        m *= left_extent[i + batch_rank];
+      for(unsigned int i = gemm_helper.left_inner_begin();
+          i < gemm_helper.left_inner_end(); ++i)
+        k *= left_extent[i + batch_rank];
+      for(unsigned int i = gemm_helper.right_outer_begin();
+          i < gemm_helper.right_outer_end(); ++i)
+        n *= right_extent[i + batch_rank];
+
+      // Get the leading dimension for left and right matrices.
+      const integer lda =
+          (gemm_helper.left_op() == madness::cblas::NoTrans ? k : m);
+      const integer ldb =
+          (gemm_helper.right_op() == madness::cblas::NoTrans ? n : k);
+
+      // Contract each batch element
+      const integer mk = m * k, kn = k * n, mn = m * n;
+      for(integer i = 0; i < batch; ++i)
+        math::gemm(gemm_helper.left_op(), gemm_helper.right_op(), m, n, k, factor,
+            left.data() + i * mk, lda, right.data() + i * kn, ldb,
+            numeric_type(1), pimpl_->data_ + i * mn, n);
+
+      return *this;
+    }
+
     // Reduction operations
 
     /// Generalized tensor trace
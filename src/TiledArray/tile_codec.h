@@ -0,0 +1,480 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_CODEC_H__INCLUDED
+#define TILEDARRAY_TILE_CODEC_H__INCLUDED
+
+#include <TiledArray/error.h>
+#include <TiledArray/madness.h>
+#include <TiledArray/tensor.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace TiledArray {
+
+  /// Tile transport codec
+
+  /// A codec describes how tiles are encoded when they are moved between
+  /// processes, e.g. by the SUMMA broadcasts or by remote tile requests. The
+  /// default codec sends tiles unchanged. The lossless codec byte-shuffles the
+  /// tile data, so that bytes of equal significance are adjacent, and
+  /// run-length encodes the result. The lossy codecs reduce the precision of
+  /// the data before it is passed through the lossless stage:
+  /// \c downcast() rounds elements to single precision, and \c truncated()
+  /// clears the mantissa bits that are not needed to meet a relative
+  /// precision bound. Only tensors of real floating-point elements are
+  /// encoded; all other tiles are sent unchanged.
+  /// \note A natural precision bound for sparse arrays is the sparse shape
+  /// threshold, i.e. \c TileCodec::truncated(SparseShape<float>::threshold()) ,
+  /// since tile contributions below the threshold are already neglected.
+  class TileCodec {
+  public:
+    typedef enum {
+      none,               ///< Send tiles unchanged
+      shuffle_rle,        ///< Byte shuffle + run-length encoding
+      float32,            ///< Round to single precision, then \c shuffle_rle
+      truncate_mantissa   ///< Clear low mantissa bits, then \c shuffle_rle
+    } method_type;
+
+  private:
+    method_type method_; ///< The encoding method
+    unsigned int mantissa_bits_; ///< The number of mantissa bits that are kept by \c truncate_mantissa
+
+    TileCodec(const method_type method, const unsigned int mantissa_bits) :
+      method_(method), mantissa_bits_(mantissa_bits)
+    { }
+
+  public:
+
+    /// Default constructor
+
+    /// Construct a codec that does not modify tiles.
+    TileCodec() : method_(none), mantissa_bits_(0u) { }
+
+    TileCodec(const TileCodec&) = default;
+    TileCodec& operator=(const TileCodec&) = default;
+
+    /// Lossless codec factory
+
+    /// \return A codec that byte-shuffles and run-length encodes tiles
+    static TileCodec lossless() { return TileCodec(shuffle_rle, 0u); }
+
+    /// Single precision codec factory
+
+    /// Elements are rounded to single precision, so the relative error of
+    /// each element is bounded by \c std::numeric_limits<float>::epsilon()/2 .
+    /// \return A codec that transports tiles in single precision
+    static TileCodec downcast() { return TileCodec(float32, 0u); }
+
+    /// Truncating codec factory
+
+    /// \param precision The relative precision bound of each transported
+    /// element; must be greater than zero and less than one.
+    /// \return A codec that keeps only the leading mantissa bits needed to
+    /// represent each element with relative error less than \c precision
+    static TileCodec truncated(const double precision) {
+      TA_USER_ASSERT((precision > 0.0) && (precision < 1.0),
+          "TileCodec::truncated(): precision must be in the interval (0,1).");
+      const double bits = std::ceil(-std::log2(precision));
+      return TileCodec(truncate_mantissa, static_cast<unsigned int>(bits));
+    }
+
+    /// Encoding method accessor
+
+    /// \return The encoding method
+    method_type method() const { return method_; }
+
+    /// Mantissa bits accessor
+
+    /// \return The number of explicit mantissa bits kept by
+    /// \c truncate_mantissa , or zero for other methods.
+    unsigned int mantissa_bits() const { return mantissa_bits_; }
+
+    /// Check whether tiles are modified by this codec
+
+    /// \return \c true if tiles are encoded, otherwise \c false
+    bool enabled() const { return method_ != none; }
+
+    /// Check whether this codec loses information
+
+    /// \return \c true for \c float32 and \c truncate_mantissa codecs
+    bool lossy() const {
+      return (method_ == float32) || (method_ == truncate_mantissa);
+    }
+
+    /// Serialize codec data
+
+    /// \tparam Archive The archive type
+    /// \param ar The archive
+    template <typename Archive>
+    void serialize(Archive& ar) {
+      int method = method_;
+      ar & method & mantissa_bits_;
+      method_ = static_cast<method_type>(method);
+    }
+
+  }; // class TileCodec
+
+  namespace detail {
+
+    /// Byte shuffle
+
+    /// Reorder the bytes of \c n elements of \c size bytes each, such that
+    /// byte \c b of all elements are stored contiguously.
+    /// \param[in] in The input elements
+    /// \param[out] out The shuffled bytes
+    /// \param[in] n The number of elements
+    /// \param[in] size The size of each element in bytes
+    inline void byte_shuffle(const unsigned char* const in,
+        unsigned char* const out, const std::size_t n, const std::size_t size)
+    {
+      for(std::size_t i = 0ul; i < n; ++i)
+        for(std::size_t b = 0ul; b < size; ++b)
+          out[b * n + i] = in[i * size + b];
+    }
+
+    /// Inverse of \c byte_shuffle
+
+    /// \param[in] in The shuffled bytes
+    /// \param[out] out The output elements
+    /// \param[in] n The number of elements
+    /// \param[in] size The size of each element in bytes
+    inline void byte_unshuffle(const unsigned char* const in,
+        unsigned char* const out, const std::size_t n, const std::size_t size)
+    {
+      for(std::size_t b = 0ul; b < size; ++b)
+        for(std::size_t i = 0ul; i < n; ++i)
+          out[i * size + b] = in[b * n + i];
+    }
+
+    /// Append a variable length (LEB128) unsigned integer to \c out
+    inline void rle_put_count(std::vector<unsigned char>& out, std::size_t count) {
+      while(count >= 0x80ul) {
+        out.push_back(static_cast<unsigned char>(count | 0x80ul));
+        count >>= 7;
+      }
+      out.push_back(static_cast<unsigned char>(count));
+    }
+
+    /// Read a variable length (LEB128) unsigned integer and advance \c in
+    inline std::size_t rle_get_count(const unsigned char*& in,
+        const unsigned char* const end)
+    {
+      std::size_t count = 0ul;
+      unsigned int shift = 0u;
+      for(; in != end; shift += 7u) {
+        const unsigned char byte = *in++;
+        count |= std::size_t(byte & 0x7fu) << shift;
+        if(! (byte & 0x80u))
+          return count;
+      }
+      TA_EXCEPTION("Truncated run-length encoded data.");
+      return count;
+    }
+
+    /// Run-length encode a byte sequence
+
+    /// The encoded stream is a sequence of blocks, each led by a count
+    /// \c c . If the low bit of \c c is set, the next byte is repeated
+    /// <tt>c >> 1</tt> times; otherwise the next <tt>c >> 1</tt> bytes are
+    /// copied verbatim.
+    /// \param[in] in The input bytes
+    /// \param[in] n The number of input bytes
+    /// \param[out] out The encoded stream is appended to this vector
+    inline void rle_encode(const unsigned char* const in, const std::size_t n,
+        std::vector<unsigned char>& out)
+    {
+      // Runs shorter than this are cheaper to store as literals
+      const std::size_t min_run = 4ul;
+
+      std::size_t first = 0ul; // The first byte of the pending literal block
+      std::size_t i = 0ul;
+      while(i < n) {
+        std::size_t run = 1ul;
+        while((i + run < n) && (in[i + run] == in[i]))
+          ++run;
+
+        if(run >= min_run) {
+          if(i > first) {
+            rle_put_count(out, (i - first) << 1);
+            out.insert(out.end(), in + first, in + i);
+          }
+          rle_put_count(out, (run << 1) | 1ul);
+          out.push_back(in[i]);
+          first = i + run;
+        }
+
+        i += run;
+      }
+
+      if(n > first) {
+        rle_put_count(out, (n - first) << 1);
+        out.insert(out.end(), in + first, in + n);
+      }
+    }
+
+    /// Decode a run-length encoded byte sequence
+
+    /// \param[in] in The encoded stream
+    /// \param[in] size The size of the encoded stream
+    /// \param[out] out The decoded bytes
+    /// \param[in] n The number of decoded bytes
+    inline void rle_decode(const unsigned char* in, const std::size_t size,
+        unsigned char* const out, const std::size_t n)
+    {
+      const unsigned char* const end = in + size;
+      std::size_t i = 0ul;
+      while(in != end) {
+        const std::size_t count = rle_get_count(in, end);
+        const std::size_t length = count >> 1;
+        TA_ASSERT(i + length <= n);
+        if(count & 1ul) {
+          TA_ASSERT(in != end);
+          std::memset(out + i, *in++, length);
+        } else {
+          TA_ASSERT(length <= std::size_t(end - in));
+          std::memcpy(out + i, in, length);
+          in += length;
+        }
+        i += length;
+      }
+      TA_ASSERT(i == n);
+    }
+
+    /// Clear the low mantissa bits of floating point numbers
+
+    /// Each element is truncated toward zero, so the relative error of each
+    /// element is less than <tt>2^-bits</tt> .
+    /// \tparam T A floating point type
+    /// \param[in,out] data The elements to be truncated
+    /// \param[in] n The number of elements
+    /// \param[in] bits The number of explicit mantissa bits to keep
+    template <typename T>
+    inline void truncate_mantissa(T* const data, const std::size_t n,
+        const unsigned int bits)
+    {
+      static_assert(std::numeric_limits<T>::is_iec559 &&
+          ((sizeof(T) == sizeof(std::uint32_t)) || (sizeof(T) == sizeof(std::uint64_t))),
+          "truncate_mantissa() requires IEEE single or double precision");
+      typedef typename std::conditional<sizeof(T) == sizeof(std::uint32_t),
+          std::uint32_t, std::uint64_t>::type int_type;
+
+      const unsigned int explicit_bits = std::numeric_limits<T>::digits - 1;
+      if(bits >= explicit_bits)
+        return;
+
+      const int_type mask = ~((int_type(1) << (explicit_bits - bits)) - int_type(1));
+      for(std::size_t i = 0ul; i < n; ++i) {
+        int_type x;
+        std::memcpy(&x, data + i, sizeof(T));
+        x &= mask;
+        std::memcpy(data + i, &x, sizeof(T));
+      }
+    }
+
+    /// Encoded tile used for tile transport
+
+    /// This generic implementation does not encode the tile; it is used for
+    /// all tile types that are not tensors of real floating point elements.
+    /// \tparam Tile The tile type
+    template <typename Tile, typename Enabler = void>
+    class PackedTile {
+      Tile tile_; ///< The tile
+
+    public:
+      PackedTile() = default;
+
+      /// Constructor
+
+      /// \param tile The tile to be encoded
+      PackedTile(const Tile& tile, const TileCodec&) : tile_(tile) { }
+
+      /// Decode tile
+
+      /// \return The decoded tile
+      Tile unpack() const { return tile_; }
+
+      template <typename Archive>
+      void serialize(Archive& ar) { ar & tile_; }
+    }; // class PackedTile
+
+
+    /// Encoded tensor of floating point elements
+
+    /// \tparam T The tensor element type
+    /// \tparam A The tensor allocator type
+    template <typename T, typename A>
+    class PackedTile<Tensor<T, A>,
+        typename std::enable_if<std::is_floating_point<T>::value>::type>
+    {
+    public:
+      typedef Tensor<T, A> tile_type; ///< The tile type
+
+    private:
+      /// Encoding flags
+      enum {
+        empty_flag = 1,       ///< The tile is empty
+        single_flag = 2,      ///< Elements are stored in single precision
+        rle_flag = 4          ///< Shuffled bytes are run-length encoded
+      };
+
+      Range range_; ///< The tile range
+      int flags_; ///< Encoding flags
+      std::vector<unsigned char> data_; ///< Encoded tile data
+
+      /// Shuffle and run-length encode elements
+
+      /// The shuffled bytes are stored without run-length encoding when it
+      /// does not reduce the size of the data.
+      /// \tparam U The element type
+      /// \param data The elements to be encoded
+      /// \param n The number of elements
+      template <typename U>
+      void encode(const U* const data, const std::size_t n) {
+        const std::size_t bytes = n * sizeof(U);
+        std::vector<unsigned char> shuffled(bytes);
+        byte_shuffle(reinterpret_cast<const unsigned char*>(data),
+            shuffled.data(), n, sizeof(U));
+
+        data_.reserve(bytes);
+        rle_encode(shuffled.data(), bytes, data_);
+        if(data_.size() < bytes) {
+          flags_ |= rle_flag;
+          data_.shrink_to_fit();
+        } else {
+          data_.swap(shuffled);
+        }
+      }
+
+      /// Decode elements
+
+      /// \tparam U The element type
+      /// \param data The decoded elements
+      /// \param n The number of elements
+      template <typename U>
+      void decode(U* const data, const std::size_t n) const {
+        const std::size_t bytes = n * sizeof(U);
+        if(flags_ & rle_flag) {
+          std::vector<unsigned char> shuffled(bytes);
+          rle_decode(data_.data(), data_.size(), shuffled.data(), bytes);
+          byte_unshuffle(shuffled.data(), reinterpret_cast<unsigned char*>(data),
+              n, sizeof(U));
+        } else {
+          TA_ASSERT(data_.size() == bytes);
+          byte_unshuffle(data_.data(), reinterpret_cast<unsigned char*>(data),
+              n, sizeof(U));
+        }
+      }
+
+    public:
+      PackedTile() : range_(), flags_(empty_flag), data_() { }
+
+      /// Constructor
+
+      /// \param tile The tile to be encoded
+      /// \param codec The codec used to encode \c tile
+      PackedTile(const tile_type& tile, const TileCodec& codec) :
+        range_(), flags_(0), data_()
+      {
+        if(tile.empty()) {
+          flags_ = empty_flag;
+          return;
+        }
+
+        range_ = tile.range();
+        const std::size_t n = tile.size();
+
+        if((codec.method() == TileCodec::float32) && (sizeof(T) > sizeof(float))) {
+          flags_ |= single_flag;
+          const std::vector<float> buffer(tile.data(), tile.data() + n);
+          encode(buffer.data(), n);
+        } else if(codec.method() == TileCodec::truncate_mantissa) {
+          std::vector<T> buffer(tile.data(), tile.data() + n);
+          truncate_mantissa(buffer.data(), n, codec.mantissa_bits());
+          encode(buffer.data(), n);
+        } else {
+          encode(tile.data(), n);
+        }
+      }
+
+      /// Decode tile
+
+      /// \return The decoded tile
+      tile_type unpack() const {
+        if(flags_ & empty_flag)
+          return tile_type();
+
+        tile_type result(range_);
+        const std::size_t n = range_.volume();
+        if(flags_ & single_flag) {
+          std::vector<float> buffer(n);
+          decode(buffer.data(), n);
+          std::copy(buffer.begin(), buffer.end(), result.data());
+        } else {
+          decode(result.data(), n);
+        }
+
+        return result;
+      }
+
+      /// Encoded size accessor
+
+      /// \return The size of the encoded tile data in bytes
+      std::size_t encoded_size() const { return data_.size(); }
+
+      /// Decoded size accessor
+
+      /// \return The size of the decoded tile data in bytes
+      std::size_t decoded_size() const {
+        return (flags_ & empty_flag ? 0ul : range_.volume() * sizeof(T));
+      }
+
+      template <typename Archive>
+      void serialize(Archive& ar) { ar & range_ & flags_ & data_; }
+
+    }; // class PackedTile<Tensor<T, A> >
+
+    /// Encode a tile
+
+    /// \tparam Tile The tile type
+    /// \param tile The tile to be encoded
+    /// \param codec The codec used to encode \c tile
+    /// \return The encoded tile
+    template <typename Tile>
+    inline PackedTile<Tile> pack_tile(const Tile& tile, const TileCodec& codec) {
+      return PackedTile<Tile>(tile, codec);
+    }
+
+    /// Decode a tile
+
+    /// \tparam Tile The tile type
+    /// \param packed The encoded tile
+    /// \return The decoded tile
+    template <typename Tile>
+    inline Tile unpack_tile(const PackedTile<Tile>& packed) {
+      return packed.unpack();
+    }
+
+  }  // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TILE_CODEC_H__INCLUDED
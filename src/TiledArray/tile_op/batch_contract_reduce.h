@@ -0,0 +1,222 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  batch_contract_reduce.h
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_OP_BATCH_CONTRACT_REDUCE_H__INCLUDED
+#define TILEDARRAY_TILE_OP_BATCH_CONTRACT_REDUCE_H__INCLUDED
+
+#include <TiledArray/permutation.h>
+#include <TiledArray/math/gemm_helper.h>
+#include <TiledArray/tile_op/tile_interface.h>
+#include "../tile_interface/add.h"
+#include "../tile_interface/permute.h"
+
+namespace TiledArray {
+
+  // Forward declarations
+  template <typename, typename> class Tensor;
+
+  namespace detail {
+
+    /// Batched contraction support trait
+
+    /// \c value is \c true when tiles of type \c Left and \c Right can be
+    /// contracted to \c Result with \c BatchContractReduce , i.e. all tiles are
+    /// tensors of numeric elements and \c Scalar is a numeric type.
+    /// \tparam Result The result tile type
+    /// \tparam Left The left-hand tile type
+    /// \tparam Right The right-hand tile type
+    /// \tparam Scalar The scaling factor type
+    template <typename Result, typename Left, typename Right, typename Scalar>
+    struct is_batch_contractable : public std::false_type { };
+
+    template <typename T, typename A, typename U, typename AU, typename V,
+        typename AV, typename Scalar>
+    struct is_batch_contractable<Tensor<T, A>, Tensor<U, AU>, Tensor<V, AV>, Scalar> :
+        public std::integral_constant<bool, is_numeric<T>::value &&
+            is_numeric<U>::value && is_numeric<V>::value &&
+            is_numeric<Scalar>::value>
+    { };
+
+    /// Batched contract and (sum) reduce operation
+
+    /// This encodes a binary tensor contraction with batch (shared external)
+    /// dimensions, e.g. \code C[L...,M...,N...] = A[L...,M...,K...] * B[L...,K...,N...] \endcode ,
+    /// where each batch element is contracted with a GEMM, as well as the sum
+    /// reduction and post-processing. The batch dimensions are the leading
+    /// dimensions of the argument and result tiles. This object has shallow
+    /// copy semantics.
+    /// \tparam Result The result tile type
+    /// \tparam Left The left-hand tile type
+    /// \tparam Right The right-hand tile type
+    /// \tparam Scalar The scaling factor type
+    template <typename Result, typename Left, typename Right, typename Scalar>
+    class BatchContractReduce {
+    public:
+      typedef BatchContractReduce<Result, Left, Right, Scalar>
+          BatchContractReduce_; ///< This class type
+      typedef const Left& first_argument_type; ///< The left tile type
+      typedef const Right& second_argument_type; ///< The right tile type
+      typedef Result result_type; ///< The result tile type
+      typedef Scalar scalar_type; ///< The scaling factor type
+
+    private:
+
+      struct Impl {
+        Impl(const scalar_type alpha, const unsigned int result_rank,
+            const unsigned int left_rank, const unsigned int right_rank,
+            const unsigned int batch_rank, const Permutation& perm) :
+          gemm_helper_(madness::cblas::NoTrans, madness::cblas::NoTrans,
+              result_rank - batch_rank, left_rank - batch_rank,
+              right_rank - batch_rank),
+          batch_rank_(batch_rank), alpha_(alpha), perm_(perm)
+        { }
+
+        math::GemmHelper gemm_helper_; ///< Gemm helper object for the
+            ///< non-batch dimensions
+        unsigned int batch_rank_; ///< The number of batch dimensions
+        scalar_type alpha_; ///< Scaling factor applied to the contraction of
+            ///< the left- and right-hand arguments
+        Permutation perm_; ///< Permutation that is applied to the final result
+            ///< tensor
+      };
+
+      std::shared_ptr<Impl> pimpl_;
+
+    public:
+
+      // Compiler generated defaults are fine. N.B. this is shallow-copy.
+
+      BatchContractReduce() = default;
+      BatchContractReduce(const BatchContractReduce_&) = default;
+      BatchContractReduce(BatchContractReduce_&&) = default;
+      ~BatchContractReduce() = default;
+      BatchContractReduce_& operator=(const BatchContractReduce_&) = default;
+      BatchContractReduce_& operator=(BatchContractReduce_&&) = default;
+
+      /// Construct batched contract/reduce functor
+
+      /// \param alpha The scaling factor applied to the contracted tiles
+      /// \param result_rank The rank of the result tensor
+      /// \param left_rank The rank of the left-hand tensor
+      /// \param right_rank The rank of the right-hand tensor
+      /// \param batch_rank The number of batch dimensions
+      /// \param perm The permutation to be applied to the result tensor
+      /// (default = no permute)
+      BatchContractReduce(const scalar_type alpha,
+          const unsigned int result_rank, const unsigned int left_rank,
+          const unsigned int right_rank, const unsigned int batch_rank,
+          const Permutation& perm = Permutation()) :
+        pimpl_(std::make_shared<Impl>(alpha, result_rank, left_rank,
+            right_rank, batch_rank, perm))
+      {
+        TA_ASSERT(batch_rank > 0u);
+        TA_ASSERT(batch_rank <= left_rank);
+        TA_ASSERT(batch_rank <= right_rank);
+      }
+
+      /// Gemm meta data accessor
+
+      /// \return A const reference to the gemm helper object for the
+      /// non-batch dimensions
+      const math::GemmHelper& gemm_helper() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->gemm_helper_;
+      }
+
+      /// Batch rank accessor
+
+      /// \return The number of batch dimensions
+      unsigned int batch_rank() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->batch_rank_;
+      }
+
+      /// Permutation accessor
+
+      /// \return A const reference to the permutation for this operation
+      const Permutation& perm() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->perm_;
+      }
+
+      /// Scaling factor accessor
+
+      /// \return The scaling factor for this operation
+      scalar_type factor() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->alpha_;
+      }
+
+      /// Create a result type object
+
+      /// Initialize a result object for subsequent reductions
+      result_type operator()() const {
+        return result_type();
+      }
+
+      /// Post processing step
+      result_type operator()(const result_type& temp) const {
+        using TiledArray::empty;
+        TA_ASSERT(! empty(temp));
+
+        if(! perm())
+          return temp;
+
+        TiledArray::Permute<result_type, result_type> permute;
+        return permute(temp, perm());
+      }
+
+      /// Reduce two result objects
+
+      /// Add \c arg to \c result .
+      /// \param[in,out] result The result object that will be the reduction
+      /// target
+      /// \param[in] arg The argument that will be added to \c result
+      void operator()(result_type& result, const result_type& arg) const {
+        using TiledArray::add_to;
+        add_to(result, arg);
+      }
+
+      /// Contract a pair of tiles and add to a target tile
+
+      /// Contract each batch element of \c left and \c right and add the
+      /// result to \c result.
+      /// \param[in,out] result The result object that will be the reduction
+      /// target
+      /// \param[in] left The left-hand tile to be contracted
+      /// \param[in] right The right-hand tile to be contracted
+      void operator()(result_type& result, first_argument_type left,
+          second_argument_type right) const
+      {
+        using TiledArray::empty;
+        using TiledArray::batch_gemm;
+        if(empty(result))
+          result = batch_gemm(left, right, factor(), gemm_helper(), batch_rank());
+        else
+          batch_gemm(result, left, right, factor(), gemm_helper(), batch_rank());
+      }
+
+    }; // class BatchContractReduce
+
+  } // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TILE_OP_BATCH_CONTRACT_REDUCE_H__INCLUDED
@@ -32,6 +32,7 @@
 #include "../tile_interface/add.h"
 #include "../tile_interface/permute.h"
 #include <TiledArray/tensor/complex.h>
+#include <TiledArray/mixed_precision.h>
 
 namespace TiledArray {
   namespace detail {
@@ -63,7 +64,7 @@ namespace TiledArray {
             const unsigned int left_rank, const unsigned int right_rank,
             const Permutation& perm = Permutation()) :
           gemm_helper_(left_op, right_op, result_rank, left_rank, right_rank),
-          alpha_(alpha), perm_(perm)
+          alpha_(alpha), perm_(perm), mixed_precision_()
         { }
 
         math::GemmHelper gemm_helper_; ///< Gemm helper object
@@ -71,6 +72,8 @@ namespace TiledArray {
             ///< the left- and right-hand arguments
         Permutation perm_; ///< Permutation that is applied to the final result
             ///< tensor
+        std::shared_ptr<MixedPrecision> mixed_precision_; ///< Mixed precision
+            ///< control (null for full precision contractions)
       };
 
       std::shared_ptr<Impl> pimpl_;
@@ -131,6 +134,25 @@ namespace TiledArray {
         return pimpl_->alpha_;
       }
 
+      /// Mixed precision control accessor
+
+      /// \return A const reference to the mixed precision control object, which
+      /// is null when all products are computed in full precision
+      const std::shared_ptr<MixedPrecision>& mixed_precision() const {
+        TA_ASSERT(pimpl_);
+        return pimpl_->mixed_precision_;
+      }
+
+      /// Set the mixed precision control object
+
+      /// \param mixed_precision The mixed precision control object that
+      /// selects the precision of each tile product; if null, all products
+      /// are computed in full precision
+      void set_mixed_precision(const std::shared_ptr<MixedPrecision>& mixed_precision) {
+        TA_ASSERT(pimpl_);
+        pimpl_->mixed_precision_ = mixed_precision;
+      }
+
       //-------------- these are only used for unit tests -----------------
       
       /// Compute the number of contracted ranks
@@ -261,6 +283,12 @@ namespace TiledArray {
       {
         using TiledArray::empty;
         using TiledArray::gemm;
+        if(ContractReduceBase_::mixed_precision() &&
+            mixed_precision_gemm(*ContractReduceBase_::mixed_precision(), result,
+            left, right, ContractReduceBase_::factor(),
+            ContractReduceBase_::gemm_helper()))
+          return;
+
         if(empty(result))
           result = gemm(left, right, ContractReduceBase_::factor(),
               ContractReduceBase_::gemm_helper());
@@ -373,6 +401,11 @@ namespace TiledArray {
       {
         using TiledArray::empty;
         using TiledArray::gemm;
+        if(ContractReduceBase_::mixed_precision() &&
+            mixed_precision_gemm(*ContractReduceBase_::mixed_precision(), result,
+            left, right, 1, ContractReduceBase_::gemm_helper()))
+          return;
+
         if(empty(result))
           result = gemm(left, right, 1, ContractReduceBase_::gemm_helper());
         else
@@ -485,6 +518,11 @@ namespace TiledArray {
       {
         using TiledArray::empty;
         using TiledArray::gemm;
+        if(ContractReduceBase_::mixed_precision() &&
+            mixed_precision_gemm(*ContractReduceBase_::mixed_precision(), result,
+            left, right, 1, ContractReduceBase_::gemm_helper()))
+          return;
+
         if(empty(result))
           result = gemm(left, right, 1, ContractReduceBase_::gemm_helper());
         else
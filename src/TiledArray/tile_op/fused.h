@@ -0,0 +1,186 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  fused.h
+ *
+ */
+
+#ifndef TILEDARRAY_TILE_OP_FUSED_H__INCLUDED
+#define TILEDARRAY_TILE_OP_FUSED_H__INCLUDED
+
+#include <TiledArray/permutation.h>
+#include <TiledArray/tensor/kernels.h>
+#include <tuple>
+#include <utility>
+
+namespace TiledArray {
+
+  // Forward declarations
+  template <typename, typename> class Tensor;
+
+  namespace detail {
+
+    /// The maximum number of leaves of a fused element-wise expression
+    static constexpr unsigned int max_fused_leaves = 7u;
+
+    /// Fused tile trait
+
+    /// \c value is \c true when tiles of type \c T can be evaluated with a
+    /// fused element-wise operation, i.e. \c T is a tensor of numeric
+    /// elements.
+    /// \tparam T The tile type
+    template <typename T>
+    struct is_fusable_tile : public std::false_type { };
+
+    template <typename T, typename A>
+    struct is_fusable_tile<Tensor<T, A> > :
+        public std::integral_constant<bool, is_numeric<T>::value>
+    { };
+
+    /// Fused scaling factor trait
+
+    /// \c value is \c true when \c S is a plain numeric scaling factor, i.e.
+    /// not a \c ComplexConjugate operator.
+    /// \tparam S The scaling factor type
+    template <typename S>
+    struct is_fusable_scalar :
+        public std::integral_constant<bool, std::is_arithmetic<S>::value ||
+            is_complex<S>::value>
+    { };
+
+    /// Fused binary element operation
+
+    /// This operation applies a binary element operation to the results of
+    /// the element operations of the left- and right-hand subexpressions,
+    /// where the first \c N arguments are the leaf elements of the left-hand
+    /// subexpression and the remaining arguments are the leaf elements of the
+    /// right-hand subexpression.
+    /// \tparam N The number of leaves of the left-hand subexpression
+    /// \tparam Left The left-hand element operation type
+    /// \tparam Right The right-hand element operation type
+    /// \tparam Op The binary element operation type
+    template <unsigned int N, typename Left, typename Right, typename Op>
+    class FusedBinaryOp {
+      Left left_; ///< The left-hand element operation
+      Right right_; ///< The right-hand element operation
+      Op op_; ///< The binary element operation
+
+      template <typename Args, std::size_t... L, std::size_t... R>
+      auto eval(const Args& args, std::index_sequence<L...>,
+          std::index_sequence<R...>) const
+      {
+        return op_(left_(std::get<L>(args)...),
+            right_(std::get<N + R>(args)...));
+      }
+
+    public:
+
+      /// Constructor
+
+      /// \param left The left-hand element operation
+      /// \param right The right-hand element operation
+      /// \param op The binary element operation
+      FusedBinaryOp(const Left& left, const Right& right, const Op& op) :
+        left_(left), right_(right), op_(op)
+      { }
+
+      /// Evaluate an element
+
+      /// \tparam Ts The leaf element types
+      /// \param args The leaf elements
+      /// \return The result element
+      template <typename... Ts>
+      auto operator()(const Ts&... args) const {
+        static_assert(sizeof...(Ts) > N, "Too few leaf elements.");
+        return eval(std::forward_as_tuple(args...),
+            std::make_index_sequence<N>(),
+            std::make_index_sequence<sizeof...(Ts) - N>());
+      }
+
+    }; // class FusedBinaryOp
+
+    /// Fused binary element operation factory function
+
+    /// \tparam N The number of leaves of the left-hand subexpression
+    /// \param left The left-hand element operation
+    /// \param right The right-hand element operation
+    /// \param op The binary element operation
+    /// \return The fused element operation
+    template <unsigned int N, typename Left, typename Right, typename Op>
+    inline FusedBinaryOp<N, Left, Right, Op>
+    make_fused_binary_op(const Left& left, const Right& right, const Op& op) {
+      return FusedBinaryOp<N, Left, Right, Op>(left, right, op);
+    }
+
+    /// Fused element-wise tile operation
+
+    /// This operation evaluates a tree of element-wise operations with a
+    /// single pass over the leaf tiles of the tree, and applies a
+    /// permutation to the result tensor. If no permutation is given or the
+    /// permutation is null, then the result is not permuted.
+    /// \tparam Result The result tile type
+    /// \tparam ElementOp The fused element operation type
+    template <typename Result, typename ElementOp>
+    class Fused {
+    public:
+      typedef Fused<Result, ElementOp> Fused_; ///< This object type
+      typedef Result result_type; ///< The result tile type
+      typedef ElementOp element_op_type; ///< The element operation type
+
+    private:
+
+      element_op_type op_; ///< The fused element operation
+      Permutation perm_; ///< The result permutation
+
+    public:
+
+      /// Constructor
+
+      /// \param op The fused element operation
+      /// \param perm The permutation applied to the result tile
+      /// (default = no permute)
+      explicit Fused(const element_op_type& op,
+          const Permutation& perm = Permutation()) :
+        op_(op), perm_(perm)
+      { }
+
+      /// Evaluate the result tile
+
+      /// \tparam T1 The first leaf tile type
+      /// \tparam Ts The remaining leaf tile types
+      /// \param tile1 The first leaf tile
+      /// \param tiles The remaining leaf tiles
+      /// \return The result tile
+      template <typename T1, typename... Ts>
+      result_type operator()(const T1& tile1, const Ts&... tiles) const {
+        if(perm_) {
+          result_type result(perm_ * tile1.range());
+          tensor_init(op_, perm_, result, tile1, tiles...);
+          return result;
+        }
+
+        result_type result(tile1.range());
+        tensor_init(op_, result, tile1, tiles...);
+        return result;
+      }
+
+    }; // class Fused
+
+  } // namespace detail
+} // namespace TiledArray
+
+#endif // TILEDARRAY_TILE_OP_FUSED_H__INCLUDED
@@ -654,6 +654,48 @@ namespace TiledArray {
   template <typename... T>
   using result_of_gemm_t = decltype(gemm(std::declval<T>()...));
 
+  /// Batched contraction and scaling of tile arguments
+
+  /// The leading \c batch_rank dimensions of the arguments are batch
+  /// dimensions, which are not contracted. The remaining dimensions of each
+  /// batch element are contracted via a GEMM operation with fused indices as
+  /// defined by \c gemm_config.
+  /// \tparam Left The left-hand tile type
+  /// \tparam Right The right-hand tile type
+  /// \tparam Scalar A scalar type
+  /// \param left The left-hand argument to be contracted
+  /// \param right The right-hand argument to be contracted
+  /// \param factor The scaling factor
+  /// \param gemm_config A helper object used to simplify gemm operations
+  /// \param batch_rank The number of batch dimensions
+  /// \return A tile that is equal to <tt>(left * right) * factor</tt>
+  template <typename Left, typename Right, typename Scalar,
+      typename std::enable_if<TiledArray::detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline auto batch_gemm(const Left& left, const Right& right,
+      const Scalar factor, const math::GemmHelper& gemm_config,
+      const unsigned int batch_rank)
+  { return left.batch_gemm(right, factor, gemm_config, batch_rank); }
+
+  /// Batched contraction and scaling of tile arguments to the result tile
+
+  /// \tparam Result The result tile type
+  /// \tparam Left The left-hand tile type
+  /// \tparam Right The right-hand tile type
+  /// \tparam Scalar A scalar type
+  /// \param result The contracted result
+  /// \param left The left-hand argument to be contracted
+  /// \param right The right-hand argument to be contracted
+  /// \param factor The scaling factor
+  /// \param gemm_config A helper object used to simplify gemm operations
+  /// \param batch_rank The number of batch dimensions
+  /// \return A tile that is equal to <tt>result += (left * right) * factor</tt>
+  template <typename Result, typename Left, typename Right, typename Scalar,
+      typename std::enable_if<TiledArray::detail::is_numeric<Scalar>::value>::type* = nullptr>
+  inline Result& batch_gemm(Result& result, const Left& left, const Right& right,
+      const Scalar factor, const math::GemmHelper& gemm_config,
+      const unsigned int batch_rank)
+  { return result.batch_gemm(left, right, factor, gemm_config, batch_rank); }
+
   // Reduction operations ------------------------------------------------------
 
   /// Sum the hyper-diagonal elements a tile
@@ -24,7 +24,7 @@
 #include <TiledArray/type_traits.h>
 #include <vector>
 #include <initializer_list>
-#include <mutex>
+#include <algorithm>
 #include <cassert>
 
 namespace TiledArray {
@@ -52,7 +52,7 @@ namespace TiledArray {
     /// \endcode
     TiledRange1() :
         range_(0,0), elements_range_(0,0),
-        tiles_ranges_(), elem2tile_()
+        tiles_ranges_(), tile_size_(0)
     {
     }
 
@@ -61,7 +61,7 @@ namespace TiledArray {
     template <typename RandIter,
         typename std::enable_if<detail::is_random_iterator<RandIter>::value>::type* = nullptr>
     TiledRange1(RandIter first, RandIter last) :
-        range_(), elements_range_(), tiles_ranges_(), elem2tile_()
+        range_(), elements_range_(), tiles_ranges_(), tile_size_(0)
     {
       init_tiles_(first, last, 0);
     }
@@ -166,19 +166,30 @@ namespace TiledArray {
     /// \code
     /// assert(i >= elements_range().first && i < elements_range().second);
     /// \endcode
-    /// \note element->tile map is memoized, thus complexity of the first call is linear in the number of elements,
-    ///       complexity of subsequent calls is constant. Note that the memoization assumes infrequent (or serial) use as it
-    ///       is serialized across ALL TiledRange1 instances.
-    const size_type& element_to_tile(const size_type& i) const {
+    /// \note The tile is computed with a division when the tiling is uniform
+    ///       (see \c tile_size() ), otherwise it is found with a binary search
+    ///       of the tile boundaries, so the complexity is logarithmic in the
+    ///       number of tiles and no per-element data is stored.
+    size_type element_to_tile(const size_type& i) const {
       TA_ASSERT( includes(elements_range_, i) );
-      if (elem2tile_.empty()) {
-        init_elem2tile_();
-      }
-      return elem2tile_[i - elements_range_.first];
+      if(tile_size_)
+        return (i - elements_range_.first) / tile_size_ + range_.first;
+
+      // Find the first tile with an upper bound greater than i
+      const const_iterator it = std::upper_bound(tiles_ranges_.begin(),
+          tiles_ranges_.end(), i,
+          [] (const size_type e, const range_type& t) { return e < t.second; });
+      return (it - tiles_ranges_.begin()) + range_.first;
     }
 
+    /// Uniform tile size accessor
+
+    /// \return The extent of the tiles if all tiles, except possibly the last
+    /// one which may be smaller, have the same extent; otherwise zero
+    size_type tile_size() const { return tile_size_; }
+
     /// \deprecated use TiledRange1::element_to_tile()
-    DEPRECATED const size_type& element2tile(const size_type& i) const {
+    DEPRECATED size_type element2tile(const size_type& i) const {
       return element_to_tile(i);
     }
 
@@ -189,7 +200,7 @@ namespace TiledArray {
       std::swap(range_, other.range_);
       std::swap(elements_range_, other.elements_range_);
       std::swap(tiles_ranges_, other.tiles_ranges_);
-      std::swap(elem2tile_, other.elem2tile_);
+      std::swap(tile_size_, other.tile_size_);
     }
 
   private:
@@ -221,25 +232,15 @@ namespace TiledArray {
       elements_range_.second = *(last - 1);
       for (; first != (last - 1); ++first)
         tiles_ranges_.emplace_back(*first, *(first + 1));
-    }
 
-    /// Initialize elem2tile
-    void init_elem2tile_() const {
-      // check for 0 size range.
-      if((elements_range_.second - elements_range_.first) == 0)
-        return;
-
-      static std::mutex mtx;
-      {
-        std::lock_guard<std::mutex> lock(mtx);
-        if (elem2tile_.empty()) {
-          // initialize elem2tile map
-          elem2tile_.resize(elements_range_.second - elements_range_.first);
-          const size_type end = range_.second - range_.first;
-          for (size_type t = 0; t < end; ++t)
-            for (size_type e = tiles_ranges_[t].first; e < tiles_ranges_[t].second; ++e)
-              elem2tile_[e - elements_range_.first] = t + range_.first;
-        }
+      // Check for a uniform tiling, where only the last tile may be smaller
+      tile_size_ = 0;
+      if(! tiles_ranges_.empty()) {
+        const size_type size = tiles_ranges_.front().second - tiles_ranges_.front().first;
+        const bool uniform = std::all_of(tiles_ranges_.begin(), tiles_ranges_.end() - 1,
+            [size] (const range_type& t) { return (t.second - t.first) == size; });
+        if(uniform && ((tiles_ranges_.back().second - tiles_ranges_.back().first) <= size))
+          tile_size_ = size;
       }
     }
 
@@ -249,7 +250,7 @@ namespace TiledArray {
     range_type range_; ///< the range of tile indices
     range_type elements_range_; ///< the range of element indices
     std::vector<range_type> tiles_ranges_; ///< ranges of each tile (NO GAPS between tiles)
-    mutable std::vector<size_type> elem2tile_; ///< maps element index to tile index (memoized data).
+    size_type tile_size_; ///< the extent of uniform tiles, or zero if the tiling is not uniform
 
   }; // class TiledRange1
 
@@ -35,15 +35,18 @@
 // Expression functionality
 #include <TiledArray/expressions/scal_expr.h>
 #include <TiledArray/expressions/tsr_expr.h>
+#include <TiledArray/expressions/expr_cache.h>
 #include <TiledArray/conversions/sparse_to_dense.h>
 #include <TiledArray/conversions/dense_to_sparse.h>
 #include <TiledArray/conversions/to_new_tile_type.h>
 #include <TiledArray/conversions/truncate.h>
 #include <TiledArray/conversions/foreach.h>
 #include <TiledArray/conversions/make_array.h>
+#include <TiledArray/conversions/symmetry.h>
 
 // Special Arrays
 #include <TiledArray/special/diagonal_array.h>
+#include <TiledArray/special/direct_array.h>
 
 // Process maps
 #include <TiledArray/pmap/hash_pmap.h>
@@ -0,0 +1,256 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  arena_tensor.cpp
+ *
+ */
+
+#include "TiledArray/tensor/arena_tensor.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct ArenaTensorFixture {
+  typedef ArenaTensor<int> ATensor;
+  typedef Tensor<Tensor<int> > ToT;
+
+  ArenaTensorFixture() :
+    r(4, 5), a(make_rand_tensor_of_tensor(r)), b(make_rand_tensor_of_tensor(r)),
+    x(a), y(b)
+  { }
+
+  ~ArenaTensorFixture() { }
+
+  // The range of inner tensor (i,j)
+  static Range inner_range(const std::size_t i, const std::size_t j) {
+    const std::array<std::size_t, 2> lower_bound = {{ i, j }};
+    const std::array<std::size_t, 2> upper_bound = {{ 2 * i + 2, j + 3 }};
+    return Range(lower_bound, upper_bound);
+  }
+
+  // Fill a tensor of tensors with random data
+  static ToT make_rand_tensor_of_tensor(const Range& r) {
+    ToT tensor(r);
+    for(std::size_t i = 0ul; i < r.extent(0); ++i) {
+      for(std::size_t j = 0ul; j < r.extent(1); ++j) {
+        Tensor<int> inner(inner_range(i, j));
+        for(std::size_t x = 0ul; x < inner.size(); ++x)
+          inner[x] = GlobalFixture::world->rand() % 42 + 1;
+        tensor(i,j) = inner;
+      }
+    }
+    return tensor;
+  }
+
+  // Check that an arena tensor is equal to a tensor of tensors
+  static void check_equal(const ATensor& t, const ToT& ref) {
+    BOOST_REQUIRE(! t.empty());
+    BOOST_CHECK_EQUAL(t.range(), ref.range());
+    for(std::size_t i = 0ul; i < ref.size(); ++i) {
+      BOOST_CHECK_EQUAL(t.inner_range(i), ref[i].range());
+      BOOST_REQUIRE_EQUAL(t.inner_size(i), ref[i].size());
+      for(std::size_t x = 0ul; x < ref[i].size(); ++x)
+        BOOST_CHECK_EQUAL(t[i].data()[x], ref[i][x]);
+    }
+  }
+
+  Range r;
+  ToT a, b;
+  ATensor x, y;
+
+}; // ArenaTensorFixture
+
+BOOST_FIXTURE_TEST_SUITE( arena_tensor_suite, ArenaTensorFixture )
+
+BOOST_AUTO_TEST_CASE( constructors )
+{
+  BOOST_CHECK(ATensor().empty());
+
+  // Pack a tensor of tensors into one arena
+  check_equal(x, a);
+  std::size_t volume = 0ul;
+  for(std::size_t i = 0ul; i < a.size(); ++i)
+    volume += a[i].size();
+  BOOST_CHECK_EQUAL(x.arena().size(), volume);
+
+  // Unpack
+  ToT t = static_cast<ToT>(x);
+  BOOST_CHECK_EQUAL(t.range(), a.range());
+  for(std::size_t i = 0ul; i < a.size(); ++i) {
+    BOOST_CHECK_EQUAL(t[i].range(), a[i].range());
+    BOOST_CHECK_NE(t[i].data(), a[i].data());
+    BOOST_CHECK_EQUAL_COLLECTIONS(t[i].begin(), t[i].end(), a[i].begin(), a[i].end());
+  }
+
+  // Construct from inner ranges
+  ATensor z(r, [&] (const std::size_t i) {
+    return inner_range(i / r.extent(1), i % r.extent(1));
+  });
+  BOOST_CHECK(z.is_congruent(x));
+  BOOST_CHECK(ATensor(x, 3).is_congruent(x));
+  BOOST_CHECK_EQUAL(ATensor(x, 3).sum(), 3 * int(volume));
+
+  // Inner tensors are views of the arena
+  z = x.clone();
+  z[3].data()[0] = -1;
+  BOOST_CHECK_EQUAL(z.arena()[z.inner_size(0) + z.inner_size(1) + z.inner_size(2)], -1);
+  BOOST_CHECK_NE(x.arena()[x.inner_size(0) + x.inner_size(1) + x.inner_size(2)], -1);
+}
+
+BOOST_AUTO_TEST_CASE( empty_inner_tensors )
+{
+  ToT t(r);
+  t[3] = a[3];
+  t[7] = a[7];
+  ATensor z(t);
+  BOOST_CHECK_EQUAL(z.inner_size(0), 0ul);
+  BOOST_CHECK_EQUAL(z.inner_size(3), a[3].size());
+  BOOST_CHECK_EQUAL(z.inner_range(7), a[7].range());
+  BOOST_CHECK_EQUAL(z.arena().size(), a[3].size() + a[7].size());
+
+  ToT u = static_cast<ToT>(z);
+  BOOST_CHECK(u[0].empty());
+  BOOST_CHECK_EQUAL_COLLECTIONS(u[7].begin(), u[7].end(), a[7].begin(), a[7].end());
+}
+
+BOOST_AUTO_TEST_CASE( permute )
+{
+  const Permutation perm({1, 0});
+  check_equal(x.permute(perm), a.permute(perm));
+  check_equal(x.scale(2, perm), a.scale(2, perm));
+  check_equal(x.add(y, perm), a.add(b, perm));
+}
+
+BOOST_AUTO_TEST_CASE( element_wise )
+{
+  check_equal(x.scale(3), a.scale(3));
+  check_equal(x.add(y), a.add(b));
+  check_equal(x.add(y, 2), a.add(b, 2));
+  check_equal(x.add(5), a.add(5));
+  check_equal(x.subt(y), a.subt(b));
+  check_equal(x.subt(y, 2), a.subt(b, 2));
+  check_equal(x.mult(y), a.mult(b));
+  check_equal(x.mult(y, 2), a.mult(b, 2));
+  check_equal(x.neg(), a.neg());
+
+  ATensor z = x.clone();
+  z.add_to(y);
+  check_equal(z, a.add(b));
+  z.subt_to(y, 2);
+  check_equal(z, a.scale(2));
+  z.mult_to(y);
+  check_equal(z, a.mult(b, 2));
+  z.neg_to();
+  check_equal(z, a.mult(b, -2));
+
+  // The layout is shared with the arguments
+  BOOST_CHECK(x.add(y).is_congruent(y));
+}
+
+BOOST_AUTO_TEST_CASE( reductions )
+{
+  BOOST_CHECK_EQUAL(x.sum(), a.sum());
+  BOOST_CHECK_EQUAL(x.squared_norm(), a.squared_norm());
+  BOOST_CHECK_CLOSE(x.norm(), a.norm(), 1.0e-10);
+  BOOST_CHECK_EQUAL(x.min(), a.min());
+  BOOST_CHECK_EQUAL(x.max(), a.max());
+  BOOST_CHECK_EQUAL(x.abs_max(), a.abs_max());
+  BOOST_CHECK_EQUAL(x.dot(y), a.dot(b));
+}
+
+BOOST_AUTO_TEST_CASE( serialization )
+{
+  std::size_t buf_size = 1000000;
+  unsigned char* buf = new unsigned char[buf_size];
+  madness::archive::BufferOutputArchive oar(buf, buf_size);
+  BOOST_REQUIRE_NO_THROW(oar & x);
+  std::size_t nbyte = oar.size();
+  oar.close();
+
+  ATensor x_roundtrip;
+  madness::archive::BufferInputArchive iar(buf, nbyte);
+  BOOST_REQUIRE_NO_THROW(iar & x_roundtrip);
+  iar.close();
+
+  delete [] buf;
+
+  check_equal(x_roundtrip, a);
+  BOOST_CHECK(x_roundtrip.is_congruent(x));
+}
+
+BOOST_AUTO_TEST_CASE( dist_array_expressions )
+{
+  World& world = * GlobalFixture::world;
+  const std::array<std::size_t, 3> tiling = {{ 0, 3, 7 }};
+  const TiledRange1 tr1(tiling.begin(), tiling.end());
+  const TiledRange trange({ tr1, tr1 });
+
+  // Inner tensor (i,j) of an array; the inner ranges depend on (i,j) only,
+  // so the tiles of different arrays are congruent.
+  auto make_inner = [] (const std::size_t i, const std::size_t j, const int seed) {
+    Tensor<int> inner(Range(i % 3ul + 1ul, j % 2ul + 2ul));
+    for(std::size_t x = 0ul; x < inner.size(); ++x)
+      inner[x] = int((i + 2ul * j + x) % 11ul) + seed;
+    return inner;
+  };
+  auto make_tile = [=] (const Range& range, const int seed) {
+    ToT tile(range);
+    for(const auto& idx : range)
+      tile[idx] = make_inner(idx[0], idx[1], seed);
+    return ATensor(tile);
+  };
+
+  DistArray<ATensor> x(world, trange), y(world, trange), c, d;
+  x.init_tiles([=] (const Range& range) { return make_tile(range, 1); });
+  y.init_tiles([=] (const Range& range) { return make_tile(range, 5); });
+
+  // Element-wise expressions, with and without a permutation
+  BOOST_REQUIRE_NO_THROW(c("i,j") = 2 * (x("i,j") + y("i,j")));
+  BOOST_REQUIRE_NO_THROW(d("j,i") = x("i,j") - y("i,j"));
+
+  for(auto it = c.begin(); it != c.end(); ++it) {
+    const ToT tile = static_cast<ToT>(it->get());
+    for(const auto& idx : tile.range()) {
+      const Tensor<int> ref = make_inner(idx[0], idx[1], 1).add(
+          make_inner(idx[0], idx[1], 5), 2);
+      BOOST_CHECK_EQUAL(tile[idx].range(), ref.range());
+      BOOST_CHECK_EQUAL_COLLECTIONS(tile[idx].begin(), tile[idx].end(),
+          ref.begin(), ref.end());
+    }
+  }
+  for(auto it = d.begin(); it != d.end(); ++it) {
+    const ToT tile = static_cast<ToT>(it->get());
+    for(const auto& idx : tile.range()) {
+      const Tensor<int> ref = make_inner(idx[1], idx[0], 1).subt(
+          make_inner(idx[1], idx[0], 5));
+      BOOST_CHECK_EQUAL(tile[idx].range(), ref.range());
+      BOOST_CHECK_EQUAL_COLLECTIONS(tile[idx].begin(), tile[idx].end(),
+          ref.begin(), ref.end());
+    }
+  }
+
+  // Reductions over the arenas
+  int dot = 0;
+  for(std::size_t i = 0ul; i < tiling.back(); ++i)
+    for(std::size_t j = 0ul; j < tiling.back(); ++j)
+      dot += make_inner(i, j, 1).dot(make_inner(i, j, 5));
+  BOOST_CHECK_EQUAL(x("i,j").dot(y("i,j")).get(), dot);
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
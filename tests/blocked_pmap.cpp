@@ -114,4 +114,16 @@ BOOST_AUTO_TEST_CASE( local_group )
   }
 }
 
+BOOST_AUTO_TEST_CASE( local_ordinal )
+{
+  for(std::size_t tiles = 1ul; tiles < 100ul; ++tiles) {
+    TiledArray::detail::BlockedPmap pmap(* GlobalFixture::world, tiles);
+
+    // Check that local ordinals are the positions in the local tile list
+    std::size_t ordinal = 0ul;
+    for(detail::BlockedPmap::const_iterator it = pmap.begin(); it != pmap.end(); ++it, ++ordinal)
+      BOOST_CHECK_EQUAL(pmap.local_ordinal(*it), ordinal);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,175 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  diagonal_tile.cpp
+ *
+ */
+
+#include "TiledArray/special/diagonal_tile.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct DiagonalTileFixture {
+
+  DiagonalTileFixture() :
+    r(Range({3, 1}, {8, 7})), d(), t(r), tr{{0, 3, 7, 12, 20}, {0, 3, 7, 12, 20}},
+    values(20)
+  {
+    GlobalFixture::world->srand(27);
+    Tensor<double> diag(detail::diagonal_range(r));
+    for(std::size_t i = 0ul; i < diag.size(); ++i)
+      diag[i] = random();
+    d = DiagonalTile<double>(r, diag);
+    for(std::size_t i = 0ul; i < t.size(); ++i)
+      t[i] = random();
+    for(std::size_t i = 0ul; i < values.size(); ++i)
+      values[i] = random();
+  }
+
+  ~DiagonalTileFixture() { }
+
+  static double random() {
+    return double(GlobalFixture::world->rand()) / RAND_MAX - 0.5;
+  }
+
+  static void check_close(const Tensor<double>& x, const Tensor<double>& y) {
+    BOOST_CHECK_EQUAL(x.range(), y.range());
+    for(std::size_t i = 0ul; i < x.size(); ++i)
+      BOOST_CHECK_SMALL(x[i] - y[i], 1.0e-12);
+  }
+
+  Range r;
+  DiagonalTile<double> d;
+  Tensor<double> t;
+  TiledRange tr;
+  std::vector<double> values;
+
+}; // DiagonalTileFixture
+
+BOOST_FIXTURE_TEST_SUITE( diagonal_tile_suite, DiagonalTileFixture )
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  BOOST_CHECK(DiagonalTile<double>().empty());
+  BOOST_CHECK(! d.empty());
+  BOOST_CHECK_EQUAL(d.range(), r);
+  BOOST_CHECK_EQUAL(d.diagonal().range(), Range({3}, {7}));
+
+  const Tensor<double> dense = static_cast<Tensor<double> >(d);
+  for(auto i : r) {
+    if(i[0] == i[1])
+      BOOST_CHECK_EQUAL(dense(i), d.diagonal(i[0]));
+    else
+      BOOST_CHECK_EQUAL(dense(i), 0.0);
+  }
+
+  // A transposed diagonal tile has the same diagonal
+  const Permutation perm({1, 0});
+  check_close(static_cast<Tensor<double> >(d.permute(perm)), dense.permute(perm));
+}
+
+BOOST_AUTO_TEST_CASE( contraction )
+{
+  const Tensor<double> dense = static_cast<Tensor<double> >(d);
+  Tensor<double> x(Range({1, 0}, {7, 4}));
+  for(std::size_t i = 0ul; i < x.size(); ++i)
+    x[i] = random();
+
+  // Row scaling
+  math::GemmHelper nn(madness::cblas::NoTrans, madness::cblas::NoTrans, 2u, 2u, 2u);
+  check_close(gemm(d, x, 2.0, nn), dense.gemm(x, 2.0, nn));
+
+  // Row scaling of a transposed tensor
+  const Tensor<double> xt = x.permute(Permutation({1, 0}));
+  math::GemmHelper nt(madness::cblas::NoTrans, madness::cblas::Trans, 2u, 2u, 2u);
+  check_close(gemm(d, xt, 1.0, nt), dense.gemm(xt, 1.0, nt));
+
+  // Column scaling, with and without transposed arguments
+  Tensor<double> y(Range({0, 3}, {5, 8}));
+  for(std::size_t i = 0ul; i < y.size(); ++i)
+    y[i] = random();
+  check_close(gemm(y, d, 1.0, nn), y.gemm(dense, 1.0, nn));
+  const Tensor<double> yt = y.permute(Permutation({1, 0}));
+  math::GemmHelper tn(madness::cblas::Trans, madness::cblas::NoTrans, 2u, 2u, 2u);
+  check_close(gemm(yt, d, 1.0, tn), yt.gemm(dense, 1.0, tn));
+
+  // Accumulate to an existing tile
+  Tensor<double> z = gemm(d, x, 1.0, nn);
+  gemm(z, d, x, 1.0, nn);
+  check_close(z, dense.gemm(x, 2.0, nn));
+}
+
+BOOST_AUTO_TEST_CASE( element_wise )
+{
+  const Tensor<double> dense = static_cast<Tensor<double> >(d);
+
+  check_close(mult(d, t), dense.mult(t));
+  check_close(mult(t, d, 3.0), t.mult(dense, 3.0));
+  check_close(add(t, d), t.add(dense));
+  check_close(add(d, t, 2.0), dense.add(t, 2.0));
+  check_close(subt(d, t), dense.subt(t));
+  check_close(subt(t, d, 2.0), t.subt(dense, 2.0));
+
+  const Permutation perm({1, 0});
+  check_close(add(d, t, perm), dense.add(t, perm));
+
+  Tensor<double> x = t.clone();
+  add_to(x, d);
+  check_close(x, t.add(dense));
+  subt_to(x, d);
+  check_close(x, t);
+}
+
+BOOST_AUTO_TEST_CASE( expressions )
+{
+  TArrayD a(*GlobalFixture::world, tr);
+  a.fill_random();
+
+  auto diag = diagonal_tile_array<double, DensePolicy>(*GlobalFixture::world,
+      tr, values);
+  TArrayD dense(*GlobalFixture::world, tr);
+  dense.init_tiles([&] (const Range& range) {
+    Tensor<double> tile(range, 0.0);
+    const Range d_range = detail::diagonal_range(range);
+    for(std::size_t i = 0ul; i < d_range.volume(); ++i) {
+      const std::size_t e = d_range.lobound_data()[0] + i;
+      tile(e, e) = values[e];
+    }
+    return tile;
+  });
+
+  TArrayD c, c_ref;
+  c("i,j") = diag("i,k") * a("k,j");
+  c_ref("i,j") = dense("i,k") * a("k,j");
+  BOOST_CHECK_SMALL((c("i,j") - c_ref("i,j")).norm().get(), 1.0e-10);
+
+  c("i,j") = a("i,k") * diag("j,k");
+  c_ref("i,j") = a("i,k") * dense("j,k");
+  BOOST_CHECK_SMALL((c("i,j") - c_ref("i,j")).norm().get(), 1.0e-10);
+
+  c("i,j") = a("i,j") - diag("i,j");
+  c_ref("i,j") = a("i,j") - dense("i,j");
+  BOOST_CHECK_SMALL((c("i,j") - c_ref("i,j")).norm().get(), 1.0e-10);
+
+  c("i,j") = diag("i,j") * a("i,j");
+  c_ref("i,j") = dense("i,j") * a("i,j");
+  BOOST_CHECK_SMALL((c("i,j") - c_ref("i,j")).norm().get(), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
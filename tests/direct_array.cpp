@@ -0,0 +1,151 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  direct_array.cpp
+ *
+ */
+
+#include "TiledArray/special/direct_array.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include <atomic>
+
+using namespace TiledArray;
+
+struct DirectArrayFixture {
+
+  DirectArrayFixture() :
+    tr{{0, 3, 7, 12, 20}, {0, 3, 7, 12, 20}}, calls(0ul), a(*GlobalFixture::world, tr)
+  {
+    a.fill_random();
+  }
+
+  ~DirectArrayFixture() { }
+
+  /// Tile generator that counts the number of generated tiles
+  std::function<Tensor<double>(const Range&)> generator() {
+    return [this] (const Range& range) {
+      ++calls;
+      Tensor<double> tile(range);
+      for(auto i : range)
+        tile(i) = 0.1 * double(i[0]) - 0.01 * double(i[1]);
+      return tile;
+    };
+  }
+
+  /// The total number of generated tiles
+  std::size_t total_calls() const {
+    std::size_t result = calls;
+    GlobalFixture::world->gop.sum(result);
+    return result;
+  }
+
+  TiledRange tr;
+  std::atomic<std::size_t> calls;
+  TArrayD a;
+
+}; // DirectArrayFixture
+
+BOOST_FIXTURE_TEST_SUITE( direct_array_suite, DirectArrayFixture )
+
+BOOST_AUTO_TEST_CASE( generator_cache )
+{
+  std::size_t count = 0ul;
+  DirectTileGenerator<Tensor<double> > gen([&] (const Range& range) {
+    ++count;
+    return Tensor<double>(range, 1.0);
+  }, 2ul, 3.0f);
+  BOOST_CHECK_EQUAL(gen.cost(), 3.0f);
+  BOOST_CHECK_EQUAL(gen.capacity(), 2ul);
+
+  const Range r0({0, 0}, {3, 3}), r1({0, 3}, {3, 7}), r2({3, 0}, {7, 3});
+  Tensor<double> t0 = gen(0ul, r0);
+  gen(1ul, r1);
+  BOOST_CHECK_EQUAL(count, 2ul);
+
+  // Cached tiles are not shared with the result
+  t0[0] = 2.0;
+  BOOST_CHECK_EQUAL(gen(0ul, r0)[0], 1.0);
+  BOOST_CHECK_EQUAL(count, 2ul);
+  BOOST_CHECK_EQUAL(gen.hits(), 1ul);
+
+  // Tile 1 is the least recently used tile
+  gen(2ul, r2);
+  gen(0ul, r0);
+  BOOST_CHECK_EQUAL(count, 3ul);
+  gen(1ul, r1);
+  BOOST_CHECK_EQUAL(count, 4ul);
+  BOOST_CHECK_EQUAL(gen.misses(), 4ul);
+
+  gen.clear();
+  gen(1ul, r1);
+  BOOST_CHECK_EQUAL(count, 5ul);
+}
+
+BOOST_AUTO_TEST_CASE( contraction )
+{
+  TArrayD ref(*GlobalFixture::world, tr);
+  ref.init_tiles(generator());
+  GlobalFixture::world->gop.fence();
+  calls = 0ul;
+
+  auto direct = make_direct_array<Tensor<double> >(*GlobalFixture::world, tr,
+      generator(), tr.tiles_range().volume(), 2.0f);
+
+  TArrayD c, c_ref;
+  c_ref("i,j") = a("i,k") * ref("k,j");
+  c("i,j") = a("i,k") * direct("k,j");
+  BOOST_CHECK_SMALL((c("i,j") - c_ref("i,j")).norm().get(), 1.0e-10);
+  const std::size_t first_calls = total_calls();
+  BOOST_CHECK(first_calls > 0ul);
+
+  // All tiles are taken from the cache
+  c("i,j") = direct("k,i") * a("k,j");
+  c_ref("i,j") = ref("k,i") * a("k,j");
+  BOOST_CHECK_SMALL((c("i,j") - c_ref("i,j")).norm().get(), 1.0e-10);
+  BOOST_CHECK_EQUAL(total_calls(), first_calls);
+
+  // Without a cache tiles are generated each time they are used
+  auto uncached = make_direct_array<Tensor<double> >(*GlobalFixture::world, tr,
+      generator());
+  calls = 0ul;
+  c_ref("i,j") = a("i,k") * ref("k,j");
+  c("i,j") = a("i,k") * uncached("k,j");
+  GlobalFixture::world->gop.fence();
+  const std::size_t uncached_calls = total_calls();
+  c("i,j") = a("i,k") * uncached("k,j");
+  BOOST_CHECK_SMALL((c("i,j") - c_ref("i,j")).norm().get(), 1.0e-10);
+  BOOST_CHECK(total_calls() > uncached_calls);
+}
+
+BOOST_AUTO_TEST_CASE( sparse_contraction )
+{
+  TSpArrayD ref(*GlobalFixture::world, tr);
+  ref.init_tiles(generator());
+  GlobalFixture::world->gop.fence();
+
+  auto direct = make_direct_array<Tensor<double>, SparsePolicy>(
+      *GlobalFixture::world, tr, ref.shape(), generator(), 4ul, 1.0f);
+
+  TSpArrayD b(*GlobalFixture::world, tr), c, c_ref;
+  b.fill_random();
+  c_ref("i,j") = b("i,k") * ref("k,j");
+  c("i,j") = b("i,k") * direct("k,j");
+  BOOST_CHECK_SMALL((c("i,j") - c_ref("i,j")).norm().get(), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -280,6 +280,30 @@ BOOST_AUTO_TEST_CASE( make_replicated )
   }
 }
 
+BOOST_AUTO_TEST_CASE( make_node_replicated )
+{
+  // Get a copy of the original process map
+  std::shared_ptr<ArrayN::pmap_interface> distributed_pmap = a.pmap();
+
+  // Convert array to a node-replicated array.
+  BOOST_REQUIRE_NO_THROW(a.make_node_replicated());
+
+  if(GlobalFixture::world->size() == 1)
+    BOOST_CHECK(! a.pmap()->is_replicated());
+  else
+    BOOST_CHECK(a.pmap()->is_replicated());
+
+  // Check that all the data is local
+  for(std::size_t i = 0; i < a.size(); ++i) {
+    BOOST_CHECK(a.is_local(i));
+    BOOST_CHECK_EQUAL(a.pmap()->owner(i), GlobalFixture::world->rank());
+    Future<ArrayN::value_type> tile = a.find(i);
+    BOOST_CHECK_EQUAL(tile.get().range(), a.trange().make_tile_range(i));
+    for(ArrayN::value_type::const_iterator it = tile.get().begin(); it != tile.get().end(); ++it)
+      BOOST_CHECK_EQUAL(*it, distributed_pmap->owner(i) + 1);
+  }
+}
+
 BOOST_AUTO_TEST_CASE( serialization )
 {
   decltype(a) acopy(a.world(), a.trange(), a.shape());
@@ -331,5 +355,70 @@ BOOST_AUTO_TEST_CASE( serialization )
   BOOST_CHECK_EQUAL_COLLECTIONS(a.begin(), a.end(), acopy.begin(), acopy.end());
 }
 
+BOOST_AUTO_TEST_CASE( bulk_tiles )
+{
+  ArrayN b(world, tr);
+
+  // Set the tiles in bulk from the process that owns the first tile
+  std::vector<std::size_t> indices;
+  std::vector<ArrayN::value_type> tiles;
+  if(world.rank() == 0) {
+    for(std::size_t i = 0ul; i < tr.tiles_range().volume(); ++i) {
+      indices.push_back(i);
+      tiles.push_back(ArrayN::value_type(tr.make_tile_range(i), int(i)));
+    }
+    b.set_tiles(indices, tiles);
+  }
+
+  world.gop.fence();
+
+  // Find all tiles in bulk
+  std::vector<ArrayN::index> index_list(b.range().begin(), b.range().end());
+  std::vector<Future<ArrayN::value_type> > futures = b.find_tiles(index_list);
+  BOOST_CHECK_EQUAL(futures.size(), index_list.size());
+  for(std::size_t i = 0ul; i < futures.size(); ++i) {
+    BOOST_CHECK_EQUAL(futures[i].get().range(), tr.make_tile_range(index_list[i]));
+    for(ArrayN::value_type::iterator it = futures[i].get().begin(); it != futures[i].get().end(); ++it)
+      BOOST_CHECK_EQUAL(*it, int(b.range().ordinal(index_list[i])));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( fill_random_tiling )
+{
+  // Fill arrays with different tilings of the same elements
+  TArrayD x(world, tr);
+  x.fill_random(math::RandomDistribution::normal, 42ul);
+  std::vector<TiledRange1> dims(GlobalFixture::dim,
+      TiledRange1(tr.elements_range().lobound_data()[0],
+      tr.elements_range().upbound_data()[0]));
+  TArrayD y(world, TiledRange(dims.begin(), dims.end()));
+  y.fill_random(math::RandomDistribution::normal, 42ul);
+  y.make_replicated();
+
+  // Check that the elements do not depend on the tiling
+  const TArrayD::value_type y_tile = y.find(0).get();
+  for(auto it = x.begin(); it != x.end(); ++it) {
+    const TArrayD::value_type x_tile = it->get();
+    for(const auto& idx : x_tile.range())
+      BOOST_CHECK_EQUAL(x_tile[idx], y_tile[idx]);
+  }
+
+  // Check that a different seed gives different elements
+  TArrayD z(world, tr);
+  z.fill_random(math::RandomDistribution::normal, 43ul);
+  for(auto it = z.begin(); it != z.end(); ++it)
+    BOOST_CHECK(it->get()[0] != x.find(it.ordinal()).get()[0]);
+
+  // Check that other tile types get the same elements
+  DistArray<Tile<Tensor<double> > > w(world, tr);
+  w.fill_random(math::RandomDistribution::normal, 42ul);
+  for(auto it = w.begin(); it != w.end(); ++it) {
+    const auto w_tile = it->get();
+    const TArrayD::value_type x_tile = x.find(it.ordinal()).get();
+    for(const auto& idx : x_tile.range())
+      BOOST_CHECK_EQUAL(w_tile.tensor()[idx], x_tile[idx]);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
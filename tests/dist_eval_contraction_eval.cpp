@@ -29,6 +29,7 @@
 #include "../src/tiledarray.h"
 #include "unit_test_config.h"
 #include "sparse_shape_fixture.h"
+#include <set>
 
 using namespace TiledArray;
 using TiledArray::detail::Noop;
@@ -449,4 +450,136 @@ BOOST_AUTO_TEST_CASE( sparse_eval )
   do_sparse_eval(true);
 }
 
+BOOST_AUTO_TEST_CASE( node_split_bcast )
+{
+  // Six processes, two on each node
+  const detail::NodeTopology topology({ 0, 0, 2, 2, 4, 4 });
+  BOOST_CHECK_EQUAL(topology.nodes(), 3);
+  BOOST_CHECK_EQUAL(topology.ranks_per_node(), 2ul);
+
+  const std::vector<ProcessID> members = { 0, 1, 2, 3, 4, 5 };
+  std::vector<ProcessID> leaders, node;
+
+  // The root leads its node, and the first member leads the other nodes
+  BOOST_CHECK_EQUAL(topology.split_bcast(members, 1, 1, leaders, node), 1);
+  BOOST_CHECK(leaders == std::vector<ProcessID>({ 1, 2, 4 }));
+  BOOST_CHECK(node == std::vector<ProcessID>({ 0, 1 }));
+  BOOST_CHECK_EQUAL(topology.split_bcast(members, 1, 0, leaders, node), 1);
+  BOOST_CHECK_EQUAL(topology.split_bcast(members, 1, 5, leaders, node), 4);
+  BOOST_CHECK(leaders == std::vector<ProcessID>({ 1, 2, 4 }));
+  BOOST_CHECK(node == std::vector<ProcessID>({ 4, 5 }));
+
+  // Members on one node, or each on its own node, use a flat broadcast
+  BOOST_CHECK_EQUAL(topology.split_bcast({ 2, 3 }, 2, 3, leaders, node), -1);
+  BOOST_CHECK_EQUAL(topology.split_bcast({ 0, 2, 4 }, 0, 2, leaders, node), -1);
+}
+
+BOOST_AUTO_TEST_CASE( node_bcast_keys )
+{
+  const std::size_t k = 5ul, world_size = 4ul, tiles = 4ul * k;
+
+  // Row and column group keys are less than 2 * k; leader group keys, node
+  // group keys, and group keys must all be distinct.
+  std::set<std::size_t> group_keys;
+  for(std::size_t group_key = 0ul; group_key < 2ul * k; ++group_key) {
+    BOOST_CHECK(group_keys.insert(group_key).second);
+    BOOST_CHECK(group_keys.insert(detail::summa_node_group_key(k, world_size,
+        group_key)).second);
+    for(ProcessID root = 0; root < ProcessID(world_size); ++root)
+      BOOST_CHECK(group_keys.insert(detail::summa_leader_group_key(k,
+          world_size, group_key, root)).second);
+  }
+
+  // Intra-node tile keys must be distinct from the argument tile keys
+  std::set<std::size_t> tile_keys;
+  for(std::size_t key = 0ul; key < 2ul * tiles; ++key)
+    BOOST_CHECK(tile_keys.insert(key).second);
+  for(std::size_t key = 0ul; key < 2ul * tiles; ++key)
+    BOOST_CHECK(tile_keys.insert(detail::summa_node_tile_key(key, tiles,
+        tiles)).second);
+}
+
+BOOST_AUTO_TEST_CASE( node_topology_eval )
+{
+  World& world = * GlobalFixture::world;
+
+  // Inject a topology with two processes on each node
+  const std::shared_ptr<const detail::NodeTopology> topology =
+      detail::node_topology(world);
+  std::vector<ProcessID> node_leaders(world.size());
+  for(ProcessID p = 0; p < world.size(); ++p)
+    node_leaders[p] = p - (p % 2);
+  detail::set_node_topology(world,
+      std::make_shared<detail::NodeTopology>(node_leaders));
+  BOOST_CHECK_EQUAL(detail::node_topology(world)->ranks_per_node(),
+      (world.size() % 2 ? 1ul : 2ul));
+
+  // The process grid and argument distributions follow the topology
+  const detail::ProcGrid grid(world, tr.tiles_range().extent(0),
+      tr.tiles_range().extent(tr.tiles_range().rank() - 1u),
+      tr.elements_range().extent(0),
+      tr.elements_range().extent(tr.elements_range().rank() - 1u));
+  const std::size_t left_cols =
+      tr.tiles_range().volume() / tr.tiles_range().extent(0);
+  const std::size_t right_rows =
+      tr.tiles_range().volume() / tr.tiles_range().extent(tr.tiles_range().rank() - 1u);
+
+  auto check_eval = [&] (auto& contract, const matrix_type& reference) {
+    for(auto index : *contract.pmap()) {
+      if(contract.is_zero(index))
+        continue;
+      const auto tile = contract.get(index).get();
+      BOOST_CHECK_EQUAL(tile.range(), contract.trange().make_tile_range(index));
+      BOOST_CHECK(eigen_map(tile) == reference.block(tile.range().lobound(0),
+          tile.range().lobound(1), tile.range().extent(0), tile.range().extent(1)));
+    }
+  };
+
+  // Dense contraction
+  {
+    auto left_eval = make_array_eval(left, world, DenseShape(),
+        grid.make_row_phase_pmap(left_cols), Permutation(), make_array_noop());
+    auto right_eval = make_array_eval(right, world, DenseShape(),
+        grid.make_col_phase_pmap(right_rows), Permutation(), make_array_noop());
+    auto contract = make_contract_eval(left_eval, right_eval, world,
+        DenseShape(), pmap, Permutation(), make_contract(2u,
+        left_eval.trange().tiles_range().rank(),
+        right_eval.trange().tiles_range().rank()));
+    BOOST_REQUIRE_NO_THROW(contract.eval());
+    BOOST_REQUIRE_NO_THROW(contract.wait());
+
+    check_eval(contract, matrix_type(copy_to_matrix(left, 1) *
+        copy_to_matrix(right, GlobalFixture::dim - 1)));
+  }
+
+  // Sparse contraction
+  {
+    TSpArrayI sp_left(world, tr, make_shape(tr, 0.1, 23));
+    TSpArrayI sp_right(world, tr, make_shape(tr, 0.1, 42));
+    rand_fill_array(sp_left);
+    sp_left.truncate();
+    rand_fill_array(sp_right);
+    sp_right.truncate();
+
+    auto left_eval = make_array_eval(sp_left, world, sp_left.shape(),
+        grid.make_row_phase_pmap(left_cols), Permutation(), make_array_noop());
+    auto right_eval = make_array_eval(sp_right, world, sp_right.shape(),
+        grid.make_col_phase_pmap(right_rows), Permutation(), make_array_noop());
+    auto op = make_contract(2u, left_eval.trange().tiles_range().rank(),
+        right_eval.trange().tiles_range().rank());
+    auto contract = make_contract_eval(left_eval, right_eval, world,
+        left_eval.shape().gemm(right_eval.shape(), 1, op.gemm_helper()), pmap,
+        Permutation(), op);
+    BOOST_REQUIRE_NO_THROW(contract.eval());
+    BOOST_REQUIRE_NO_THROW(contract.wait());
+
+    check_eval(contract, matrix_type(copy_to_matrix(sp_left, 1) *
+        copy_to_matrix(sp_right, GlobalFixture::dim - 1)));
+  }
+
+  // Restore the topology of the world
+  world.gop.fence();
+  detail::set_node_topology(world, topology);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
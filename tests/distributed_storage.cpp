@@ -122,4 +122,115 @@ BOOST_AUTO_TEST_CASE( array_operator )
 }
 
 
+BOOST_AUTO_TEST_CASE( flat_storage )
+{
+  Storage s(world, 10, pmap, true);
+  BOOST_CHECK(s.is_flat());
+  BOOST_CHECK(! t.is_flat());
+  BOOST_CHECK_EQUAL(s.size(), 0ul);
+
+  // Check that futures for local elements are set when the value is set
+  std::vector<Storage::future> futures;
+  for(std::size_t i = 0; i < s.max_size(); ++i)
+    if(s.is_local(i))
+      futures.push_back(s.get(i));
+
+  for(std::size_t i = 0; i < s.max_size(); ++i)
+    if(s.is_local(i))
+      s.set(i, int(i));
+
+  world.gop.fence();
+  std::size_t n = s.size();
+  world.gop.sum(n);
+  BOOST_CHECK_EQUAL(n, s.max_size());
+
+  std::vector<Storage::future>::const_iterator it = futures.begin();
+  for(std::size_t i = 0; i < s.max_size(); ++i)
+    if(s.is_local(i)) {
+      BOOST_CHECK(it->probe());
+      BOOST_CHECK_EQUAL(it->get(), int(i));
+      ++it;
+    }
+
+  // Check that all elements are accessible from any process
+  for(std::size_t i = 0; i < s.max_size(); ++i)
+    BOOST_CHECK_EQUAL(s.get(i).get(), int(i));
+
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( bulk_set_get )
+{
+  // Each process sets a share of all elements, local or remote
+  Storage::key_vector keys;
+  Storage::value_vector values;
+  for(std::size_t i = world.rank(); i < t.max_size(); i += world.size()) {
+    keys.push_back(i);
+    values.push_back(int(i) + 1);
+  }
+  t.set(keys, values);
+
+  world.gop.fence();
+  std::size_t n = t.size();
+  world.gop.sum(n);
+  BOOST_CHECK_EQUAL(n, t.max_size());
+
+  // Get all elements
+  keys.clear();
+  for(std::size_t i = 0; i < t.max_size(); ++i)
+    keys.push_back(t.max_size() - i - 1);
+  Storage::future_vector futures = t.get(keys);
+  BOOST_CHECK_EQUAL(futures.size(), keys.size());
+  for(std::size_t k = 0; k < keys.size(); ++k)
+    BOOST_CHECK_EQUAL(futures[k].get(), int(keys[k]) + 1);
+
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( batched_set )
+{
+  Storage s(world, 10, pmap);
+  s.set_batch_size(3);
+  BOOST_CHECK_EQUAL(s.batch_size(), 3ul);
+
+  // Remote sets are buffered, and partial batches are sent before the fence
+  if(world.rank() == 0)
+    for(std::size_t i = 0; i < s.max_size(); ++i)
+      s.set(i, int(i));
+
+  world.gop.fence();
+  std::size_t n = s.size();
+  world.gop.sum(n);
+  BOOST_CHECK_EQUAL(n, s.max_size());
+
+  for(std::size_t i = 0; i < s.max_size(); ++i)
+    BOOST_CHECK_EQUAL(s.get(i).get(), int(i));
+
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( consume_discard )
+{
+  for(const bool flat : { false, true }) {
+    Storage s(world, 10, pmap, flat);
+    for(std::size_t i = 0; i < s.max_size(); ++i)
+      if(s.is_local(i))
+        s.set(i, int(i));
+    world.gop.fence();
+    s.set_consumers(world.size());
+
+    // Each process consumes the even elements and discards the odd ones
+    for(std::size_t i = 0; i < s.max_size(); ++i) {
+      if(i % 2ul)
+        s.discard(i);
+      else
+        BOOST_CHECK_EQUAL(s.consume(i).get(), int(i));
+    }
+
+    // All elements are released after the last consumer
+    world.gop.fence();
+    BOOST_CHECK_EQUAL(s.size(), 0ul);
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1671,6 +1671,272 @@ BOOST_AUTO_TEST_CASE( cont_non_uniform2 )
   }
 }
 
+BOOST_AUTO_TEST_CASE( batched_cont )
+{
+  // Gather the arguments into replicated tensors
+  auto gather = [] (const TArrayI& array) {
+    Tensor<int> result(array.trange().elements_range(), 0);
+    for(std::size_t t = 0ul; t < array.size(); ++t) {
+      const TArrayI::value_type tile = array.find(t).get();
+      for(auto index : tile.range())
+        result[index] = tile[index];
+    }
+    return result;
+  };
+  const Tensor<int> left = gather(a);
+  const Tensor<int> right = gather(b);
+  const std::size_t k = a.trange().elements_range().extent(2);
+
+  // Check c(i,j,l) = factor * sum_k a(i,l,k) * b(j,l,k)
+  auto check = [&] (const TArrayI& result, const int factor) {
+    for(TArrayI::const_iterator it = result.begin(); it != result.end(); ++it) {
+      TArrayI::value_type tile = *it;
+      for(auto index : tile.range()) {
+        int expected = 0;
+        for(std::size_t x = 0ul; x < k; ++x)
+          expected += left(index[0], index[2], x) * right(index[1], index[2], x);
+        BOOST_CHECK_EQUAL(tile[index], expected * factor);
+      }
+    }
+  };
+
+  BOOST_REQUIRE_NO_THROW(c("i,j,l") = a("i,l,k") * b("j,l,k"));
+  check(c, 1);
+
+  // Permuted batch and outer indices
+  TArrayI d;
+  BOOST_REQUIRE_NO_THROW(d("l,j,i") = a("i,l,k") * b("j,l,k"));
+  for(TArrayI::const_iterator it = d.begin(); it != d.end(); ++it) {
+    TArrayI::value_type tile = *it;
+    for(auto index : tile.range()) {
+      int expected = 0;
+      for(std::size_t x = 0ul; x < k; ++x)
+        expected += left(index[2], index[0], x) * right(index[1], index[0], x);
+      BOOST_CHECK_EQUAL(tile[index], expected);
+    }
+  }
+
+  BOOST_REQUIRE_NO_THROW(c("i,j,l") = (2 * a("i,l,k")) * b("j,l,k"));
+  check(c, 2);
+
+  // Unrelated shared indices must appear in the result
+  BOOST_CHECK_THROW(c("i,j,l") = a("i,l,k") * b("i,j,l"), TiledArray::Exception);
+}
+
+BOOST_AUTO_TEST_CASE( async_assign )
+{
+  TArrayI d, e, f, ref;
+
+  // Start independent expressions
+  Future<TArrayI> d_future, e_future, f_future;
+  BOOST_REQUIRE_NO_THROW(d_future = d("i,j").assign_async(a("i,b,c") * b("j,b,c")));
+  BOOST_REQUIRE_NO_THROW(e_future = e("a,b,c").assign_async(a("a,b,c") + b("a,b,c")));
+
+  // Read the result of an expression that is in flight
+  BOOST_REQUIRE_NO_THROW(f_future = f("i,j").assign_async(2 * d("j,i")));
+
+  ref("i,j") = a("i,b,c") * b("j,b,c");
+  BOOST_CHECK_EQUAL((d_future.get()("i,j") - ref("i,j")).norm().get(), 0);
+  BOOST_CHECK_EQUAL((f_future.get()("i,j") - 2 * ref("j,i")).norm().get(), 0);
+  BOOST_CHECK_EQUAL((e_future.get()("a,b,c") - a("a,b,c") - b("a,b,c")).norm().get(), 0);
+
+  // The assigned arrays are the results
+  BOOST_CHECK_EQUAL((d("i,j") - ref("i,j")).norm().get(), 0);
+  GlobalFixture::world->gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( streamed_intermediate )
+{
+  TArrayI t, u, ref;
+
+  // Stream an intermediate to two consumers
+  BOOST_REQUIRE_NO_THROW(t("i,j").assign_async(a("i,b,c") * b("j,b,c")));
+  BOOST_REQUIRE_NO_THROW(t.set_consumers(2u));
+  BOOST_CHECK_EQUAL(t.consumers(), 2u);
+  BOOST_REQUIRE_NO_THROW(u("i,j") = t("i,k") * t("j,k"));
+  GlobalFixture::world->gop.fence();
+
+  // Every tile of the intermediate was released by its last consumer
+  BOOST_CHECK_EQUAL(t.stored_size(), 0ul);
+
+  ref("i,j") = a("i,b,c") * b("j,b,c");
+  ref("i,j") = ref("i,k") * ref("j,k");
+  BOOST_CHECK_EQUAL((u("i,j") - ref("i,j")).norm().get(), 0);
+  GlobalFixture::world->gop.fence();
+
+  // A block expression also releases the tiles outside the block
+  BOOST_REQUIRE_NO_THROW(t("i,j").assign_async(a("i,b,c") * b("j,b,c")));
+  BOOST_REQUIRE_NO_THROW(t.set_consumers(1u));
+  BOOST_REQUIRE_NO_THROW(u("i,j") = t("i,j").block({1, 1}, {3, 3}));
+  GlobalFixture::world->gop.fence();
+  BOOST_CHECK_EQUAL(t.stored_size(), 0ul);
+
+  ref("i,j") = a("i,b,c") * b("j,b,c");
+  BOOST_CHECK_EQUAL((u("i,j") - ref("i,j").block({1, 1}, {3, 3})).norm().get(), 0);
+  GlobalFixture::world->gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( optimized_product )
+{
+  TArrayI t, ref;
+
+  // Contracting the last two operands first is cheaper
+  expressions::ContractionPlan plan;
+  BOOST_REQUIRE_NO_THROW(plan =
+      t("i,j,n").assign_optimized(a("i,j,k") * b("k,l,m") * a("l,m,n")));
+  BOOST_REQUIRE_EQUAL(plan.size(), 2ul);
+  BOOST_CHECK_EQUAL(plan.step(0).left, 1ul);
+  BOOST_CHECK_EQUAL(plan.step(0).right, 2ul);
+  BOOST_CHECK_EQUAL(plan.step(0).vars, expressions::VariableList("k,n"));
+  BOOST_CHECK_EQUAL(plan.step(1).left, 0ul);
+  BOOST_CHECK_EQUAL(plan.step(1).right, 3ul);
+  BOOST_CHECK_LT(plan.flops(), plan.left_to_right_flops());
+
+  ref("i,j,n") = a("i,j,k") * b("k,l,m") * a("l,m,n");
+  BOOST_CHECK_EQUAL((t("i,j,n") - ref("i,j,n")).norm().get(), 0);
+
+  // Left-to-right evaluation is optimal
+  BOOST_REQUIRE_NO_THROW(plan =
+      t("i,m,n").assign_optimized(a("i,j,k") * b("j,k,l") * a("l,m,n")));
+  BOOST_CHECK_EQUAL(plan.step(0).left, 0ul);
+  BOOST_CHECK_EQUAL(plan.step(0).right, 1ul);
+  BOOST_CHECK_EQUAL(plan.flops(), plan.left_to_right_flops());
+}
+
+BOOST_AUTO_TEST_CASE( common_subexpressions )
+{
+  TArrayI r, s, ref;
+
+  // Keys are invariant to the renaming of indices
+  BOOST_CHECK_EQUAL(expressions::expr_key(a("i,b,c") * b("j,b,c")),
+      expressions::expr_key(a("j,c,d") * b("i,c,d")));
+  BOOST_CHECK_NE(expressions::expr_key(a("i,b,c") * b("j,b,c")),
+      expressions::expr_key(a("i,b,c") * b("j,c,b")));
+  BOOST_CHECK_NE(expressions::expr_key(a("i,b,c") * b("j,b,c")),
+      expressions::expr_key(b("i,b,c") * a("j,b,c")));
+  BOOST_CHECK_NE(expressions::expr_key(2 * a("i,j,k")),
+      expressions::expr_key(3 * a("i,j,k")));
+
+  // The product and its transpose are evaluated once
+  expressions::ExprCache cache;
+  BOOST_REQUIRE_NO_THROW(r("i,j") = cache(a("i,b,c") * b("j,b,c")) +
+      2 * cache(a("j,b,c") * b("i,b,c")));
+  BOOST_REQUIRE_NO_THROW(s("i,j") = 3 * cache(a("i,b,c") * b("j,b,c")));
+  BOOST_CHECK_EQUAL(cache.size(), 1ul);
+  BOOST_CHECK_EQUAL(cache.hits(), 2ul);
+
+  ref("i,j") = a("i,b,c") * b("j,b,c");
+  BOOST_CHECK_EQUAL((r("i,j") - ref("i,j") - 2 * ref("j,i")).norm().get(), 0);
+  BOOST_CHECK_EQUAL((s("i,j") - 3 * ref("i,j")).norm().get(), 0);
+
+  cache.clear();
+  BOOST_CHECK_EQUAL(cache.size(), 0ul);
+  GlobalFixture::world->gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( fused_element_wise )
+{
+  Permutation perm({2, 1, 0});
+
+  // Element-wise subtrees are evaluated in a single pass over the leaves
+  BOOST_REQUIRE_NO_THROW(c("a,b,c") = 2 * (a("a,b,c") + b("a,b,c")) - a("a,b,c") * b("a,b,c"));
+
+  for(std::size_t i = 0ul; i < c.size(); ++i) {
+    TArrayI::value_type c_tile = c.find(i).get();
+    TArrayI::value_type a_tile = a.find(i).get();
+    TArrayI::value_type b_tile = b.find(i).get();
+
+    for(std::size_t j = 0ul; j < c_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(c_tile[j], 2 * (a_tile[j] + b_tile[j]) - a_tile[j] * b_tile[j]);
+  }
+
+  // Permuted leaf
+  BOOST_REQUIRE_NO_THROW(c("a,b,c") = 3 * (a("c,b,a") - b("a,b,c")) + b("a,b,c"));
+
+  for(std::size_t i = 0ul; i < c.size(); ++i) {
+    TArrayI::value_type c_tile = c.find(i).get();
+    const size_t perm_index = c.range().ordinal(perm * a.range().idx(i));
+    TArrayI::value_type a_tile = perm * a.find(perm_index).get();
+    TArrayI::value_type b_tile = b.find(i).get();
+
+    for(std::size_t j = 0ul; j < c_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(c_tile[j], 3 * (a_tile[j] - b_tile[j]) + b_tile[j]);
+  }
+
+  // Permuted result
+  BOOST_REQUIRE_NO_THROW(c("c,b,a") = (a("a,b,c") + b("a,b,c")) * b("a,b,c"));
+
+  for(std::size_t i = 0ul; i < c.size(); ++i) {
+    TArrayI::value_type c_tile = c.find(i).get();
+    const size_t perm_index = c.range().ordinal(perm * c.range().idx(i));
+    TArrayI::value_type a_tile = perm * a.find(perm_index).get();
+    TArrayI::value_type b_tile = perm * b.find(perm_index).get();
+
+    for(std::size_t j = 0ul; j < c_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(c_tile[j], (a_tile[j] + b_tile[j]) * b_tile[j]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( fused_element_wise_sparse )
+{
+  World& world = * GlobalFixture::world;
+
+  // x is zero for every third tile, and y is zero for the next ones
+  auto make_array = [&] (const std::size_t zero, const int scale) {
+    Tensor<float> norms(tr.tiles_range(), 0.0f);
+    for(std::size_t i = 0ul; i < norms.size(); ++i)
+      if(i % 3ul != zero)
+        norms[i] = 100.0f * tr.make_tile_range(i).volume();
+    TSpArrayI array(world, tr, SparseShape<float>(norms, tr));
+    for(auto it = array.begin(); it != array.end(); ++it) {
+      TSpArrayI::value_type tile(array.trange().make_tile_range(it.index()));
+      for(std::size_t j = 0ul; j < tile.size(); ++j)
+        tile[j] = int((scale * it.ordinal() + j) % 7ul) + 1;
+      *it = tile;
+    }
+    return array;
+  };
+  auto element = [] (const TSpArrayI& array, const std::size_t i,
+      const std::size_t j, const int scale)
+  {
+    return (array.is_zero(i) ? 0 : int((scale * i + j) % 7ul) + 1);
+  };
+
+  TSpArrayI x = make_array(0ul, 1), y = make_array(1ul, 2), z;
+
+  // The tiles of x are zero where y is not: the zero leaf tiles are skipped
+  BOOST_REQUIRE_NO_THROW(z("a,b,c") = 2 * (x("a,b,c") + y("a,b,c")) - x("a,b,c"));
+  for(std::size_t i = 0ul; i < z.size(); ++i) {
+    BOOST_CHECK_EQUAL(z.is_zero(i), x.is_zero(i) && y.is_zero(i));
+    if(z.is_zero(i))
+      continue;
+    TSpArrayI::value_type z_tile = z.find(i).get();
+    for(std::size_t j = 0ul; j < z_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(z_tile[j], 2 * (element(x, i, j, 1) +
+          element(y, i, j, 2)) - element(x, i, j, 1));
+  }
+
+  // The result is zero where y is, so the non-zero tiles of x are discarded
+  // there. As an intermediate with one consumer, x releases every tile.
+  world.gop.fence();
+  x.set_consumers(1u);
+  BOOST_REQUIRE_NO_THROW(z("a,b,c") = (x("a,b,c") + y("a,b,c")) * y("a,b,c"));
+  world.gop.fence();
+  BOOST_CHECK_EQUAL(x.stored_size(), 0ul);
+  for(std::size_t i = 0ul; i < z.size(); ++i) {
+    if(y.is_zero(i)) {
+      BOOST_CHECK(z.is_zero(i));
+      continue;
+    }
+    if(z.is_zero(i))
+      continue;
+    TSpArrayI::value_type z_tile = z.find(i).get();
+    for(std::size_t j = 0ul; j < z_tile.size(); ++j)
+      BOOST_CHECK_EQUAL(z_tile[j], (element(x, i, j, 1) +
+          element(y, i, j, 2)) * element(y, i, j, 2));
+  }
+}
+
 BOOST_AUTO_TEST_CASE( cont_plus_reduce )
 {
   // Construct the tiled range
@@ -242,4 +242,35 @@ BOOST_AUTO_TEST_CASE( outer_product_factories )
   }
 }
 
+BOOST_AUTO_TEST_CASE( kronecker_delta_fast_paths )
+{
+  // these can only work if nproc == 1 since KroneckerDelta does not travel
+  if (GlobalFixture::world->nproc() == 1) {
+    TArrayD r;
+
+    // contractions with delta relabel the other argument
+    BOOST_CHECK_NO_THROW(r("a,c") = delta1e("a,b") * e2("b,c"));
+    BOOST_CHECK_SMALL((r("a,c") - e2("a,c")).norm().get(), 1.0e-10);
+    BOOST_CHECK_NO_THROW(r("a,c") = 2.0 * (e2("a,b") * delta1e("c,b")));
+    BOOST_CHECK_SMALL((r("a,c") - 2.0 * e2("a,c")).norm().get(), 1.0e-10);
+
+    // sums with delta only touch the diagonal
+    BOOST_CHECK_NO_THROW(r("a,b") = e2("a,b") + delta1e("a,b"));
+    BOOST_CHECK_CLOSE((r("a,b") - e2("a,b")).norm().get(), std::sqrt(41.0), 1.0e-10);
+
+    // Hadamard products with delta extract the diagonal
+    BOOST_CHECK_NO_THROW(r("a,b") = delta1e("a,b") * e2("a,b"));
+    for (std::size_t i = 0; i < r.size(); ++i) {
+      const auto tile = r.find(i).get();
+      const auto e2_tile = e2.find(i).get();
+      for (auto idx : tile.range()) {
+        if (idx[0] == idx[1])
+          BOOST_CHECK_EQUAL(tile[idx], e2_tile[idx]);
+        else
+          BOOST_CHECK_EQUAL(tile[idx], 0.0);
+      }
+    }
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1596,6 +1596,109 @@ BOOST_AUTO_TEST_CASE(cont) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(cont_work_stealing) {
+  TSpArrayI ref;
+  BOOST_REQUIRE_NO_THROW(ref("i,j") = a("i,b,c") * b("j,b,c"));
+  GlobalFixture::world->gop.fence();
+
+  // Contract with work stealing, where all but one product per process may
+  // be stolen
+  const std::size_t granularity = work_stealing_granularity();
+  const std::size_t threshold = work_stealing_threshold();
+  set_work_stealing_granularity(2ul);
+  set_work_stealing_threshold(1ul);
+  reset_work_stealing_statistics();
+
+  BOOST_REQUIRE_NO_THROW(w("i,j") = a("i,b,c") * b("j,b,c"));
+  GlobalFixture::world->gop.fence();
+
+  set_work_stealing_granularity(granularity);
+  set_work_stealing_threshold(threshold);
+
+  BOOST_CHECK(w.shape().data() == ref.shape().data());
+  for (TSpArrayI::const_iterator it = w.begin(); it != w.end(); ++it) {
+    const TSpArrayI::value_type tile = *it;
+    const TSpArrayI::value_type ref_tile = ref.find(it.ordinal()).get();
+    BOOST_CHECK_EQUAL_COLLECTIONS(tile.begin(), tile.end(), ref_tile.begin(),
+                                  ref_tile.end());
+  }
+
+  // Every stolen product was given by another process
+  const WorkStealingStatistics stats = work_stealing_statistics();
+  std::size_t stolen = stats.stolen;
+  std::size_t given = stats.given;
+  GlobalFixture::world->gop.sum(stolen);
+  GlobalFixture::world->gop.sum(given);
+  BOOST_CHECK_EQUAL(stolen, given);
+  BOOST_CHECK_LE(stats.failed, stats.requests);
+}
+
+BOOST_AUTO_TEST_CASE(cont_plan) {
+  TSpArrayI ref;
+  BOOST_REQUIRE_NO_THROW(ref("i,j") = a("i,b,c") * b("j,b,c"));
+  GlobalFixture::world->gop.fence();
+
+  auto plan = std::make_shared<SparseContractionPlan<TSpArrayI::shape_type> >(0.01f);
+
+  // The first evaluation inspects the shapes, and the second reuses the plan
+  for (unsigned int i = 0u; i < 2u; ++i) {
+    BOOST_REQUIRE_NO_THROW(w("i,j") = (a("i,b,c") * b("j,b,c")).set_plan(plan));
+    GlobalFixture::world->gop.fence();
+
+    BOOST_CHECK(w.shape().data() == ref.shape().data());
+    for (TSpArrayI::const_iterator it = w.begin(); it != w.end(); ++it) {
+      const TSpArrayI::value_type tile = *it;
+      const TSpArrayI::value_type ref_tile = ref.find(it.ordinal()).get();
+      BOOST_CHECK_EQUAL_COLLECTIONS(tile.begin(), tile.end(), ref_tile.begin(),
+                                    ref_tile.end());
+    }
+  }
+  BOOST_CHECK_EQUAL(plan->inspections(), 1ul);
+  BOOST_CHECK_EQUAL(plan->executions(), 1ul);
+
+  // Arguments with other zero tiles are inspected again
+  BOOST_REQUIRE_NO_THROW(ref("i,j") = b("i,b,c") * a("j,b,c"));
+  BOOST_REQUIRE_NO_THROW(w("i,j") = (b("i,b,c") * a("j,b,c")).set_plan(plan));
+  GlobalFixture::world->gop.fence();
+
+  BOOST_CHECK(w.shape().data() == ref.shape().data());
+  for (TSpArrayI::const_iterator it = w.begin(); it != w.end(); ++it) {
+    const TSpArrayI::value_type tile = *it;
+    const TSpArrayI::value_type ref_tile = ref.find(it.ordinal()).get();
+    BOOST_CHECK_EQUAL_COLLECTIONS(tile.begin(), tile.end(), ref_tile.begin(),
+                                  ref_tile.end());
+  }
+  if (!detail::same_zero_tiles(a.shape(), b.shape()))
+    BOOST_CHECK_EQUAL(plan->inspections(), 2ul);
+}
+
+BOOST_AUTO_TEST_CASE(cont_plan_tolerance) {
+  auto plan = std::make_shared<SparseContractionPlan<TSpArrayI::shape_type> >(1.5f);
+  BOOST_REQUIRE_NO_THROW(w("i,j") = (a("i,b,c") * b("j,b,c")).set_plan(plan));
+  GlobalFixture::world->gop.fence();
+
+  // The norms of the scaled argument change within the tolerance, so the
+  // plan is reused, but the result norms are those of the scaled argument
+  TSpArrayI a2, ref;
+  BOOST_REQUIRE_NO_THROW(a2("i,b,c") = 2 * a("i,b,c"));
+  BOOST_REQUIRE_NO_THROW(ref("i,j") = a2("i,b,c") * b("j,b,c"));
+  BOOST_REQUIRE_NO_THROW(w("i,j") = (a2("i,b,c") * b("j,b,c")).set_plan(plan));
+  GlobalFixture::world->gop.fence();
+
+  BOOST_CHECK_EQUAL(plan->inspections(), 1ul);
+  BOOST_CHECK_EQUAL(plan->executions(), 1ul);
+  for (std::size_t i = 0ul; i < ref.size(); ++i) {
+    BOOST_CHECK_EQUAL(w.is_zero(i), ref.is_zero(i));
+    BOOST_CHECK_CLOSE(w.shape()[i], ref.shape()[i], 0.0001);
+  }
+  for (TSpArrayI::const_iterator it = w.begin(); it != w.end(); ++it) {
+    const TSpArrayI::value_type tile = *it;
+    const TSpArrayI::value_type ref_tile = ref.find(it.ordinal()).get();
+    BOOST_CHECK_EQUAL_COLLECTIONS(tile.begin(), tile.end(), ref_tile.begin(),
+                                  ref_tile.end());
+  }
+}
+
 BOOST_AUTO_TEST_CASE( cont_permute )
 {
   const std::size_t m = a.trange().elements_range().extent(0);
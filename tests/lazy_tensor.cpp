@@ -0,0 +1,108 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  lazy_tensor.cpp
+ *
+ */
+
+#include "TiledArray/tensor/lazy_tensor.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct LazyTensorFixture {
+  typedef Tensor<int> TensorN;
+
+  LazyTensorFixture() :
+    r(std::array<int, 3>{{0, 1, 2}}, std::array<int, 3>{{4, 6, 5}}),
+    a(make_rand_tensor(r)), b(make_rand_tensor(r)), c(make_rand_tensor(r))
+  { }
+
+  ~LazyTensorFixture() { }
+
+  static TensorN make_rand_tensor(const Range& r) {
+    TensorN tensor(r);
+    for(std::size_t i = 0ul; i < tensor.size(); ++i)
+      tensor[i] = GlobalFixture::world->rand() % 42 + 1;
+    return tensor;
+  }
+
+  Range r;
+  TensorN a, b, c;
+
+}; // LazyTensorFixture
+
+BOOST_FIXTURE_TEST_SUITE( lazy_tensor_suite, LazyTensorFixture )
+
+BOOST_AUTO_TEST_CASE( element_wise )
+{
+  TensorN x = lazy(a) + 2 * lazy(b) - c;
+  BOOST_CHECK_EQUAL(x.range(), r);
+  for(std::size_t i = 0ul; i < x.size(); ++i)
+    BOOST_CHECK_EQUAL(x[i], a[i] + 2 * b[i] - c[i]);
+
+  x = -(lazy(a) * b) + (lazy(c) - a) * 3;
+  for(std::size_t i = 0ul; i < x.size(); ++i)
+    BOOST_CHECK_EQUAL(x[i], -(a[i] * b[i]) + (c[i] - a[i]) * 3);
+
+  // Mixed element types
+  Tensor<double> y = lazy(a) / (lazy(b) * 2.0);
+  for(std::size_t i = 0ul; i < y.size(); ++i)
+    BOOST_CHECK_CLOSE(y[i], double(a[i]) / (b[i] * 2.0), 1.0e-12);
+
+  // Arguments are held by shallow copy
+  auto expr = lazy(a) + b;
+  TensorN z = expr.eval();
+  for(std::size_t i = 0ul; i < z.size(); ++i)
+    BOOST_CHECK_EQUAL(z[i], a[i] + b[i]);
+  BOOST_CHECK_NE(z.data(), a.data());
+}
+
+BOOST_AUTO_TEST_CASE( permute )
+{
+  const Permutation perm({2, 0, 1});
+
+  TensorN x = (lazy(a) + 2 * lazy(b) - c).eval(perm);
+  TensorN ref = perm * (a + b.scale(2) - c);
+  BOOST_CHECK_EQUAL(x.range(), ref.range());
+  BOOST_CHECK_EQUAL_COLLECTIONS(x.begin(), x.end(), ref.begin(), ref.end());
+}
+
+BOOST_AUTO_TEST_CASE( block_views )
+{
+  const std::array<int, 3> lower{{1, 2, 3}};
+  const std::array<int, 3> upper{{3, 5, 5}};
+  const std::array<int, 3> lower2{{2, 3, 2}};
+  const std::array<int, 3> upper2{{4, 6, 4}};
+
+  // Strided views are read in place
+  TensorN x = lazy(a.block(lower, upper)) * b.block(lower2, upper2);
+  TensorN a_block = TensorN(a.block(lower, upper));
+  TensorN b_block = TensorN(b.block(lower2, upper2));
+  BOOST_CHECK_EQUAL(x.range(), a_block.range());
+  for(std::size_t i = 0ul; i < x.size(); ++i)
+    BOOST_CHECK_EQUAL(x[i], a_block[i] * b_block[i]);
+
+  // Permuted views
+  const Permutation perm({1, 2, 0});
+  x = (lazy(a.block(lower, upper)) - b.block(lower2, upper2)).eval(perm);
+  TensorN ref = perm * (a_block - TensorN(a_block.range(), b_block.data()));
+  BOOST_CHECK_EQUAL_COLLECTIONS(x.begin(), x.end(), ref.begin(), ref.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,263 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  low_rank_tensor.cpp
+ *
+ */
+
+#include "TiledArray/tensor/low_rank_tensor.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+
+struct LowRankTensorFixture {
+  typedef LowRankTensor<double> LRTensor;
+  typedef LRTensor::matrix_type matrix_type;
+
+  LowRankTensorFixture() :
+    r(Range(6, 5, 8, 7)), u(30, 3), v(56, 3), a(), t(r)
+  {
+    GlobalFixture::world->srand(27);
+    for(long i = 0l; i < u.size(); ++i)
+      u.data()[i] = random();
+    for(long i = 0l; i < v.size(); ++i)
+      v.data()[i] = random();
+
+    Eigen::Map<matrix_type>(t.data(), 30, 56) = u * v.transpose();
+    a = LRTensor(t, 2u);
+  }
+
+  ~LowRankTensorFixture() { }
+
+  static double random() {
+    return double(GlobalFixture::world->rand()) / RAND_MAX - 0.5;
+  }
+
+  static Tensor<double> make_dense(const Range& range) {
+    Tensor<double> result(range);
+    for(std::size_t i = 0ul; i < result.size(); ++i)
+      result[i] = random();
+    return result;
+  }
+
+  static void check_close(const Tensor<double>& x, const Tensor<double>& y,
+      const double tolerance)
+  {
+    BOOST_CHECK_EQUAL(x.range(), y.range());
+    for(std::size_t i = 0ul; i < x.size(); ++i)
+      BOOST_CHECK_SMALL(x[i] - y[i], tolerance);
+  }
+
+  Range r;
+  matrix_type u;
+  matrix_type v;
+  LRTensor a;
+  Tensor<double> t;
+
+}; // LowRankTensorFixture
+
+BOOST_FIXTURE_TEST_SUITE( low_rank_tensor_suite, LowRankTensorFixture )
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  BOOST_CHECK(LRTensor().empty());
+
+  // Check that the compressed tile recovers the rank of the data
+  BOOST_CHECK(! a.empty());
+  BOOST_CHECK(! a.is_dense());
+  BOOST_CHECK_EQUAL(a.rank(), 3ul);
+  BOOST_CHECK_EQUAL(a.row_dims(), 2u);
+  BOOST_CHECK_EQUAL(a.range(), r);
+  BOOST_CHECK_EQUAL(a.u().rows(), 30);
+  BOOST_CHECK_EQUAL(a.v().rows(), 56);
+  check_close(static_cast<Tensor<double> >(a), t, 1.0e-12);
+
+  // Check the factor constructor
+  LRTensor b(r, 2u, u, v);
+  BOOST_CHECK(! b.is_dense());
+  BOOST_CHECK_EQUAL(b.rank(), 3ul);
+  check_close(static_cast<Tensor<double> >(b), t, 1.0e-12);
+
+  // Check that clone is a deep copy
+  LRTensor c = a.clone();
+  c.scale_to(2.0);
+  check_close(static_cast<Tensor<double> >(a), t, 1.0e-12);
+}
+
+BOOST_AUTO_TEST_CASE( dense_fallback )
+{
+  // Random data is full rank, so it is stored densely
+  const Tensor<double> d = make_dense(r);
+  LRTensor b(d, 2u);
+  BOOST_CHECK(b.is_dense());
+  check_close(static_cast<Tensor<double> >(b), d, 0.0);
+
+  // The maximum rank ratio controls the fallback
+  const double ratio = LRTensor::max_rank_ratio();
+  LRTensor::max_rank_ratio(0.05);
+  BOOST_CHECK(LRTensor(t, 2u).is_dense());
+  LRTensor::max_rank_ratio(ratio);
+}
+
+BOOST_AUTO_TEST_CASE( resplit )
+{
+  LRTensor b = a.resplit(3u);
+  BOOST_CHECK_EQUAL(b.row_dims(), 3u);
+  check_close(static_cast<Tensor<double> >(b), t, 1.0e-12);
+  BOOST_CHECK(a.resplit(2u).u().data() == a.u().data());
+}
+
+BOOST_AUTO_TEST_CASE( add )
+{
+  // The sum of tiles with the same column space has the same rank
+  LRTensor b(r, 2u, matrix_type(u * 2.0), v);
+  LRTensor c = a.add(b);
+  BOOST_CHECK(! c.is_dense());
+  BOOST_CHECK_EQUAL(c.rank(), 3ul);
+  check_close(static_cast<Tensor<double> >(c), t * 3.0, 1.0e-12);
+
+  c = a.subt(b, 2.0);
+  check_close(static_cast<Tensor<double> >(c), t * -2.0, 1.0e-12);
+
+  c = a.clone();
+  c.add_to(b);
+  BOOST_CHECK_EQUAL(c.rank(), 3ul);
+  check_close(static_cast<Tensor<double> >(c), t * 3.0, 1.0e-12);
+
+  // Check addition of a dense tile
+  const Tensor<double> d = make_dense(r);
+  c = a.add(LRTensor(d, 2u));
+  check_close(static_cast<Tensor<double> >(c), t.add(d), 1.0e-12);
+}
+
+BOOST_AUTO_TEST_CASE( permute )
+{
+  // Row and column dimensions are permuted separately
+  Permutation p1({1, 0, 3, 2});
+  LRTensor b = a.permute(p1);
+  BOOST_CHECK(! b.is_dense());
+  BOOST_CHECK_EQUAL(b.rank(), 3ul);
+  check_close(static_cast<Tensor<double> >(b), t.permute(p1), 1.0e-12);
+
+  // Row and column dimensions are exchanged
+  Permutation p2({2, 3, 1, 0});
+  b = a.permute(p2);
+  BOOST_CHECK(! b.is_dense());
+  BOOST_CHECK_EQUAL(b.row_dims(), 2u);
+  check_close(static_cast<Tensor<double> >(b), t.permute(p2), 1.0e-12);
+
+  // Row and column dimensions are mixed
+  Permutation p3({0, 2, 1, 3});
+  b = a.permute(p3);
+  check_close(static_cast<Tensor<double> >(b), t.permute(p3), 1.0e-12);
+}
+
+BOOST_AUTO_TEST_CASE( gemm )
+{
+  // Low-rank x low-rank
+  math::GemmHelper helper(madness::cblas::NoTrans, madness::cblas::NoTrans, 4u, 4u, 4u);
+  const Tensor<double> t2 = t.permute(Permutation({2, 3, 0, 1}));
+  LRTensor b(t2, 2u);
+  LRTensor c = a.gemm(b, 0.5, helper);
+  BOOST_CHECK(! c.is_dense());
+  BOOST_CHECK_LE(c.rank(), 3ul);
+  check_close(static_cast<Tensor<double> >(c), t.gemm(t2, 0.5, helper), 1.0e-10);
+
+  // Low-rank x dense, with a transposed left-hand argument
+  math::GemmHelper helper_t(madness::cblas::Trans, madness::cblas::NoTrans, 4u, 4u, 4u);
+  const Tensor<double> d = make_dense(Range(6, 5, 3, 2));
+  c = a.gemm(LRTensor(d, 2u), 1.0, helper_t);
+  BOOST_CHECK(! c.is_dense());
+  check_close(static_cast<Tensor<double> >(c), t.gemm(d, 1.0, helper_t), 1.0e-10);
+
+  // Accumulate to an existing tile
+  c = a.gemm(b, 1.0, helper);
+  c.gemm(a, b, 1.0, helper);
+  check_close(static_cast<Tensor<double> >(c), t.gemm(t2, 2.0, helper), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( norm )
+{
+  BOOST_CHECK_CLOSE(a.norm(), t.norm(), 1.0e-10);
+  BOOST_CHECK_CLOSE(a.squared_norm(), t.squared_norm(), 1.0e-10);
+
+  const Tensor<double> d = make_dense(r);
+  BOOST_CHECK_CLOSE(LRTensor(d, 2u).norm(), d.norm(), 1.0e-10);
+}
+
+BOOST_AUTO_TEST_CASE( serialization )
+{
+  std::size_t buf_size = (a.u().size() + a.v().size()) * sizeof(double) + 1024;
+  std::unique_ptr<unsigned char[]> buf(new unsigned char[buf_size]);
+  madness::archive::BufferOutputArchive oar(buf.get(), buf_size);
+  oar & a;
+  std::size_t nbyte = oar.size();
+  oar.close();
+
+  LRTensor b;
+  madness::archive::BufferInputArchive iar(buf.get(), nbyte);
+  iar & b;
+  iar.close();
+
+  BOOST_CHECK_EQUAL(b.range(), a.range());
+  BOOST_CHECK_EQUAL(b.row_dims(), a.row_dims());
+  BOOST_CHECK_EQUAL(b.rank(), a.rank());
+  check_close(static_cast<Tensor<double> >(b), t, 0.0);
+}
+
+BOOST_AUTO_TEST_CASE( dist_array_expressions )
+{
+  World& world = * GlobalFixture::world;
+  const std::array<std::size_t, 4> tiling = {{ 0, 5, 12, 20 }};
+  const TiledRange1 tr1(tiling.begin(), tiling.end());
+  const TiledRange trange({ tr1, tr1 });
+
+  // Tiles of a rank-2 matrix, as low-rank and dense arrays
+  auto make_tile = [] (const Range& range, const double alpha) {
+    Tensor<double> tile(range);
+    for(const auto& idx : range)
+      tile[idx] = std::sin(alpha * idx[0]) * std::cos(0.2 * idx[1]) +
+          0.01 * alpha * idx[0];
+    return tile;
+  };
+  DistArray<LRTensor> a(world, trange), b(world, trange), c, d;
+  TArrayD a_ref(world, trange), b_ref(world, trange), c_ref, d_ref;
+  a.init_tiles([=] (const Range& range) { return LRTensor(make_tile(range, 0.1), 1u); });
+  b.init_tiles([=] (const Range& range) { return LRTensor(make_tile(range, 0.3), 1u); });
+  a_ref.init_tiles([=] (const Range& range) { return make_tile(range, 0.1); });
+  b_ref.init_tiles([=] (const Range& range) { return make_tile(range, 0.3); });
+
+  // Contract and add the factors directly
+  BOOST_REQUIRE_NO_THROW(c("i,j") = a("i,k") * b("k,j"));
+  BOOST_REQUIRE_NO_THROW(d("i,j") = a("i,j") + 2 * b("j,i"));
+  c_ref("i,j") = a_ref("i,k") * b_ref("k,j");
+  d_ref("i,j") = a_ref("i,j") + 2 * b_ref("j,i");
+
+  for(auto it = c.begin(); it != c.end(); ++it) {
+    const LRTensor tile = it->get();
+    BOOST_CHECK(! tile.is_dense());
+    check_close(static_cast<Tensor<double> >(tile),
+        c_ref.find(it.index()).get(), 1.0e-8);
+  }
+  for(auto it = d.begin(); it != d.end(); ++it)
+    check_close(static_cast<Tensor<double> >(it->get()),
+        d_ref.find(it.index()).get(), 1.0e-8);
+  world.gop.fence();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
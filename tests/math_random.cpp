@@ -0,0 +1,122 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  math_random.cpp
+ *
+ */
+
+#include "TiledArray/math/random.h"
+#include "unit_test_config.h"
+#include <algorithm>
+#include <vector>
+
+using namespace TiledArray;
+
+struct RandomFixture {
+
+  RandomFixture() : x(1001ul, 0.0) { }
+
+  ~RandomFixture() { }
+
+  std::vector<double> x;
+
+}; // RandomFixture
+
+BOOST_FIXTURE_TEST_SUITE( math_random_suite, RandomFixture )
+
+BOOST_AUTO_TEST_CASE( philox )
+{
+  // Known answers of the reference implementation
+  math::Philox4x32::counter_type r =
+      math::Philox4x32::generate({{ 0u, 0u, 0u, 0u }}, {{ 0u, 0u }});
+  BOOST_CHECK_EQUAL(r[0], 0x6627e8d5u);
+  BOOST_CHECK_EQUAL(r[1], 0xe169c58du);
+  BOOST_CHECK_EQUAL(r[2], 0xbc57ac4cu);
+  BOOST_CHECK_EQUAL(r[3], 0x9b00dbd8u);
+
+  r = math::Philox4x32::generate(
+      {{ 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu }},
+      {{ 0xffffffffu, 0xffffffffu }});
+  BOOST_CHECK_EQUAL(r[0], 0x408f276du);
+  BOOST_CHECK_EQUAL(r[1], 0x41c83b0eu);
+  BOOST_CHECK_EQUAL(r[2], 0xa20bc7c6u);
+  BOOST_CHECK_EQUAL(r[3], 0x6d5451fdu);
+}
+
+BOOST_AUTO_TEST_CASE( fill_in_pieces )
+{
+  for(auto dist : { math::RandomDistribution::uniform,
+      math::RandomDistribution::normal })
+  {
+    math::random_fill(x.size(), x.data(), 7ul, 3ul, dist);
+
+    // Fill the same ordinals in pieces of even and odd size and offset
+    std::vector<double> y(x.size(), 0.0);
+    const std::size_t pieces[] = { 1ul, 2ul, 5ul, 64ul, 1ul, 301ul, 627ul };
+    for(std::size_t first = 0ul, p = 0ul; first < y.size(); ++p) {
+      const std::size_t n = std::min(pieces[p % 7ul], y.size() - first);
+      math::random_fill(n, y.data() + first, 7ul, 3ul + first, dist);
+      first += n;
+    }
+
+    BOOST_CHECK_EQUAL_COLLECTIONS(x.begin(), x.end(), y.begin(), y.end());
+  }
+
+  // Different seeds give different numbers
+  std::vector<double> z(x.size(), 0.0);
+  math::random_fill(z.size(), z.data(), 8ul, 3ul,
+      math::RandomDistribution::normal);
+  std::size_t equal = 0ul;
+  for(std::size_t i = 0ul; i < x.size(); ++i)
+    if(x[i] == z[i])
+      ++equal;
+  BOOST_CHECK_EQUAL(equal, 0ul);
+}
+
+BOOST_AUTO_TEST_CASE( uniform )
+{
+  math::random_fill(x.size(), x.data(), 11ul, 0ul,
+      math::RandomDistribution::uniform);
+
+  double mean = 0.0;
+  for(const double value : x) {
+    BOOST_CHECK_GE(value, 0.0);
+    BOOST_CHECK_LT(value, 1.0);
+    mean += value;
+  }
+  mean /= double(x.size());
+  BOOST_CHECK_SMALL(mean - 0.5, 0.05);
+}
+
+BOOST_AUTO_TEST_CASE( normal )
+{
+  math::random_fill(x.size(), x.data(), 11ul, 0ul,
+      math::RandomDistribution::normal);
+
+  double mean = 0.0, var = 0.0;
+  for(const double value : x)
+    mean += value;
+  mean /= double(x.size());
+  for(const double value : x)
+    var += (value - mean) * (value - mean);
+  var /= double(x.size() - 1ul);
+
+  BOOST_CHECK_SMALL(mean, 0.15);
+  BOOST_CHECK_SMALL(var - 1.0, 0.15);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
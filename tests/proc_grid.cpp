@@ -154,6 +154,33 @@ BOOST_AUTO_TEST_CASE( random_constructor_test )
   }
 }
 
+BOOST_AUTO_TEST_CASE( node_aligned_constructor )
+{
+  // 36 processes without node information
+  TiledArray::detail::ProcGrid proc_grid(*GlobalFixture::world, 0, 36,
+      1000, 1000, 10000, 10000);
+  BOOST_CHECK_EQUAL(proc_grid.proc_rows(), 6ul);
+  BOOST_CHECK_EQUAL(proc_grid.proc_cols(), 6ul);
+
+  // 4 nodes with 9 processes each, where each node holds one process row
+  TiledArray::detail::ProcGrid node_grid(*GlobalFixture::world, 0, 36,
+      1000, 1000, 10000, 10000, 9);
+  BOOST_CHECK_EQUAL(node_grid.proc_rows(), 4ul);
+  BOOST_CHECK_EQUAL(node_grid.proc_cols(), 9ul);
+  BOOST_CHECK_EQUAL(node_grid.proc_size(), 36ul);
+
+  // The node topology detects a block placement of ranks
+  TiledArray::detail::NodeTopology topology({0, 0, 0, 3, 3, 3});
+  BOOST_CHECK_EQUAL(topology.nodes(), 2);
+  BOOST_CHECK_EQUAL(topology.node(4), 1);
+  BOOST_CHECK_EQUAL(topology.ranks_per_node(), 3ul);
+
+  TiledArray::detail::NodeTopology round_robin({0, 1, 0, 1});
+  BOOST_CHECK_EQUAL(round_robin.nodes(), 2);
+  BOOST_CHECK_EQUAL(round_robin.node(2), 0);
+  BOOST_CHECK_EQUAL(round_robin.ranks_per_node(), 1ul);
+}
+
 BOOST_AUTO_TEST_CASE( make_groups )
 {
   madness::DistributedID did_row(madness::uniqueidT(), 0);
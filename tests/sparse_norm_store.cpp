@@ -0,0 +1,117 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  sparse_norm_store.cpp
+ *
+ */
+
+#include "TiledArray/sparse_norm_store.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include "sparse_shape_fixture.h"
+
+using namespace TiledArray;
+
+struct SparseNormStoreFixture : public SparseShapeFixture {
+  typedef SparseNormStore<float> Store;
+  typedef std::vector<std::pair<std::vector<std::size_t>, float> > norm_list;
+
+  SparseNormStoreFixture() :
+    tile_norms(make_norm_tensor(tr, 1, 98)), local_norms(), shape_ref()
+  {
+    // Every process contributes every 7th norm, and the tiles of the first
+    // process are also contributed a second time by the last process.
+    const std::size_t nproc = GlobalFixture::world->size();
+    const std::size_t rank = GlobalFixture::world->rank();
+    Tensor<float> tile_norms_ref(tile_norms.range(), 0.0f);
+    for(std::size_t i = 0ul; i < tile_norms.size(); ++i) {
+      if((i % 7ul) != 0ul)
+        continue;
+      const bool twice = ((i / 7ul) % nproc) == 0ul;
+      tile_norms_ref[i] = tile_norms[i] * float(nproc + (twice ? 1ul : 0ul));
+      local_norms.push_back(std::make_pair(tr.tiles_range().idx(i), tile_norms[i]));
+      if(twice && (rank == (nproc - 1ul)))
+        local_norms.push_back(std::make_pair(tr.tiles_range().idx(i), tile_norms[i]));
+    }
+
+    shape_ref = SparseShape<float>(tile_norms_ref, tr);
+  }
+
+  ~SparseNormStoreFixture() { }
+
+  Tensor<float> tile_norms;
+  norm_list local_norms;
+  SparseShape<float> shape_ref;
+}; // SparseNormStoreFixture
+
+BOOST_FIXTURE_TEST_SUITE( sparse_norm_store_suite, SparseNormStoreFixture )
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  Store store(*GlobalFixture::world, local_norms, tr);
+
+  BOOST_CHECK(! store.is_replicated());
+  BOOST_CHECK_EQUAL(store.size(), tr.tiles_range().volume());
+  BOOST_CHECK_CLOSE(store.sparsity(), shape_ref.sparsity(), tolerance);
+
+  // Only the non-zero norms of the local block are stored
+  std::size_t local_nonzeros = 0ul;
+  for(std::size_t i = 0ul; i < store.size(); ++i) {
+    if(store.is_local(i)) {
+      BOOST_CHECK_CLOSE(store.local_norm(i), shape_ref[i], tolerance);
+      if(! shape_ref.is_zero(i))
+        ++local_nonzeros;
+    }
+  }
+  BOOST_CHECK_EQUAL(store.local_nonzeros(), local_nonzeros);
+  BOOST_CHECK(std::is_sorted(store.local_ordinals().begin(),
+      store.local_ordinals().end()));
+  BOOST_CHECK_EQUAL(store.local_norms().size(), local_nonzeros);
+}
+
+BOOST_AUTO_TEST_CASE( find )
+{
+  Store store(*GlobalFixture::world, local_norms, tr);
+
+  for(std::size_t i = 0ul; i < store.size(); ++i)
+    BOOST_CHECK_CLOSE(store.find(i).get(), shape_ref[i], tolerance);
+
+  // Bulk lookup, in reverse order
+  Store::key_vector ordinals;
+  for(std::size_t i = store.size(); i > 0ul; --i)
+    ordinals.push_back(i - 1ul);
+  Store::future_vector norms = store.find(ordinals);
+  BOOST_CHECK_EQUAL(norms.size(), ordinals.size());
+  for(std::size_t k = 0ul; k < ordinals.size(); ++k)
+    BOOST_CHECK_CLOSE(norms[k].get(), shape_ref[ordinals[k]], tolerance);
+
+  GlobalFixture::world->gop.fence();
+}
+
+BOOST_AUTO_TEST_CASE( replicated )
+{
+  Store store(*GlobalFixture::world, local_norms, tr, true);
+
+  BOOST_CHECK(store.is_replicated());
+  BOOST_CHECK_EQUAL(store.local_nonzeros(), store.nonzeros());
+  for(std::size_t i = 0ul; i < store.size(); ++i) {
+    BOOST_CHECK(store.is_local(i));
+    BOOST_CHECK_CLOSE(store.local_norm(i), shape_ref[i], tolerance);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
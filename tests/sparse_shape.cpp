@@ -206,6 +206,38 @@ BOOST_AUTO_TEST_CASE( comm_constructor )
   }
 }
 
+BOOST_AUTO_TEST_CASE( comm_constructor_sparse_reduce )
+{
+  // Construct test tile norms with few non-zero tiles, so that only the
+  // non-zero norms are exchanged
+  Tensor<float> tile_norms = make_norm_tensor(tr, 1, 98);
+  Tensor<float> tile_norms_ref(tile_norms.range(), 0.0f);
+  TiledArray::detail::BlockedPmap pmap(*GlobalFixture::world, tr.tiles_range().volume());
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i) {
+    if((i % 23ul) == 0ul)
+      tile_norms_ref[i] = tile_norms[i];
+    if(((i % 23ul) != 0ul) || ! pmap.is_local(i))
+      tile_norms[i] = 0.0f;
+  }
+
+  SparseShape<float> x(*GlobalFixture::world, tile_norms, tr);
+  SparseShape<float> x_ref(tile_norms_ref, tr);
+
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i)
+    BOOST_CHECK_CLOSE(x[i], x_ref[i], tolerance);
+  BOOST_CHECK_CLOSE(x.sparsity(), x_ref.sparsity(), tolerance);
+
+  // use the sparse ctor
+  std::vector<std::pair<std::vector<std::size_t>,float>> sparse_tile_norms;
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i)
+    if (tile_norms[i] > 0.0)
+      sparse_tile_norms.push_back(std::make_pair(tr.tiles_range().idx(i), tile_norms[i]));
+
+  SparseShape<float> x_sp(*GlobalFixture::world, sparse_tile_norms, tr);
+  for(Tensor<float>::size_type i = 0ul; i < tile_norms.size(); ++i)
+    BOOST_CHECK_CLOSE(x_sp[i], x_ref[i], tolerance);
+  BOOST_CHECK_CLOSE(x_sp.sparsity(), x_ref.sparsity(), tolerance);
+}
 
 BOOST_AUTO_TEST_CASE( copy_constructor )
 {
@@ -227,6 +259,58 @@ BOOST_AUTO_TEST_CASE( copy_constructor )
   BOOST_CHECK_EQUAL(y.sparsity(), sparse_shape.sparsity());
 }
 
+BOOST_AUTO_TEST_CASE( nonzero_index )
+{
+  const std::size_t size = tr.tiles_range().volume();
+  const std::size_t cols = tr.tiles_range().extent_data()[tr.tiles_range().rank() - 1u];
+  const std::size_t rows = size / cols;
+
+  std::shared_ptr<const detail::NonzeroIndex> index;
+  BOOST_REQUIRE_NO_THROW(index = sparse_shape.nonzero_index(cols));
+  BOOST_CHECK_EQUAL(index->rows(), rows);
+  BOOST_CHECK_EQUAL(index->cols(), cols);
+
+  // Check that the index is cached
+  BOOST_CHECK_EQUAL(sparse_shape.nonzero_index(cols), index);
+
+  // Check the sorted list of non-zero tiles
+  std::vector<std::size_t> nonzeros;
+  for(std::size_t i = 0ul; i < size; ++i)
+    if(! sparse_shape.is_zero(i))
+      nonzeros.push_back(i);
+  BOOST_CHECK_EQUAL_COLLECTIONS(index->begin(), index->end(),
+      nonzeros.begin(), nonzeros.end());
+  BOOST_CHECK_CLOSE(float(size - index->size()) / float(size),
+      sparse_shape.sparsity(), tolerance);
+
+  // Check the rows
+  for(std::size_t i = 0ul; i < rows; ++i) {
+    std::vector<std::size_t> row;
+    for(std::size_t j = 0ul; j < cols; ++j)
+      if(! sparse_shape.is_zero(i * cols + j))
+        row.push_back(i * cols + j);
+    BOOST_CHECK_EQUAL(index->row_size(i), row.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(index->row_begin(i), index->row_end(i),
+        row.begin(), row.end());
+  }
+
+  // Check the columns
+  for(std::size_t j = 0ul; j < cols; ++j) {
+    std::vector<std::size_t> col;
+    for(std::size_t i = 0ul; i < rows; ++i)
+      if(! sparse_shape.is_zero(i * cols + j))
+        col.push_back(i * cols + j);
+    BOOST_CHECK_EQUAL(index->col_size(j), col.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(index->col_begin(j), index->col_end(j),
+        col.begin(), col.end());
+  }
+
+  // Check that the index is rebuilt for a different matrix view
+  std::shared_ptr<const detail::NonzeroIndex> index2 = sparse_shape.nonzero_index(size);
+  BOOST_CHECK_EQUAL(index2->rows(), 1ul);
+  BOOST_CHECK_EQUAL(index2->size(), index->size());
+}
+
 BOOST_AUTO_TEST_CASE( permute )
 {
   SparseShape<float> result;
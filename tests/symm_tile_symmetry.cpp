@@ -0,0 +1,234 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  symm_tile_symmetry.cpp
+ *
+ */
+
+#include "TiledArray/symm/tile_symmetry.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+
+using namespace TiledArray;
+using TiledArray::symmetry::TileSymmetry;
+
+struct TileSymmetryFixture {
+
+  TileSymmetryFixture() :
+    tr{{0, 3, 7, 12, 20}, {0, 3, 7, 12, 20}},
+    t2_symm(TileSymmetry::antisymmetric({0, 1}) * TileSymmetry::antisymmetric({2, 3}))
+  { }
+
+  ~TileSymmetryFixture() { }
+
+  /// Check that all tiles of two arrays are equal
+  static void check_equal(const TSpArrayD& x, const TSpArrayD& y) {
+    for(std::size_t i = 0ul; i < x.size(); ++i) {
+      BOOST_CHECK_EQUAL(x.is_zero(i), y.is_zero(i));
+      if(x.is_zero(i) || y.is_zero(i)) continue;
+      const TSpArrayD::value_type x_tile = x.find(i).get();
+      const TSpArrayD::value_type y_tile = y.find(i).get();
+      BOOST_CHECK_EQUAL(x_tile.range(), y_tile.range());
+      for(std::size_t j = 0ul; j < x_tile.size(); ++j)
+        BOOST_CHECK_SMALL(x_tile[j] - y_tile[j], 1.0e-10);
+    }
+  }
+
+  TiledRange tr;
+  TileSymmetry t2_symm;
+
+}; // TileSymmetryFixture
+
+BOOST_FIXTURE_TEST_SUITE( symm_tile_symmetry_suite, TileSymmetryFixture )
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  BOOST_CHECK(TileSymmetry().trivial());
+  BOOST_CHECK_EQUAL(TileSymmetry().order(), 1ul);
+  BOOST_CHECK_EQUAL(t2_symm.order(), 4ul);
+
+  typedef TileSymmetry::element_type element_type;
+  BOOST_CHECK_EQUAL(t2_symm.phase(element_type{1, 0, 2, 3}), -1);
+  BOOST_CHECK_EQUAL(t2_symm.phase(element_type{0, 1, 3, 2}), -1);
+  BOOST_CHECK_EQUAL(t2_symm.phase(element_type{1, 0, 3, 2}), 1);
+
+  TileSymmetry s3 = TileSymmetry::antisymmetric({0, 1, 2});
+  BOOST_CHECK_EQUAL(s3.order(), 6ul);
+  BOOST_CHECK_EQUAL(s3.phase(element_type{1, 2, 0}), 1);
+  BOOST_CHECK_EQUAL(s3.phase(element_type{2, 1, 0}), -1);
+  for(const auto& e : TileSymmetry::symmetric({0, 1, 2}).elements())
+    BOOST_CHECK_EQUAL(e.second, 1);
+
+#ifdef TA_EXCEPTION_ERROR
+  // (0 2) = (0 1)(1 2)(0 1) must have phase -1
+  TileSymmetry::map_type generators = {
+    { element_type{1, 0, 2}, -1 }, { element_type{0, 2, 1}, -1 },
+    { element_type{2, 1, 0}, 1 } };
+  BOOST_CHECK_THROW(TileSymmetry{generators}, TiledArray::Exception);
+#endif // TA_EXCEPTION_ERROR
+}
+
+BOOST_AUTO_TEST_CASE( canonical )
+{
+  const std::vector<std::size_t> index = {3, 1, 2, 0};
+  TileSymmetry::element_type g;
+  const std::vector<std::size_t> canonical = t2_symm.canonical(index, g);
+
+  const std::vector<std::size_t> expected = {1, 3, 0, 2};
+  BOOST_CHECK_EQUAL_COLLECTIONS(canonical.begin(), canonical.end(),
+      expected.begin(), expected.end());
+  BOOST_CHECK_EQUAL(t2_symm.phase(g), 1);
+
+  std::vector<std::size_t> permuted(4);
+  symmetry::detail::permute_array(g, canonical, permuted);
+  BOOST_CHECK_EQUAL_COLLECTIONS(permuted.begin(), permuted.end(),
+      index.begin(), index.end());
+
+  BOOST_CHECK(! t2_symm.is_unique(index));
+  BOOST_CHECK(t2_symm.is_unique(canonical));
+  BOOST_CHECK(t2_symm.is_unique(std::vector<std::size_t>{1, 1, 0, 2}));
+
+  BOOST_CHECK(t2_symm.is_compatible(TiledRange{tr.data()[0], tr.data()[0],
+      tr.data()[1], tr.data()[1]}));
+  BOOST_CHECK(! t2_symm.is_compatible(TiledRange{tr.data()[0], TiledRange1{0, 5, 20},
+      tr.data()[1], tr.data()[1]}));
+}
+
+BOOST_AUTO_TEST_CASE( compress_and_expand )
+{
+  const TileSymmetry symm = TileSymmetry::antisymmetric({0, 1});
+
+  TSpArrayD a(*GlobalFixture::world, tr);
+  a.fill_random();
+  TSpArrayD t;
+  t("i,j") = a("i,j") - a("j,i");
+
+  TSpArrayD c = compress_symmetric(t, symm);
+  BOOST_CHECK(! c.is_zero({0, 1}));
+  BOOST_CHECK(! c.is_zero({1, 1}));
+  BOOST_CHECK(c.is_zero({1, 0}));
+
+  // Check that non-unique tiles map to the unique tiles
+  for(std::size_t i = 0ul; i < t.size(); ++i) {
+    const TSpArrayD::value_type tile = t.find(i).get();
+    const TSpArrayD::value_type symm_tile = find_symmetric(c, symm, i).get();
+    BOOST_CHECK_EQUAL(symm_tile.range(), tile.range());
+    for(std::size_t j = 0ul; j < tile.size(); ++j)
+      BOOST_CHECK_SMALL(symm_tile[j] - tile[j], 1.0e-12);
+  }
+
+  check_equal(expand_symmetric(c, symm), t);
+}
+
+BOOST_AUTO_TEST_CASE( compressed_argument )
+{
+  const TileSymmetry symm = TileSymmetry::antisymmetric({0, 1});
+
+  TSpArrayD a(*GlobalFixture::world, tr);
+  a.fill_random();
+  TSpArrayD t;
+  t("i,j") = a("i,j") - a("j,i");
+
+  TSpArrayD c = compress_symmetric(t, symm);
+  TSpArrayD e = expand_symmetric(c, symm);
+  BOOST_CHECK(! c.symmetry().trivial());
+  BOOST_CHECK(e.symmetry().trivial());
+
+  // The non-unique tiles of c are mapped to its unique tiles
+  TSpArrayD r, r_ref;
+  r("i,j") = c("i,k") * a("k,j");
+  r_ref("i,j") = e("i,k") * a("k,j");
+  check_equal(r, r_ref);
+
+  r("i,j") = c("k,i") * a("k,j");
+  r_ref("i,j") = e("k,i") * a("k,j");
+  check_equal(r, r_ref);
+
+  r("i,j") = 2.0 * c("j,i") + a("i,j");
+  r_ref("i,j") = 2.0 * e("j,i") + a("i,j");
+  check_equal(r, r_ref);
+
+  r("i,j") = c("i,j").block({1, 0}, {3, 2});
+  r_ref("i,j") = e("i,j").block({1, 0}, {3, 2});
+  check_equal(r, r_ref);
+
+  // A result that stores only its unique tiles is also mapped
+  const TileSymmetry s_symm = TileSymmetry::symmetric({0, 1});
+  TSpArrayD s;
+  s("i,j") = (t("i,k") * t("k,j")).set_symmetry(s_symm);
+  BOOST_CHECK(! s.symmetry().trivial());
+  TSpArrayD s_full = expand_symmetric(s, s_symm);
+  r("i,j") = s("i,k") * a("k,j");
+  r_ref("i,j") = s_full("i,k") * a("k,j");
+  check_equal(r, r_ref);
+}
+
+BOOST_AUTO_TEST_CASE( contraction )
+{
+  TSpArrayD a(*GlobalFixture::world, tr);
+  a.fill_random();
+  TSpArrayD t;
+  t("i,j") = a("i,j") - a("j,i");
+
+  // The square of an antisymmetric matrix is symmetric
+  const TileSymmetry symm = TileSymmetry::symmetric({0, 1});
+  TSpArrayD r, r_unique;
+  r("i,j") = t("i,k") * t("k,j");
+  r_unique("i,j") = (t("i,k") * t("k,j")).set_symmetry(symm);
+
+  BOOST_CHECK(! r_unique.is_zero({0, 2}));
+  BOOST_CHECK(r_unique.is_zero({2, 0}));
+  check_equal(expand_symmetric(r_unique, symm), r);
+}
+
+BOOST_AUTO_TEST_CASE( symmetric_result )
+{
+  TSpArrayD a(*GlobalFixture::world, tr);
+  a.fill_random();
+  TSpArrayD at;
+  at("j,k") = a("k,j");
+
+  // The symmetry of a * a^T is detected automatically
+  TSpArrayD r, r_ref;
+  r("i,j") = a("i,k") * a("j,k");
+  r_ref("i,j") = a("i,k") * at("k,j");
+  check_equal(r, r_ref);
+
+  // The symmetry of the result of an antisymmetric matrix squared is given
+  // by the user
+  TSpArrayD t;
+  t("i,j") = a("i,j") - a("j,i");
+  r_ref("i,j") = t("i,k") * t("k,j");
+  r("i,j") = (t("i,k") * t("k,j")).set_result_symmetry(TileSymmetry::symmetric({0, 1}));
+  check_equal(r, r_ref);
+
+  // Dense results
+  TArrayD d(*GlobalFixture::world, tr);
+  d.fill_random();
+  TArrayD s, s_ref, dt;
+  dt("j,k") = d("k,j");
+  s("i,j") = 2.0 * (d("i,k") * d("j,k"));
+  s_ref("i,j") = 2.0 * (d("i,k") * dt("k,j"));
+  for(std::size_t i = 0ul; i < s.size(); ++i) {
+    const TArrayD::value_type tile = s.find(i).get();
+    const TArrayD::value_type ref_tile = s_ref.find(i).get();
+    for(std::size_t j = 0ul; j < tile.size(); ++j)
+      BOOST_CHECK_SMALL(tile[j] - ref_tile[j], 1.0e-10);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
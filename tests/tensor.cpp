@@ -123,6 +123,34 @@ BOOST_AUTO_TEST_CASE( copy_constructor ) {
   BOOST_CHECK_EQUAL_COLLECTIONS(tc.begin(), tc.end(), t.begin(), t.end());
 }
 
+BOOST_AUTO_TEST_CASE( view_constructor ) {
+  // Create external data that is owned by a shared pointer
+  std::shared_ptr<int> data(new int[r.volume()], std::default_delete<int[]>());
+  std::copy(t.begin(), t.end(), data.get());
+  std::weak_ptr<int> owner = data;
+
+  // check constructor
+  BOOST_REQUIRE_NO_THROW(TensorN x(r, data));
+  TensorN x(r, data);
+
+  // Check that the data is not copied
+  BOOST_CHECK(! x.empty());
+  BOOST_CHECK_EQUAL(x.data(), data.get());
+  BOOST_CHECK_EQUAL(x.size(), r.volume());
+  BOOST_CHECK_EQUAL(x.range(), r);
+  BOOST_CHECK_EQUAL_COLLECTIONS(x.begin(), x.end(), t.begin(), t.end());
+
+  // Check that the tensor keeps the owner of the data alive
+  data.reset();
+  BOOST_CHECK(! owner.expired());
+  TensorN y = x;
+  x = TensorN();
+  BOOST_CHECK(! owner.expired());
+  BOOST_CHECK_EQUAL_COLLECTIONS(y.begin(), y.end(), t.begin(), t.end());
+  y = TensorN();
+  BOOST_CHECK(owner.expired());
+}
+
 BOOST_AUTO_TEST_CASE( permute_constructor ) {
   Permutation perm = make_perm();
 
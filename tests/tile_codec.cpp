@@ -0,0 +1,169 @@
+/*
+ *  This file is a part of TiledArray.
+ *  Copyright (C) 2018  Virginia Tech
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  tile_codec.cpp
+ *
+ */
+
+#include "TiledArray/tile_codec.h"
+#include "tiledarray.h"
+#include "unit_test_config.h"
+#include "range_fixture.h"
+
+using namespace TiledArray;
+
+struct TileCodecFixture : public RangeFixture {
+
+  TileCodecFixture() : t(RangeFixture::r), s(RangeFixture::r, 0.0) {
+    GlobalFixture::world->srand(27);
+    for(std::size_t i = 0ul; i < r.volume(); ++i)
+      t[i] = double(GlobalFixture::world->rand()) / RAND_MAX - 0.5;
+
+    // s is mostly zero, with a few non-zero elements
+    for(std::size_t i = 0ul; i < r.volume(); i += 7)
+      s[i] = t[i];
+  }
+
+  ~TileCodecFixture() { }
+
+  template <typename Tile>
+  static Tile round_trip(const Tile& tile, const TileCodec& codec) {
+    detail::PackedTile<Tile> packed(tile, codec);
+
+    // Serialize the encoded tile
+    const std::size_t buf_size = tile.size() * sizeof(typename Tile::value_type) * 2 + 1024;
+    std::unique_ptr<unsigned char[]> buf(new unsigned char[buf_size]);
+    madness::archive::BufferOutputArchive oar(buf.get(), buf_size);
+    oar & packed;
+    const std::size_t nbyte = oar.size();
+    oar.close();
+
+    detail::PackedTile<Tile> received;
+    madness::archive::BufferInputArchive iar(buf.get(), nbyte);
+    iar & received;
+    iar.close();
+
+    return received.unpack();
+  }
+
+  Tensor<double> t;
+  Tensor<double> s;
+
+}; // TileCodecFixture
+
+BOOST_FIXTURE_TEST_SUITE( tile_codec_suite, TileCodecFixture )
+
+BOOST_AUTO_TEST_CASE( constructor )
+{
+  BOOST_CHECK(! TileCodec().enabled());
+  BOOST_CHECK(TileCodec::lossless().enabled());
+  BOOST_CHECK(! TileCodec::lossless().lossy());
+  BOOST_CHECK(TileCodec::downcast().lossy());
+  BOOST_CHECK(TileCodec::truncated(1.0e-4).lossy());
+  BOOST_CHECK_EQUAL(TileCodec::truncated(1.0e-4).mantissa_bits(), 14u);
+#ifdef TA_EXCEPTION_ERROR
+  BOOST_CHECK_THROW(TileCodec::truncated(0.0), TiledArray::Exception);
+#endif // TA_EXCEPTION_ERROR
+}
+
+BOOST_AUTO_TEST_CASE( run_length )
+{
+  std::vector<unsigned char> in = { 1, 2, 3, 0, 0, 0, 0, 0, 0, 4, 4, 5, 5, 5, 5, 5 };
+  std::vector<unsigned char> encoded;
+  detail::rle_encode(in.data(), in.size(), encoded);
+  BOOST_CHECK_LT(encoded.size(), in.size());
+
+  std::vector<unsigned char> out(in.size());
+  detail::rle_decode(encoded.data(), encoded.size(), out.data(), out.size());
+  BOOST_CHECK_EQUAL_COLLECTIONS(in.begin(), in.end(), out.begin(), out.end());
+}
+
+BOOST_AUTO_TEST_CASE( lossless )
+{
+  Tensor<double> result = round_trip(t, TileCodec::lossless());
+  BOOST_CHECK_EQUAL(result.range(), t.range());
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), t.begin(), t.end());
+
+  // Check that sparse data is compressed
+  detail::PackedTile<Tensor<double> > packed(s, TileCodec::lossless());
+  BOOST_CHECK_LT(packed.encoded_size(), packed.decoded_size());
+  result = packed.unpack();
+  BOOST_CHECK_EQUAL_COLLECTIONS(result.begin(), result.end(), s.begin(), s.end());
+}
+
+BOOST_AUTO_TEST_CASE( downcast )
+{
+  Tensor<double> result = round_trip(t, TileCodec::downcast());
+  BOOST_CHECK_EQUAL(result.range(), t.range());
+  for(std::size_t i = 0ul; i < r.volume(); ++i)
+    BOOST_CHECK_EQUAL(result[i], double(float(t[i])));
+}
+
+BOOST_AUTO_TEST_CASE( truncated )
+{
+  const double precision = 1.0e-5;
+  Tensor<double> result = round_trip(t, TileCodec::truncated(precision));
+  BOOST_CHECK_EQUAL(result.range(), t.range());
+  for(std::size_t i = 0ul; i < r.volume(); ++i)
+    BOOST_CHECK_LE(std::abs(result[i] - t[i]), std::abs(t[i]) * precision);
+}
+
+BOOST_AUTO_TEST_CASE( empty_and_other_tiles )
+{
+  Tensor<double> result = round_trip(Tensor<double>(), TileCodec::lossless());
+  BOOST_CHECK(result.empty());
+
+  // Integer tiles are passed through unchanged
+  Tensor<int> i(r, 3);
+  Tensor<int> i_result = round_trip(i, TileCodec::truncated(0.1));
+  BOOST_CHECK_EQUAL_COLLECTIONS(i_result.begin(), i_result.end(), i.begin(), i.end());
+}
+
+BOOST_AUTO_TEST_CASE( contraction )
+{
+  TiledRange tr{{0, 3, 7, 12, 20}, {0, 4, 9, 14, 20}};
+  TArrayD a(*GlobalFixture::world, tr);
+  TArrayD b(*GlobalFixture::world, tr);
+  a.fill_random();
+  b.fill_random();
+
+  TArrayD c, c_lossless, c_truncated;
+  c("i,j") = a("i,k") * b("k,j");
+  c_lossless("i,j") = (a("i,k") * b("k,j")).set_codec(TileCodec::lossless());
+  c_truncated("i,j") = (a("i,k") * b("k,j")).set_codec(TileCodec::truncated(1.0e-6));
+
+  for(std::size_t i = 0ul; i < c.size(); ++i) {
+    if(! c.is_local(i)) continue;
+    const TArrayD::value_type c_tile = c.find(i).get();
+    const TArrayD::value_type lossless_tile = c_lossless.find(i).get();
+    const TArrayD::value_type truncated_tile = c_truncated.find(i).get();
+    for(std::size_t j = 0ul; j < c_tile.size(); ++j) {
+      BOOST_CHECK_CLOSE(lossless_tile[j], c_tile[j], 1.0e-10);
+      BOOST_CHECK_SMALL(truncated_tile[j] - c_tile[j], 1.0e-4);
+    }
+  }
+
+  // Check encoded remote tile requests
+  for(std::size_t i = 0ul; i < a.size(); ++i) {
+    const TArrayD::value_type tile = a.find(i).get();
+    const TArrayD::value_type encoded_tile = a.find(i, TileCodec::lossless()).get();
+    BOOST_CHECK_EQUAL_COLLECTIONS(encoded_tile.begin(), encoded_tile.end(),
+        tile.begin(), tile.end());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -472,4 +472,44 @@ BOOST_AUTO_TEST_CASE( tensor_contract2 )
 }
 
 
+BOOST_AUTO_TEST_CASE( mixed_precision )
+{
+  TensorD left(TensorD::range_type(18, 27)), right(TensorD::range_type(27, 36));
+  for(std::size_t i = 0ul; i < left.size(); ++i)
+    left[i] = GlobalFixture::world->rand() % 27;
+  for(std::size_t i = 0ul; i < right.size(); ++i)
+    right[i] = GlobalFixture::world->rand() % 27;
+  TensorD small_left = left.scale(1.0e-6);
+
+  auto mp = std::make_shared<MixedPrecision>(1.0e-3);
+  ContractReduce<TensorD, TensorD, TensorD, double>
+  op(madness::cblas::NoTrans, madness::cblas::NoTrans, 3, 2u, 2u, 2u);
+  ContractReduce<TensorD, TensorD, TensorD, double>
+  mixed_op(madness::cblas::NoTrans, madness::cblas::NoTrans, 3, 2u, 2u, 2u);
+  mixed_op.set_mixed_precision(mp);
+
+  // Compute the reference result in full precision
+  TensorD reference;
+  op(reference, small_left, right);
+  op(reference, left, right);
+
+  // The contribution of small_left is computed in single precision
+  TensorD result;
+  BOOST_REQUIRE_NO_THROW(mixed_op(result, small_left, right));
+  BOOST_CHECK_EQUAL(mp->single_precision_count(), 1ul);
+  BOOST_CHECK_EQUAL(mp->double_precision_count(), 0ul);
+  BOOST_REQUIRE_NO_THROW(mixed_op(result, left, right));
+  BOOST_CHECK_EQUAL(mp->single_precision_count(), 1ul);
+  BOOST_CHECK_EQUAL(mp->double_precision_count(), 1ul);
+
+  BOOST_CHECK_EQUAL(result.range(), reference.range());
+  for(std::size_t i = 0ul; i < result.size(); ++i)
+    BOOST_CHECK_CLOSE(result[i], reference[i], 1.0e-6);
+
+  // The operation without a mixed precision object is not counted
+  op(result, left, right);
+  BOOST_CHECK_EQUAL(mp->double_precision_count(), 1ul);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
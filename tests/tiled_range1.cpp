@@ -184,6 +184,22 @@ BOOST_AUTO_TEST_CASE( element_to_tile )
   BOOST_CHECK_EQUAL_COLLECTIONS(c.begin(), c.end(), e.begin(), e.end());
 }
 
+BOOST_AUTO_TEST_CASE( element_to_tile_uniform )
+{
+  TiledRange1 u{ 3, 7, 11, 15, 17 };
+  TiledRange1 n{ 3, 7, 11, 12, 17 };
+  BOOST_CHECK_EQUAL(u.tile_size(), 4ul);
+  BOOST_CHECK_EQUAL(n.tile_size(), 0ul);
+  BOOST_CHECK_EQUAL((TiledRange1{ 0, 5 }).tile_size(), 5ul);
+  BOOST_CHECK_EQUAL((TiledRange1{ 0, 2, 5 }).tile_size(), 0ul);
+
+  // Check that the division and the binary search give the tile of each element
+  for(const TiledRange1& tr : { u, n })
+    for(std::size_t t = tr.tiles_range().first; t < tr.tiles_range().second; ++t)
+      for(std::size_t i = tr.tile(t).first; i < tr.tile(t).second; ++i)
+        BOOST_CHECK_EQUAL(tr.element_to_tile(i), t);
+}
+
 BOOST_AUTO_TEST_CASE( comparison )
 {
   TiledRange1 r1{ 1, 2, 4, 6, 8, 10 };